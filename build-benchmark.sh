@@ -0,0 +1,6 @@
+#!/bin/bash
+# -fno-math-errno and -fno-trapping-math don't change any results, they let GCC
+# vectorize std::sqrt and the selects in ReactorEnsemble::tick().
+# -ffp-contract=off stops -march=native fusing multiplies and adds differently
+# wherever a function is inlined, so the bit for bit comparisons hold
+g++ src/benchmark-desktop.cpp src/control_rod.cpp src/reactor.cpp src/reactor_parameters.cpp -O3 -march=native -fno-math-errno -fno-trapping-math -ffp-contract=off -std=c++20 -o build/benchmark
@@ -1,2 +1,2 @@
 #!/bin/bash
-g++ src/main-desktop.cpp src/control_rod.cpp src/reactor.cpp -O3 -std=c++20 -o build/desktop
+g++ src/main-desktop.cpp src/control_rod.cpp src/reactor.cpp src/reactor_parameters.cpp -O3 -std=c++20 -o build/desktop
@@ -0,0 +1,2966 @@
+// Desktop benchmarks for the reactor model
+//
+// Build with build-benchmark.sh, then run build/benchmark to run everything,
+// or build/benchmark <name> to only run one of them
+#include "constants.hpp"
+#include "decay_heat_groups.hpp"
+#include "fuel_element_temperatures.hpp"
+#include "precursor_groups.hpp"
+#include "reactor.hpp"
+#include "reactor_ensemble.hpp"
+#include "reactor_parameters.hpp"
+#include "reactor_presets.hpp"
+#include "reactor_snapshot_file.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <stdio.h>
+#include <vector>
+
+/// Written to after every benchmark, so the compiler can't throw away the
+/// work we're measuring
+static volatile double benchmark_sink = 0.0;
+
+/// Runs step() a number of times and returns how many nanoseconds one call took
+template <typename F> double measure_ns_per_step(uint64_t steps, F &&step) {
+  // Warm up the caches and the branch predictor
+  for (uint64_t i = 0; i < steps / 10; i++) {
+    step();
+  }
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (uint64_t i = 0; i < steps; i++) {
+    step();
+  }
+
+  auto end = std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         (double)steps;
+}
+
+void print_result(const char *name, double ns_per_step,
+                  double baseline_ns_per_step) {
+  printf("  %-44s %9.2f ns/step  (%.2fx)\n", name, ns_per_step,
+         baseline_ns_per_step / ns_per_step);
+}
+
+// == Precursor groups ==
+
+/// Copy of the kinetics from before the precursor groups were arrays, kept
+/// here as the baseline
+class SwitchPrecursorKinetics {
+public:
+  double neutrons_in_core = 1e6;
+  double reactivity_pcm = -100.0;
+
+  double neutron_population_group_1 = 0.0;
+  double neutron_population_group_2 = 0.0;
+  double neutron_population_group_3 = 0.0;
+  double neutron_population_group_4 = 0.0;
+  double neutron_population_group_5 = 0.0;
+  double neutron_population_group_6 = 0.0;
+
+  double get_neutron_population_for_group(uint8_t group) {
+    switch (group) {
+    case 1:
+      return neutron_population_group_1;
+    case 2:
+      return neutron_population_group_2;
+    case 3:
+      return neutron_population_group_3;
+    case 4:
+      return neutron_population_group_4;
+    case 5:
+      return neutron_population_group_5;
+    case 6:
+      return neutron_population_group_6;
+    default:
+      return 0.0;
+    }
+  }
+
+  double get_delayed_neutron_fraction_for_group(uint8_t group) {
+    switch (group) {
+    case 1:
+      return DELAYED_NEUTRON_FRACTION_GROUP_1;
+    case 2:
+      return DELAYED_NEUTRON_FRACTION_GROUP_2;
+    case 3:
+      return DELAYED_NEUTRON_FRACTION_GROUP_3;
+    case 4:
+      return DELAYED_NEUTRON_FRACTION_GROUP_4;
+    case 5:
+      return DELAYED_NEUTRON_FRACTION_GROUP_5;
+    case 6:
+      return DELAYED_NEUTRON_FRACTION_GROUP_6;
+    default:
+      return 0.0;
+    }
+  }
+
+  double get_neutron_decay_time_for_group(uint8_t group) {
+    switch (group) {
+    case 1:
+      return DECAY_TIME_GROUP_1;
+    case 2:
+      return DECAY_TIME_GROUP_2;
+    case 3:
+      return DECAY_TIME_GROUP_3;
+    case 4:
+      return DECAY_TIME_GROUP_4;
+    case 5:
+      return DECAY_TIME_GROUP_5;
+    case 6:
+      return DECAY_TIME_GROUP_6;
+    default:
+      return 0.0;
+    }
+  }
+
+  double calculate_dN_dt() {
+    double neutrons_from_population =
+        DECAY_TIME_GROUP_1 * neutron_population_group_1;
+    neutrons_from_population += DECAY_TIME_GROUP_2 * neutron_population_group_2;
+    neutrons_from_population += DECAY_TIME_GROUP_3 * neutron_population_group_3;
+    neutrons_from_population += DECAY_TIME_GROUP_4 * neutron_population_group_4;
+    neutrons_from_population += DECAY_TIME_GROUP_5 * neutron_population_group_5;
+    neutrons_from_population += DECAY_TIME_GROUP_6 * neutron_population_group_6;
+
+    double effective_delayed_neutron_fraction =
+        DELAYED_NEUTRON_FRACTION_GROUP_1 + DELAYED_NEUTRON_FRACTION_GROUP_2 +
+        DELAYED_NEUTRON_FRACTION_GROUP_3 + DELAYED_NEUTRON_FRACTION_GROUP_4 +
+        DELAYED_NEUTRON_FRACTION_GROUP_5 + DELAYED_NEUTRON_FRACTION_GROUP_6;
+
+    double balanced_reactivity =
+        reactivity_pcm * 1e-5 - effective_delayed_neutron_fraction;
+
+    return neutrons_in_core *
+               (balanced_reactivity / PROMPT_NEUTRON_LIFETIME_SECONDS) +
+           neutrons_from_population +
+           NEUTRON_SOURCE_INTENSITY_NEUTRONS_PER_SECOND;
+  }
+
+  double calculate_dCi_dt(uint8_t i) {
+    double a =
+        get_delayed_neutron_fraction_for_group(i) / PROMPT_NEUTRON_LIFETIME_SECONDS;
+
+    return a * neutrons_in_core -
+           get_neutron_decay_time_for_group(i) *
+               get_neutron_population_for_group(i);
+  }
+
+  void tick(double time_delta_seconds) {
+    neutrons_in_core += calculate_dN_dt() * time_delta_seconds;
+
+    neutron_population_group_1 += calculate_dCi_dt(1) * time_delta_seconds;
+    neutron_population_group_2 += calculate_dCi_dt(2) * time_delta_seconds;
+    neutron_population_group_3 += calculate_dCi_dt(3) * time_delta_seconds;
+    neutron_population_group_4 += calculate_dCi_dt(4) * time_delta_seconds;
+    neutron_population_group_5 += calculate_dCi_dt(5) * time_delta_seconds;
+    neutron_population_group_6 += calculate_dCi_dt(6) * time_delta_seconds;
+  }
+};
+
+/// The same kinetics on top of the array based precursor groups
+template <uint8_t GROUPS> class ArrayPrecursorKinetics {
+public:
+  ArrayPrecursorKinetics(const std::array<double, GROUPS> &fractions,
+                         const std::array<double, GROUPS> &decay_times)
+      : constants(PrecursorGroupConstants<GROUPS>::calculate(
+            fractions, decay_times, PROMPT_NEUTRON_LIFETIME_SECONDS)) {}
+
+  double neutrons_in_core = 1e6;
+  double reactivity_pcm = -100.0;
+
+  PrecursorGroupConstants<GROUPS> constants;
+  PrecursorGroups<GROUPS> precursor_groups;
+
+  void tick(double time_delta_seconds) {
+    double balanced_reactivity =
+        reactivity_pcm * 1e-5 - constants.effective_delayed_neutron_fraction;
+
+    neutrons_in_core +=
+        (neutrons_in_core *
+             (balanced_reactivity / PROMPT_NEUTRON_LIFETIME_SECONDS) +
+         precursor_groups.calculate_delayed_neutron_source(constants) +
+         NEUTRON_SOURCE_INTENSITY_NEUTRONS_PER_SECOND) *
+        time_delta_seconds;
+
+    precursor_groups.integrate_euler(neutrons_in_core, time_delta_seconds,
+                                     constants);
+  }
+};
+
+void benchmark_precursor_groups() {
+  printf("precursors: point kinetics step, switch dispatch vs arrays\n");
+
+  const uint64_t steps = 20000000;
+  const double time_delta_seconds = 1e-4;
+
+  SwitchPrecursorKinetics switch_kinetics;
+  double switch_ns = measure_ns_per_step(
+      steps, [&]() { switch_kinetics.tick(time_delta_seconds); });
+  benchmark_sink = switch_kinetics.neutrons_in_core;
+
+  ArrayPrecursorKinetics<6> array_kinetics_6(DELAYED_NEUTRON_FRACTIONS_6_GROUP,
+                                             DECAY_TIMES_6_GROUP);
+  double array_6_ns = measure_ns_per_step(
+      steps, [&]() { array_kinetics_6.tick(time_delta_seconds); });
+  benchmark_sink = array_kinetics_6.neutrons_in_core;
+
+  ArrayPrecursorKinetics<8> array_kinetics_8(DELAYED_NEUTRON_FRACTIONS_8_GROUP,
+                                             DECAY_TIMES_8_GROUP);
+  double array_8_ns = measure_ns_per_step(
+      steps, [&]() { array_kinetics_8.tick(time_delta_seconds); });
+  benchmark_sink = array_kinetics_8.neutrons_in_core;
+
+  print_result("switch, 6 groups (old Reactor code)", switch_ns, switch_ns);
+  print_result("PrecursorGroups<6>", array_6_ns, switch_ns);
+  print_result("PrecursorGroups<8>", array_8_ns, switch_ns);
+
+  // Same steps, so the 6 group results have to agree exactly
+  printf("  6 group results identical: %s\n",
+         switch_kinetics.neutrons_in_core == array_kinetics_6.neutrons_in_core
+             ? "yes"
+             : "NO");
+
+  Reactor reactor;
+  double reactor_ns = measure_ns_per_step(steps / 10, [&]() { reactor.tick(); });
+  benchmark_sink = reactor.get_neutrons_in_core();
+
+  printf("  %-44s %9.2f ns/step\n", "full Reactor::tick()", reactor_ns);
+}
+
+// == Precursor integration ==
+
+/// Moves precursor groups forward under a neutron population that grows with
+/// a stable period, and returns the relative error of the delayed neutron
+/// source (sum of lambda_i * Ci) against the exact solution at the end
+double calculate_precursor_integration_error(PrecursorIntegration integration,
+                                             double time_delta_seconds) {
+  const double period_seconds = 10.0;
+  const double neutrons_at_start = 1e9;
+  const double end_time_seconds = 20.0;
+
+  const auto constants = PrecursorGroupConstants<DELAYED_NEUTRON_GROUPS>::
+      calculate(DELAYED_NEUTRON_FRACTIONS, DECAY_TIMES,
+                PROMPT_NEUTRON_LIFETIME_SECONDS);
+  PrecursorGroups<DELAYED_NEUTRON_GROUPS> groups;
+  PrecursorStepExponentials<DELAYED_NEUTRON_GROUPS> exponentials;
+  exponentials.set_time_delta_seconds(time_delta_seconds, constants);
+
+  // Start in equilibrium, Ci = a N / lambda_i, the exact solution is then
+  // Ci(t) = g e^(t / T) + (Ci(0) - g) e^(-lambda_i t), g = a N / (lambda_i + 1/T)
+  double exact_source = 0.0;
+
+  for (uint8_t i = 0; i < DELAYED_NEUTRON_GROUPS; i++) {
+    double a = DELAYED_NEUTRON_FRACTIONS[i] / PROMPT_NEUTRON_LIFETIME_SECONDS;
+    double lambda = DECAY_TIMES[i];
+
+    double equilibrium = a * neutrons_at_start / lambda;
+    double growing = a * neutrons_at_start / (lambda + 1.0 / period_seconds);
+
+    groups.set_population(i, equilibrium);
+
+    exact_source +=
+        lambda * (growing * std::exp(end_time_seconds / period_seconds) +
+                  (equilibrium - growing) * std::exp(-lambda * end_time_seconds));
+  }
+
+  uint64_t steps = (uint64_t)std::llround(end_time_seconds / time_delta_seconds);
+
+  for (uint64_t step = 0; step < steps; step++) {
+    double neutrons_at_step_start =
+        neutrons_at_start *
+        std::exp((double)step * time_delta_seconds / period_seconds);
+    double neutrons_at_step_end =
+        neutrons_at_start *
+        std::exp((double)(step + 1) * time_delta_seconds / period_seconds);
+
+    // Same neutron values as Reactor::tick() hands over
+    switch (integration) {
+    case PrecursorIntegration::EULER:
+      groups.integrate_euler(neutrons_at_step_end, time_delta_seconds,
+                             constants);
+      break;
+    case PrecursorIntegration::EXPONENTIAL:
+      groups.integrate_exponential(neutrons_at_step_start,
+                                   neutrons_at_step_end, exponentials);
+      break;
+    }
+  }
+
+  return std::abs(groups.calculate_delayed_neutron_source(constants) -
+                  exact_source) /
+         exact_source;
+}
+
+void benchmark_precursor_integration() {
+  printf("exponential: precursor integration accuracy and cost\n");
+
+  const PrecursorIntegration integrations[] = {
+      PrecursorIntegration::EULER,
+      PrecursorIntegration::EXPONENTIAL,
+  };
+  const char *names[] = {"euler", "exponential"};
+
+  printf("  relative error of sum(lambda_i Ci) after 20 s on a 10 s period:\n");
+  printf("  %-24s %10s %10s %10s %10s\n", "", "dt=1e-4", "dt=1e-3",
+         "dt=1e-2", "dt=1e-1");
+
+  for (uint8_t m = 0; m < 2; m++) {
+    printf("  %-24s", names[m]);
+
+    for (double time_delta_seconds : {1e-4, 1e-3, 1e-2, 1e-1}) {
+      printf(" %10.2e", calculate_precursor_integration_error(
+                            integrations[m], time_delta_seconds));
+    }
+
+    printf("\n");
+  }
+
+  const uint64_t steps = 20000000;
+  const double time_delta_seconds = 1e-4;
+
+  const auto constants = PrecursorGroupConstants<DELAYED_NEUTRON_GROUPS>::
+      calculate(DELAYED_NEUTRON_FRACTIONS, DECAY_TIMES,
+                PROMPT_NEUTRON_LIFETIME_SECONDS);
+  PrecursorGroups<DELAYED_NEUTRON_GROUPS> groups;
+  PrecursorStepExponentials<DELAYED_NEUTRON_GROUPS> exponentials;
+  exponentials.set_time_delta_seconds(time_delta_seconds, constants);
+
+  double neutrons = 1e9;
+
+  double euler_ns = measure_ns_per_step(steps, [&]() {
+    groups.integrate_euler(neutrons, time_delta_seconds, constants);
+  });
+  double exponential_ns = measure_ns_per_step(steps, [&]() {
+    groups.integrate_exponential(neutrons, neutrons, exponentials);
+  });
+  benchmark_sink = groups.calculate_delayed_neutron_source(constants);
+
+  print_result("euler", euler_ns, euler_ns);
+  print_result("exponential", exponential_ns, euler_ns);
+}
+
+// == Reactor ensemble ==
+
+void benchmark_reactor_ensemble() {
+  printf("ensemble: 64 reactors, loop over Reactor vs ReactorEnsemble<64>\n");
+
+  const size_t members = 64;
+  const uint64_t ticks = 200000;
+
+  // Different target powers, so members take different branches
+  std::vector<Reactor> reactors(members);
+  ReactorEnsemble<members> ensemble;
+
+  for (size_t i = 0; i < members; i++) {
+    reactors[i].set_target_thermal_power_watts(10000 + 3000 * i);
+    ensemble.set_target_thermal_power_watts(i, 10000 + 3000 * i);
+  }
+
+  double reactors_ns = measure_ns_per_step(ticks, [&]() {
+    for (auto &reactor : reactors) {
+      reactor.tick();
+    }
+  });
+
+  double ensemble_ns = measure_ns_per_step(ticks, [&]() { ensemble.tick(); });
+
+  print_result("64x Reactor::tick()", reactors_ns, reactors_ns);
+  print_result("ReactorEnsemble<64>::tick()", ensemble_ns, reactors_ns);
+
+  double seconds_per_tick = reactors[0].get_time_delta_seconds();
+  printf("  reactor-seconds per core-second: %.0f (Reactor), %.0f (ensemble)\n",
+         members * seconds_per_tick / (reactors_ns * 1e-9),
+         members * seconds_per_tick / (ensemble_ns * 1e-9));
+
+  // Both ran the same number of ticks, so the members should agree
+  double max_relative_difference = 0.0;
+  uint32_t rod_mismatches = 0;
+
+  for (size_t i = 0; i < members; i++) {
+    double neutrons = reactors[i].get_neutrons_in_core();
+    max_relative_difference =
+        std::max(max_relative_difference,
+                 std::abs(ensemble.get_neutrons_in_core(i) - neutrons) /
+                     neutrons);
+    max_relative_difference = std::max(
+        max_relative_difference,
+        std::abs(ensemble.get_fuel_temperature_celcius(i) -
+                 reactors[i].get_fuel_temperature_celcius()) /
+            reactors[i].get_fuel_temperature_celcius());
+
+    rod_mismatches += ensemble.get_regulating_rod_position(i) !=
+                      reactors[i].get_regulating_control_rod()
+                          ->get_current_position();
+  }
+
+  printf("  max relative difference to Reactor: %.2e, rod mismatches: %u\n",
+         max_relative_difference, rod_mismatches);
+  benchmark_sink = ensemble.get_neutrons_in_core(0);
+}
+
+// == Integrators ==
+
+/// Result of simulating a reactor for a while
+struct SimulationResult {
+  uint64_t steps;
+  double wall_seconds;
+  double scram_time_seconds;
+  double power_at_scram_watts;
+};
+
+/// Ticks a reactor until it has simulated a number of seconds, noting when the
+/// first SCRAM happened
+SimulationResult simulate(Reactor &reactor, double seconds) {
+  SimulationResult result = {0, 0.0, -1.0, 0.0};
+
+  auto start = std::chrono::steady_clock::now();
+
+  while (reactor.get_time_elapsed_seconds() < seconds) {
+    bool was_in_scram = reactor.get_in_scram();
+
+    reactor.tick();
+    result.steps++;
+
+    if (!was_in_scram && reactor.get_in_scram() &&
+        result.scram_time_seconds < 0.0) {
+      result.scram_time_seconds = reactor.get_time_elapsed_seconds();
+      result.power_at_scram_watts = reactor.calculate_power_watts();
+    }
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  result.wall_seconds = std::chrono::duration<double>(end - start).count();
+
+  benchmark_sink = reactor.get_neutrons_in_core();
+
+  return result;
+}
+
+/// Creates a reactor starting up from cold, either holding 100 kW with the
+/// automatic control or with the regulating rod held at a fixed position
+template <typename Scalar = double>
+BasicReactor<Scalar> create_startup_reactor(float time_delta_seconds,
+                                            bool automatic_control,
+                                            uint32_t regulating_rod_position) {
+  BasicReactor<Scalar> reactor;
+  reactor.set_time_delta_seconds(time_delta_seconds);
+  reactor.automatic_control = automatic_control;
+  reactor.set_target_thermal_power_watts(100000);
+
+  if (!automatic_control) {
+    reactor.get_regulating_control_rod()->set_current_position(
+        regulating_rod_position);
+    reactor.get_regulating_control_rod()->set_target_position(
+        regulating_rod_position);
+  }
+
+  return reactor;
+}
+
+/// Simulates one hour from a cold start, either holding 100 kW with the
+/// automatic control or with the regulating rod held at 57.5 %, which is
+/// supercritical and runs into the power SCRAM
+SimulationResult simulate_hour(Integrator integrator, double time_delta_seconds,
+                               bool automatic_control) {
+  Reactor reactor =
+      create_startup_reactor(time_delta_seconds, automatic_control, 23e5);
+  reactor.integrator = integrator;
+
+  return simulate(reactor, 3600.0);
+}
+
+void benchmark_integrators() {
+  printf("integrators: steps and wall time per simulated hour\n");
+
+  struct {
+    const char *name;
+    Integrator integrator;
+    double time_delta_seconds;
+  } integrators[] = {
+      {"euler, dt = 0.1 ms", Integrator::EULER, 1e-4},
+      {"rk4, dt = 1 ms", Integrator::RK4, 1e-3},
+      {"rk45, adaptive", Integrator::RK45, 1e-4},
+      {"rosenbrock23, adaptive", Integrator::ROSENBROCK23, 1e-4},
+  };
+
+  printf("  holding 100 kW with the automatic control:\n");
+
+  for (auto &integrator : integrators) {
+    SimulationResult result = simulate_hour(integrator.integrator,
+                                      integrator.time_delta_seconds, true);
+
+    printf("  %-24s %10llu steps %8.3f s\n", integrator.name,
+           (unsigned long long)result.steps, result.wall_seconds);
+  }
+
+  printf("  regulating rod fixed at 57.5 %%, power SCRAM:\n");
+
+  for (auto &integrator : integrators) {
+    SimulationResult result = simulate_hour(integrator.integrator,
+                                      integrator.time_delta_seconds, false);
+
+    printf("  %-24s %10llu steps %8.3f s, SCRAM at %.5f s, %.0f W\n",
+           integrator.name, (unsigned long long)result.steps,
+           result.wall_seconds, result.scram_time_seconds,
+           result.power_at_scram_watts);
+  }
+}
+
+// == Prompt jump ==
+
+void benchmark_prompt_jump() {
+  printf("prompt-jump: 10 minutes from a cold start, euler at 0.1 ms vs the "
+         "prompt jump approximation\n");
+
+  struct {
+    const char *name;
+    bool automatic_control;
+    uint32_t regulating_rod_position;
+  } scenarios[] = {
+      {"automatic control, 100 kW", true, 0},
+      {"regulating rod at 62.5 %, ~0.55 $", false, 2500000},
+      {"regulating rod at 56.25 %, ~0.9 $", false, 2250000},
+  };
+
+  for (auto &scenario : scenarios) {
+    printf("  %s:\n", scenario.name);
+
+    for (float time_delta_seconds : {1e-4f, 5e-3f, 1e-2f, 2e-2f}) {
+      for (bool prompt_jump : {false, true}) {
+        // Plain euler is only stable at short steps
+        if (!prompt_jump && time_delta_seconds > 1e-4f) {
+          continue;
+        }
+
+        Reactor reactor =
+            create_startup_reactor(time_delta_seconds,
+                                   scenario.automatic_control,
+                                   scenario.regulating_rod_position);
+        reactor.prompt_jump = prompt_jump;
+
+        if (prompt_jump) {
+          reactor.precursor_integration = PrecursorIntegration::EXPONENTIAL;
+        }
+
+        uint64_t prompt_jump_steps = 0;
+        SimulationResult result = {0, 0.0, -1.0, 0.0};
+        auto start = std::chrono::steady_clock::now();
+
+        while (reactor.get_time_elapsed_seconds() < 600.0) {
+          bool was_in_scram = reactor.get_in_scram();
+
+          reactor.tick();
+          result.steps++;
+          prompt_jump_steps += reactor.get_prompt_jump_active();
+
+          if (!was_in_scram && reactor.get_in_scram() &&
+              result.scram_time_seconds < 0.0) {
+            result.scram_time_seconds = reactor.get_time_elapsed_seconds();
+          }
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        result.wall_seconds =
+            std::chrono::duration<double>(end - start).count();
+
+        char name[64];
+        snprintf(name, sizeof(name), "%s, dt = %g ms",
+                 prompt_jump ? "prompt jump" : "euler",
+                 time_delta_seconds * 1e3);
+
+        printf("    %-28s %8.0fx real time, %5.1f %% prompt jump, ", name,
+               600.0 / result.wall_seconds,
+               100.0 * (double)prompt_jump_steps / (double)result.steps);
+
+        if (result.scram_time_seconds >= 0.0) {
+          printf("SCRAM at %.3f s\n", result.scram_time_seconds);
+        } else {
+          printf("%.0f W, fuel %.2f C\n", reactor.calculate_power_watts(),
+                 reactor.get_fuel_temperature_celcius());
+        }
+      }
+    }
+  }
+}
+
+// == Multi-rate ==
+
+void benchmark_multi_rate() {
+  printf("multi-rate: fuel and water temperature updates every n ticks\n");
+
+  struct {
+    const char *name;
+    uint32_t fuel_interval_ticks;
+    uint32_t water_interval_ticks;
+  } rates[] = {
+      {"all at 10 kHz", 1, 1},
+      {"fuel 1 kHz, water 10 kHz", 10, 1},
+      {"fuel 1 kHz, water 10 Hz", 10, 1000},
+  };
+
+  double baseline_ns = 0.0;
+
+  for (auto &rate : rates) {
+    // Start from 100 kW, without active cooling so the water heats up
+    Reactor reactor = create_startup_reactor(1e-4f, true, 0);
+    reactor.fuel_temperature_update_interval_ticks = rate.fuel_interval_ticks;
+    reactor.water_temperature_update_interval_ticks = rate.water_interval_ticks;
+    reactor.set_active_cooling_system_enabled(false);
+
+    simulate(reactor, 300.0);
+
+    double ns = measure_ns_per_step(3000000, [&]() { reactor.tick(); });
+
+    if (baseline_ns == 0.0) {
+      baseline_ns = ns;
+    }
+
+    print_result(rate.name, ns, baseline_ns);
+    printf("    after %.0f s: %.1f W, fuel %.4f C, water %.4f C\n",
+           reactor.get_time_elapsed_seconds(), reactor.calculate_power_watts(),
+           reactor.get_fuel_temperature_celcius(),
+           reactor.get_water_temperature_celcius());
+  }
+}
+
+// == Scalar types ==
+
+/// Neutrons, power and temperatures of a reactor once every simulated second
+struct ScalarTypeTrace {
+  std::vector<double> neutrons;
+  std::vector<double> power_watts;
+  std::vector<double> fuel_temperatures_celcius;
+  std::vector<double> water_temperatures_celcius;
+  double scram_time_seconds = -1.0;
+  double ns_per_tick = 0.0;
+};
+
+/// Runs one of the standard transients on a BasicReactor<Scalar>, with the
+/// temperatures updated every fuel_interval_ticks and water_interval_ticks
+template <typename Scalar>
+ScalarTypeTrace trace_scalar_type(bool automatic_control,
+                                  uint32_t regulating_rod_position,
+                                  bool active_cooling, double seconds,
+                                  uint32_t fuel_interval_ticks,
+                                  uint32_t water_interval_ticks,
+                                  bool logarithmic_neutrons = false,
+                                  bool approximate_thermal_math = false) {
+  BasicReactor<Scalar> reactor = create_startup_reactor<Scalar>(
+      1e-4f, automatic_control, regulating_rod_position);
+  reactor.fuel_temperature_update_interval_ticks = fuel_interval_ticks;
+  reactor.water_temperature_update_interval_ticks = water_interval_ticks;
+  reactor.set_active_cooling_system_enabled(active_cooling);
+  reactor.set_logarithmic_neutron_population(logarithmic_neutrons);
+  reactor.approximate_thermal_math = approximate_thermal_math;
+
+  ScalarTypeTrace trace;
+  uint64_t ticks = 0;
+  auto start = std::chrono::steady_clock::now();
+
+  // 1e4 ticks of 0.1 ms per sample
+  for (uint32_t second = 0; second < (uint32_t)seconds; second++) {
+    for (uint32_t i = 0; i < 10000; i++) {
+      bool was_in_scram = reactor.get_in_scram();
+
+      reactor.tick();
+      ticks++;
+
+      if (!was_in_scram && reactor.get_in_scram() &&
+          trace.scram_time_seconds < 0.0) {
+        trace.scram_time_seconds = reactor.get_time_elapsed_seconds();
+      }
+    }
+
+    trace.neutrons.push_back(reactor.get_neutrons_in_core());
+    trace.power_watts.push_back((double)reactor.calculate_power_watts());
+    trace.fuel_temperatures_celcius.push_back(
+        (double)reactor.get_fuel_temperature_celcius());
+    trace.water_temperatures_celcius.push_back(
+        (double)reactor.get_water_temperature_celcius());
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  trace.ns_per_tick =
+      std::chrono::duration<double, std::nano>(end - start).count() /
+      (double)ticks;
+
+  benchmark_sink = reactor.get_neutrons_in_core();
+
+  return trace;
+}
+
+void benchmark_scalar_types() {
+  printf("scalar-types: float and Q32.32 fixed point against the double "
+         "reference, dt = 0.1 ms\n");
+
+  struct {
+    const char *name;
+    bool automatic_control;
+    uint32_t regulating_rod_position;
+    bool active_cooling;
+    double seconds;
+  } transients[] = {
+      {"startup to 100 kW", true, 0, true, 300.0},
+      {"regulating rod at 62.5 %, to SCRAM", false, 2500000, true, 200.0},
+      {"loss of cooling at 100 kW", true, 0, false, 600.0},
+  };
+
+  for (auto &transient : transients) {
+    printf("  %s:\n", transient.name);
+
+    auto trace = [&](auto scalar, uint32_t fuel_interval_ticks,
+                     uint32_t water_interval_ticks) {
+      return trace_scalar_type<decltype(scalar)>(
+          transient.automatic_control, transient.regulating_rod_position,
+          transient.active_cooling, transient.seconds, fuel_interval_ticks,
+          water_interval_ticks);
+    };
+
+    ScalarTypeTrace reference = trace(0.0, 1, 1);
+
+    struct {
+      const char *name;
+      ScalarTypeTrace trace;
+    } variants[] = {
+        {"double, multi-rate", trace(0.0, 10, 1000)},
+        {"float", trace(0.0f, 1, 1)},
+        {"float, multi-rate", trace(0.0f, 10, 1000)},
+        {"Q32.32, multi-rate", trace(Q32_32(0), 10, 1000)},
+    };
+
+    printf("    %-20s %8.1f ns/tick", "double", reference.ns_per_tick);
+
+    if (reference.scram_time_seconds >= 0.0) {
+      printf(", SCRAM at %.4f s", reference.scram_time_seconds);
+    }
+
+    printf("\n");
+
+    for (auto &variant : variants) {
+      double max_power_error = 0.0;
+      double max_fuel_error_celcius = 0.0;
+      double max_water_error_celcius = 0.0;
+
+      for (size_t i = 0; i < reference.power_watts.size(); i++) {
+        // Relative errors of a shut down core don't mean much
+        if (reference.power_watts[i] > 1.0) {
+          max_power_error = std::max(
+              max_power_error, std::fabs(variant.trace.power_watts[i] -
+                                         reference.power_watts[i]) /
+                                   reference.power_watts[i]);
+        }
+
+        max_fuel_error_celcius =
+            std::max(max_fuel_error_celcius,
+                     std::fabs(variant.trace.fuel_temperatures_celcius[i] -
+                               reference.fuel_temperatures_celcius[i]));
+        max_water_error_celcius =
+            std::max(max_water_error_celcius,
+                     std::fabs(variant.trace.water_temperatures_celcius[i] -
+                               reference.water_temperatures_celcius[i]));
+      }
+
+      printf("    %-20s %8.1f ns/tick, power %.1e, fuel %.1e C, water %.1e C",
+             variant.name, variant.trace.ns_per_tick, max_power_error,
+             max_fuel_error_celcius, max_water_error_celcius);
+
+      if (reference.scram_time_seconds >= 0.0) {
+        printf(", SCRAM %+.4f s", variant.trace.scram_time_seconds -
+                                      reference.scram_time_seconds);
+      }
+
+      printf("\n");
+    }
+  }
+}
+
+// == Logarithmic neutrons ==
+
+void benchmark_logarithmic_neutrons() {
+  printf("log-neutrons: the neutrons and their logarithm against the double "
+         "neutrons, dt = 0.1 ms, fuel 1 kHz, water 10 Hz\n");
+
+  struct {
+    const char *name;
+    uint32_t regulating_rod_position;
+    double seconds;
+  } transients[] = {
+      {"rods in, at the source level", 4000000, 100.0},
+      {"regulating rod at 62.5 %, to SCRAM", 2500000, 200.0},
+  };
+
+  for (auto &transient : transients) {
+    printf("  %s:\n", transient.name);
+
+    auto trace = [&](auto scalar, bool logarithmic_neutrons) {
+      return trace_scalar_type<decltype(scalar)>(
+          false, transient.regulating_rod_position, true, transient.seconds,
+          10, 1000, logarithmic_neutrons);
+    };
+
+    ScalarTypeTrace reference = trace(0.0, false);
+
+    struct {
+      const char *name;
+      ScalarTypeTrace trace;
+    } variants[] = {
+        {"double, logarithmic", trace(0.0, true)},
+        {"float", trace(0.0f, false)},
+        {"float, logarithmic", trace(0.0f, true)},
+        {"Q32.32", trace(Q32_32(0), false)},
+        {"Q32.32, logarithmic", trace(Q32_32(0), true)},
+    };
+
+    printf("    %-20s %8.1f ns/tick, %.3g to %.3g neutrons", "double",
+           reference.ns_per_tick,
+           *std::min_element(reference.neutrons.begin(),
+                             reference.neutrons.end()),
+           *std::max_element(reference.neutrons.begin(),
+                             reference.neutrons.end()));
+
+    if (reference.scram_time_seconds >= 0.0) {
+      printf(", SCRAM at %.4f s", reference.scram_time_seconds);
+    }
+
+    printf("\n");
+
+    for (auto &variant : variants) {
+      // Over every sample, the source level ones included
+      double max_neutron_error = 0.0;
+
+      for (size_t i = 0; i < reference.neutrons.size(); i++) {
+        max_neutron_error = std::max(
+            max_neutron_error,
+            std::fabs(variant.trace.neutrons[i] - reference.neutrons[i]) /
+                reference.neutrons[i]);
+      }
+
+      printf("    %-20s %8.1f ns/tick, neutrons %.1e", variant.name,
+             variant.trace.ns_per_tick, max_neutron_error);
+
+      if (reference.scram_time_seconds >= 0.0) {
+        printf(", SCRAM %+.4f s", variant.trace.scram_time_seconds -
+                                      reference.scram_time_seconds);
+      }
+
+      printf("\n");
+    }
+  }
+}
+
+// == Derived quantities ==
+
+/// Times reading the power calculated against reading it from the per tick
+/// derived quantities, on a BasicReactor<Scalar> holding 100 kW
+template <typename Scalar> void measure_derived_quantities(const char *name) {
+  printf("  %s:\n", name);
+
+  BasicReactor<Scalar> reactor = create_startup_reactor<Scalar>(1e-4f, true, 0);
+  reactor.fuel_temperature_update_interval_ticks = 10;
+  reactor.water_temperature_update_interval_ticks = 1000;
+
+  for (uint32_t i = 0; i < 3000000; i++) {
+    reactor.tick();
+  }
+
+  double calculate_ns = measure_ns_per_step(10000000, [&]() {
+    benchmark_sink = (double)reactor.calculate_power_watts();
+  });
+  double get_ns = measure_ns_per_step(10000000, [&]() {
+    benchmark_sink = (double)reactor.get_power_watts();
+  });
+
+  print_result("calculate_power_watts()", calculate_ns, calculate_ns);
+  print_result("get_power_watts()", get_ns, calculate_ns);
+
+  // main.cpp reads the power twice a loop, for the Cherenkov LEDs and the
+  // other core
+  double loop_calculate_ns = measure_ns_per_step(3000000, [&]() {
+    reactor.tick();
+    benchmark_sink = (double)reactor.calculate_power_watts();
+    benchmark_sink = (double)reactor.calculate_power_watts();
+  });
+  double loop_get_ns = measure_ns_per_step(3000000, [&]() {
+    reactor.tick();
+    benchmark_sink = (double)reactor.get_power_watts();
+    benchmark_sink = (double)reactor.get_power_watts();
+  });
+
+  print_result("tick, main loop reads calculated", loop_calculate_ns,
+               loop_calculate_ns);
+  print_result("tick, main loop reads cached", loop_get_ns, loop_calculate_ns);
+
+  printf("    cached %.17g W, calculated %.17g W\n",
+         (double)reactor.get_power_watts(),
+         (double)reactor.calculate_power_watts());
+}
+
+void benchmark_derived_quantities() {
+  printf("derived-cache: the power worked out once per tick and read from "
+         "there, fuel 1 kHz, water 10 Hz\n");
+
+  measure_derived_quantities<double>("double");
+  measure_derived_quantities<Q32_32>("Q32.32");
+}
+
+// == Reactivity cache ==
+
+void benchmark_reactivity_cache() {
+  printf("reactivity-cache: the rod worths and the fuel temperature feedback "
+         "only recalculated when they change, holding 100 kW, 60 s\n");
+
+  struct {
+    const char *name;
+    uint32_t fuel_interval_ticks;
+    double tolerance_celcius;
+  } variants[] = {
+      {"fuel 10 kHz, tolerance 0", 1, 0.0},
+      {"fuel 1 kHz, tolerance 0", 10, 0.0},
+      {"fuel 1 kHz, tolerance 0.001 C", 10, 0.001},
+      {"fuel 1 kHz, tolerance 0.01 C", 10, 0.01},
+      {"fuel 1 kHz, tolerance 0.1 C", 10, 0.1},
+  };
+
+  const uint64_t ticks = 600000;
+  double baseline_ns = 0.0;
+
+  for (auto &variant : variants) {
+    Reactor reactor = create_startup_reactor(1e-4f, true, 0);
+    reactor.fuel_temperature_update_interval_ticks =
+        variant.fuel_interval_ticks;
+    reactor.water_temperature_update_interval_ticks = 1000;
+    reactor.fuel_temperature_feedback_tolerance_celcius =
+        variant.tolerance_celcius;
+
+    simulate(reactor, 300.0);
+
+    // How far the cached reactivity is from recalculating everything
+    reactor.reset_reactivity_recalculations();
+    double max_error_pcm = 0.0;
+
+    for (uint64_t i = 0; i < ticks; i++) {
+      reactor.tick();
+      max_error_pcm = std::max(
+          max_error_pcm, std::fabs(reactor.get_reactivity_pcm() -
+                                   reactor.calculate_reactivity_pcm()));
+    }
+
+    Reactor::ReactivityRecalculations counts =
+        reactor.get_reactivity_recalculations();
+
+    double ns = measure_ns_per_step(3000000, [&]() { reactor.tick(); });
+
+    if (baseline_ns == 0.0) {
+      baseline_ns = ns;
+    }
+
+    print_result(variant.name, ns, baseline_ns);
+    printf("    per %llu updates: rods %llu/%llu/%llu, fuel feedback %llu, "
+           "max error %.3g pcm\n",
+           (unsigned long long)counts.reactivity,
+           (unsigned long long)counts.control_rod_worths[0],
+           (unsigned long long)counts.control_rod_worths[1],
+           (unsigned long long)counts.control_rod_worths[2],
+           (unsigned long long)counts.fuel_temperature_feedback,
+           max_error_pcm);
+  }
+
+  // What every update used to cost
+  Reactor reactor = create_startup_reactor(1e-4f, true, 0);
+  double calculate_ns = measure_ns_per_step(10000000, [&]() {
+    benchmark_sink = reactor.calculate_reactivity_pcm();
+  });
+  printf("  calculate_reactivity_pcm() %.2f ns\n", calculate_ns);
+}
+
+// == Thermal approximations ==
+
+/// Largest error of a piecewise cubic in T against the double function,
+/// sampled much more finely than the compile time check
+template <typename T, size_t PIECES, typename F>
+double calculate_approximation_error(const PiecewiseCubic<T, PIECES> &pieces,
+                                     F &&function) {
+  return pieces.calculate_max_error(function, 64);
+}
+
+/// Times the thermal functions with and without approximate_thermal_math, on
+/// a BasicReactor<Scalar> at 100 kW
+template <typename Scalar> void measure_thermal_functions(const char *name) {
+  printf("  %s:\n", name);
+
+  BasicReactor<Scalar> reactor = create_startup_reactor<Scalar>(1e-4f, true, 0);
+  reactor.fuel_temperature_update_interval_ticks = 10;
+  reactor.water_temperature_update_interval_ticks = 1000;
+  reactor.set_active_cooling_system_enabled(false);
+
+  // Warm the water up, so the air convection isn't 0
+  for (uint32_t i = 0; i < 3000000; i++) {
+    reactor.tick();
+  }
+
+  for (bool approximate : {false, true}) {
+    reactor.approximate_thermal_math = approximate;
+    uint32_t i = 0;
+
+    // Fuel from 20 to 320 C
+    double power_exchanged_ns = measure_ns_per_step(10000000, [&]() {
+      Scalar fuel_temperature_celcius = Scalar(20.0 + (double)(i++ % 300));
+      benchmark_sink = (double)reactor.calculate_power_exchanged_joule_per_second(
+          fuel_temperature_celcius);
+    });
+    double air_convection_ns = measure_ns_per_step(10000000, [&]() {
+      benchmark_sink =
+          (double)reactor.calculate_water_tank_to_air_convection_J_per_second();
+    });
+    double fuel_capacity_ns = measure_ns_per_step(10000000, [&]() {
+      Scalar fuel_temperature_celcius = Scalar(20.0 + (double)(i++ % 300));
+      benchmark_sink =
+          (double)reactor.calculate_temperature_dependent_fuel_capacity_J_per_K(
+              fuel_temperature_celcius);
+    });
+    double feedback_ns = measure_ns_per_step(10000000, [&]() {
+      benchmark_sink = (double)reactor.calculate_fuel_temperature_feedback_pcm();
+    });
+
+    printf("    %-12s P_fe_stat %6.2f ns, Q air %6.2f ns, Cp %6.2f ns, "
+           "feedback %6.2f ns\n",
+           approximate ? "approximate" : "exact", power_exchanged_ns,
+           air_convection_ns, fuel_capacity_ns, feedback_ns);
+  }
+}
+
+void benchmark_thermal_approximations() {
+  printf("thermal-approx: compile time tables and folded polynomials for the "
+         "thermal math\n");
+
+  constexpr ReactorConfiguration JSI = JSI_TRIGA_CONFIGURATION;
+  auto power_exchanged_watts = [](double temperature_difference_K) {
+    return calculate_constexpr_power_exchanged_watts(JSI_TRIGA_CONFIGURATION,
+                                                     temperature_difference_K);
+  };
+
+  printf("  P_fe_stat, %zu pieces over %.0f to %.0f C, stated %.1f W: double "
+         "%.3f W, float %.3f W\n",
+         POWER_EXCHANGED_APPROXIMATION_DOUBLE<JSI>.pieces.size(),
+         POWER_EXCHANGED_APPROXIMATION_DOUBLE<JSI>.x_min,
+         POWER_EXCHANGED_APPROXIMATION_DOUBLE<JSI>.x_max,
+         POWER_EXCHANGED_APPROXIMATION_MAX_ERROR_WATTS_PER_ELEMENT *
+             JSI.fuel_elements_in_core,
+         calculate_approximation_error(
+             POWER_EXCHANGED_APPROXIMATION<double, JSI>, power_exchanged_watts),
+         calculate_approximation_error(
+             POWER_EXCHANGED_APPROXIMATION<float, JSI>, power_exchanged_watts));
+  printf("  Q air, %zu pieces over %.0f to %.0f C, stated %.1f W: double "
+         "%.3f W, float %.3f W\n",
+         AIR_CONVECTION_APPROXIMATION_DOUBLE.pieces.size(),
+         AIR_CONVECTION_APPROXIMATION_DOUBLE.x_min,
+         AIR_CONVECTION_APPROXIMATION_DOUBLE.x_max,
+         AIR_CONVECTION_APPROXIMATION_MAX_ERROR_WATTS,
+         calculate_approximation_error(AIR_CONVECTION_APPROXIMATION<double>,
+                                       calculate_constexpr_air_convection_watts),
+         calculate_approximation_error(AIR_CONVECTION_APPROXIMATION<float>,
+                                       calculate_constexpr_air_convection_watts));
+
+  measure_thermal_functions<double>("double");
+  measure_thermal_functions<float>("float");
+  measure_thermal_functions<Q32_32>("Q32.32");
+
+  // The same transients with and without the approximations
+  struct {
+    const char *name;
+    uint32_t regulating_rod_position;
+    bool active_cooling;
+    double seconds;
+  } transients[] = {
+      {"loss of cooling at 100 kW", 0, false, 600.0},
+      {"regulating rod at 62.5 %, to SCRAM", 2500000, true, 200.0},
+  };
+
+  for (auto &transient : transients) {
+    printf("  %s, fuel 1 kHz, water 10 Hz:\n", transient.name);
+
+    auto trace = [&](auto scalar, bool approximate) {
+      return trace_scalar_type<decltype(scalar)>(
+          transient.regulating_rod_position == 0,
+          transient.regulating_rod_position, transient.active_cooling,
+          transient.seconds, 10, 1000, false, approximate);
+    };
+
+    struct {
+      const char *name;
+      ScalarTypeTrace exact;
+      ScalarTypeTrace approximate;
+    } variants[] = {
+        {"double", trace(0.0, false), trace(0.0, true)},
+        {"float", trace(0.0f, false), trace(0.0f, true)},
+    };
+
+    for (auto &variant : variants) {
+      double max_power_error = 0.0;
+      double max_fuel_error_celcius = 0.0;
+      double max_water_error_celcius = 0.0;
+
+      for (size_t i = 0; i < variant.exact.power_watts.size(); i++) {
+        if (variant.exact.power_watts[i] > 1.0) {
+          max_power_error = std::max(
+              max_power_error, std::fabs(variant.approximate.power_watts[i] -
+                                         variant.exact.power_watts[i]) /
+                                   variant.exact.power_watts[i]);
+        }
+
+        max_fuel_error_celcius =
+            std::max(max_fuel_error_celcius,
+                     std::fabs(variant.approximate.fuel_temperatures_celcius[i] -
+                               variant.exact.fuel_temperatures_celcius[i]));
+        max_water_error_celcius = std::max(
+            max_water_error_celcius,
+            std::fabs(variant.approximate.water_temperatures_celcius[i] -
+                      variant.exact.water_temperatures_celcius[i]));
+      }
+
+      printf("    %-8s %6.1f -> %6.1f ns/tick, power %.1e, fuel %.1e C, "
+             "water %.1e C",
+             variant.name, variant.exact.ns_per_tick,
+             variant.approximate.ns_per_tick, max_power_error,
+             max_fuel_error_celcius, max_water_error_celcius);
+
+      if (variant.exact.scram_time_seconds >= 0.0) {
+        printf(", SCRAM %+.4f s", variant.approximate.scram_time_seconds -
+                                      variant.exact.scram_time_seconds);
+      }
+
+      printf("\n");
+    }
+  }
+}
+
+// == Rod worth curves ==
+
+/// Exact normalized worth of the pulsing rod's bezier curve at a position
+/// between 0 and 1, found by bisection like set_worth_curve_bezier does
+double calculate_bezier_worth(double position) {
+  double parameter_0 = PULSING_ROD_WORTH_CURVE_BEZIER_PARAMETER_0;
+  double parameter_1 = PULSING_ROD_WORTH_CURVE_BEZIER_PARAMETER_1;
+  double t_low = 0.0;
+  double t_high = 1.0;
+
+  for (uint8_t iteration = 0; iteration < 60; iteration++) {
+    double t = 0.5 * (t_low + t_high);
+    double x = 3.0 * (1.0 - t) * (1.0 - t) * t * parameter_0 +
+               3.0 * (1.0 - t) * t * t * parameter_1 + t * t * t;
+
+    if (x < position) {
+      t_low = t;
+    } else {
+      t_high = t;
+    }
+  }
+
+  double t = 0.5 * (t_low + t_high);
+  return 3.0 * (1.0 - t) * t * t + t * t * t;
+}
+
+/// Times calculate_worth_pcm() on a rod moving through all positions, linear
+/// and with the pulsing rod's curve
+template <typename Scalar> void measure_rod_worth(const char *name) {
+  BasicControlRod<Scalar> rod(0);
+  uint32_t position = 0;
+
+  auto step = [&]() {
+    // About 4000 steps, so every segment of the table gets used
+    position = (position + 997) % 4000001;
+    rod.set_current_position(position);
+    benchmark_sink = (double)rod.calculate_worth_pcm();
+  };
+
+  double linear_ns = measure_ns_per_step(10000000, step);
+
+  rod.set_worth_curve_bezier(PULSING_ROD_WORTH_CURVE_BEZIER_PARAMETER_0,
+                             PULSING_ROD_WORTH_CURVE_BEZIER_PARAMETER_1);
+  double curve_ns = measure_ns_per_step(10000000, step);
+
+  // Largest difference of the table to the bezier itself
+  double max_error_pcm = 0.0;
+
+  for (uint32_t i = 0; i <= 4000000; i += 97) {
+    rod.set_current_position(i);
+    max_error_pcm = std::max(
+        max_error_pcm, std::fabs((double)rod.calculate_worth_pcm() -
+                                 calculate_bezier_worth((double)i / 4e6) *
+                                     CONTROL_ROD_WORTH_PCM));
+  }
+
+  printf("  %s:\n", name);
+  print_result("linear", linear_ns, linear_ns);
+  print_result("pulsing rod curve, table", curve_ns, linear_ns);
+  printf("    table within %.3f pcm of the bezier\n", max_error_pcm);
+}
+
+void benchmark_rod_worth() {
+  printf("rod-worth: worth of a moving control rod, linear against a %u "
+         "segment table of the pulsing rod's S-curve\n",
+         (unsigned)ControlRod::WORTH_CURVE_SEGMENTS);
+
+  measure_rod_worth<double>("double");
+  measure_rod_worth<float>("float");
+  measure_rod_worth<Q32_32>("Q32.32");
+
+  // What evaluating the bezier directly in the tick would cost
+  uint32_t position = 0;
+  double bezier_ns = measure_ns_per_step(1000000, [&]() {
+    position = (position + 997) % 4000001;
+    benchmark_sink = calculate_bezier_worth((double)position / 4e6);
+  });
+  printf("  bezier evaluated directly %.2f ns\n", bezier_ns);
+}
+
+// == Control rod motion ==
+
+/// Copy of the control rod move from before the steps per tick were cached,
+/// kept here as the baseline. Not inlined, like the real one in
+/// control_rod.cpp
+template <typename Scalar> struct FloatingPointRodMove {
+  uint32_t current_position = 0;
+  uint32_t target_position = 0;
+  uint32_t speed_per_second = 15 * 4000;
+
+  __attribute__((noinline)) void
+  move_towards_target(Scalar delta_t_seconds) {
+    int64_t target_delta_position =
+        (int64_t)target_position - (int64_t)current_position;
+    int64_t max_delta_position =
+        (uint64_t)(delta_t_seconds * Scalar(speed_per_second));
+    int64_t delta_position = std::clamp(
+        target_delta_position, -max_delta_position, max_delta_position);
+
+    current_position = (uint32_t)((int64_t)current_position + delta_position);
+  }
+};
+
+/// Times moving a rod back and forth between both ends, the old floating
+/// point move against the cached integer one
+template <typename Scalar> void measure_rod_motion(const char *name) {
+  Scalar time_delta_seconds = Scalar(1e-4);
+  // About 1.4 s end to end, like the real rods
+  uint32_t speed = 28000 * 10000;
+
+  // Turns around every 200 ticks, after about 60 ticks standing at the end
+  uint32_t ticks = 0;
+
+  FloatingPointRodMove<Scalar> old_rod;
+  old_rod.speed_per_second = speed;
+  double old_ns = measure_ns_per_step(10000000, [&]() {
+    if (++ticks == 200) {
+      ticks = 0;
+      old_rod.target_position = 4000000 - old_rod.target_position;
+    }
+    old_rod.move_towards_target(time_delta_seconds);
+  });
+  benchmark_sink = (double)old_rod.current_position;
+
+  BasicControlRod<Scalar> rod(0);
+  auto motion = BasicControlRod<Scalar>::Motion::calculate(
+      speed, 0, 0, time_delta_seconds);
+  ticks = 0;
+  double new_ns = measure_ns_per_step(10000000, [&]() {
+    if (++ticks == 200) {
+      ticks = 0;
+      rod.set_target_position(4000000 - rod.get_target_position());
+    }
+    rod.move_towards_target(motion);
+  });
+  benchmark_sink = (double)rod.get_current_position();
+
+  printf("  %s:\n", name);
+  print_result("floating point step every tick", old_ns, old_ns);
+  print_result("integer, cached step", new_ns, old_ns);
+}
+
+/// Moves a rod from every position towards a few targets by a few step sizes,
+/// and counts the moves that leave 0 to 4_000_000, overshoot the target or
+/// move by the wrong amount
+uint64_t check_rod_moves_exhaustively(uint64_t &moves) {
+  const uint32_t steps_per_tick[] = {0, 1, 2, 3, 6, 4000, 4000000, UINT32_MAX};
+  uint64_t failures = 0;
+
+  for (uint32_t steps : steps_per_tick) {
+    ControlRod rod(0);
+    // With a 1 s tick, the speed is the steps per tick
+    auto motion = ControlRod::Motion::calculate(steps, 0, 0, 1.0);
+
+    for (uint32_t position = 0; position <= 4000000; position++) {
+      const uint32_t targets[] = {0, 4000000, 2000000, position - 1,
+                                  position + 1};
+
+      for (uint32_t target : targets) {
+        rod.set_current_position(position);
+        rod.set_target_position(target);
+        target = rod.get_target_position();
+        rod.move_towards_target(motion);
+        moves++;
+
+        uint32_t moved_to = rod.get_current_position();
+        uint32_t distance =
+            target > position ? target - position : position - target;
+        uint32_t moved =
+            moved_to > position ? moved_to - position : position - moved_to;
+        bool towards_target = target > position ? moved_to >= position
+                                                : moved_to <= position;
+        bool past_target = target > position ? moved_to > target
+                                             : moved_to < target;
+
+        if (moved_to > 4000000 || !towards_target || past_target ||
+            moved != std::min(distance, steps)) {
+          failures++;
+        }
+      }
+    }
+  }
+
+  return failures;
+}
+
+/// Balances the regulating rod from every position, with the power above and
+/// below the target, and counts the targets outside the 60 to 100 % the
+/// controller may use
+uint64_t check_balanced_rods_exhaustively(uint64_t &balances) {
+  Reactor reactor;
+  auto state = reactor.get_state_vector();
+  uint64_t failures = 0;
+
+  // Some power, above a target of 0 and below one of 4.29 GW
+  state[0] = 1e15;
+  reactor.set_state_vector(state);
+
+  for (uint32_t target_watts : {(uint32_t)0, UINT32_MAX}) {
+    reactor.set_target_thermal_power_watts(target_watts);
+
+    for (uint32_t position = 0; position <= 4000000; position++) {
+      reactor.get_regulating_control_rod()->set_current_position(position);
+      reactor.balance_control_rods();
+      balances++;
+
+      uint32_t target =
+          reactor.get_regulating_control_rod()->get_target_position();
+
+      if (target < 2400000 || target > 4000000) {
+        failures++;
+      }
+    }
+  }
+
+  return failures;
+}
+
+/// Moves rods with acceleration profiles to random targets, changing the
+/// target while they move, and counts the ticks they left 0 to 4_000_000 and
+/// the moves that never arrived
+uint64_t check_accelerated_rods(uint64_t &ticks) {
+  const uint32_t speeds[] = {1, 28000, 60000, 4000000, UINT32_MAX};
+  const uint32_t accelerations[] = {1, 1000, 1000000, UINT32_MAX};
+  const double time_deltas[] = {1e-4, 1e-3, 1.0};
+  uint64_t failures = 0;
+  uint32_t random = 12345;
+
+  auto next_random = [&]() {
+    random = random * 1664525 + 1013904223;
+    return random;
+  };
+
+  for (uint32_t speed : speeds) {
+    for (uint32_t acceleration : accelerations) {
+      for (double time_delta : time_deltas) {
+        ControlRod rod(next_random() % 4000001);
+        auto motion =
+            ControlRod::Motion::calculate(speed, acceleration, 0, time_delta);
+
+        for (uint8_t move = 0; move < 50; move++) {
+          rod.set_target_position(next_random() % 4000001);
+          uint32_t ticks_before_change = next_random() % 2000;
+
+          for (uint32_t tick = 0; tick < ticks_before_change; tick++) {
+            rod.move_towards_target(motion);
+            ticks++;
+
+            if (rod.get_current_position() > 4000000) {
+              failures++;
+            }
+          }
+        }
+
+        // Has to arrive at the last target, as long as that's possible in a
+        // reasonable time at full speed with a slow start and end
+        uint32_t target = rod.get_target_position();
+        uint32_t position = rod.get_current_position();
+        double distance = std::fabs((double)target - (double)position);
+        double full_speed_seconds = distance / (double)speed;
+        double accelerating_seconds =
+            2.0 * std::sqrt(distance / (double)acceleration) +
+            2.0 * time_delta;
+        double expected_ticks =
+            std::max(full_speed_seconds, accelerating_seconds) / time_delta;
+
+        if (expected_ticks > 1e6) {
+          continue;
+        }
+
+        uint64_t tick = 0;
+
+        for (; tick < (uint64_t)(4.0 * expected_ticks) + 10 &&
+               rod.get_current_position() != target;
+             tick++) {
+          rod.move_towards_target(motion);
+          ticks++;
+        }
+
+        if (rod.get_current_position() != target) {
+          failures++;
+        }
+      }
+    }
+  }
+
+  return failures;
+}
+
+void benchmark_rod_motion() {
+  printf("rod-motion: control rod moves with the steps per tick cached, in "
+         "integer math\n");
+
+  measure_rod_motion<double>("double");
+  measure_rod_motion<float>("float");
+  measure_rod_motion<Q32_32>("Q32.32");
+
+  uint64_t moves = 0;
+  uint64_t move_failures = check_rod_moves_exhaustively(moves);
+  printf("  every position, %llu moves: %llu out of range or wrong\n",
+         (unsigned long long)moves, (unsigned long long)move_failures);
+
+  uint64_t balances = 0;
+  uint64_t balance_failures = check_balanced_rods_exhaustively(balances);
+  printf("  every regulating rod position, %llu balances: %llu targets "
+         "outside 60 to 100 %%\n",
+         (unsigned long long)balances, (unsigned long long)balance_failures);
+
+  uint64_t ticks = 0;
+  uint64_t profile_failures = check_accelerated_rods(ticks);
+  printf("  acceleration profiles, %llu ticks: %llu out of range or never "
+         "arrived\n",
+         (unsigned long long)ticks, (unsigned long long)profile_failures);
+}
+
+// == Reactor configurations ==
+
+/// Starts a core up to a power with the automatic control, then times its
+/// ticks there
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void measure_configuration(const char *name, uint32_t target_power_watts,
+                           double &baseline_ns) {
+  BasicReactor<Scalar, CONFIGURATION> reactor;
+  reactor.automatic_control = true;
+  reactor.set_target_thermal_power_watts(target_power_watts);
+  reactor.fuel_temperature_update_interval_ticks = 10;
+  reactor.water_temperature_update_interval_ticks = 1000;
+
+  // 5 minutes
+  for (uint32_t i = 0; i < 3000000; i++) {
+    reactor.tick();
+  }
+
+  double tick_ns = measure_ns_per_step(3000000, [&]() { reactor.tick(); });
+
+  if (baseline_ns == 0.0) {
+    baseline_ns = tick_ns;
+  }
+
+  print_result(name, tick_ns, baseline_ns);
+  printf("    after %.0f s: %.1f kW, fuel %.2f C, regulating rod %.1f %%%s\n",
+         reactor.get_time_elapsed_seconds(),
+         (double)reactor.get_power_watts() / 1000.0,
+         (double)reactor.get_fuel_temperature_celcius(),
+         (double)reactor.get_regulating_control_rod()
+                 ->get_current_position_as_fraction() *
+             100.0,
+         reactor.get_in_scram() ? ", in SCRAM" : "");
+
+  benchmark_sink = reactor.get_neutrons_in_core();
+}
+
+void benchmark_configurations() {
+  printf("configurations: ticks of each compile time core configuration, "
+         "holding power with the automatic control (fuel 1 kHz, water 10 "
+         "Hz)\n");
+
+  double double_ns = 0.0;
+  measure_configuration<double, JSI_TRIGA_CONFIGURATION>(
+      "double, JSI TRIGA, 100 kW", 100000, double_ns);
+  measure_configuration<double, EXAMPLE_80_ELEMENT_TRIGA_CONFIGURATION>(
+      "double, example 80 element TRIGA, 100 kW", 100000, double_ns);
+  measure_configuration<double, JSI_TRIGA_8_GROUP_CONFIGURATION>(
+      "double, JSI TRIGA with 8 groups, 100 kW", 100000, double_ns);
+
+  double float_ns = 0.0;
+  measure_configuration<float, JSI_TRIGA_CONFIGURATION>(
+      "float, JSI TRIGA, 100 kW", 100000, float_ns);
+  measure_configuration<float, EXAMPLE_80_ELEMENT_TRIGA_CONFIGURATION>(
+      "float, example 80 element TRIGA, 100 kW", 100000, float_ns);
+}
+
+// == Runtime parameters ==
+
+/// The example 80 element core, the way it would be written in a file
+const char *EXAMPLE_80_ELEMENT_TRIGA_PARAMETERS = R"(
+# Differences from the JSI TRIGA
+fuel_elements_in_core = 80
+core_volume_liters = 34.5
+excess_reactivity_pcm = 3300   # Stronger rods to hold it
+control_rod_worth_pcm = 4500
+
+water_volume_cubic_meters = 40
+water_active_cooling_power_watts = 480000
+power_scram_watts = 500000
+)";
+
+/// Ticks both reactors from the same start for 10 s of rod moves and power
+/// changes, and counts the ticks their states weren't bit for bit the same
+template <typename A, typename B> uint64_t count_differing_ticks(A &a, B &b) {
+  uint64_t differing_ticks = 0;
+
+  for (uint32_t i = 0; i < 100000; i++) {
+    if (i % 20000 == 0) {
+      uint32_t target = 20000 + i * 2;
+      a.set_target_thermal_power_watts(target);
+      b.set_target_thermal_power_watts(target);
+    }
+
+    a.tick();
+    b.tick();
+
+    if (a.get_state_vector() != b.get_state_vector() ||
+        a.get_reactivity_pcm() != b.get_reactivity_pcm()) {
+      differing_ticks += 1;
+    }
+  }
+
+  return differing_ticks;
+}
+
+void benchmark_runtime_parameters() {
+  printf("parameters: parameters loaded at runtime, against the same "
+         "configurations compiled in\n");
+
+  ReactorParameters parameters;
+
+  if (!parameters.load_from_string(EXAMPLE_80_ELEMENT_TRIGA_PARAMETERS) ||
+      !parameters.validate()) {
+    printf("  loading the example failed: %s\n", parameters.get_error());
+    return;
+  }
+
+  RuntimeReactor jsi_runtime;
+  Reactor jsi;
+  printf("  JSI TRIGA, 10 s: %llu ticks differ\n",
+         (unsigned long long)count_differing_ticks(jsi_runtime, jsi));
+
+  RuntimeReactor example_runtime;
+  BasicReactor<double, EXAMPLE_80_ELEMENT_TRIGA_CONFIGURATION> example;
+  example_runtime.apply_parameters(parameters.get_parameters());
+  printf("  example 80 element TRIGA from text, 10 s: %llu ticks differ\n",
+         (unsigned long long)count_differing_ticks(example_runtime, example));
+
+  // What validation catches
+  const char *invalid_texts[] = {
+      "prompt_neutron_lifetime_seconds = 0",
+      "delayed_neutron_fraction_7 = 0.001",
+      "fuel_elements_in_core = 80.5",
+      "fuel_elements_in_core = 200",
+      "decay_time_2 = -1",
+      "temperature_fe_stat_a2 = -1e-6",
+      "water_volume_cubic_meters = 40 m3",
+  };
+
+  for (const char *text : invalid_texts) {
+    ReactorParameters invalid;
+    bool valid = invalid.load_from_string(text) && invalid.validate();
+    printf("  \"%s\": %s\n", text, valid ? "valid" : invalid.get_error());
+  }
+
+  double apply_ns = measure_ns_per_step(1000, [&]() {
+    example_runtime.apply_parameters(parameters.get_parameters());
+  });
+  printf("  applying parameters: %.1f us\n", apply_ns / 1000.0);
+
+  double baseline_ns = 0.0;
+  measure_configuration<double, JSI_TRIGA_CONFIGURATION>(
+      "compiled in, JSI TRIGA, 100 kW", 100000, baseline_ns);
+  measure_configuration<double, RUNTIME_TRIGA_CONFIGURATION>(
+      "runtime, JSI TRIGA, 100 kW", 100000, baseline_ns);
+}
+
+// == Reactor state ==
+
+/// Whether two states have the same continuous state, reactivity and rods
+template <typename State> bool states_match(const State &a, const State &b) {
+  return a.neutrons_in_core == b.neutrons_in_core &&
+         a.fuel_temperature_celcius == b.fuel_temperature_celcius &&
+         a.water_temperature_celcius == b.water_temperature_celcius &&
+         a.reactivity_pcm == b.reactivity_pcm &&
+         a.steps_elapsed == b.steps_elapsed && a.in_scram == b.in_scram &&
+         memcmp(&a.precursor_groups, &b.precursor_groups,
+                sizeof(a.precursor_groups)) == 0 &&
+         memcmp(&a.regulating_control_rod, &b.regulating_control_rod,
+                sizeof(a.regulating_control_rod)) == 0;
+}
+
+void benchmark_reactor_state() {
+  printf("state: the reactor's state as a plain struct, and the pure step "
+         "function\n");
+
+  printf("  ReactorState: double %zu bytes, float %zu, Q32.32 %zu\n",
+         sizeof(Reactor::ReactorState),
+         sizeof(BasicReactor<float>::ReactorState),
+         sizeof(BasicReactor<Q32_32>::ReactorState));
+  printf("  coefficients: %zu bytes, time step coefficients %zu\n",
+         sizeof(Reactor::Model::Coefficients),
+         sizeof(Reactor::TimeStepCoefficients));
+
+  // step() from the same start, with the same power changes as tick(). The
+  // model's own step gets the compiled in coefficients and the switches
+  Reactor ticked;
+  Reactor stepped;
+  Reactor::ReactorState state = stepped.get_state();
+  Reactor::ReactorState model_state = state;
+  ReactorSwitches<double> switches = stepped;
+  uint64_t differing_steps = 0;
+  uint64_t differing_model_steps = 0;
+
+  for (uint32_t i = 0; i < 100000; i++) {
+    if (i % 20000 == 0) {
+      ticked.set_target_thermal_power_watts(20000 + i * 2);
+    }
+
+    Reactor::ReactorInputs inputs = ticked.get_inputs();
+    ticked.tick();
+    stepped.step(state, inputs, state);
+    Reactor::Model::step(Reactor::CONFIGURATION_COEFFICIENTS, switches,
+                         model_state, inputs, model_state);
+
+    if (!states_match(ticked.get_state(), state)) {
+      differing_steps += 1;
+    }
+
+    if (!states_match(ticked.get_state(), model_state)) {
+      differing_model_steps += 1;
+    }
+  }
+
+  printf("  step() against tick(), 10 s: %llu steps differ\n",
+         (unsigned long long)differing_steps);
+  printf("  BasicReactorModel::step(coefficients, switches, ...), 10 s: %llu "
+         "steps differ\n",
+         (unsigned long long)differing_model_steps);
+
+  // The fuel element nodes aren't in the state, so there's no step with them
+  ReactorSwitches<double> nodes_switches = switches;
+  nodes_switches.fuel_element_temperatures = true;
+  printf("  step() with fuel element temperatures: %s\n",
+         Reactor::Model::step(Reactor::CONFIGURATION_COEFFICIENTS,
+                              nodes_switches, model_state,
+                              ticked.get_inputs(), model_state)
+             ? "stepped"
+             : "refused");
+
+  // Rolling back 10 s and running them again
+  Reactor reactor;
+  reactor.set_target_thermal_power_watts(100000);
+  Reactor::ReactorState snapshot;
+  memcpy(&snapshot, &reactor.get_state(), sizeof(snapshot));
+
+  for (uint32_t i = 0; i < 100000; i++) {
+    reactor.tick();
+  }
+
+  Reactor::ReactorState first_run = reactor.get_state();
+  reactor.set_state(snapshot);
+
+  for (uint32_t i = 0; i < 100000; i++) {
+    reactor.tick();
+  }
+
+  printf("  rolled back 10 s and ran them again: %s\n",
+         states_match(first_run, reactor.get_state()) ? "same state"
+                                                       : "different state");
+
+  double tick_ns = measure_ns_per_step(1000000, [&]() { reactor.tick(); });
+  print_result("tick()", tick_ns, tick_ns);
+
+  double snapshot_ns = measure_ns_per_step(1000000, [&]() {
+    memcpy(&snapshot, &reactor.get_state(), sizeof(snapshot));
+    benchmark_sink = (double)snapshot.neutrons_in_core;
+  });
+  print_result("snapshot (memcpy)", snapshot_ns, tick_ns);
+
+  Reactor::ReactorInputs inputs = reactor.get_inputs();
+  double step_ns = measure_ns_per_step(
+      1000000, [&]() { reactor.step(snapshot, inputs, snapshot); });
+  print_result("step(), in place", step_ns, tick_ns);
+
+  Reactor::ReactorState stepped_state;
+  double copying_step_ns = measure_ns_per_step(1000000, [&]() {
+    reactor.step(snapshot, inputs, stepped_state);
+    benchmark_sink = (double)stepped_state.neutrons_in_core;
+  });
+  print_result("step(), state in and out", copying_step_ns, tick_ns);
+
+  benchmark_sink = reactor.get_neutrons_in_core();
+}
+
+// == Snapshots ==
+
+/// Ticks a reactor and the one it was loaded into for a number of seconds,
+/// switching the cooling off on both halfway, and counts the ticks their
+/// states differ after
+template <typename R>
+uint64_t count_differing_ticks_after_load(R &original, R &loaded,
+                                          double seconds) {
+  uint64_t ticks = (uint64_t)(seconds / original.get_time_delta_seconds());
+  uint64_t differing_ticks = 0;
+
+  for (uint64_t i = 0; i < ticks; i++) {
+    if (i == ticks / 2) {
+      original.set_active_cooling_system_enabled(false);
+      loaded.set_active_cooling_system_enabled(false);
+    }
+
+    original.tick();
+    loaded.tick();
+
+    if (!states_match(original.get_state(), loaded.get_state())) {
+      differing_ticks += 1;
+    }
+  }
+
+  return differing_ticks;
+}
+
+void benchmark_snapshots() {
+  printf("snapshot: saving a running reactor to a file and carrying on from "
+         "it\n");
+
+  const char *path = "build/benchmark-snapshot.bin";
+
+  printf("  ReactorSnapshot: double %zu bytes, float %zu, Q32.32 %zu\n",
+         sizeof(Reactor::ReactorSnapshot),
+         sizeof(BasicReactor<float>::ReactorSnapshot),
+         sizeof(BasicReactor<Q32_32>::ReactorSnapshot));
+
+  // 5 minutes up to 100 kW with the multi-rate and approximate math
+  // switches, saved, then 5 more minutes in both
+  Reactor *original = new Reactor();
+  original->fuel_temperature_update_interval_ticks = 10;
+  original->water_temperature_update_interval_ticks = 1000;
+  original->approximate_thermal_math = true;
+  original->set_target_thermal_power_watts(100000);
+
+  for (uint32_t i = 0; i < 3000000; i++) {
+    original->tick();
+  }
+
+  Reactor::ReactorSnapshot *snapshot = new Reactor::ReactorSnapshot();
+  original->save_snapshot(*snapshot);
+
+  if (!write_snapshot_file(path, *snapshot) ||
+      !read_snapshot_file(path, *snapshot)) {
+    printf("  couldn't write and read %s\n", path);
+    return;
+  }
+
+  Reactor *loaded = new Reactor();
+  SnapshotStatus status = loaded->load_snapshot(*snapshot);
+  printf("  at %.0f W, water %.1f C, through %s: %s\n",
+         original->get_power_watts(), original->get_water_temperature_celcius(),
+         path, describe_snapshot_status(status));
+  printf("  carried on for 300 s, cooling off halfway: %llu ticks differ\n",
+         (unsigned long long)count_differing_ticks_after_load(*original,
+                                                              *loaded, 300.0));
+
+  // Runtime parameters are saved with the state, and applied again
+  ReactorParameters parameters;
+  parameters.load_from_string(EXAMPLE_80_ELEMENT_TRIGA_PARAMETERS);
+
+  RuntimeReactor *runtime_original = new RuntimeReactor();
+  runtime_original->apply_parameters(parameters.get_parameters());
+  runtime_original->set_target_thermal_power_watts(300000);
+  // The curve is saved with the snapshot, the state only has which it is
+  runtime_original->get_regulating_control_rod()->set_worth_curve_bezier(
+      PULSING_ROD_WORTH_CURVE_BEZIER_PARAMETER_0,
+      PULSING_ROD_WORTH_CURVE_BEZIER_PARAMETER_1);
+
+  for (uint32_t i = 0; i < 1000000; i++) {
+    runtime_original->tick();
+  }
+
+  RuntimeReactor::ReactorSnapshot *runtime_snapshot =
+      new RuntimeReactor::ReactorSnapshot();
+  runtime_original->save_snapshot(*runtime_snapshot);
+
+  RuntimeReactor *runtime_loaded = new RuntimeReactor();
+  status = runtime_loaded->load_snapshot(*runtime_snapshot);
+  printf("  runtime parameters, example 80 element TRIGA, regulating rod on "
+         "a worth curve: %s, %llu ticks differ over 100 s\n",
+         describe_snapshot_status(status),
+         (unsigned long long)count_differing_ticks_after_load(
+             *runtime_original, *runtime_loaded, 100.0));
+
+  // What loading catches, with the file read into other reactors
+  auto *q32_snapshot = new BasicReactor<Q32_32>::ReactorSnapshot();
+  BasicReactor<Q32_32> *q32 = new BasicReactor<Q32_32>();
+  read_snapshot_file(path, *q32_snapshot);
+  printf("  into a Q32.32 reactor: %s\n",
+         describe_snapshot_status(q32->load_snapshot(*q32_snapshot)));
+
+  using ExampleReactor =
+      BasicReactor<double, EXAMPLE_80_ELEMENT_TRIGA_CONFIGURATION>;
+  auto *example_snapshot = new ExampleReactor::ReactorSnapshot();
+  ExampleReactor *example = new ExampleReactor();
+  read_snapshot_file(path, *example_snapshot);
+  printf("  into the example 80 element TRIGA: %s\n",
+         describe_snapshot_status(example->load_snapshot(*example_snapshot)));
+
+  read_snapshot_file(path, *snapshot);
+  snapshot->state.neutrons_in_core *= 1.0000001;
+  printf("  with the neutrons changed: %s\n",
+         describe_snapshot_status(loaded->load_snapshot(*snapshot)));
+
+  read_snapshot_file(path, *snapshot);
+  snapshot->version += 1;
+  printf("  with another version: %s\n",
+         describe_snapshot_status(loaded->load_snapshot(*snapshot)));
+
+  original->save_snapshot_unsealed(*snapshot);
+  printf("  not sealed yet: %s\n",
+         describe_snapshot_status(loaded->load_snapshot(*snapshot)));
+  Reactor::seal_snapshot(*snapshot);
+  printf("  once sealed: %s\n",
+         describe_snapshot_status(loaded->load_snapshot(*snapshot)));
+
+  memset((void *)snapshot, 0xFF, sizeof(*snapshot));
+  printf("  erased flash: %s\n",
+         describe_snapshot_status(loaded->load_snapshot(*snapshot)));
+
+  double tick_ns = measure_ns_per_step(1000000, [&]() { original->tick(); });
+  print_result("tick()", tick_ns, tick_ns);
+
+  double save_ns = measure_ns_per_step(1000, [&]() {
+    original->save_snapshot(*snapshot);
+    write_snapshot_file(path, *snapshot);
+  });
+  print_result("save_snapshot and write", save_ns, tick_ns);
+
+  // What the Pico does when the SCRAM button is pressed, and held
+  double unsealed_ns = measure_ns_per_step(
+      1000, [&]() { original->save_snapshot_unsealed(*snapshot); });
+  print_result("save_snapshot_unsealed", unsealed_ns, tick_ns);
+
+  double seal_ns =
+      measure_ns_per_step(1000, [&]() { Reactor::seal_snapshot(*snapshot); });
+  print_result("seal_snapshot", seal_ns, tick_ns);
+
+  double load_ns = measure_ns_per_step(1000, [&]() {
+    read_snapshot_file(path, *snapshot);
+    loaded->load_snapshot(*snapshot);
+  });
+  print_result("read and load_snapshot", load_ns, tick_ns);
+
+  benchmark_sink = loaded->get_neutrons_in_core();
+
+  remove(path);
+  delete original;
+  delete loaded;
+  delete snapshot;
+  delete runtime_original;
+  delete runtime_loaded;
+  delete runtime_snapshot;
+  delete q32;
+  delete q32_snapshot;
+  delete example;
+  delete example_snapshot;
+}
+
+// == Equilibrium ==
+
+/// Starts a reactor at equilibrium with the rods held, and prints how far the
+/// power and fuel temperature move over a minute
+template <typename Scalar>
+void measure_equilibrium(const char *name, uint32_t power_watts,
+                         double water_temperature_celcius,
+                         bool logarithmic_neutrons = false) {
+  BasicReactor<Scalar> *reactor = new BasicReactor<Scalar>();
+  reactor->automatic_control = false;
+  reactor->set_logarithmic_neutron_population(logarithmic_neutrons);
+
+  auto start = std::chrono::steady_clock::now();
+  bool initialized = reactor->initialize_at_equilibrium(
+      power_watts, Scalar(water_temperature_celcius));
+  auto end = std::chrono::steady_clock::now();
+
+  if (!initialized) {
+    printf("    %-28s out of the regulating rod's reach\n", name);
+    delete reactor;
+    return;
+  }
+
+  double initialize_us =
+      std::chrono::duration<double, std::micro>(end - start).count();
+  double fuel_temperature_celcius =
+      (double)reactor->get_fuel_temperature_celcius();
+  double rod_fraction = (double)reactor->get_regulating_control_rod()
+                            ->get_current_position_as_fraction();
+  double max_power_error = 0.0;
+
+  for (uint32_t i = 0; i < 600000; i++) {
+    reactor->tick();
+    max_power_error = std::max(
+        max_power_error,
+        std::fabs((double)reactor->get_power_watts() - (double)power_watts) /
+            (double)power_watts);
+  }
+
+  printf("    %-28s %6.1f us, rod %.4f, fuel %6.2f C, over 60 s: power "
+         "%.1e, fuel %+.3f C\n",
+         name, initialize_us, rod_fraction, fuel_temperature_celcius,
+         max_power_error,
+         (double)reactor->get_fuel_temperature_celcius() -
+             fuel_temperature_celcius);
+
+  delete reactor;
+}
+
+void benchmark_equilibrium() {
+  printf("equilibrium: starting at a power instead of from cold, rods held "
+         "after\n");
+
+  printf("  double, water at 20 C:\n");
+  measure_equilibrium<double>("10 W", 10, 20.0);
+  measure_equilibrium<double>("1 kW", 1000, 20.0);
+  measure_equilibrium<double>("100 kW", 100000, 20.0);
+  measure_equilibrium<double>("240 kW", 240000, 20.0);
+  measure_equilibrium<double>("100 kW, logarithmic", 100000, 20.0, true);
+  measure_equilibrium<double>("1 W", 1, 20.0);
+  measure_equilibrium<double>("2 MW", 2000000, 20.0);
+
+  printf("  100 kW, water at 40 C:\n");
+  measure_equilibrium<double>("double", 100000, 40.0);
+  measure_equilibrium<float>("float", 100000, 40.0);
+  measure_equilibrium<Q32_32>("Q32.32", 100000, 40.0);
+
+  // What it saves, the automatic control bringing a cold core to within 1 %
+  // of 100 kW
+  Reactor *reactor = new Reactor();
+  reactor->set_target_thermal_power_watts(100000);
+  auto start = std::chrono::steady_clock::now();
+
+  while (reactor->get_power_watts() < 99000.0 &&
+         reactor->get_time_elapsed_seconds() < 3600.0) {
+    reactor->tick();
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  printf("  from cold to 99 kW with the automatic control: %.0f simulated s, "
+         "%.1f ms\n",
+         reactor->get_time_elapsed_seconds(),
+         std::chrono::duration<double, std::milli>(end - start).count());
+
+  benchmark_sink = reactor->get_neutrons_in_core();
+  delete reactor;
+}
+
+// == Presets ==
+
+/// Loads a preset, prints its residuals, and how far the power and fuel
+/// temperature move over a minute with the rods held
+void measure_preset(const char *name, const Reactor::Equilibrium &preset,
+                    bool fission_products = false) {
+  Reactor::EquilibriumResiduals residuals =
+      Reactor::calculate_preset_residuals(preset);
+
+  Reactor *reactor = new Reactor();
+  reactor->automatic_control = false;
+  reactor->xenon_poisoning = fission_products;
+  reactor->decay_heat = fission_products;
+
+  auto start = std::chrono::steady_clock::now();
+  reactor->load_equilibrium(preset);
+  auto end = std::chrono::steady_clock::now();
+
+  double power_watts = (double)reactor->get_power_watts();
+  double fuel_temperature_celcius =
+      (double)reactor->get_fuel_temperature_celcius();
+  double max_power_error = 0.0;
+
+  for (uint32_t i = 0; i < 600000; i++) {
+    reactor->tick();
+    max_power_error =
+        std::max(max_power_error,
+                 std::fabs((double)reactor->get_power_watts() - power_watts) /
+                     power_watts);
+  }
+
+  printf("    %-22s %5.2f us, residuals: rho %+.1e pcm, Ci %.1e, fuel "
+         "%+.1e W, over 60 s: power %.1e, fuel %+.4f C\n",
+         name, std::chrono::duration<double, std::micro>(end - start).count(),
+         residuals.reactivity_pcm, residuals.precursor_imbalance,
+         residuals.fuel_power_watts, max_power_error,
+         (double)reactor->get_fuel_temperature_celcius() -
+             fuel_temperature_celcius);
+
+  benchmark_sink = reactor->get_neutrons_in_core();
+  delete reactor;
+}
+
+void benchmark_presets() {
+  printf("presets: steady states solved at compile time, loaded at start\n");
+  printf("  water at 20 C, rods held:\n");
+  measure_preset("source level shutdown", SOURCE_LEVEL_SHUTDOWN_PRESET);
+  measure_preset("100 W", PRESET_100_W);
+  measure_preset("20 kW", PRESET_20_KW);
+  measure_preset("240 kW", PRESET_240_KW);
+  measure_preset("240 kW, xenon, decay", PRESET_240_KW_WITH_XENON, true);
+
+  // The step the static_asserts take, against the reactor's first tick
+  double largest_difference = 0.0;
+
+  for (const Reactor::Equilibrium *preset :
+       {&SOURCE_LEVEL_SHUTDOWN_PRESET, &PRESET_100_W, &PRESET_20_KW,
+        &PRESET_240_KW}) {
+    Reactor reactor;
+    reactor.automatic_control = false;
+    reactor.load_equilibrium(*preset);
+    reactor.tick();
+
+    Reactor::Equilibrium stepped =
+        Reactor::calculate_preset_step(*preset, 1e-4);
+    largest_difference = std::max(
+        {largest_difference,
+         std::fabs(reactor.get_state().neutrons_in_core /
+                       stepped.neutrons_in_core -
+                   1.0),
+         std::fabs(reactor.get_state().fuel_temperature_celcius -
+                   stepped.fuel_temperature_celcius)});
+  }
+
+  printf("  constexpr step against the first tick(): within %.1e\n",
+         largest_difference);
+
+  // Against solving it when the reactor starts
+  Reactor *reactor = new Reactor();
+  auto start = std::chrono::steady_clock::now();
+  reactor->initialize_at_equilibrium(240000, 20.0);
+  auto end = std::chrono::steady_clock::now();
+  printf("  initialize_at_equilibrium(240 kW) instead: %.2f us\n",
+         std::chrono::duration<double, std::micro>(end - start).count());
+
+  benchmark_sink = reactor->get_neutrons_in_core();
+  delete reactor;
+}
+
+// == Adaptive tick rate ==
+
+/// Runs a reactor from a preset for an hour, with the rods held or moved by
+/// an operator every 10 minutes, at full rate and with the adaptive tick
+/// rate, and prints the ticks saved and where both ended up
+void measure_adaptive_tick_rate(const char *name,
+                                const Reactor::Equilibrium &preset,
+                                bool automatic_control, bool operator_moves) {
+  double seconds = 3600.0;
+  double power_watts[2] = {};
+  double fuel_temperatures_celcius[2] = {};
+  uint64_t ticks[2] = {};
+  uint64_t quiescent_ticks = 0;
+  double wall_seconds[2] = {};
+
+  for (bool adaptive : {false, true}) {
+    Reactor *reactor = new Reactor();
+    reactor->load_equilibrium(preset);
+    reactor->automatic_control = automatic_control;
+    reactor->adaptive_tick_rate = adaptive;
+
+    uint32_t moves = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    while (reactor->get_time_elapsed_seconds() < seconds) {
+      // Nudges the regulating rod in and back out again 2 s later
+      double next_move_seconds = 600.0 * (moves / 2 + 1) + 2.0 * (moves % 2);
+
+      if (operator_moves &&
+          reactor->get_time_elapsed_seconds() >= next_move_seconds) {
+        ControlRod *rod = reactor->get_regulating_control_rod();
+        rod->set_target_position(rod->get_current_position() +
+                                 (moves % 2 == 0 ? 4000 : -4000));
+        moves++;
+      }
+
+      reactor->tick();
+      ticks[adaptive]++;
+      quiescent_ticks += adaptive && reactor->get_quiescent();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    wall_seconds[adaptive] = std::chrono::duration<double>(end - start).count();
+    power_watts[adaptive] = (double)reactor->get_power_watts();
+    fuel_temperatures_celcius[adaptive] =
+        (double)reactor->get_fuel_temperature_celcius();
+
+    benchmark_sink = reactor->get_neutrons_in_core();
+    delete reactor;
+  }
+
+  printf("    %-34s %5.1f %% of ticks saved, %5.1f %% quiescent, %6.1fx "
+         "faster, power %+.1e, fuel %+.4f C\n",
+         name, 100.0 * (1.0 - (double)ticks[1] / (double)ticks[0]),
+         100.0 * (double)quiescent_ticks / (double)ticks[1],
+         wall_seconds[0] / wall_seconds[1],
+         (power_watts[1] - power_watts[0]) / power_watts[0],
+         fuel_temperatures_celcius[1] - fuel_temperatures_celcius[0]);
+}
+
+void benchmark_adaptive_tick_rate() {
+  printf("adaptive-tick-rate: an hour from a preset, 10 ms ticks while "
+         "quiescent vs 0.1 ms throughout\n");
+  printf("  manual control:\n");
+  measure_adaptive_tick_rate("source level shutdown",
+                             SOURCE_LEVEL_SHUTDOWN_PRESET, false, false);
+  measure_adaptive_tick_rate("100 W, rods held", PRESET_100_W, false, false);
+  measure_adaptive_tick_rate("20 kW, rods held", PRESET_20_KW, false, false);
+  measure_adaptive_tick_rate("240 kW, rods held", PRESET_240_KW, false, false);
+  measure_adaptive_tick_rate("20 kW, rod nudged every 10 min", PRESET_20_KW,
+                             false, true);
+  // The RCS holds the rods while the power in whole watts is the target
+  printf("  automatic control:\n");
+  measure_adaptive_tick_rate("20 kW", PRESET_20_KW, true, false);
+}
+
+// == Batched ticks ==
+
+/// The parts of the firmware loop that don't depend on the hardware, its
+/// mutex round trips and reads of the reactor, done once per call
+struct FirmwareLoopOutputs {
+  std::mutex reactor_data_mutex;
+  std::mutex rod_target_positions_mutex;
+  double neutrons_in_core;
+  double power_watts;
+  std::array<uint32_t, 3> rod_positions;
+  std::array<uint32_t, 3> rod_targets = {0, 2400000, 0};
+
+  void update(Reactor &reactor, uint64_t loops) {
+    if (loops % 100 == 0) {
+      benchmark_sink = (double)reactor.get_fuel_temperature_celcius() +
+                       (double)reactor.get_water_temperature_celcius();
+    }
+
+    reactor_data_mutex.lock();
+    neutrons_in_core = reactor.get_neutrons_in_core();
+    power_watts = reactor.get_power_watts();
+    rod_positions = {
+        reactor.get_safety_control_rod()->get_current_position(),
+        reactor.get_regulating_control_rod()->get_current_position(),
+        reactor.get_compensating_control_rod()->get_current_position()};
+    reactor_data_mutex.unlock();
+
+    rod_target_positions_mutex.lock();
+    reactor.get_safety_control_rod()->set_target_position(rod_targets[0]);
+    reactor.get_regulating_control_rod()->set_target_position(rod_targets[1]);
+    reactor.get_compensating_control_rod()->set_target_position(
+        rod_targets[2]);
+    rod_target_positions_mutex.unlock();
+  }
+};
+
+void benchmark_tick_n() {
+  printf("tick-n: ticks in batches, 100 kW under manual control, best of "
+         "10\n");
+
+  // Held at 100 kW with the rods still, so a batch isn't cut short
+  auto create_reactor = []() {
+    Reactor reactor;
+    reactor.automatic_control = false;
+    reactor.initialize_at_equilibrium(100000, 20.0);
+    return reactor;
+  };
+
+  auto measure_ns = [&](uint32_t batch_ticks, bool firmware_loop) {
+    Reactor reactor = create_reactor();
+    FirmwareLoopOutputs outputs;
+    uint64_t loops = 0;
+
+    uint32_t ticks_per_step = std::max(batch_ticks, (uint32_t)1);
+    double ns = measure_ns_per_step(5000000 / ticks_per_step, [&]() {
+      if (batch_ticks == 0) {
+        reactor.tick();
+      } else {
+        reactor.tick_n(batch_ticks);
+      }
+
+      if (firmware_loop) {
+        outputs.update(reactor, loops++);
+      }
+    });
+
+    benchmark_sink = reactor.get_neutrons_in_core();
+    return ns / ticks_per_step;
+  };
+
+  // tick() and each batch size, then the firmware loop once per tick() and
+  // once per tick_n(10). They take turns, so all of them see the same
+  // interruptions, and the shortest of the runs is kept
+  const std::array<uint32_t, 7> batch_ticks = {0, 1, 10, 100, 1000, 0, 10};
+  const std::array<bool, 7> firmware_loop = {false, false, false, false,
+                                             false, true,  true};
+  std::array<double, 7> best_ns;
+  best_ns.fill(INFINITY);
+
+  for (uint32_t run = 0; run < 10; run++) {
+    for (size_t i = 0; i < best_ns.size(); i++) {
+      best_ns[i] =
+          std::min(best_ns[i], measure_ns(batch_ticks[i], firmware_loop[i]));
+    }
+  }
+
+  print_result("tick()", best_ns[0], best_ns[0]);
+
+  for (size_t i = 1; i < 5; i++) {
+    char name[48];
+    snprintf(name, sizeof(name), "tick_n(%u)", batch_ticks[i]);
+    print_result(name, best_ns[i], best_ns[0]);
+  }
+
+  // With what the firmware loop does around the ticks
+  printf("  with the firmware loop's reads and mutexes:\n");
+  print_result("once per tick()", best_ns[5], best_ns[5]);
+  print_result("once per tick_n(10), as main.cpp", best_ns[6], best_ns[5]);
+
+  // Where a batch stops
+  Reactor stopped = create_reactor();
+  stopped.get_regulating_control_rod()->set_target_position(
+      stopped.get_regulating_control_rod()->get_current_position() + 1000);
+  TickBatch batch = stopped.tick_n(UINT32_MAX);
+  printf("  regulating rod moved in 1000 steps: stopped after %u ticks, %s\n",
+         batch.ticks, describe_tick_batch_stop(batch.stop));
+
+  stopped.get_regulating_control_rod()->set_target_position(0);
+  batch = stopped.tick_n(UINT32_MAX);
+  printf("  regulating rod pulled out: stopped after %u ticks, %s\n",
+         batch.ticks, describe_tick_batch_stop(batch.stop));
+}
+
+// == Xenon poisoning ==
+
+/// Xe-135 a zero power core reaches from some iodine and xenon, integrated
+/// with RK4 in 10 s steps, to check the reactor's exact updates against
+double calculate_reference_xenon_after_shutdown(double iodine, double xenon,
+                                                double seconds) {
+  auto calculate_rates = [](double I, double X, double &dI, double &dX) {
+    dI = -IODINE_135_DECAY_CONSTANT_PER_SECOND * I;
+    dX = IODINE_135_DECAY_CONSTANT_PER_SECOND * I -
+         XENON_135_DECAY_CONSTANT_PER_SECOND * X;
+  };
+
+  for (double t = 0.0; t < seconds; t += 10.0) {
+    double h = std::min(10.0, seconds - t);
+    double I1, X1, I2, X2, I3, X3, I4, X4;
+    calculate_rates(iodine, xenon, I1, X1);
+    calculate_rates(iodine + 0.5 * h * I1, xenon + 0.5 * h * X1, I2, X2);
+    calculate_rates(iodine + 0.5 * h * I2, xenon + 0.5 * h * X2, I3, X3);
+    calculate_rates(iodine + h * I3, xenon + h * X3, I4, X4);
+    iodine += h / 6.0 * (I1 + 2.0 * I2 + 2.0 * I3 + I4);
+    xenon += h / 6.0 * (X1 + 2.0 * X2 + 2.0 * X3 + X4);
+  }
+
+  return xenon;
+}
+
+void benchmark_xenon() {
+  printf("xenon: I-135 and Xe-135 updated once a simulated second\n");
+
+  // Held at 240 kW with the rods still. The runs with and without take
+  // turns, so both see the same interruptions
+  double best_ns[2] = {INFINITY, INFINITY};
+
+  for (uint32_t run = 0; run < 10; run++) {
+    for (bool xenon_poisoning : {false, true}) {
+      Reactor reactor;
+      reactor.load_equilibrium(PRESET_240_KW);
+      reactor.automatic_control = false;
+      reactor.xenon_poisoning = xenon_poisoning;
+
+      best_ns[xenon_poisoning] =
+          std::min(best_ns[xenon_poisoning],
+                   measure_ns_per_step(2000000, [&]() { reactor.tick(); }));
+      benchmark_sink = reactor.get_neutrons_in_core();
+    }
+  }
+
+  print_result("tick(), no xenon, best of 10", best_ns[0], best_ns[0]);
+  print_result("tick(), xenon", best_ns[1], best_ns[0]);
+
+  // A steady state has to have the xenon in it for the rods to hold the
+  // power, otherwise it builds in and shuts the reactor down
+  printf("  held at 240 kW for 10 h with the rods still, xenon and decay heat "
+         "on:\n");
+
+  for (bool with_xenon : {false, true}) {
+    Reactor *held = new Reactor();
+    held->automatic_control = false;
+    held->adaptive_tick_rate = true;
+    held->xenon_poisoning = true;
+    held->decay_heat = true;
+    held->load_equilibrium(with_xenon ? PRESET_240_KW_WITH_XENON
+                                      : PRESET_240_KW);
+
+    while (held->get_time_elapsed_seconds() < 10.0 * 3600.0) {
+      held->tick_n(1000);
+    }
+
+    printf("    %-28s %9.1f W, Xe-135 %6.1f pcm\n",
+           with_xenon ? "PRESET_240_KW_WITH_XENON" : "PRESET_240_KW, no xenon",
+           (double)held->get_power_watts(),
+           (double)held->get_xenon_worth_pcm());
+    benchmark_sink = held->get_neutrons_in_core();
+    delete held;
+  }
+
+  printf("  after a long run at:\n");
+
+  for (double power_watts : {100.0, 20000.0, 240000.0}) {
+    Reactor reactor;
+    reactor.set_fission_products_at_equilibrium(power_watts);
+    printf("    %6.0f W   Xe-135 %.3e /cm^3, %6.1f pcm\n", power_watts,
+           reactor.get_xenon_atoms_per_cm3(),
+           (double)reactor.get_xenon_worth_pcm());
+  }
+
+  // Shut down straight after a long run at 240 kW, and fast forwarded with
+  // the adaptive tick rate
+  Reactor *reactor = new Reactor();
+  reactor->load_equilibrium(SOURCE_LEVEL_SHUTDOWN_PRESET);
+  reactor->automatic_control = false;
+  reactor->adaptive_tick_rate = true;
+  reactor->xenon_poisoning = true;
+  reactor->set_fission_products_at_equilibrium(240000.0);
+
+  double iodine_at_shutdown = reactor->get_iodine_atoms_per_cm3();
+  double xenon_at_shutdown = reactor->get_xenon_atoms_per_cm3();
+  double peak_worth_pcm = 0.0;
+  double peak_hours = 0.0;
+  double largest_difference = 0.0;
+  uint64_t ticks = 0;
+
+  printf("  shut down after a long run at 240 kW:\n");
+  auto start = std::chrono::steady_clock::now();
+
+  for (uint32_t hour = 0; hour <= 48; hour++) {
+    while (reactor->get_time_elapsed_seconds() < hour * 3600.0) {
+      ticks += reactor->tick_n(1000).ticks;
+    }
+
+    double worth_pcm = (double)reactor->get_xenon_worth_pcm();
+    double reference_xenon = calculate_reference_xenon_after_shutdown(
+        iodine_at_shutdown, xenon_at_shutdown,
+        reactor->get_time_elapsed_seconds());
+
+    largest_difference =
+        std::max(largest_difference,
+                 std::fabs(reactor->get_xenon_atoms_per_cm3() / reference_xenon -
+                           1.0));
+
+    if (worth_pcm > peak_worth_pcm) {
+      peak_worth_pcm = worth_pcm;
+      peak_hours = hour;
+    }
+
+    if (hour % 8 == 0) {
+      printf("    %2u h   %6.1f pcm, %.2e W\n", hour, worth_pcm,
+             (double)reactor->get_power_watts());
+    }
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  double wall_seconds = std::chrono::duration<double>(end - start).count();
+
+  // The reactor's last update is up to a second behind
+  printf("    peak %.1f pcm at %.0f h, within %.1e of RK4 in 10 s steps\n",
+         peak_worth_pcm, peak_hours, largest_difference);
+  printf("    48 h in %.2f s, %llu ticks, %.0fx real time\n", wall_seconds,
+         (unsigned long long)ticks, 48.0 * 3600.0 / wall_seconds);
+
+  benchmark_sink = reactor->get_neutrons_in_core();
+  delete reactor;
+}
+
+// == Pulse mode ==
+
+/// Sum of the delayed neutron fractions, a dollar of reactivity
+const double DOLLAR_PCM =
+    (DELAYED_NEUTRON_FRACTION_GROUP_1 + DELAYED_NEUTRON_FRACTION_GROUP_2 +
+     DELAYED_NEUTRON_FRACTION_GROUP_3 + DELAYED_NEUTRON_FRACTION_GROUP_4 +
+     DELAYED_NEUTRON_FRACTION_GROUP_5 + DELAYED_NEUTRON_FRACTION_GROUP_6) *
+    1e5;
+
+/// A pulse of a number of dollars fired from 100 W, the safety rod in by its
+/// worth and the regulating rod holding the reactor critical against it
+struct PulseRun {
+  PulseReport report;
+  /// Longest and average wall time of a tick from firing to the end
+  double worst_tick_ns;
+  double average_tick_ns;
+};
+
+PulseRun run_pulse(double dollars, Integrator integrator,
+                   float time_delta_seconds) {
+  Reactor reactor;
+  double worth_pcm = dollars * DOLLAR_PCM;
+  uint32_t position = (uint32_t)(worth_pcm / CONTROL_ROD_WORTH_PCM * 4e6);
+
+  reactor.get_safety_control_rod()->set_current_position(position);
+  reactor.get_safety_control_rod()->set_target_position(position);
+  reactor.initialize_at_equilibrium(100, 20.0);
+  reactor.automatic_control = false;
+  reactor.integrator = integrator;
+  reactor.set_time_delta_seconds(time_delta_seconds);
+
+  PulseRun run = {};
+  uint64_t ticks = 0;
+  double total_ns = 0.0;
+
+  reactor.fire_pulse();
+
+  while (reactor.get_pulse_in_progress()) {
+    auto start = std::chrono::steady_clock::now();
+    reactor.tick();
+    auto end = std::chrono::steady_clock::now();
+
+    double tick_ns = std::chrono::duration<double, std::nano>(end - start).count();
+    run.worst_tick_ns = std::max(run.worst_tick_ns, tick_ns);
+    total_ns += tick_ns;
+    ticks++;
+  }
+
+  run.report = reactor.get_last_pulse();
+  run.average_tick_ns = total_ns / (double)ticks;
+  benchmark_sink = reactor.get_neutrons_in_core();
+  return run;
+}
+
+void benchmark_pulse() {
+  printf("pulse: the safety rod ejected from 100 W, euler at 0.1 ms against "
+         "RK4 at 10 us\n");
+  printf("  %5s %9s %8s %8s %9s %9s %11s %11s\n", "$", "peak MW", "to peak",
+         "MJ", "fuel C", "sub-steps", "peak vs RK4", "MJ vs RK4");
+
+  for (double dollars : {1.5, 2.0, 2.5, 3.0}) {
+    PulseReport euler = run_pulse(dollars, Integrator::EULER, 1e-4).report;
+    PulseReport reference = run_pulse(dollars, Integrator::RK4, 1e-5).report;
+
+    printf("  %5.2f %9.1f %6.1fms %8.2f %9.1f %9u %+10.2f%% %+10.2f%%\n",
+           euler.inserted_reactivity_pcm / DOLLAR_PCM,
+           euler.peak_power_watts / 1e6, euler.seconds_to_peak * 1e3,
+           euler.energy_J / 1e6, euler.peak_fuel_temperature_celcius,
+           euler.most_kinetics_sub_steps,
+           (euler.peak_power_watts / reference.peak_power_watts - 1.0) * 100.0,
+           (euler.energy_J / reference.energy_J - 1.0) * 100.0);
+  }
+
+  // The firmware ticks at 0.1 ms, so a tick has 100 us of wall time. Best of
+  // 10 against the interruptions of the machine
+  printf("  wall time of a tick from firing to the end, best of 10:\n");
+
+  for (double dollars : {1.5, 3.0}) {
+    PulseRun best = {
+        .report = {}, .worst_tick_ns = INFINITY, .average_tick_ns = INFINITY};
+
+    for (uint32_t run = 0; run < 10; run++) {
+      PulseRun pulse = run_pulse(dollars, Integrator::EULER, 1e-4);
+      best.worst_tick_ns = std::min(best.worst_tick_ns, pulse.worst_tick_ns);
+      best.average_tick_ns =
+          std::min(best.average_tick_ns, pulse.average_tick_ns);
+    }
+
+    printf("    $%.1f   worst %7.0f ns, average %5.0f ns, of a 100000 ns "
+           "budget\n",
+           dollars, best.worst_tick_ns, best.average_tick_ns);
+  }
+}
+
+// == Decay heat ==
+
+/// The decay heat groups updated one at a time, working out each group's
+/// exponentials at every update, as the baseline
+struct ScalarDecayHeatGroups {
+  std::array<double, DECAY_HEAT_GROUPS> energies_J = {};
+
+  double update(double average_power_watts, double interval_seconds) {
+    double decay_heat_watts = 0.0;
+
+    for (uint8_t i = 0; i < DECAY_HEAT_GROUPS; i++) {
+      double decay_constant = DECAY_HEAT_DECAY_CONSTANTS_PER_SECOND[i];
+      double fraction = DECAY_HEAT_GROUP_POWERS_MEV_PER_SECOND[i] /
+                        decay_constant / NEUTRON_FISSION_ENERGY_RELEASED_MEV;
+      double decay_per_interval = decay_constant * interval_seconds;
+
+      energies_J[i] = energies_J[i] * std::exp(-decay_per_interval) +
+                      fraction * average_power_watts *
+                          -std::expm1(-decay_per_interval) / decay_constant;
+      decay_heat_watts += decay_constant * energies_J[i];
+    }
+
+    return decay_heat_watts;
+  }
+};
+
+/// Decay heat over the power before a shutdown after a long run, with no
+/// fissions after it, sum of alpha_i / lambda_i * e^(-lambda_i t) / Q
+double calculate_reference_decay_heat_fraction(double seconds_after_shutdown) {
+  double fraction = 0.0;
+
+  for (uint8_t i = 0; i < DECAY_HEAT_GROUPS; i++) {
+    fraction += DECAY_HEAT_GROUP_POWERS_MEV_PER_SECOND[i] /
+                DECAY_HEAT_DECAY_CONSTANTS_PER_SECOND[i] *
+                std::exp(-DECAY_HEAT_DECAY_CONSTANTS_PER_SECOND[i] *
+                         seconds_after_shutdown) /
+                NEUTRON_FISSION_ENERGY_RELEASED_MEV;
+  }
+
+  return fraction;
+}
+
+void benchmark_decay_heat() {
+  printf("decay heat: %u groups updated every %.0f ms\n", DECAY_HEAT_GROUPS,
+         DECAY_HEAT_UPDATE_INTERVAL_SECONDS * 1e3);
+
+  // One update, cached and vectorized against the per-group code
+  constexpr auto constants = DecayHeatGroupConstants<DECAY_HEAT_GROUPS>::
+      calculate(DECAY_HEAT_GROUP_POWERS_MEV_PER_SECOND,
+                DECAY_HEAT_DECAY_CONSTANTS_PER_SECOND,
+                NEUTRON_FISSION_ENERGY_RELEASED_MEV);
+  DecayHeatGroups<DECAY_HEAT_GROUPS> groups;
+  DecayHeatIntervalExponentials<DECAY_HEAT_GROUPS> exponentials;
+  ScalarDecayHeatGroups scalar_groups;
+
+  double scalar_ns = measure_ns_per_step(1000000, [&]() {
+    benchmark_sink =
+        scalar_groups.update(240000.0, DECAY_HEAT_UPDATE_INTERVAL_SECONDS);
+  });
+  double cached_ns = measure_ns_per_step(1000000, [&]() {
+    exponentials.set_interval_seconds(DECAY_HEAT_UPDATE_INTERVAL_SECONDS,
+                                      constants);
+    groups.integrate_exponential(240000.0, exponentials);
+    benchmark_sink = groups.calculate_decay_heat_watts(constants);
+  });
+
+  print_result("update, per group with exp()", scalar_ns, scalar_ns);
+  print_result("update, DecayHeatGroups", cached_ns, scalar_ns);
+
+  // Held at 240 kW with the rods still. The runs with and without take
+  // turns, so both see the same interruptions
+  double best_ns[2] = {INFINITY, INFINITY};
+
+  for (uint32_t run = 0; run < 10; run++) {
+    for (bool decay_heat : {false, true}) {
+      Reactor reactor;
+      reactor.load_equilibrium(PRESET_240_KW);
+      reactor.automatic_control = false;
+      reactor.decay_heat = decay_heat;
+
+      best_ns[decay_heat] =
+          std::min(best_ns[decay_heat],
+                   measure_ns_per_step(2000000, [&]() { reactor.tick(); }));
+      benchmark_sink = reactor.get_neutrons_in_core();
+    }
+  }
+
+  print_result("tick(), no decay heat, best of 10", best_ns[0], best_ns[0]);
+  print_result("tick(), decay heat", best_ns[1], best_ns[0]);
+
+  // SCRAMed after a long run at 240 kW. The reference is the same groups
+  // updated every tick with the tick's power, so the difference is down to
+  // the 10 ms updates. The fissions die away with the delayed neutrons, so
+  // there's more decay heat than after an instant shutdown
+  printf("  SCRAMed after a long run at 240 kW:\n");
+  printf("    %6s %10s %12s %12s %10s %10s\n", "s", "decay heat",
+         "vs per tick", "instant", "fuel C", "without");
+
+  Reactor *reactors[2] = {new Reactor(), new Reactor()};
+
+  for (bool decay_heat : {false, true}) {
+    Reactor *reactor = reactors[decay_heat];
+    reactor->load_equilibrium(PRESET_240_KW);
+    reactor->automatic_control = false;
+    reactor->decay_heat = decay_heat;
+    reactor->scram();
+  }
+
+  DecayHeatGroups<DECAY_HEAT_GROUPS> reference;
+  DecayHeatIntervalExponentials<DECAY_HEAT_GROUPS> reference_exponentials;
+  reference.set_at_equilibrium(240000.0, constants);
+
+  double largest_difference = 0.0;
+
+  for (double seconds : {0.1, 1.0, 10.0, 60.0, 300.0}) {
+    while (reactors[1]->get_time_elapsed_seconds() < seconds) {
+      double power_watts = (double)reactors[1]->get_power_watts();
+      double time_before = reactors[1]->get_time_elapsed_seconds();
+
+      reactors[0]->tick();
+      reactors[1]->tick();
+
+      reference_exponentials.set_interval_seconds(
+          reactors[1]->get_time_elapsed_seconds() - time_before, constants);
+      reference.integrate_exponential(
+          0.5 * (power_watts + (double)reactors[1]->get_power_watts()),
+          reference_exponentials);
+
+      double reference_watts = reference.calculate_decay_heat_watts(constants);
+      largest_difference = std::max(
+          largest_difference,
+          std::fabs((double)reactors[1]->get_decay_heat_watts() /
+                        reference_watts -
+                    1.0));
+    }
+
+    double decay_heat_watts = (double)reactors[1]->get_decay_heat_watts();
+    printf("    %6.1f %8.0f W %+11.2e%% %10.2f %% %10.1f %10.1f\n", seconds,
+           decay_heat_watts,
+           (decay_heat_watts / reference.calculate_decay_heat_watts(constants) - 1.0) *
+               100.0,
+           calculate_reference_decay_heat_fraction(seconds) * 100.0,
+           (double)reactors[1]->get_fuel_temperature_celcius(),
+           (double)reactors[0]->get_fuel_temperature_celcius());
+  }
+
+  printf("    largest difference from per tick %.2e\n", largest_difference);
+  printf("    decay heat right after a long run: %.2f %% of the power\n",
+         calculate_reference_decay_heat_fraction(0.0) * 100.0);
+
+  benchmark_sink = reactors[0]->get_neutrons_in_core() +
+                   reactors[1]->get_neutrons_in_core();
+  delete reactors[0];
+  delete reactors[1];
+}
+
+// == Fuel element temperatures ==
+
+/// The fuel element nodes updated one at a time with std::cbrt, which doesn't
+/// vectorize, as the baseline
+template <size_t NODES> struct ScalarFuelNodes {
+  std::array<double, NODES> temperatures;
+  std::array<double, NODES> power_shares;
+  double hottest_temperature_celcius = 20.0;
+  double average_temperature_celcius = 20.0;
+
+  ScalarFuelNodes() {
+    temperatures.fill(20.0);
+    power_shares.fill(1.0 / NODES);
+  }
+
+  void integrate(double heat_J, double seconds,
+                 double water_temperature_celcius,
+                 const FuelNodeCoefficients &coefficients) {
+    hottest_temperature_celcius = -1e300;
+    average_temperature_celcius = 0.0;
+
+    for (size_t node = 0; node < NODES; node++) {
+      double temperature_celcius = temperatures[node];
+      double first = coefficients.cardano_first;
+      double second = coefficients.cardano_second_constant +
+                      coefficients.cardano_second_per_K *
+                          (water_temperature_celcius - temperature_celcius);
+      double discriminant = second * second - 4.0 * first * first * first;
+      double root = std::cbrt((second + std::sqrt(discriminant)) / 2.0);
+      double exchanged_J_per_second =
+          coefficients.cardano_result_scale / NODES *
+          (coefficients.temperature_fe_stat_a1 + root + first / root);
+      double capacity_J_per_K =
+          (coefficients.capacity_J_per_K_c0 +
+           coefficients.capacity_J_per_K_c1 * temperature_celcius) /
+          NODES;
+
+      temperature_celcius +=
+          (heat_J * power_shares[node] - exchanged_J_per_second * seconds) /
+          capacity_J_per_K;
+      temperatures[node] = temperature_celcius;
+
+      hottest_temperature_celcius =
+          std::max(hottest_temperature_celcius, temperature_celcius);
+      average_temperature_celcius += power_shares[node] * temperature_celcius;
+    }
+  }
+};
+
+FuelNodeCoefficients calculate_fuel_node_coefficients() {
+  const Reactor::Coefficients &coefficients =
+      Reactor::CONFIGURATION_COEFFICIENTS;
+
+  return {
+      .cardano_first = coefficients.cardano_first,
+      .cardano_second_constant = coefficients.cardano_second_constant,
+      .cardano_second_per_K = coefficients.cardano_second_per_K,
+      .cardano_result_scale = coefficients.cardano_result_scale,
+      .temperature_fe_stat_a1 = coefficients.temperature_fe_stat_a1,
+      .capacity_J_per_K_c0 = coefficients.fuel_capacity_J_per_K_c0,
+      .capacity_J_per_K_c1 = coefficients.fuel_capacity_J_per_K_c1,
+  };
+}
+
+/// One update of all the nodes at 240 kW and a 0.1 ms step, against the same
+/// nodes one at a time
+template <uint8_t AXIAL_NODES> void measure_fuel_node_update() {
+  using Nodes = FuelElementTemperatures<FUEL_ELEMENTS_IN_CORE, AXIAL_NODES>;
+  FuelNodeCoefficients coefficients = calculate_fuel_node_coefficients();
+  Nodes nodes;
+  ScalarFuelNodes<Nodes::MAX_NODES> scalar_nodes;
+
+  double best_ns[2] = {INFINITY, INFINITY};
+
+  for (uint32_t run = 0; run < 10; run++) {
+    best_ns[0] = std::min(best_ns[0], measure_ns_per_step(200000, [&]() {
+                            scalar_nodes.integrate(24.0, 1e-4, 20.0,
+                                                   coefficients);
+                            benchmark_sink =
+                                scalar_nodes.hottest_temperature_celcius;
+                          }));
+    best_ns[1] = std::min(best_ns[1], measure_ns_per_step(200000, [&]() {
+                            nodes.integrate(24.0, 1e-4, 20.0, coefficients);
+                            benchmark_sink =
+                                nodes.get_hottest_temperature_celcius();
+                          }));
+  }
+
+  char name[64];
+  snprintf(name, sizeof(name), "%u x %u nodes, one at a time with cbrt",
+           FUEL_ELEMENTS_IN_CORE, AXIAL_NODES);
+  print_result(name, best_ns[0], best_ns[0]);
+  snprintf(name, sizeof(name), "%u x %u nodes, FuelElementTemperatures",
+           FUEL_ELEMENTS_IN_CORE, AXIAL_NODES);
+  print_result(name, best_ns[1], best_ns[0]);
+  printf("    %.0f M nodes/s, one at a time %.0f M nodes/s\n",
+         Nodes::MAX_NODES / best_ns[1] * 1e3,
+         Nodes::MAX_NODES / best_ns[0] * 1e3);
+}
+
+void benchmark_fuel_element_temperatures() {
+  using FuelElements = Reactor::FuelElements;
+
+  printf("fuel element temperatures: %u elements x %u axial nodes\n",
+         FUEL_ELEMENTS_IN_CORE, FUEL_ELEMENT_AXIAL_NODES);
+
+  measure_fuel_node_update<1>();
+  measure_fuel_node_update<FUEL_ELEMENT_AXIAL_NODES>();
+
+  // With every node given the same share, each follows the lumped model, so
+  // the two only differ by rounding. Raised 1 % of the regulating rod for
+  // 20 s from 240 kW, then SCRAMed
+  Reactor *lumped = new Reactor();
+  Reactor *uniform = new Reactor();
+  uniform->fuel_element_temperatures = true;
+
+  std::array<double, FuelElements::MAX_NODES> equal_shares;
+  equal_shares.fill(1.0);
+  uniform->get_fuel_elements()->set_power_shares(equal_shares);
+
+  double largest_temperature_difference = 0.0;
+  double largest_power_difference = 0.0;
+
+  for (Reactor *reactor : {lumped, uniform}) {
+    reactor->load_equilibrium(PRESET_240_KW);
+    reactor->automatic_control = false;
+    reactor->get_regulating_control_rod()->set_target_position(
+        reactor->get_regulating_control_rod()->get_current_position() - 40000);
+  }
+
+  while (lumped->get_time_elapsed_seconds() < 30.0) {
+    if (lumped->get_time_elapsed_seconds() >= 20.0 && !lumped->get_in_scram()) {
+      lumped->scram();
+      uniform->scram();
+    }
+
+    lumped->tick();
+    uniform->tick();
+
+    largest_temperature_difference =
+        std::max(largest_temperature_difference,
+                 std::fabs((double)uniform->get_fuel_temperature_celcius() -
+                           (double)lumped->get_fuel_temperature_celcius()));
+    largest_power_difference = std::max(
+        largest_power_difference,
+        std::fabs((double)uniform->get_power_watts() /
+                      (double)lumped->get_power_watts() -
+                  1.0));
+  }
+
+  printf("  equal shares against the lumped fuel, 20 s up 1 %% of a rod and "
+         "a SCRAM:\n");
+  printf("    largest fuel temperature difference %.2e C, power %.2e\n",
+         largest_temperature_difference, largest_power_difference);
+
+  // The estimated power map at 240 kW, and 60 s after the regulating rod is
+  // raised 1 %, the fuel SCRAM trips on the hottest node
+  Reactor *mapped = new Reactor();
+  mapped->fuel_element_temperatures = true;
+
+  for (Reactor *reactor : {lumped, mapped}) {
+    reactor->load_equilibrium(PRESET_240_KW);
+    reactor->automatic_control = false;
+    reactor->scrams_enabled = false;
+  }
+
+  FuelElements *fuel_elements = mapped->get_fuel_elements();
+  double highest_share = 0.0;
+
+  for (size_t node = 0; node < fuel_elements->get_node_count(); node++) {
+    highest_share =
+        std::max(highest_share, fuel_elements->get_power_share(node));
+  }
+
+  printf("  estimated power map, hottest node at %.2f x the average:\n",
+         highest_share * fuel_elements->get_node_count());
+  printf("    %6s %10s %10s %10s %10s\n", "s", "power kW", "lumped C",
+         "average C", "hottest C");
+
+  for (Reactor *reactor : {lumped, mapped}) {
+    reactor->get_regulating_control_rod()->set_target_position(
+        reactor->get_regulating_control_rod()->get_current_position() - 40000);
+  }
+
+  for (double seconds : {0.0, 10.0, 60.0}) {
+    while (mapped->get_time_elapsed_seconds() < seconds) {
+      lumped->tick();
+      mapped->tick();
+    }
+
+    printf("    %6.0f %10.1f %10.1f %10.1f %10.1f\n", seconds,
+           (double)mapped->get_power_watts() / 1e3,
+           (double)lumped->get_fuel_temperature_celcius(),
+           (double)mapped->get_fuel_temperature_celcius(),
+           (double)mapped->get_hottest_fuel_temperature_celcius());
+  }
+
+  printf("    fuel temperature SCRAM at %.0f C\n",
+         (double)Reactor::CONFIGURATION_COEFFICIENTS
+             .fuel_temperature_scram_celcius);
+
+  benchmark_sink = lumped->get_neutrons_in_core() +
+                   uniform->get_neutrons_in_core() +
+                   mapped->get_neutrons_in_core();
+  delete lumped;
+  delete uniform;
+  delete mapped;
+
+  // The map follows the parameters applied at runtime, the same as the
+  // configuration compiled in
+  using Example = BasicReactor<double, EXAMPLE_80_ELEMENT_TRIGA_CONFIGURATION>;
+  ReactorParameters parameters;
+  parameters.load_from_string(EXAMPLE_80_ELEMENT_TRIGA_PARAMETERS);
+  RuntimeReactor *runtime = new RuntimeReactor();
+  Example *example = new Example();
+  runtime->apply_parameters(parameters.get_parameters());
+
+  RuntimeReactor::FuelElements *runtime_elements =
+      runtime->get_fuel_elements();
+  Example::FuelElements *example_elements = example->get_fuel_elements();
+  bool same_map =
+      runtime_elements->get_node_count() == example_elements->get_node_count();
+
+  for (size_t node = 0; same_map && node < example_elements->get_node_count();
+       node++) {
+    same_map = runtime_elements->get_power_share(node) ==
+               example_elements->get_power_share(node);
+  }
+
+  printf("  runtime parameters, example 80 element TRIGA: %zu nodes, %s\n",
+         runtime_elements->get_node_count(),
+         same_map ? "same map as compiled in" : "map differs");
+  printf("  nodes kept: Reactor %zu bytes, RuntimeReactor %zu, outside the "
+         "%zu byte ReactorState\n",
+         sizeof(FuelElements), sizeof(RuntimeReactor::FuelElements),
+         sizeof(Reactor::ReactorState));
+  delete runtime;
+  delete example;
+
+  // Held at 240 kW with the rods still, the nodes updated every tick and
+  // every 10 ticks. The runs take turns, so all see the same interruptions
+  double best_ns[3] = {INFINITY, INFINITY, INFINITY};
+  const uint32_t INTERVALS[3] = {1, 1, 10};
+
+  for (uint32_t run = 0; run < 10; run++) {
+    for (uint8_t i = 0; i < 3; i++) {
+      Reactor reactor;
+      reactor.fuel_element_temperatures = i > 0;
+      reactor.fuel_temperature_update_interval_ticks = INTERVALS[i];
+      reactor.load_equilibrium(PRESET_240_KW);
+      reactor.automatic_control = false;
+
+      best_ns[i] = std::min(
+          best_ns[i], measure_ns_per_step(200000, [&]() { reactor.tick(); }));
+      benchmark_sink = reactor.get_neutrons_in_core();
+    }
+  }
+
+  print_result("tick(), lumped fuel, best of 10", best_ns[0], best_ns[0]);
+  print_result("tick(), fuel elements", best_ns[1], best_ns[0]);
+  print_result("tick(), fuel elements every 10 ticks", best_ns[2],
+               best_ns[0]);
+}
+
+struct Benchmark {
+  const char *name;
+  void (*run)();
+};
+
+const Benchmark BENCHMARKS[] = {
+    {"precursors", benchmark_precursor_groups},
+    {"exponential", benchmark_precursor_integration},
+    {"ensemble", benchmark_reactor_ensemble},
+    {"integrators", benchmark_integrators},
+    {"prompt-jump", benchmark_prompt_jump},
+    {"multi-rate", benchmark_multi_rate},
+    {"scalar-types", benchmark_scalar_types},
+    {"log-neutrons", benchmark_logarithmic_neutrons},
+    {"derived-cache", benchmark_derived_quantities},
+    {"reactivity-cache", benchmark_reactivity_cache},
+    {"thermal-approx", benchmark_thermal_approximations},
+    {"rod-worth", benchmark_rod_worth},
+    {"rod-motion", benchmark_rod_motion},
+    {"configurations", benchmark_configurations},
+    {"parameters", benchmark_runtime_parameters},
+    {"state", benchmark_reactor_state},
+    {"snapshot", benchmark_snapshots},
+    {"equilibrium", benchmark_equilibrium},
+    {"presets", benchmark_presets},
+    {"adaptive-tick-rate", benchmark_adaptive_tick_rate},
+    {"tick-n", benchmark_tick_n},
+    {"xenon", benchmark_xenon},
+    {"pulse", benchmark_pulse},
+    {"decay-heat", benchmark_decay_heat},
+    {"fuel-elements", benchmark_fuel_element_temperatures},
+};
+
+int main(int argc, char **argv) {
+  for (auto &benchmark : BENCHMARKS) {
+    if (argc > 1 && strcmp(argv[1], benchmark.name) != 0) {
+      continue;
+    }
+
+    benchmark.run();
+    printf("\n");
+  }
+
+  return 0;
+}
@@ -1,6 +1,7 @@
 #ifndef CONSTANTS_HPP
 #define CONSTANTS_HPP
 
+#include <array>
 #include <stdint.h>
 
 // Constants
@@ -49,6 +50,8 @@ const uint32_t MAIN_PIN_ACTIVE_COOLING_SWITCH = 21;
 const uint32_t MAIN_PIN_ENABLE_SCRAMS_SWITCH = 20;
 
 const uint32_t MAIN_PIN_SCRAM_BUTTON = 19;
+/// Fires a pulse under manual control, see Reactor::fire_pulse
+const uint32_t MAIN_PIN_PULSE_BUTTON = 2;
 
 const uint32_t MAIN_PIN_CHERENKOV_LED = 18;
 const uint32_t MAIN_PIN_SCRAM_LED = 15;
@@ -68,6 +71,27 @@ const uint32_t MAIN_PIN_LCD_DATA_7 = 3;
 const uint32_t MAIN_PIN_UART_RX = 17;
 const uint32_t MAIN_PIN_UART_TX = 16;
 
+/// How long the SCRAM button has to be held to save the reactor to flash, as
+/// it was when the button was pressed, with its SCRAM started. Holding the button while the
+/// pico starts carries on from the saved reactor
+const uint32_t MAIN_SNAPSHOT_SAVE_HOLD_MS = 3000;
+
+/// How many 0.1 ms ticks the pico runs in one batch before it reads the
+/// inputs and updates the outputs, so they're handled at 1 kHz
+const uint32_t MAIN_TICKS_PER_LOOP = 10;
+
+/// How far the loop can fall behind real time and still catch up, by running
+/// the loops after it back to back. Ticks during a pulse take longer, with
+/// the kinetics in sub-steps. Past it the loop gives up on that time, which
+/// is added up and shown on the LCD
+const uint32_t MAIN_MAX_CATCH_UP_MS = 100;
+
+/// How long the LCD shows the report of a pulse after it ends
+const uint32_t MAIN_PULSE_REPORT_DISPLAY_MS = 10000;
+
+/// How long the LCD shows why the snapshot in flash wasn't loaded at start
+const uint32_t MAIN_SNAPSHOT_STATUS_DISPLAY_MS = 10000;
+
 // == Simulation constants ==
 
 // Stolen from RRS/include/Settings.h
@@ -101,12 +125,116 @@ const auto WATER_ACTIVE_COOLING_POWER_WATTS = 240000;
 /// fully into the core completely kill reactivity?
 const auto CONTROL_ROD_WORTH_PCM = 4000;
 
+// Reactor control system
+/// Every how much simulated time the controller looks at the power and gives
+/// the regulating rod a new target, whatever the tick or integrator step.
+/// Counted in whole microseconds like DECAY_HEAT_UPDATE_INTERVAL_MICROSECONDS
+constexpr uint32_t RCS_SAMPLE_PERIOD_MICROSECONDS = 100000;
+
 // Scram conditions
 const auto SCRAM_PERIOD_SECONDS = 6.0;
 const auto POWER_SCRAM_WATTS = 250000;
 const auto FUEL_TEMPERATURE_SCRAM_CELCIUS = 300;
 const auto WATER_TEMPERATURE_SCRAM_CELCIUS = 80;
 
+/// How close in time a SCRAM limit crossing is located inside one step of the
+/// Runge-Kutta integrators
+const auto SCRAM_LOCATION_TOLERANCE_SECONDS = 1e-6;
+
+// Adaptive integration (Integrator::RK45)
+/// Error allowed per step, relative to the size of each value
+const auto ADAPTIVE_RELATIVE_TOLERANCE = 1e-6;
+/// Error allowed per step on top of the relative one, for the neutron and
+/// precursor populations
+const auto ADAPTIVE_ABSOLUTE_TOLERANCE_NEUTRONS = 1.0;
+/// Error allowed per step on top of the relative one, for the temperatures
+const auto ADAPTIVE_ABSOLUTE_TOLERANCE_CELCIUS = 1e-6;
+const auto ADAPTIVE_MIN_TIME_DELTA_SECONDS = 1e-6;
+const auto ADAPTIVE_MAX_TIME_DELTA_SECONDS = 1.0;
+
+// Prompt jump approximation (Reactor::prompt_jump)
+/// Above this reactivity, in dollars (fractions of beta), the prompt neutrons
+/// are too slow to settle within a step and the full kinetics are used
+const auto PROMPT_JUMP_MAX_REACTIVITY_DOLLARS = 0.8;
+/// Longest sub-step of the full kinetics when the prompt jump approximation
+/// falls back to them
+const auto PROMPT_JUMP_FALLBACK_TIME_DELTA_SECONDS = 1e-4;
+
+// Adaptive tick rate (Reactor::adaptive_tick_rate)
+/// How many full rate ticks one tick covers while the reactor is quiescent,
+/// 10 ms at the 0.1 ms step, where the prompt jump approximation is valid
+const uint32_t QUIESCENT_TICKS_PER_TICK = 100;
+/// Every how many full rate ticks to check for quiescence
+const uint32_t QUIESCENCE_CHECK_INTERVAL_TICKS = 100;
+/// How many checks in a row have to find the reactor quiescent before the
+/// ticks get longer, a second at the 0.1 ms step
+const uint32_t QUIESCENCE_CHECKS_BEFORE_SLOWING = 100;
+/// Fastest the neutrons can change, relative to themselves, a period of
+/// 1000 s
+const auto QUIESCENCE_MAX_RELATIVE_NEUTRON_RATE_PER_SECOND = 1e-3;
+/// Fastest the fuel and water temperatures can change
+const auto QUIESCENCE_MAX_TEMPERATURE_RATE_CELCIUS_PER_SECOND = 1e-2;
+
+// Xenon poisoning (Reactor::xenon_poisoning), thermal fission of U-235
+/// Every how much simulated time the iodine and xenon are updated, hours
+/// shorter than their half lives
+constexpr auto XENON_UPDATE_INTERVAL_SECONDS = 1.0;
+/// Atoms made directly by each fission. Most of the xenon comes from the
+/// iodine decaying
+constexpr auto IODINE_135_FISSION_YIELD = 0.0639;
+constexpr auto XENON_135_FISSION_YIELD = 0.00237;
+/// ln 2 over the half lives, 6.57 h and 9.14 h
+constexpr auto IODINE_135_DECAY_CONSTANT_PER_SECOND = 0.693147 / (6.57 * 3600.0);
+constexpr auto XENON_135_DECAY_CONSTANT_PER_SECOND = 0.693147 / (9.14 * 3600.0);
+/// Thermal neutron absorption cross section of Xe-135, 2.65 million barns
+constexpr auto XENON_135_ABSORPTION_CROSS_SECTION_CM2 = 2.65e-18;
+/// Neutrons released by each fission, nu
+constexpr auto NEUTRONS_PER_FISSION = 2.43;
+/// Thermal flux averaged over the core for each watt of power, about
+/// 2e12 1/(cm^2 s) at 250 kW. An estimate, the point kinetics don't give it
+constexpr auto THERMAL_FLUX_PER_WATT = 8e6;
+
+// Pulse mode (Reactor::fire_pulse)
+/// How fast the transient rod speeds up when it's ejected, fully outside in
+/// 0.1 s
+const uint32_t TRANSIENT_ROD_EJECTION_ACCELERATION_STEPS_PER_SECOND_SQUARED =
+    800000000;
+/// How long a pulse lasts from firing. The power SCRAM is held off until then,
+/// and the reactor is SCRAMed at the end
+const auto PULSE_DURATION_SECONDS = 1.0;
+/// Above prompt critical the neutrons grow with the prompt period, Λ / (ρ - β).
+/// The kinetics take at least this many sub-steps per period
+const auto KINETICS_SUB_STEPS_PER_PROMPT_PERIOD = 1000.0;
+/// Most sub-steps a tick's kinetics take, which bounds how long a tick can be
+/// during a pulse
+const uint32_t MAX_KINETICS_SUB_STEPS_PER_TICK = 64;
+
+// Decay heat (Reactor::decay_heat), thermal fission of U-235
+//
+// The 23 group fit of ANSI/ANS-5.1-1979: after a fission the fission products
+// give off sum of alpha_i * e^(-lambda_i t) MeV per second, about 6.6 % of the
+// power after a long run
+/// alpha_i, in MeV per fission per second
+constexpr std::array<double, 23> DECAY_HEAT_GROUP_POWERS_MEV_PER_SECOND = {
+    6.5057e-01, 5.1264e-01, 2.4384e-01, 1.3850e-01, 5.5440e-02, 2.2225e-02,
+    3.3088e-03, 9.3015e-04, 8.0943e-04, 1.9567e-04, 3.2535e-05, 7.5595e-06,
+    2.5232e-06, 4.9948e-07, 1.8531e-07, 2.6608e-08, 2.2398e-09, 8.1641e-12,
+    8.7797e-11, 2.5131e-14, 3.2176e-16, 4.5038e-17, 7.4791e-17};
+/// lambda_i, in 1/s
+constexpr std::array<double, 23> DECAY_HEAT_DECAY_CONSTANTS_PER_SECOND = {
+    2.2138e+01, 5.1587e-01, 1.9594e-01, 1.0314e-01, 3.3656e-02, 1.1681e-02,
+    3.5870e-03, 1.3930e-03, 6.2630e-04, 1.8906e-04, 5.4988e-05, 2.0958e-05,
+    1.0010e-05, 2.5438e-06, 6.6361e-07, 1.2290e-07, 2.7213e-08, 4.3714e-09,
+    7.5780e-10, 2.4786e-10, 2.2384e-13, 2.4600e-14, 1.5699e-14};
+constexpr uint8_t DECAY_HEAT_GROUPS =
+    DECAY_HEAT_DECAY_CONSTANTS_PER_SECOND.size();
+/// Every how much simulated time the decay heat groups are updated. The
+/// fastest group has a half life of 31 ms. Counted in whole microseconds, so
+/// the float ticks adding up to it don't fall a hair short
+constexpr uint32_t DECAY_HEAT_UPDATE_INTERVAL_MICROSECONDS = 10000;
+constexpr auto DECAY_HEAT_UPDATE_INTERVAL_SECONDS =
+    DECAY_HEAT_UPDATE_INTERVAL_MICROSECONDS * 1e-6;
+
 const auto NEUTRON_SOURCE_INTENSITY_NEUTRONS_PER_SECOND = 1e5;
 
 // See table 1 again
@@ -124,23 +252,51 @@ const auto DECAY_TIME_GROUP_4 = 0.30100;
 const auto DECAY_TIME_GROUP_5 = 0.13800;
 const auto DECAY_TIME_GROUP_6 = 3.01000;
 
-const auto FUEL_T_FEEDBACK_COEFFICIENT_0_C_PCM_PER_C = 6.0;
-const auto FUEL_T_FEEDBACK_COEFFICIENT_240_C_PCM_PER_C = 9.0;
-const auto FUEL_T_FEEDBACK_COEFFICIENT_SLOPE_AFTER_PEAK_PCM_PER_C_SQUARED =
+/// The groups above as arrays, for the precursor engine
+///
+/// Note: the "decay times" are used as decay constants (lambda_i, in 1/s)
+constexpr std::array<double, 6> DELAYED_NEUTRON_FRACTIONS_6_GROUP = {
+    DELAYED_NEUTRON_FRACTION_GROUP_1, DELAYED_NEUTRON_FRACTION_GROUP_2,
+    DELAYED_NEUTRON_FRACTION_GROUP_3, DELAYED_NEUTRON_FRACTION_GROUP_4,
+    DELAYED_NEUTRON_FRACTION_GROUP_5, DELAYED_NEUTRON_FRACTION_GROUP_6};
+constexpr std::array<double, 6> DECAY_TIMES_6_GROUP = {
+    DECAY_TIME_GROUP_1, DECAY_TIME_GROUP_2, DECAY_TIME_GROUP_3,
+    DECAY_TIME_GROUP_4, DECAY_TIME_GROUP_5, DECAY_TIME_GROUP_6};
+
+/// 8 group data for thermal fission of U-235 (JEFF-3.1 decay constants,
+/// relative abundances from Spriggs et al.), scaled to the same effective
+/// delayed neutron fraction as the 6 group data above
+constexpr std::array<double, 8> DELAYED_NEUTRON_FRACTIONS_8_GROUP = {
+    0.0328 * 0.00699891, 0.1539 * 0.00699891, 0.0917 * 0.00699891,
+    0.1970 * 0.00699891, 0.3308 * 0.00699891, 0.0903 * 0.00699891,
+    0.0812 * 0.00699891, 0.0223 * 0.00699891};
+constexpr std::array<double, 8> DECAY_TIMES_8_GROUP = {
+    0.012467, 0.028292, 0.042524, 0.133042,
+    0.292467, 0.666488, 1.634781, 3.554600};
+
+/// Which group data JSI_TRIGA_CONFIGURATION and the presets use,
+/// JSI_TRIGA_8_GROUP_CONFIGURATION has the 8 group set
+constexpr auto DELAYED_NEUTRON_FRACTIONS = DELAYED_NEUTRON_FRACTIONS_6_GROUP;
+constexpr auto DECAY_TIMES = DECAY_TIMES_6_GROUP;
+constexpr uint8_t DELAYED_NEUTRON_GROUPS = DELAYED_NEUTRON_FRACTIONS.size();
+
+constexpr auto FUEL_T_FEEDBACK_COEFFICIENT_0_C_PCM_PER_C = 6.0;
+constexpr auto FUEL_T_FEEDBACK_COEFFICIENT_240_C_PCM_PER_C = 9.0;
+constexpr auto FUEL_T_FEEDBACK_COEFFICIENT_SLOPE_AFTER_PEAK_PCM_PER_C_SQUARED =
     -0.004;
 
 // See section 2.1
-const auto NEUTRON_VELOCITY_METERS_PER_SECOND = 2200;
-const auto NEUTRON_FISSION_ENERGY_RELEASED_MEV = 200;
+constexpr auto NEUTRON_VELOCITY_METERS_PER_SECOND = 2200;
+constexpr auto NEUTRON_FISSION_ENERGY_RELEASED_MEV = 200;
 
 // Taken from RRS/include/Simulator.h
-const auto FUEL_ELEMENTS_IN_CORE = 59;
+constexpr auto FUEL_ELEMENTS_IN_CORE = 59;
 
 // Taken from RSS/src/Simulator.cpp, line 504, getFuelCp
-const auto FUEL_ELEMENT_OUTER_RADIUS_CM = 3.556;
-const auto FUEL_ELEMENT_INNER_RADIUS_CM = 0.635;
-const auto FUEL_ELEMENT_LENGTH_CM = 38.1;
-const auto ONE_FUEL_ELEMENT_VOLUME_CM3 =
+constexpr auto FUEL_ELEMENT_OUTER_RADIUS_CM = 3.556;
+constexpr auto FUEL_ELEMENT_INNER_RADIUS_CM = 0.635;
+constexpr auto FUEL_ELEMENT_LENGTH_CM = 38.1;
+constexpr auto ONE_FUEL_ELEMENT_VOLUME_CM3 =
 
     ((0.5 * FUEL_ELEMENT_OUTER_RADIUS_CM) *
      (0.5 * FUEL_ELEMENT_OUTER_RADIUS_CM) -
@@ -160,10 +316,30 @@ const auto ONE_FUEL_ELEMENT_VOLUME_CM3 =
 ///
 /// Also, https://ric.ijs.si/wp-content/uploads/Description_TRIGA_Reactor.pdf
 /// says it's 6.0? Who knows at this point
-const auto FUEL_DENSITY_KG_PER_CM3 = 0.0614;
+constexpr auto FUEL_DENSITY_KG_PER_CM3 = 0.0614;
 
 /// Mass of all the fuel elements in the core
-const auto FUEL_MASS_KG = FUEL_DENSITY_KG_PER_CM3 * ONE_FUEL_ELEMENT_VOLUME_CM3 * FUEL_ELEMENTS_IN_CORE;
+constexpr auto FUEL_MASS_KG = FUEL_DENSITY_KG_PER_CM3 * ONE_FUEL_ELEMENT_VOLUME_CM3 * FUEL_ELEMENTS_IN_CORE;
+
+// Per element fuel temperatures (Reactor::fuel_element_temperatures)
+//
+// The power map is an estimate, not the measured one of the JSI core: the
+// elements fill the rings from B outwards, 6 more to each ring, and the power
+// falls off across the core with J0 as in a bare cylinder, and along each
+// element with a cosine. That puts the B ring at 1.47 times the average and
+// the outer ring at 0.70
+/// How many nodes each element is split into along its length, 1 for one
+/// temperature per element
+constexpr uint8_t FUEL_ELEMENT_AXIAL_NODES = 4;
+/// How far past the last ring the J0 shape reaches 0, in ring pitches. The
+/// graphite reflector keeps the power up at the edge of the core
+constexpr auto FUEL_ELEMENT_RADIAL_EXTRAPOLATION_RINGS = 2.0;
+/// How far past each end of the fuel the axial cosine reaches 0, for the
+/// graphite end reflectors. 55 cm from end to end for the JSI's 38.1 cm
+constexpr auto FUEL_ELEMENT_AXIAL_REFLECTOR_SAVINGS_CM = 8.45;
+/// The most elements a core with runtime parameters has nodes for, rings B
+/// to G full
+constexpr uint8_t FUEL_ELEMENT_TEMPERATURES_MAX_ELEMENTS = 127;
 
 /// taken from tempModelCoeff in RRS/include/Simulator.h, L142,
 /// used to calculate Temperature_fe_stat
@@ -171,13 +347,19 @@ const auto FUEL_MASS_KG = FUEL_DENSITY_KG_PER_CM3 * ONE_FUEL_ELEMENT_VOLUME_CM3
 /// this was in turn "// From TRIGLAV documentation"
 ///
 /// Also see figure 6 in https://www.sciencedirect.com/science/article/pii/S0306454920303285#b0070
-const auto TEMPERATURE_FE_STAT_A0 = 67.18e-03;
-const auto TEMPERATURE_FE_STAT_A1 = -8.381e-06;
-const auto TEMPERATURE_FE_STAT_A2 = 0.3843e-09;
+constexpr auto TEMPERATURE_FE_STAT_A0 = 67.18e-03;
+constexpr auto TEMPERATURE_FE_STAT_A1 = -8.381e-06;
+constexpr auto TEMPERATURE_FE_STAT_A2 = 0.3843e-09;
 
 /// Taken from RRS
 // Their values are 15/1000, 7/1000 and 20/1000
 const auto SAFETY_ROD_SPEED_PER_SECOND = 15 * 4000;
 const auto REGULATING_ROD_SPEED_PER_SECOND = 7 * 4000;
 const auto COMPENSATING_ROD_SPEED_PER_SECOND = 20 * 4000;
+
+/// Bezier parameters of the pulsing rod's integral worth curve, see
+/// ControlRod::set_worth_curve_bezier and figure 22 in
+/// https://www.sciencedirect.com/science/article/pii/S0306454920303285#t0005
+const auto PULSING_ROD_WORTH_CURVE_BEZIER_PARAMETER_0 = 0.57;
+const auto PULSING_ROD_WORTH_CURVE_BEZIER_PARAMETER_1 = 0.68;
 #endif
@@ -1,62 +1,259 @@
 #include "control_rod.hpp"
 #include "constants.hpp"
+#include "fixed_point.hpp"
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 //#include "pico/stdlib.h"
 
-ControlRod::ControlRod() { current_position = 0; }
+template <typename Scalar> BasicControlRod<Scalar>::BasicControlRod() {
+  current_position = 0;
+}
 
 /// Creates a control rod with a starting position
-ControlRod::ControlRod(uint32_t position) {
+template <typename Scalar>
+BasicControlRod<Scalar>::BasicControlRod(uint32_t position) {
   this->current_position = std::clamp(position, (uint32_t)0, (uint32_t)4e6);
 }
 
 /// Gets the current position of the control rod, between 0 and 4_000_000
-uint32_t ControlRod::get_current_position() { return current_position; }
+template <typename Scalar>
+uint32_t BasicControlRod<Scalar>::get_current_position() {
+  return current_position;
+}
 
 /// Gets the current position of the control rod, as a double between 0 and 1
 ///
 /// 1 is fully inside and 0 is fully outside
-double ControlRod::get_current_position_as_fraction() { return (double)current_position / (double)4e6; }
+template <typename Scalar>
+Scalar BasicControlRod<Scalar>::get_current_position_as_fraction() {
+  return Scalar((double)current_position / (double)4e6);
+}
 
 /// Sets the current position of the control rod, between 0 and 4_000_000
-void ControlRod::set_current_position(uint32_t new_position) {
+template <typename Scalar>
+void BasicControlRod<Scalar>::set_current_position(uint32_t new_position) {
   current_position = std::clamp(new_position, (uint32_t)0, (uint32_t)4e6);
+
+  // Put somewhere else, like by a SCRAM
+  if (ejecting) {
+    ejecting = false;
+    velocity_q16 = 0;
+    step_remainder_q16 = 0;
+  }
 }
 
 /// Gets the target position of the control rod, between 0 and 4_000_000
-uint32_t ControlRod::get_target_position() { return target_position; }
+template <typename Scalar>
+uint32_t BasicControlRod<Scalar>::get_target_position() {
+  return target_position;
+}
 
 /// Sets the target position of the control rod, between 0 and 4_000_000
-void ControlRod::set_target_position(uint32_t new_position) {
+template <typename Scalar>
+void BasicControlRod<Scalar>::set_target_position(uint32_t new_position) {
   target_position = std::clamp(new_position, (uint32_t)0, (uint32_t)4e6);
 }
 
 /// Gets the current position of the control rod, as a double between 0 and 1
 ///
 /// 1 is fully inside and 0 is fully outside
-double ControlRod::get_target_position_as_fraction() { return (double)target_position / (double)4e6; }
+template <typename Scalar>
+Scalar BasicControlRod<Scalar>::get_target_position_as_fraction() {
+  return Scalar((double)target_position / (double)4e6);
+}
 
-/// Gets the speed of the control rod, in a fraction per second
-uint32_t ControlRod::get_speed_steps_per_second() { return speed_per_second; }
+/// Fires a transient rod out of the core, see move_out_with_ejection
+template <typename Scalar>
+bool BasicControlRod<Scalar>::eject(const Motion &motion) {
+  if (!motion.ejectable || current_position == 0) {
+    return false;
+  }
 
-/// Sets the speed of the control rod, in a fraction per second
-void ControlRod::set_speed_steps_per_second(
-    uint32_t new_speed_frac_per_second) {
-  speed_per_second = new_speed_frac_per_second;
+  ejecting = true;
+  target_position = 0;
+  velocity_q16 = 0;
+  step_remainder_q16 = 0;
+  return true;
 }
 
-/// Slowly moves the rod towards the target, for a given delta_t time
-void ControlRod::move_towards_target(double delta_t_seconds) {
-  int64_t target_delta_position = (int64_t)target_position - (int64_t)current_position;
+/// Whether the rod is on its way out after eject()
+template <typename Scalar> bool BasicControlRod<Scalar>::get_ejecting() {
+  return ejecting;
+}
+
+/// The velocity is per time step, so it scales with it
+template <typename Scalar>
+void BasicControlRod<Scalar>::rescale_velocity(Scalar from_time_delta_seconds,
+                                               Scalar to_time_delta_seconds) {
+  if (velocity_q16 != 0 && from_time_delta_seconds > Scalar(0.0) &&
+      from_time_delta_seconds != to_time_delta_seconds) {
+    velocity_q16 = (int64_t)((double)velocity_q16 *
+                             (double)to_time_delta_seconds /
+                             (double)from_time_delta_seconds);
+  }
+}
+
+/// Works out the steps per time step once for a time step, so moving the rod
+/// is integer math only
+template <typename Scalar>
+typename BasicControlRod<Scalar>::Motion
+BasicControlRod<Scalar>::Motion::calculate(
+    uint32_t speed_per_second, uint32_t acceleration_per_second_squared,
+    uint32_t ejection_acceleration_per_second_squared,
+    Scalar time_delta_seconds) {
+  Motion motion;
+
+  // Velocities are 1/65536 steps per time step, so slow rods and short time
+  // steps still move at their speed. Any more than the whole rod is the whole
+  // rod. Not on the move path, so double is fine
+  double time_delta = (double)time_delta_seconds;
+  motion.max_velocity_q16 = (int64_t)std::min(
+      time_delta * (double)speed_per_second * 65536.0, 4e6 * 65536.0);
+  motion.acceleration_q16 = std::max(
+      (int64_t)std::min(time_delta * time_delta *
+                            (double)acceleration_per_second_squared * 65536.0,
+                        4e6 * 65536.0),
+      (int64_t)1);
+  motion.ejection_acceleration_q16 = (int64_t)std::min(
+      time_delta * time_delta *
+          (double)ejection_acceleration_per_second_squared * 65536.0,
+      4e6 * 65536.0);
+
+  // With the part of a step carried over, one time step can round up
+  motion.max_steps_per_time_delta =
+      (uint32_t)(((uint64_t)motion.max_velocity_q16 + 0xffff) >> 16);
 
-  int64_t max_delta_position =
-      (uint64_t)((double)delta_t_seconds * (double)speed_per_second);
+  motion.accelerating = acceleration_per_second_squared != 0;
+  motion.ejectable = ejection_acceleration_per_second_squared != 0;
 
-  int64_t delta_position = std::clamp(target_delta_position,
-                                       -max_delta_position, max_delta_position);
+  return motion;
+}
 
-  current_position = (uint32_t)((int64_t)current_position + delta_position);
+/// Moves the rod at most max_steps towards the target.
+///
+/// Never goes past the target, which is always between 0 and 4_000_000, so
+/// the position can't wrap around
+template <typename Scalar>
+void BasicControlRod<Scalar>::move_towards_target_by_at_most(
+    uint32_t max_steps) {
+  if (target_position > current_position) {
+    current_position += std::min(target_position - current_position, max_steps);
+  } else {
+    current_position -= std::min(current_position - target_position, max_steps);
+  }
+}
+
+/// Moves the rod by one time step, speeding up at the acceleration until it's
+/// at full speed, and slowing down in time to stop at the target
+template <typename Scalar>
+void BasicControlRod<Scalar>::move_towards_target_with_acceleration(
+    const Motion &motion) {
+  const int64_t acceleration_q16 = motion.acceleration_q16;
+  const int64_t max_velocity_q16 = motion.max_velocity_q16;
+
+  if (target_position == current_position) {
+    velocity_q16 = 0;
+    step_remainder_q16 = 0;
+    return;
+  }
+
+  int64_t direction = target_position > current_position ? 1 : -1;
+  uint64_t distance_q16 =
+      (uint64_t)(direction > 0 ? target_position - current_position
+                               : current_position - target_position)
+      << 16;
+
+  // Positive when moving towards the target
+  int64_t speed_q16 = velocity_q16 * direction;
+
+  if (speed_q16 <= 0) {
+    // Standing, or moving away because the target changed, so turn around
+    speed_q16 = acceleration_q16;
+  } else {
+    // Slowing down by a every time step covers v + (v - a) + ... which is
+    // about v^2 / 2a + v / 2
+    uint64_t speed_squared;
+    uint64_t braking_distance_q16 = UINT64_MAX;
+
+    if (!__builtin_mul_overflow((uint64_t)speed_q16, (uint64_t)speed_q16,
+                                &speed_squared)) {
+      braking_distance_q16 =
+          speed_squared / (2 * (uint64_t)acceleration_q16) +
+          (uint64_t)speed_q16 / 2;
+    }
+
+    if (braking_distance_q16 >= distance_q16) {
+      // Never stop short, keep creeping at the slowest speed
+      speed_q16 = std::max(speed_q16 - acceleration_q16, acceleration_q16);
+    } else {
+      speed_q16 = std::min(speed_q16 + acceleration_q16, max_velocity_q16);
+    }
+  }
+
+  speed_q16 = std::min(speed_q16, max_velocity_q16);
+  velocity_q16 = speed_q16 * direction;
+
+  // Whole steps to take now, the rest is kept for the next time step
+  uint64_t travel_q16 = (uint64_t)speed_q16 + step_remainder_q16;
+  uint64_t steps = travel_q16 >> 16;
+  step_remainder_q16 = travel_q16 & 0xffff;
+
+  if (steps >= (distance_q16 >> 16)) {
+    // Arrived, stop dead
+    current_position = target_position;
+    velocity_q16 = 0;
+    step_remainder_q16 = 0;
+    return;
+  }
+
+  move_towards_target_by_at_most((uint32_t)steps);
+}
+
+/// Moves the rod out by one time step, speeding up at the ejection
+/// acceleration with no top speed, until it's outside
+template <typename Scalar>
+void BasicControlRod<Scalar>::move_out_with_ejection(const Motion &motion) {
+  // Out is a negative velocity
+  velocity_q16 -= motion.ejection_acceleration_q16;
+
+  uint64_t travel_q16 = (uint64_t)(-velocity_q16) + step_remainder_q16;
+  uint64_t steps = travel_q16 >> 16;
+  step_remainder_q16 = travel_q16 & 0xffff;
+
+  if (steps >= current_position) {
+    current_position = 0;
+    ejecting = false;
+    velocity_q16 = 0;
+    step_remainder_q16 = 0;
+    return;
+  }
+
+  current_position -= (uint32_t)steps;
+}
+
+/// Slowly moves the rod towards the target by one time step of the motion
+template <typename Scalar>
+bool BasicControlRod<Scalar>::move_towards_target(const Motion &motion) {
+  bool was_moving = current_position != target_position;
+
+  if (ejecting) {
+    move_out_with_ejection(motion);
+  } else if (motion.accelerating) {
+    move_towards_target_with_acceleration(motion);
+  } else {
+    // Full speed, with the part of a step left over kept for the next time
+    // step, so the rod keeps its speed at any time step
+    uint64_t travel_q16 = (uint64_t)motion.max_velocity_q16 + step_remainder_q16;
+    step_remainder_q16 = travel_q16 & 0xffff;
+    move_towards_target_by_at_most((uint32_t)(travel_q16 >> 16));
+
+    if (current_position == target_position) {
+      step_remainder_q16 = 0;
+    }
+  }
+
+  return was_moving && current_position == target_position;
 }
 
 /// Calculates the normalized worth of the control rod at a given position
@@ -64,35 +261,252 @@ void ControlRod::move_towards_target(double delta_t_seconds) {
 ///
 /// 1 means the rod is contributing its full worth and 0 it is not contributing
 /// any of its worth
-double ControlRod::calculate_normalized_worth_at_position(double position) {
-  // TODO: Maybe use bezier at some point
-  // For now, just do it fully linearly
+template <typename Scalar>
+Scalar BasicControlRod<Scalar>::calculate_normalized_worth_at_position(
+    Scalar position) {
+  if (worth_curve != 0) {
+    // Positions are whole steps, so the curve is only looked up at them
+    Scalar clamped_position =
+        std::clamp(position, Scalar(0.0), Scalar(4e6));
+    return calculate_normalized_worth_from_curve((uint32_t)clamped_position);
+  }
+
+  // Without a worth curve, just do it fully linearly
   //
   // For a fully linear rod:
   // position 0.0 => worth 0.0
   // position 0.5 => worth 0.5
   // position 1.0 => worth 1.0
-  return (double)position / (double) 4e6;
+  return position / Scalar(4e6);
 }
 
 /// Calculates the normalized worth of the control rod at its current position.
 ///
 /// 1 means the rod is contributing its full worth and 0 it is not contributing
 /// any of its worth
-double ControlRod::calculate_normlized_worth() {
-  return calculate_normalized_worth_at_position(current_position);
+template <typename Scalar>
+Scalar BasicControlRod<Scalar>::calculate_normlized_worth() {
+  return calculate_normalized_worth_at_position(Scalar(current_position));
 }
 
 /// Calculates the worth of the control rod at a given position between 0 and 1,
 /// in pcm
 ///
 /// 1 is fully inside and 0 is fully outside
-double ControlRod::calculate_worth_at_position_pcm(double position) {
-  return calculate_normalized_worth_at_position(position) *
-         CONTROL_ROD_WORTH_PCM;
+template <typename Scalar>
+Scalar BasicControlRod<Scalar>::calculate_worth_at_position_pcm(
+    Scalar position) {
+  return calculate_normalized_worth_at_position(position) * full_worth_pcm;
 }
 
 /// Calculates the worth of the control rod at its current position, in pcm
-double ControlRod::calculate_worth_pcm() {
-  return calculate_worth_at_position_pcm(current_position);
+template <typename Scalar>
+Scalar BasicControlRod<Scalar>::calculate_worth_pcm() {
+  if (worth_curve != 0) {
+    return calculate_normalized_worth_from_curve(current_position) *
+           full_worth_pcm;
+  }
+
+  return calculate_worth_at_position_pcm(Scalar(current_position));
+}
+
+/// Normalized worth at a position, from the worth curve table
+///
+/// A division by a constant to find the segment and one multiply-add, so the
+/// same few operations whatever the curve
+template <typename Scalar>
+Scalar BasicControlRod<Scalar>::calculate_normalized_worth_from_curve(
+    uint32_t position) {
+  // Fully inside lands on the last point, whose slope is 0
+  uint32_t segment = position / POSITIONS_PER_WORTH_CURVE_SEGMENT;
+  uint32_t position_in_segment =
+      position - segment * POSITIONS_PER_WORTH_CURVE_SEGMENT;
+
+  const WorthCurvePoint &point = worth_curves[worth_curve - 1][segment];
+
+  return point.worth + point.slope_per_position * Scalar(position_in_segment);
+}
+
+template <typename Scalar>
+std::array<typename BasicControlRod<Scalar>::WorthCurvePoints,
+           BasicControlRod<Scalar>::MAX_WORTH_CURVES>
+    BasicControlRod<Scalar>::worth_curves = {};
+
+template <typename Scalar>
+uint8_t BasicControlRod<Scalar>::worth_curves_loaded = 0;
+
+/// Uses the table of the same curve if one is loaded, or loads it into the
+/// next free one
+///
+/// The slopes are worked out from the worths in Scalar, so the same worths
+/// always make the same table
+template <typename Scalar>
+bool BasicControlRod<Scalar>::set_worth_curve_table(const WorthCurve &curve) {
+  WorthCurvePoints points;
+
+  for (uint32_t i = 0; i <= WORTH_CURVE_SEGMENTS; i++) {
+    double slope_per_position = 0.0;
+
+    if (i < WORTH_CURVE_SEGMENTS) {
+      slope_per_position = ((double)curve[i + 1] - (double)curve[i]) /
+                           (double)POSITIONS_PER_WORTH_CURVE_SEGMENT;
+    }
+
+    points[i] = {curve[i], Scalar(slope_per_position)};
+  }
+
+  uint8_t curve_index = 0;
+
+  // Compared as bytes, the points are plain numbers with no padding
+  while (curve_index < worth_curves_loaded &&
+         memcmp(&worth_curves[curve_index], &points, sizeof(points)) != 0) {
+    curve_index++;
+  }
+
+  if (curve_index == MAX_WORTH_CURVES) {
+    return false;
+  }
+
+  if (curve_index == worth_curves_loaded) {
+    worth_curves[curve_index] = points;
+    worth_curves_loaded += 1;
+  }
+
+  // The same curve is the same worth, so cached worths stay valid
+  if (worth_curve != curve_index + 1) {
+    worth_curve = curve_index + 1;
+    worth_curve_revision += 1;
+  }
+
+  return true;
+}
+
+template <typename Scalar>
+bool BasicControlRod<Scalar>::get_worth_curve(WorthCurve &curve) {
+  if (worth_curve == 0) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i <= WORTH_CURVE_SEGMENTS; i++) {
+    curve[i] = worth_curves[worth_curve - 1][i].worth;
+  }
+
+  return true;
+}
+
+template <typename Scalar>
+bool BasicControlRod<Scalar>::set_worth_curve_from_doubles(
+    const std::array<double, WORTH_CURVE_SEGMENTS + 1> &normalized_worths) {
+  WorthCurve curve;
+
+  for (uint32_t i = 0; i <= WORTH_CURVE_SEGMENTS; i++) {
+    curve[i] = Scalar(normalized_worths[i]);
+  }
+
+  return set_worth_curve_table(curve);
 }
+
+/// Loads an integral worth curve shaped like a cubic bezier from (0, 0) to
+/// (1, 1), with control points (parameter_0, 0) and (parameter_1, 1)
+///
+/// The bezier is only evaluated here, once for every point of the table
+template <typename Scalar>
+bool BasicControlRod<Scalar>::set_worth_curve_bezier(double parameter_0,
+                                                     double parameter_1) {
+  // Between 0 and 1, with parameter_0 <= parameter_1 the position always
+  // grows along the curve
+  parameter_0 = std::clamp(parameter_0, 0.0, 1.0);
+  parameter_1 = std::clamp(parameter_1, parameter_0, 1.0);
+
+  auto calculate_position = [&](double t) {
+    return 3.0 * (1.0 - t) * (1.0 - t) * t * parameter_0 +
+           3.0 * (1.0 - t) * t * t * parameter_1 + t * t * t;
+  };
+
+  std::array<double, WORTH_CURVE_SEGMENTS + 1> normalized_worths;
+
+  for (uint32_t i = 0; i <= WORTH_CURVE_SEGMENTS; i++) {
+    double position = (double)i / (double)WORTH_CURVE_SEGMENTS;
+
+    // Find the curve parameter at the position by bisection
+    double t_low = 0.0;
+    double t_high = 1.0;
+
+    for (uint8_t iteration = 0; iteration < 60; iteration++) {
+      double t_middle = 0.5 * (t_low + t_high);
+
+      if (calculate_position(t_middle) < position) {
+        t_low = t_middle;
+      } else {
+        t_high = t_middle;
+      }
+    }
+
+    double t = 0.5 * (t_low + t_high);
+    normalized_worths[i] = 3.0 * (1.0 - t) * t * t + t * t * t;
+  }
+
+  return set_worth_curve_from_doubles(normalized_worths);
+}
+
+/// Loads an integral worth curve from calibration data, the normalized worths
+/// at count evenly spaced positions from fully outside to fully inside
+///
+/// The data is resampled to the table with linear interpolation
+template <typename Scalar>
+bool BasicControlRod<Scalar>::set_worth_curve(const double *normalized_worths,
+                                              size_t count) {
+  if (count < 2) {
+    set_worth_curve_linear();
+    return true;
+  }
+
+  std::array<double, WORTH_CURVE_SEGMENTS + 1> resampled_worths;
+
+  for (uint32_t i = 0; i <= WORTH_CURVE_SEGMENTS; i++) {
+    double sample_position =
+        (double)i / (double)WORTH_CURVE_SEGMENTS * (double)(count - 1);
+    size_t sample = std::min((size_t)sample_position, count - 2);
+    double fraction = sample_position - (double)sample;
+
+    resampled_worths[i] =
+        normalized_worths[sample] +
+        (normalized_worths[sample + 1] - normalized_worths[sample]) * fraction;
+  }
+
+  return set_worth_curve_from_doubles(resampled_worths);
+}
+
+template <typename Scalar>
+Scalar BasicControlRod<Scalar>::get_full_worth_pcm() {
+  return full_worth_pcm;
+}
+
+/// Sets the worth of the rod when fully inserted, the worth curve is
+/// normalized so it scales with it
+template <typename Scalar>
+void BasicControlRod<Scalar>::set_full_worth_pcm(Scalar new_worth_pcm) {
+  full_worth_pcm = new_worth_pcm;
+  worth_curve_revision += 1;
+}
+
+/// Goes back to the linear worth
+template <typename Scalar>
+void BasicControlRod<Scalar>::set_worth_curve_linear() {
+  worth_curve = 0;
+  worth_curve_revision += 1;
+}
+
+template <typename Scalar>
+bool BasicControlRod<Scalar>::get_worth_curve_loaded() {
+  return worth_curve != 0;
+}
+
+template <typename Scalar>
+uint32_t BasicControlRod<Scalar>::get_worth_curve_revision() {
+  return worth_curve_revision;
+}
+
+template class BasicControlRod<double>;
+template class BasicControlRod<float>;
+template class BasicControlRod<Q32_32>;
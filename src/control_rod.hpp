@@ -2,15 +2,32 @@
 #define CONTROL_ROD_HPP
 
 //#include "pico/stdlib.h"
+#include "constants.hpp"
+#include <array>
+#include <stddef.h>
 #include <stdint.h>
 
-class ControlRod {
+/// A control rod, with its worth calculated in Scalar (double, float or
+/// fixed point). See ControlRod for the double one
+template <typename Scalar> class BasicControlRod {
 	public:
 
-		ControlRod();
+		/// Segments of the worth curve table, each POSITIONS_PER_WORTH_CURVE_SEGMENT
+		/// positions long
+		static constexpr uint32_t WORTH_CURVE_SEGMENTS = 256;
+		static constexpr uint32_t POSITIONS_PER_WORTH_CURVE_SEGMENT = 4000000 / WORTH_CURVE_SEGMENTS;
+		/// Different worth curves loaded at once, by all the rods of this Scalar together.
+		/// The rods only keep which one they use, rods with the same curve share it
+		static constexpr uint8_t MAX_WORTH_CURVES = 4;
+
+		/// A worth curve, as the normalized worths at every POSITIONS_PER_WORTH_CURVE_SEGMENT
+		/// positions from fully outside to fully inside
+		using WorthCurve = std::array<Scalar, WORTH_CURVE_SEGMENTS + 1>;
+
+		BasicControlRod();
 
 		/// Creates a control rod with a starting position
-		ControlRod(uint32_t position);
+		BasicControlRod(uint32_t position);
 
 		/// Gets the current position of the control rod, between 0 and 4_000_000
 		///
@@ -20,7 +37,7 @@ class ControlRod {
 		/// Gets the current position of the control rod, as a double between 0 and 1
 		///
 		/// 1 is fully inside and 0 is fully outside
-		double get_current_position_as_fraction();
+		Scalar get_current_position_as_fraction();
 
 		/// Sets the current position of the control rod, between 0 and 4_000_000
 		///
@@ -35,60 +52,164 @@ class ControlRod {
 		/// Gets the target position of the control rod, as a double between 0 and 1
 		///
 		/// 1 is fully inside and 0 is fully outside
-		double get_target_position_as_fraction();
+		Scalar get_target_position_as_fraction();
 
 		/// Sets the target position of the control rod, between 0 and 4_000_000
 		///
 		/// 4_000_000 is fully inside and 0 is fully outside
 		void set_target_position(uint32_t new_position);
 
-		/// Gets the speed of the control rod, in steps per second
-		uint32_t get_speed_steps_per_second();
+		/// How far a rod moves in one time step, worked out from its speed, acceleration
+		/// and ejection acceleration so moving it is integer math only. Kept apart from
+		/// the rod, with the rest of the parameters, and passed in
+		struct Motion {
+			/// How many steps the rod moves at most in one time step, at full speed
+			uint32_t max_steps_per_time_delta;
+			// Speeds and acceleration profile, all in 1/65536 steps and per time step
+			int64_t max_velocity_q16;
+			int64_t acceleration_q16;
+			int64_t ejection_acceleration_q16;
+			/// Whether the rod has an acceleration profile, rather than moving at full
+			/// speed straight away and stopping dead at the target
+			bool accelerating;
+			/// Whether the rod is a transient rod, which eject() fires out of the core
+			bool ejectable;
+
+			/// Works out the motion for a time step from the speed in steps per second,
+			/// and the acceleration and the ejection acceleration in steps per second
+			/// squared. 0 moves at full speed straight away, and makes an ordinary rod
+			/// that can't be ejected
+			static Motion calculate(uint32_t speed_per_second,
+			                        uint32_t acceleration_per_second_squared,
+			                        uint32_t ejection_acceleration_per_second_squared,
+			                        Scalar time_delta_seconds);
+		};
+
+		/// Ejects a transient rod. It speeds up at the ejection acceleration until it's
+		/// fully outside, whatever its speed and target, and the target is left outside.
+		/// Setting the current position stops it
+		///
+		/// False, and nothing happens, for an ordinary rod or one that's already outside
+		bool eject(const Motion &motion);
 
-		/// Sets the speed of the control rod, in steps per second
-		void set_speed_steps_per_second(uint32_t new_speed);
+		/// Whether the rod is being ejected
+		bool get_ejecting();
 
-		/// Slowly moves the rod towards the target
-		void move_towards_target(double delta_t_seconds);
+		/// Keeps the rod at its speed when the time step it's moved by changes, the
+		/// velocity is per time step
+		void rescale_velocity(Scalar from_time_delta_seconds, Scalar to_time_delta_seconds);
+
+		/// Slowly moves the rod towards the target by one time step of the motion, in
+		/// integer math only.
+		///
+		/// Returns whether this move got the rod to its target
+		bool move_towards_target(const Motion &motion);
 
 		/// Calculates the normalized worth of the control rod at a given position between 0 and 1.
 		///
 		/// 1 means the rod is contributing its full worth and 0 it is not contributing any of its worth
-		double calculate_normalized_worth_at_position(double position);
+		Scalar calculate_normalized_worth_at_position(Scalar position);
 
 		/// Calculates the normalized worth of the control rod at its current position.
 		///
 		/// 1 means the rod is contributing its full worth and 0 it is not contributing any of its worth
-		double calculate_normlized_worth();
+		Scalar calculate_normlized_worth();
 
 		/// Calculates the worth of the control rod at a given position between 0 and 1,
 		/// in pcm
 		///
 		/// 1 is fully inside and 0 is fully outside
-		double calculate_worth_at_position_pcm(double position);
+		Scalar calculate_worth_at_position_pcm(Scalar position);
 
 		/// Calculates the worth of the control rod at its current position, in pcm
-		double calculate_worth_pcm();
+		Scalar calculate_worth_pcm();
+
+		/// Sets the worth of the rod when fully inserted, in pcm. The worth curve, if
+		/// any, is scaled to it
+		void set_full_worth_pcm(Scalar new_worth_pcm);
+		Scalar get_full_worth_pcm();
+
+		/// Loads an integral worth curve shaped like a cubic bezier from (0, 0) to (1, 1),
+		/// with control points (parameter_0, 0) and (parameter_1, 1)
+		///
+		/// See figure 22 in https://www.sciencedirect.com/science/article/pii/S0306454920303285#t0005
+		///
+		/// 0.57 and 0.68 follow the calibration of the pulsing rod, 0.0 and 1.0 is linear.
+		/// False, and the rod keeps its worth, if MAX_WORTH_CURVES other curves are loaded
+		bool set_worth_curve_bezier(double parameter_0, double parameter_1);
+
+		/// Loads an integral worth curve from calibration data, the normalized worths at
+		/// count evenly spaced positions from fully outside to fully inside. False like
+		/// set_worth_curve_bezier
+		bool set_worth_curve(const double *normalized_worths, size_t count);
+
+		/// Loads a worth curve from get_worth_curve, of this rod or another. False like
+		/// set_worth_curve_bezier
+		bool set_worth_curve_table(const WorthCurve &curve);
+
+		/// Gets the worth curve the rod uses, false for the linear worth
+		bool get_worth_curve(WorthCurve &curve);
+
+		/// Goes back to the linear worth
+		void set_worth_curve_linear();
+
+		/// Whether a worth curve is loaded, rather than the linear worth
+		bool get_worth_curve_loaded();
+
+		/// Counts the changes to the worth curve and the full worth, so a cached worth
+		/// can tell the curve changed
+		uint32_t get_worth_curve_revision();
 
 	protected:
 
+		/// Moves the rod at most max_steps towards the target, never past it
+		void move_towards_target_by_at_most(uint32_t max_steps);
+
+		/// Moves the rod by one time step of the acceleration profile
+		void move_towards_target_with_acceleration(const Motion &motion);
+
+		/// Moves the rod by one time step of an ejection
+		void move_out_with_ejection(const Motion &motion);
+
+		/// A point of a worth curve table, normalized, with the slope to the next point
+		struct WorthCurvePoint {
+			Scalar worth;
+			Scalar slope_per_position;
+		};
+		using WorthCurvePoints = std::array<WorthCurvePoint, WORTH_CURVE_SEGMENTS + 1>;
+
+		/// Normalized worth at a position, from the worth curve table
+		Scalar calculate_normalized_worth_from_curve(uint32_t position);
+
+		/// Same as set_worth_curve_table, from normalized worths in double
+		bool set_worth_curve_from_doubles(const std::array<double, WORTH_CURVE_SEGMENTS + 1> &normalized_worths);
+
+		/// The worth curve tables of every rod of this Scalar, the first worth_curves_loaded
+		/// of them in use. Never unloaded, so a curve stays where it is for as long as
+		/// the program runs
+		static std::array<WorthCurvePoints, MAX_WORTH_CURVES> worth_curves;
+		static uint8_t worth_curves_loaded;
+
 		/// Between 0 and 4000000, 4000000 is fully inside and 0 is fully outside
 		uint32_t current_position = 0;
 
 	   /// Between 0 and 4000000, 4000000 is fully inside and 0 is fully outside
 		uint32_t target_position = 0;
 
-		// Steps of the total position per second
-		// We want 15/1000, so 15 * 4000000/1000 = 15 * 4000
-		uint32_t speed_per_second = 15 * 4000;
+		/// Positive when moving in, in 1/65536 steps per time step like Motion
+		int64_t velocity_q16 = 0;
+		/// Part of a step moved but not taken yet
+		uint64_t step_remainder_q16 = 0;
+		bool ejecting = false;
 
-		// Ignore this for now, TODO: use bezier instead of fully linear rods
-		/// See figure 22 in https://www.sciencedirect.com/science/article/pii/S0306454920303285#t0005
-		///
-		/// 0 = 0.57 and 1 = 0.68 would follow the calibration of the pulsing rod
-		///
-		/// 0 = 0.0 and 1 = 1.0 is a linear calibration curve
-		//double bezier_parameter_0 = 0.0;
-		//double bezier_parameter_1 = 1.0;
+		/// Worth when fully inserted
+		Scalar full_worth_pcm = CONTROL_ROD_WORTH_PCM;
+
+		/// Which of worth_curves the rod uses, plus 1, or 0 for the linear worth. Only
+		/// means something in the program that loaded the curve, see get_worth_curve
+		uint8_t worth_curve = 0;
+		uint32_t worth_curve_revision = 0;
 };
+
+using ControlRod = BasicControlRod<double>;
 #endif
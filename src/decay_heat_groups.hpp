@@ -0,0 +1,134 @@
+#ifndef DECAY_HEAT_GROUPS_HPP
+#define DECAY_HEAT_GROUPS_HPP
+
+#include <array>
+#include <cmath>
+#include <stdint.h>
+
+/// The constants of the fission products' decay energy, in groups that each
+/// decay exponentially.
+///
+/// Each group holds the energy its fission products have yet to give off,
+/// Ei, fed by the fission power and given off at lambda_i:
+///
+///   dEi/dt = f_i * P - lambda_i * Ei,  decay heat = sum of lambda_i * Ei
+///
+/// where f_i = alpha_i / lambda_i / Q is the part of the fission energy Q that
+/// group holds back. The groups are only moved forward every few ms, over
+/// which the fission power is held at its average, so they're solved exactly
+/// with exponentials cached for the interval, see
+/// DecayHeatIntervalExponentials. Every loop is over arrays of GROUPS doubles,
+/// with a fixed trip count the compiler can vectorize
+template <uint8_t GROUPS> struct DecayHeatGroupConstants {
+  /// f_i, the part of the fission energy each group holds back
+  std::array<double, GROUPS> fractions;
+  /// lambda_i, in 1/s
+  std::array<double, GROUPS> decay_constants;
+
+  /// Works out the constants from the decay power of each group right after
+  /// a fission (alpha_i, in MeV per second) and its decay constant (lambda_i,
+  /// in 1/s), for the energy released by a fission
+  static constexpr DecayHeatGroupConstants
+  calculate(const std::array<double, GROUPS> &powers_MeV_per_second,
+            const std::array<double, GROUPS> &decay_constants_per_second,
+            double fission_energy_released_MeV) {
+    DecayHeatGroupConstants constants = {};
+    constants.decay_constants = decay_constants_per_second;
+
+    for (uint8_t i = 0; i < GROUPS; i++) {
+      constants.fractions[i] = powers_MeV_per_second[i] /
+                               decay_constants_per_second[i] /
+                               fission_energy_released_MeV;
+    }
+
+    return constants;
+  }
+};
+
+/// The exponentials of the interval the groups were last moved forward by.
+///
+/// Kept apart from the energies, and only worked out again when the interval
+/// changes. The same interval always gives the same exponentials, whatever
+/// was cached before
+template <uint8_t GROUPS> struct DecayHeatIntervalExponentials {
+  using Constants = DecayHeatGroupConstants<GROUPS>;
+
+  /// The interval they're for, 0 before they're first worked out
+  double interval_seconds = 0.0;
+  std::array<double, GROUPS> decay_factors;
+  std::array<double, GROUPS> source_weights;
+
+  /// Recalculates the exponentials of an interval, unless they're for it
+  /// already
+  void set_interval_seconds(double new_interval_seconds,
+                            const Constants &constants) {
+    if (new_interval_seconds == interval_seconds) {
+      return;
+    }
+
+    interval_seconds = new_interval_seconds;
+
+    for (uint8_t i = 0; i < GROUPS; i++) {
+      double decay_constant = constants.decay_constants[i];
+      double decay_per_interval = decay_constant * interval_seconds;
+
+      // Ei(t + h) = Ei(t) * e^(-lambda h) + f_i * P * (1 - e^(-lambda h)) /
+      // lambda
+      decay_factors[i] = std::exp(-decay_per_interval);
+      source_weights[i] = constants.fractions[i] *
+                          -std::expm1(-decay_per_interval) / decay_constant;
+    }
+  }
+
+  /// Drops the exponentials, for when the constants changed
+  void clear() { interval_seconds = 0.0; }
+};
+
+/// The energies of the groups. The constants and the exponentials of the
+/// interval are kept apart, with the rest of the parameters, and are passed in
+template <uint8_t GROUPS> class DecayHeatGroups {
+public:
+  using Constants = DecayHeatGroupConstants<GROUPS>;
+  using IntervalExponentials = DecayHeatIntervalExponentials<GROUPS>;
+
+  static constexpr uint8_t get_group_count() { return GROUPS; }
+
+  /// Gets the energy a group has yet to give off, between 0 and GROUPS - 1
+  double get_energy_J(uint8_t i) { return energies_J[i]; }
+  void set_energy_J(uint8_t i, double energy_J) { energies_J[i] = energy_J; }
+
+  /// Sets every group to what a long run at a power builds up
+  void set_at_equilibrium(double power_watts, const Constants &constants) {
+    for (uint8_t i = 0; i < GROUPS; i++) {
+      energies_J[i] =
+          constants.fractions[i] * power_watts / constants.decay_constants[i];
+    }
+  }
+
+  /// Calculates the decay heat, the sum of lambda_i * Ei
+  double calculate_decay_heat_watts(const Constants &constants) {
+    double decay_heat_watts = 0.0;
+
+    for (uint8_t i = 0; i < GROUPS; i++) {
+      decay_heat_watts += constants.decay_constants[i] * energies_J[i];
+    }
+
+    return decay_heat_watts;
+  }
+
+  /// Moves all groups forward by one interval with the exact solution of
+  /// their equations, holding the fission power at its average over it.
+  ///
+  /// Needs the exponentials to have been worked out for the interval
+  void integrate_exponential(double average_power_watts,
+                             const IntervalExponentials &exponentials) {
+    for (uint8_t i = 0; i < GROUPS; i++) {
+      energies_J[i] = exponentials.decay_factors[i] * energies_J[i] +
+                      exponentials.source_weights[i] * average_power_watts;
+    }
+  }
+
+protected:
+  std::array<double, GROUPS> energies_J = {};
+};
+#endif
@@ -0,0 +1,183 @@
+#ifndef FIXED_POINT_HPP
+#define FIXED_POINT_HPP
+
+#include <cmath>
+#include <stdint.h>
+#include <type_traits>
+
+/// Signed Q-format fixed point number, stored in 64 bits with FRACTION_BITS
+/// bits after the point.
+///
+/// Converts implicitly from double, so constants can be mixed in freely (and
+/// are folded at compile time), but only explicitly back to other types.
+/// Conversions, multiplications and divisions are rounded to the nearest
+/// value, halves away from zero. Rounding in one direction would drift over
+/// millions of ticks
+template <uint8_t FRACTION_BITS> class FixedPoint {
+public:
+  static_assert(FRACTION_BITS > 0 && FRACTION_BITS < 63);
+
+  static constexpr double ONE = (double)((int64_t)1 << FRACTION_BITS);
+
+  constexpr FixedPoint() = default;
+  constexpr FixedPoint(double value) : raw(round_to_raw(value * ONE)) {}
+  constexpr FixedPoint(float value) : raw(round_to_raw((double)value * ONE)) {}
+  constexpr FixedPoint(int value) : raw((int64_t)value << FRACTION_BITS) {}
+  constexpr FixedPoint(int64_t value) : raw(value << FRACTION_BITS) {}
+  constexpr FixedPoint(uint32_t value)
+      : raw((int64_t)value << FRACTION_BITS) {}
+  constexpr FixedPoint(uint64_t value)
+      : raw((int64_t)value << FRACTION_BITS) {}
+
+  /// Creates a number from its raw 64 bit representation
+  static constexpr FixedPoint from_raw(int64_t raw) {
+    FixedPoint result;
+    result.raw = raw;
+    return result;
+  }
+
+  constexpr int64_t get_raw() const { return raw; }
+
+  template <typename T> constexpr explicit operator T() const {
+    static_assert(std::is_arithmetic_v<T>);
+
+    if constexpr (std::is_floating_point_v<T>) {
+      return (T)((double)raw / ONE);
+    } else {
+      // Towards zero, like converting a double
+      return (T)(raw >= 0 ? raw >> FRACTION_BITS
+                          : -((-raw) >> FRACTION_BITS));
+    }
+  }
+
+  friend constexpr FixedPoint operator+(FixedPoint a, FixedPoint b) {
+    return from_raw(a.raw + b.raw);
+  }
+  friend constexpr FixedPoint operator-(FixedPoint a, FixedPoint b) {
+    return from_raw(a.raw - b.raw);
+  }
+  friend constexpr FixedPoint operator-(FixedPoint a) {
+    return from_raw(-a.raw);
+  }
+  friend constexpr FixedPoint operator*(FixedPoint a, FixedPoint b) {
+    return from_raw(multiply_raw(a.raw, b.raw));
+  }
+  friend constexpr FixedPoint operator/(FixedPoint a, FixedPoint b) {
+    return from_raw(divide_raw(a.raw, b.raw));
+  }
+
+  FixedPoint &operator+=(FixedPoint other) { return *this = *this + other; }
+  FixedPoint &operator-=(FixedPoint other) { return *this = *this - other; }
+  FixedPoint &operator*=(FixedPoint other) { return *this = *this * other; }
+  FixedPoint &operator/=(FixedPoint other) { return *this = *this / other; }
+
+  friend constexpr bool operator==(FixedPoint a, FixedPoint b) {
+    return a.raw == b.raw;
+  }
+  friend constexpr bool operator!=(FixedPoint a, FixedPoint b) {
+    return a.raw != b.raw;
+  }
+  friend constexpr bool operator<(FixedPoint a, FixedPoint b) {
+    return a.raw < b.raw;
+  }
+  friend constexpr bool operator<=(FixedPoint a, FixedPoint b) {
+    return a.raw <= b.raw;
+  }
+  friend constexpr bool operator>(FixedPoint a, FixedPoint b) {
+    return a.raw > b.raw;
+  }
+  friend constexpr bool operator>=(FixedPoint a, FixedPoint b) {
+    return a.raw >= b.raw;
+  }
+
+protected:
+  static constexpr int64_t round_to_raw(double value) {
+    return (int64_t)(value >= 0.0 ? value + 0.5 : value - 0.5);
+  }
+
+  /// (a * b) >> FRACTION_BITS, with a 128 bit intermediate
+  static constexpr int64_t multiply_raw(int64_t a, int64_t b) {
+    bool negative = (a < 0) != (b < 0);
+    uint64_t a_magnitude = a < 0 ? -(uint64_t)a : (uint64_t)a;
+    uint64_t b_magnitude = b < 0 ? -(uint64_t)b : (uint64_t)b;
+    uint64_t half = (uint64_t)1 << (FRACTION_BITS - 1);
+
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 product =
+        (unsigned __int128)a_magnitude * (unsigned __int128)b_magnitude;
+    uint64_t magnitude = (uint64_t)((product + half) >> FRACTION_BITS);
+#else
+    // No 128 bit integers on 32 bit targets, so multiply the 32 bit halves
+    uint64_t a_high = a_magnitude >> 32, a_low = a_magnitude & 0xffffffff;
+    uint64_t b_high = b_magnitude >> 32, b_low = b_magnitude & 0xffffffff;
+
+    uint64_t low = a_low * b_low;
+    uint64_t middle_1 = a_high * b_low;
+    uint64_t middle_2 = a_low * b_high;
+    uint64_t high = a_high * b_high;
+
+    uint64_t middle = (low >> 32) + (middle_1 & 0xffffffff) +
+                      (middle_2 & 0xffffffff);
+    uint64_t result_low = (middle << 32) | (low & 0xffffffff);
+    uint64_t result_high =
+        high + (middle_1 >> 32) + (middle_2 >> 32) + (middle >> 32);
+
+    uint64_t rounded_low = result_low + half;
+    result_high += rounded_low < result_low ? 1 : 0;
+
+    uint64_t magnitude = (rounded_low >> FRACTION_BITS) |
+                         (result_high << (64 - FRACTION_BITS));
+#endif
+
+    return negative ? -(int64_t)magnitude : (int64_t)magnitude;
+  }
+
+  /// (a << FRACTION_BITS) / b, with a 128 bit intermediate
+  static constexpr int64_t divide_raw(int64_t a, int64_t b) {
+    bool negative = (a < 0) != (b < 0);
+    uint64_t a_magnitude = a < 0 ? -(uint64_t)a : (uint64_t)a;
+    uint64_t b_magnitude = b < 0 ? -(uint64_t)b : (uint64_t)b;
+
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 numerator = (unsigned __int128)a_magnitude
+                                  << FRACTION_BITS;
+    uint64_t quotient = (uint64_t)(numerator / b_magnitude);
+    uint64_t remainder = (uint64_t)(numerator % b_magnitude);
+#else
+    // Long division, one bit of the fraction at a time
+    uint64_t quotient = a_magnitude / b_magnitude;
+    uint64_t remainder = a_magnitude % b_magnitude;
+
+    for (uint8_t i = 0; i < FRACTION_BITS; i++) {
+      bool carry = remainder >> 63;
+      remainder <<= 1;
+      quotient <<= 1;
+
+      if (carry || remainder >= b_magnitude) {
+        remainder -= b_magnitude;
+        quotient |= 1;
+      }
+    }
+#endif
+
+    // Round to nearest, remainder >= b / 2 without overflowing
+    if (remainder >= b_magnitude - remainder) {
+      quotient += 1;
+    }
+
+    return negative ? -(int64_t)quotient : (int64_t)quotient;
+  }
+
+  int64_t raw = 0;
+};
+
+/// Absolute value, found by argument dependent lookup from code written for
+/// any scalar type
+template <uint8_t FRACTION_BITS>
+constexpr FixedPoint<FRACTION_BITS> abs(FixedPoint<FRACTION_BITS> x) {
+  return x < FixedPoint<FRACTION_BITS>(0) ? -x : x;
+}
+
+/// 31 integer bits (about +-2.1e9) and a resolution of about 2.3e-10
+using Q32_32 = FixedPoint<32>;
+#endif
@@ -0,0 +1,302 @@
+#ifndef FUEL_ELEMENT_TEMPERATURES_HPP
+#define FUEL_ELEMENT_TEMPERATURES_HPP
+
+#include "constants.hpp"
+#include "vectorizable_math.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stddef.h>
+#include <stdint.h>
+
+/// The fuel constants of the whole core the nodes are updated with, P_fe_stat
+/// in its Cardano form and the heat capacity as c0 + c1 * T, see
+/// BasicReactor::Coefficients
+struct FuelNodeCoefficients {
+  double cardano_first;
+  double cardano_second_constant;
+  double cardano_second_per_K;
+  double cardano_result_scale;
+  double temperature_fe_stat_a1;
+  double capacity_J_per_K_c0;
+  double capacity_J_per_K_c1;
+};
+
+/// Temperatures of every fuel element, split into AXIAL_NODES nodes along its
+/// length, each heated by its share of the power.
+///
+/// Every node is a small lumped fuel model of its own, with 1 / nodes of the
+/// core's heat capacity and of its P_fe_stat to the water. With equal shares
+/// every node follows the lumped fuel temperature, the shares are what tell
+/// them apart, see FUEL_ELEMENT_RADIAL_EXTRAPOLATION_RINGS.
+///
+/// There's room for MAX_ELEMENTS elements, and the core has as many of them
+/// as set_geometry was given, the power map is worked out for those and the
+/// length of their fuel.
+///
+/// The nodes are kept as arrays padded to a whole number of LANES, and the
+/// update is a loop without branches over them, so the compiler vectorizes it
+/// (with -fno-math-errno for the square root, see build-benchmark.sh). The
+/// padding nodes get no heat and are left out of the hottest and the average
+template <size_t MAX_ELEMENTS, uint8_t AXIAL_NODES>
+class FuelElementTemperatures {
+public:
+  static constexpr size_t MAX_NODES = MAX_ELEMENTS * AXIAL_NODES;
+  /// Doubles in a vector register with AVX2. The reductions keep a partial
+  /// result for each, so they vectorize without reordering any sums
+  static constexpr size_t LANES = 4;
+  static constexpr size_t MAX_PADDED_NODES =
+      (MAX_NODES + LANES - 1) / LANES * LANES;
+
+  /// Creates nodes at 20 C for MAX_ELEMENTS elements of FUEL_ELEMENT_LENGTH_CM
+  FuelElementTemperatures() {
+    set_geometry(MAX_ELEMENTS, FUEL_ELEMENT_LENGTH_CM);
+  }
+
+  /// Sets how many elements the core has, at most MAX_ELEMENTS, and how long
+  /// their fuel is, and gives the nodes the shares of the estimated power map
+  /// for them. The nodes start again from 20 C
+  void set_geometry(size_t elements, double element_length_cm) {
+    elements = std::min(elements, MAX_ELEMENTS);
+    node_count = elements * AXIAL_NODES;
+    padded_node_count = (node_count + LANES - 1) / LANES * LANES;
+
+    std::array<double, MAX_ELEMENTS> radial =
+        calculate_radial_peaking_factors(elements);
+    std::array<double, AXIAL_NODES> axial =
+        calculate_axial_peaking_factors(element_length_cm);
+    std::array<double, MAX_NODES> shares = {};
+
+    for (size_t element = 0; element < elements; element++) {
+      for (size_t axial_node = 0; axial_node < AXIAL_NODES; axial_node++) {
+        shares[element * AXIAL_NODES + axial_node] =
+            radial[element] * axial[axial_node];
+      }
+    }
+
+    power_shares.fill(0.0);
+    set_power_shares(shares);
+
+    hottest_offsets_celcius.fill(0.0);
+
+    for (size_t node = node_count; node < MAX_PADDED_NODES; node++) {
+      hottest_offsets_celcius[node] = -1e300;
+    }
+
+    set_temperatures_celcius(20.0);
+  }
+
+  /// Gets how many nodes there are for the elements of set_geometry
+  size_t get_node_count() { return node_count; }
+
+  /// Sets the share of the heat of each of the get_node_count nodes, scaled
+  /// to add up to 1. Node element * AXIAL_NODES + axial_node, the axial nodes
+  /// from the bottom up
+  void set_power_shares(const std::array<double, MAX_NODES> &shares) {
+    double share_sum = 0.0;
+
+    for (size_t node = 0; node < node_count; node++) {
+      share_sum += shares[node];
+    }
+
+    for (size_t node = 0; node < node_count; node++) {
+      power_shares[node] = shares[node] / share_sum;
+    }
+  }
+  double get_power_share(size_t node) { return power_shares[node]; }
+
+  /// Gets the temperature of a node, between 0 and get_node_count() - 1
+  double get_temperature_celcius(size_t node) { return temperatures[node]; }
+  /// Sets the temperature of a node. update_summary has to be called once
+  /// they're all set
+  void set_temperature_celcius(size_t node, double temperature_celcius) {
+    temperatures[node] = temperature_celcius;
+  }
+  /// Sets every node to the same temperature
+  void set_temperatures_celcius(double temperature_celcius) {
+    temperatures.fill(temperature_celcius);
+    update_summary();
+  }
+
+  /// Gets the hottest node, as of the last update
+  double get_hottest_temperature_celcius() {
+    return hottest_temperature_celcius;
+  }
+  /// Gets the average of the nodes weighted by their share of the power, as
+  /// of the last update
+  double get_average_temperature_celcius() {
+    return average_temperature_celcius;
+  }
+
+  /// Moves every node forward by seconds, in which the core was given heat_J
+  /// and the water was at a temperature. The same forward euler step as the
+  /// lumped fuel temperature takes, for each node:
+  ///
+  ///   T += (heat_J * share - P_fe_stat(T) / nodes * seconds) / (Cp(T) / nodes)
+  void integrate(double heat_J, double seconds,
+                 double water_temperature_celcius,
+                 const FuelNodeCoefficients &coefficients) {
+    // In locals, so the loop doesn't read them through a reference the
+    // temperatures could alias
+    double first = coefficients.cardano_first;
+    double second_constant = coefficients.cardano_second_constant;
+    double second_per_K = coefficients.cardano_second_per_K;
+    double a1 = coefficients.temperature_fe_stat_a1;
+    double four_first_cubed = 4.0 * first * first * first;
+    double nodes = (double)node_count;
+    double node_result_scale = coefficients.cardano_result_scale / nodes;
+    double node_capacity_J_per_K_c0 = coefficients.capacity_J_per_K_c0 / nodes;
+    double node_capacity_J_per_K_c1 = coefficients.capacity_J_per_K_c1 / nodes;
+    size_t padded_nodes = padded_node_count;
+
+    for (size_t node = 0; node < padded_nodes; node++) {
+      double temperature_celcius = temperatures[node];
+
+      // P_fe_stat as in calculate_power_exchanged_joule_per_second. The cube
+      // root's argument is always positive, cardano_first is negative
+      double second =
+          second_constant +
+          second_per_K * (water_temperature_celcius - temperature_celcius);
+      double discriminant = second * second - four_first_cubed;
+      double root = vectorizable_cbrt((second + std::sqrt(discriminant)) / 2.0);
+      double exchanged_J_per_second =
+          node_result_scale * (a1 + root + first / root);
+
+      double capacity_J_per_K = node_capacity_J_per_K_c0 +
+                                node_capacity_J_per_K_c1 * temperature_celcius;
+
+      temperatures[node] =
+          temperature_celcius +
+          (heat_J * power_shares[node] - exchanged_J_per_second * seconds) /
+              capacity_J_per_K;
+    }
+
+    update_summary();
+  }
+
+  /// Works out the hottest node and the weighted average again
+  void update_summary() {
+    std::array<double, LANES> hottest;
+    std::array<double, LANES> weighted = {};
+    hottest.fill(-1e300);
+    size_t padded_nodes = padded_node_count;
+
+    for (size_t node = 0; node < padded_nodes; node += LANES) {
+      for (size_t lane = 0; lane < LANES; lane++) {
+        double temperature_celcius = temperatures[node + lane];
+
+        hottest[lane] =
+            std::max(hottest[lane], temperature_celcius +
+                                        hottest_offsets_celcius[node + lane]);
+        weighted[lane] += power_shares[node + lane] * temperature_celcius;
+      }
+    }
+
+    hottest_temperature_celcius =
+        std::max(std::max(hottest[0], hottest[1]),
+                 std::max(hottest[2], hottest[3]));
+    average_temperature_celcius =
+        (weighted[0] + weighted[1]) + (weighted[2] + weighted[3]);
+  }
+
+  /// The power of each of elements relative to the average, J0 of its ring's
+  /// distance from the centre. The rings are filled from B outwards, 6, 12,
+  /// 18... elements. The rest are 0
+  static std::array<double, MAX_ELEMENTS>
+  calculate_radial_peaking_factors(size_t elements) {
+    std::array<uint8_t, MAX_ELEMENTS> rings;
+    uint8_t ring = 1;
+    size_t in_ring = 0;
+
+    for (size_t element = 0; element < elements; element++) {
+      if (in_ring == 6 * (size_t)ring) {
+        ring++;
+        in_ring = 0;
+      }
+
+      rings[element] = ring;
+      in_ring++;
+    }
+
+    // 2.405 is the first zero of J0
+    double extrapolated_rings = ring + FUEL_ELEMENT_RADIAL_EXTRAPOLATION_RINGS;
+    std::array<double, MAX_ELEMENTS> factors = {};
+
+    for (size_t element = 0; element < elements; element++) {
+      factors[element] =
+          calculate_bessel_j0(2.405 * rings[element] / extrapolated_rings);
+    }
+
+    return normalize_to_average_of_1(factors, elements);
+  }
+
+  /// The power of each axial node relative to the average, the chopped
+  /// cosine averaged over the node, for fuel of a length
+  static std::array<double, AXIAL_NODES>
+  calculate_axial_peaking_factors(double element_length_cm) {
+    const double PI = 3.14159265358979323846;
+    double node_length_cm = element_length_cm / AXIAL_NODES;
+    double extrapolated_length_cm =
+        element_length_cm + 2.0 * FUEL_ELEMENT_AXIAL_REFLECTOR_SAVINGS_CM;
+    std::array<double, AXIAL_NODES> factors;
+
+    for (size_t axial_node = 0; axial_node < AXIAL_NODES; axial_node++) {
+      double bottom_cm = -0.5 * element_length_cm + axial_node * node_length_cm;
+      double top_cm = bottom_cm + node_length_cm;
+
+      // The integral of the cosine over the node
+      factors[axial_node] = std::sin(PI * top_cm / extrapolated_length_cm) -
+                            std::sin(PI * bottom_cm / extrapolated_length_cm);
+    }
+
+    return normalize_to_average_of_1(factors, AXIAL_NODES);
+  }
+
+protected:
+  /// J0(x) from its series, which converges quickly for the x < 2.405 of the
+  /// core
+  static double calculate_bessel_j0(double x) {
+    double quarter_x_squared = 0.25 * x * x;
+    double term = 1.0;
+    double sum = 1.0;
+
+    for (uint8_t k = 1; k < 16; k++) {
+      term *= -quarter_x_squared / ((double)k * k);
+      sum += term;
+    }
+
+    return sum;
+  }
+
+  /// Scales the first count factors to an average of 1
+  template <size_t N>
+  static std::array<double, N>
+  normalize_to_average_of_1(std::array<double, N> factors, size_t count) {
+    double sum = 0.0;
+
+    for (size_t i = 0; i < count; i++) {
+      sum += factors[i];
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      factors[i] *= count / sum;
+    }
+
+    return factors;
+  }
+
+  // For the elements of set_geometry
+  size_t node_count = 0;
+  /// node_count up to a whole number of LANES
+  size_t padded_node_count = 0;
+
+  std::array<double, MAX_PADDED_NODES> temperatures = {};
+  std::array<double, MAX_PADDED_NODES> power_shares = {};
+  /// 0, or -1e300 for the padding nodes so they're never the hottest
+  std::array<double, MAX_PADDED_NODES> hottest_offsets_celcius = {};
+
+  // Worked out by update_summary
+  double hottest_temperature_celcius = 20.0;
+  double average_temperature_celcius = 20.0;
+};
+#endif
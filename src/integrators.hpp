@@ -0,0 +1,289 @@
+#ifndef INTEGRATORS_HPP
+#define INTEGRATORS_HPP
+
+#include <array>
+#include <cmath>
+#include <utility>
+#include <stddef.h>
+
+/// How the reactor's continuous state is moved forward each tick
+enum class Integrator {
+  /// Forward euler with the original operator split ordering (fuel, rods,
+  /// kinetics, water), one fixed time step per tick
+  EULER,
+  /// Classic 4th order Runge-Kutta on the whole state, one fixed time step
+  /// per tick
+  RK4,
+  /// Dormand-Prince 5(4), the step grows or shrinks every tick to keep the
+  /// embedded error estimate within tolerance.
+  ///
+  /// Being explicit, the step stays below about 3.3 prompt neutron
+  /// generation times over (beta - rho), a few milliseconds when shut down.
+  /// Only for checking the others on short runs, the prompt neutrons are
+  /// stiff and ROSENBROCK23 isn't held back by them
+  RK45,
+  /// Rosenbrock 2(3) (Shampine's modified Rosenbrock triple, as in MATLAB's
+  /// ode23s), adaptive like RK45 but L-stable, so the step is only limited
+  /// by accuracy even though the prompt neutrons are stiff
+  ROSENBROCK23,
+};
+
+/// Moves a state forward by one classic 4th order Runge-Kutta step.
+///
+/// calculate_derivative takes a state and returns its time derivative
+template <typename T, size_t SIZE, typename Derivative>
+std::array<T, SIZE> integrate_rk4(Derivative &&calculate_derivative,
+                                  const std::array<T, SIZE> &state,
+                                  T time_delta_seconds) {
+  std::array<T, SIZE> stage;
+
+  std::array<T, SIZE> k1 = calculate_derivative(state);
+
+  for (size_t i = 0; i < SIZE; i++) {
+    stage[i] = state[i] + T(0.5) * time_delta_seconds * k1[i];
+  }
+  std::array<T, SIZE> k2 = calculate_derivative(stage);
+
+  for (size_t i = 0; i < SIZE; i++) {
+    stage[i] = state[i] + T(0.5) * time_delta_seconds * k2[i];
+  }
+  std::array<T, SIZE> k3 = calculate_derivative(stage);
+
+  for (size_t i = 0; i < SIZE; i++) {
+    stage[i] = state[i] + time_delta_seconds * k3[i];
+  }
+  std::array<T, SIZE> k4 = calculate_derivative(stage);
+
+  std::array<T, SIZE> result;
+
+  for (size_t i = 0; i < SIZE; i++) {
+    result[i] =
+        state[i] + time_delta_seconds / T(6.0) *
+                       (k1[i] + T(2.0) * k2[i] + T(2.0) * k3[i] + k4[i]);
+  }
+
+  return result;
+}
+
+/// Moves a state forward by one Dormand-Prince 5(4) step, returning the 5th
+/// order solution and writing the difference to the embedded 4th order
+/// solution (the local error estimate) into error.
+///
+/// See Hairer, Norsett and Wanner, Solving Ordinary Differential Equations I,
+/// table 5.2
+template <typename T, size_t SIZE, typename Derivative>
+std::array<T, SIZE> integrate_dormand_prince(Derivative &&calculate_derivative,
+                                             const std::array<T, SIZE> &state,
+                                             T time_delta_seconds,
+                                             std::array<T, SIZE> &error) {
+  const T h = time_delta_seconds;
+  std::array<T, SIZE> stage;
+
+  std::array<T, SIZE> k1 = calculate_derivative(state);
+
+  for (size_t i = 0; i < SIZE; i++) {
+    stage[i] = state[i] + h * T(1.0 / 5.0) * k1[i];
+  }
+  std::array<T, SIZE> k2 = calculate_derivative(stage);
+
+  for (size_t i = 0; i < SIZE; i++) {
+    stage[i] = state[i] + h * (T(3.0 / 40.0) * k1[i] + T(9.0 / 40.0) * k2[i]);
+  }
+  std::array<T, SIZE> k3 = calculate_derivative(stage);
+
+  for (size_t i = 0; i < SIZE; i++) {
+    stage[i] = state[i] + h * (T(44.0 / 45.0) * k1[i] - T(56.0 / 15.0) * k2[i] +
+                               T(32.0 / 9.0) * k3[i]);
+  }
+  std::array<T, SIZE> k4 = calculate_derivative(stage);
+
+  for (size_t i = 0; i < SIZE; i++) {
+    stage[i] = state[i] + h * (T(19372.0 / 6561.0) * k1[i] -
+                               T(25360.0 / 2187.0) * k2[i] +
+                               T(64448.0 / 6561.0) * k3[i] -
+                               T(212.0 / 729.0) * k4[i]);
+  }
+  std::array<T, SIZE> k5 = calculate_derivative(stage);
+
+  for (size_t i = 0; i < SIZE; i++) {
+    stage[i] = state[i] + h * (T(9017.0 / 3168.0) * k1[i] -
+                               T(355.0 / 33.0) * k2[i] +
+                               T(46732.0 / 5247.0) * k3[i] +
+                               T(49.0 / 176.0) * k4[i] -
+                               T(5103.0 / 18656.0) * k5[i]);
+  }
+  std::array<T, SIZE> k6 = calculate_derivative(stage);
+
+  std::array<T, SIZE> result;
+
+  for (size_t i = 0; i < SIZE; i++) {
+    result[i] = state[i] + h * (T(35.0 / 384.0) * k1[i] +
+                                T(500.0 / 1113.0) * k3[i] +
+                                T(125.0 / 192.0) * k4[i] -
+                                T(2187.0 / 6784.0) * k5[i] +
+                                T(11.0 / 84.0) * k6[i]);
+  }
+  std::array<T, SIZE> k7 = calculate_derivative(result);
+
+  // 5th order weights minus the 4th order ones
+  for (size_t i = 0; i < SIZE; i++) {
+    error[i] = h * (T(71.0 / 57600.0) * k1[i] - T(71.0 / 16695.0) * k3[i] +
+                    T(71.0 / 1920.0) * k4[i] - T(17253.0 / 339200.0) * k5[i] +
+                    T(22.0 / 525.0) * k6[i] - T(1.0 / 40.0) * k7[i]);
+  }
+
+  return result;
+}
+
+/// Solves a x = b for small dense matrices, with gaussian elimination and
+/// partial pivoting
+template <typename T, size_t SIZE> class LuDecomposition {
+public:
+  /// Factorizes a, stored row by row
+  LuDecomposition(const std::array<std::array<T, SIZE>, SIZE> &a) : lu(a) {
+    using std::abs;
+
+    for (size_t column = 0; column < SIZE; column++) {
+      size_t pivot = column;
+
+      for (size_t row = column + 1; row < SIZE; row++) {
+        if (abs(lu[row][column]) > abs(lu[pivot][column])) {
+          pivot = row;
+        }
+      }
+
+      std::swap(lu[column], lu[pivot]);
+      pivots[column] = pivot;
+
+      for (size_t row = column + 1; row < SIZE; row++) {
+        T factor = lu[row][column] / lu[column][column];
+        lu[row][column] = factor;
+
+        for (size_t k = column + 1; k < SIZE; k++) {
+          lu[row][k] -= factor * lu[column][k];
+        }
+      }
+    }
+  }
+
+  std::array<T, SIZE> solve(std::array<T, SIZE> b) const {
+    for (size_t column = 0; column < SIZE; column++) {
+      std::swap(b[column], b[pivots[column]]);
+    }
+
+    for (size_t row = 1; row < SIZE; row++) {
+      for (size_t k = 0; k < row; k++) {
+        b[row] -= lu[row][k] * b[k];
+      }
+    }
+
+    for (size_t row = SIZE; row-- > 0;) {
+      for (size_t k = row + 1; k < SIZE; k++) {
+        b[row] -= lu[row][k] * b[k];
+      }
+
+      b[row] /= lu[row][row];
+    }
+
+    return b;
+  }
+
+protected:
+  std::array<std::array<T, SIZE>, SIZE> lu;
+  std::array<size_t, SIZE> pivots;
+};
+
+/// Moves a state forward by one step of Shampine's modified Rosenbrock triple,
+/// returning the 2nd order solution and writing its local error estimate into
+/// error. The jacobian is calculated with forward differences.
+///
+/// See Shampine and Reichelt, The MATLAB ODE Suite, section 3.1. The
+/// derivative must not depend on time
+template <typename T, size_t SIZE, typename Derivative>
+std::array<T, SIZE> integrate_rosenbrock_23(Derivative &&calculate_derivative,
+                                            const std::array<T, SIZE> &state,
+                                            T time_delta_seconds,
+                                            std::array<T, SIZE> &error) {
+  const T h = time_delta_seconds;
+  const T d = T(1.0 / (2.0 + std::sqrt(2.0)));
+  const T e32 = T(6.0 + std::sqrt(2.0));
+
+  std::array<T, SIZE> f0 = calculate_derivative(state);
+
+  // W = I - h d J, built a column of J at a time
+  std::array<std::array<T, SIZE>, SIZE> w;
+
+  for (size_t column = 0; column < SIZE; column++) {
+    std::array<T, SIZE> perturbed = state;
+    perturbed[column] +=
+        T(1.5e-8 * std::fmax(std::fabs((double)state[column]), 1.0));
+    T delta = perturbed[column] - state[column];
+
+    std::array<T, SIZE> f = calculate_derivative(perturbed);
+
+    for (size_t row = 0; row < SIZE; row++) {
+      w[row][column] = (row == column ? T(1.0) : T(0.0)) -
+                       h * d * (f[row] - f0[row]) / delta;
+    }
+  }
+
+  LuDecomposition<T, SIZE> w_lu(w);
+
+  std::array<T, SIZE> stage;
+
+  std::array<T, SIZE> k1 = w_lu.solve(f0);
+
+  for (size_t i = 0; i < SIZE; i++) {
+    stage[i] = state[i] + T(0.5) * h * k1[i];
+  }
+  std::array<T, SIZE> f1 = calculate_derivative(stage);
+
+  for (size_t i = 0; i < SIZE; i++) {
+    stage[i] = f1[i] - k1[i];
+  }
+  std::array<T, SIZE> k2 = w_lu.solve(stage);
+
+  std::array<T, SIZE> result;
+
+  for (size_t i = 0; i < SIZE; i++) {
+    k2[i] += k1[i];
+    result[i] = state[i] + h * k2[i];
+  }
+  std::array<T, SIZE> f2 = calculate_derivative(result);
+
+  for (size_t i = 0; i < SIZE; i++) {
+    stage[i] = f2[i] - e32 * (k2[i] - f1[i]) - T(2.0) * (k1[i] - f0[i]);
+  }
+  std::array<T, SIZE> k3 = w_lu.solve(stage);
+
+  for (size_t i = 0; i < SIZE; i++) {
+    error[i] = h / T(6.0) * (k1[i] - T(2.0) * k2[i] + k3[i]);
+  }
+
+  return result;
+}
+
+/// Calculates the root mean square of the error, with every value scaled by
+/// absolute_tolerance + relative_tolerance * |value|. At or below 1.0 the step
+/// is within tolerance. Calculated in double whatever the state is
+template <typename T, size_t SIZE>
+double calculate_error_norm(const std::array<T, SIZE> &error,
+                            const std::array<T, SIZE> &state_at_start,
+                            const std::array<T, SIZE> &state_at_end,
+                            const std::array<double, SIZE> &absolute_tolerance,
+                            double relative_tolerance) {
+  double sum = 0.0;
+
+  for (size_t i = 0; i < SIZE; i++) {
+    double scale = absolute_tolerance[i] +
+                   relative_tolerance *
+                       std::fmax(std::fabs((double)state_at_start[i]),
+                                 std::fabs((double)state_at_end[i]));
+    double scaled_error = (double)error[i] / scale;
+
+    sum += scaled_error * scaled_error;
+  }
+
+  return std::sqrt(sum / (double)SIZE);
+}
+#endif
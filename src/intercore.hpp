@@ -16,6 +16,20 @@ public:
 
   bool in_scram = false;
 
+  // The last pulse to end, see Reactor::get_last_pulse
+  uint32_t pulses_ended = 0;
+  double last_pulse_peak_power_watts = 0;
+  double last_pulse_energy_J = 0;
+  double last_pulse_peak_fuel_temperature_celcius = 0;
+
+  // Real time the reactor fell too far behind to catch up on, see
+  // MAIN_MAX_CATCH_UP_MS
+  uint32_t real_time_dropped_ms = 0;
+
+  // Why the snapshot asked for at start, with the SCRAM button held, wasn't
+  // loaded, see describe_snapshot_status. Null when it was or wasn't asked for
+  const char *snapshot_failure = nullptr;
+
   mutex reactor_data_mutex;
 
   // Secondary core writes, main core reads if manual control is enabled
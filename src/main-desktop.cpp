@@ -1,108 +1,182 @@
 #include "reactor.hpp"
+#include "reactor_snapshot_file.hpp"
+#include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <csignal>
 #include <ctime>
+#include <filesystem>
 #include <stdio.h>
+#include <stdlib.h>
 #include <thread>
 #include <iostream>
 #include <fstream>
 
-int main() {
+/// Set by Ctrl-C, the loop saves the snapshot and stops
+static volatile std::sig_atomic_t stop_requested = 0;
+
+static void request_stop(int) { stop_requested = 1; }
+
+/// Runs the reactor in real time, or that many times faster given a speed
+/// after the snapshot file, to fast forward through hours of xenon. Given a
+/// snapshot file, it carries on from the snapshot if the file exists, and
+/// saves to it on Ctrl-C
+int main(int argc, char **argv) {
+  const char *snapshot_path = argc > 1 ? argv[1] : nullptr;
+  double speed = argc > 2 ? atof(argv[2]) : 1.0;
+
+  if (!(speed > 0.0)) {
+    printf("The speed has to be above 0\n");
+    return 1;
+  }
+
   Reactor *reactor = new Reactor();
   reactor->get_safety_control_rod()->set_current_position(0);
   reactor->get_safety_control_rod()->set_target_position(0);
   reactor->get_regulating_control_rod()->set_current_position(24e5);
   reactor->get_regulating_control_rod()->set_target_position(24e5);
   reactor->get_compensating_control_rod()->set_current_position(0);
+  // Fast forwarding is only fast with the long ticks while nothing happens
+  reactor->adaptive_tick_rate = true;
+  reactor->xenon_poisoning = true;
+  reactor->decay_heat = true;
+  // Updated at 1 kHz at full rate, all the nodes every tick would keep up
+  // with real time but not with fast forwarding
+  reactor->fuel_element_temperatures = true;
+  reactor->fuel_temperature_update_interval_ticks = 10;
+
+  Reactor::ReactorSnapshot *snapshot = new Reactor::ReactorSnapshot();
+
+  if (snapshot_path != nullptr) {
+    if (read_snapshot_file(snapshot_path, *snapshot)) {
+      SnapshotStatus status = reactor->load_snapshot(*snapshot);
+
+      if (status != SnapshotStatus::LOADED) {
+        printf("Can't carry on from %s: %s\n", snapshot_path,
+               describe_snapshot_status(status));
+        return 1;
+      }
+    } else if (std::filesystem::exists(snapshot_path)) {
+      // Not overwritten on Ctrl-C, it may be something else entirely
+      printf("Can't carry on from %s: not a snapshot of this reactor\n",
+             snapshot_path);
+      return 1;
+    }
+
+    std::signal(SIGINT, request_stop);
+  }
 
   while (true) {
 
+    if (stop_requested) {
+      reactor->save_snapshot(*snapshot);
+
+      if (!write_snapshot_file(snapshot_path, *snapshot)) {
+        printf("Couldn't save the snapshot to %s\n", snapshot_path);
+        return 1;
+      }
+
+      printf("Saved to %s\n", snapshot_path);
+      return 0;
+    }
+
     auto current_clock = std::chrono::system_clock::now();
 
-    reactor->tick();
+    // The screen only needs redrawing every 50 ms, so the reactor ticks
+    // through them, times the speed, in one batch. It stops early at a SCRAM
+    // or when a rod gets to its target, the display shows the moment it
+    // happened
+    double seconds_before_ticks = reactor->get_time_elapsed_seconds();
+    reactor->tick_n((uint32_t)std::max(
+        std::lround(0.05 * speed / reactor->get_time_delta_seconds()), 1l));
 
 	 // Stop condition for data
     /*if (reactor->get_steps_elapsed() > 10000 * 600) {
 		 return 0;
 	 }*/
 
-    if (reactor->get_steps_elapsed() % 500 == 0) {
-
 	   /*std::ofstream output_file;
 
 		output_file.open("power.txt", std::ios_base::app);
 
-		output_file << std::format("{:.2f} {:.2f}\n", reactor->get_time_elapsed_seconds(), reactor->calculate_power_watts());
+		output_file << std::format("{:.2f} {:.2f}\n", reactor->get_time_elapsed_seconds(), reactor->get_power_watts());
 
 		output_file.close();*/
 
-      printf("\033c");
-      printf("\n");
+    printf("\033c");
+    printf("\n");
 
-      if (reactor->get_in_scram()) {
-        printf("\033[1;34;31m  !! IN SCRAM !!\033[0m\n");
-      }
-
-      printf("\033[1;34;34m  %.0f seconds (%.0e steps) since reactor "
-             "start\033[0m\n",
-             reactor->get_time_elapsed_seconds(),
-             (double)reactor->get_steps_elapsed());
-
-      printf("\n");
-
-      printf("\033[1;34;33m  Reactor\033[0m\n");
-      printf("\033[1;34;33m  Neutrons: %.2e\033[0m\n",
-             reactor->get_neutrons_in_core());
-
-      printf("\033[1;34;33m  Thermal power: %.0f W, target %u W\033[0m\n",
-             reactor->calculate_power_watts(),
-             reactor->get_target_thermal_power_watts());
-
-      auto reactivity_pcm = reactor->get_reactivity_pcm();
-      auto reactivity_no_units = reactivity_pcm * 1.0e-5;
-      auto reactivity_k = 1.0 / (1.0 - reactivity_no_units);
-
-      printf("\033[1;34;33m  Reactivity: %.0f pcm (k = %f)\033[0m\n",
-             reactivity_pcm, reactivity_k);
-
-      printf("\n");
-
-      printf("\033[1;34;33m  Rods\033[0m\n");
-
-      printf(
-          "\033[1;34;33m  Positions: s %.4f, r %.4f, c %.4f\033[0m\n",
-          reactor->get_safety_control_rod()->get_current_position_as_fraction(),
-          reactor->get_regulating_control_rod()
-              ->get_current_position_as_fraction(),
-          reactor->get_compensating_control_rod()
-              ->get_current_position_as_fraction());
-      printf(
-          "\033[1;34;33m  Targets:   s %.4f, r %.4f, c %.4f\033[0m\n",
-          reactor->get_safety_control_rod()->get_target_position_as_fraction(),
-          reactor->get_regulating_control_rod()
-              ->get_target_position_as_fraction(),
-          reactor->get_compensating_control_rod()
-              ->get_target_position_as_fraction());
-
-      printf("\n");
-
-      printf("\033[1;34;36m  Thermal data\033[0m\n");
-
-      printf("\033[1;34;36m  Fuel  T: %.1f °C\033[0m\n",
-             reactor->get_fuel_temperature_celcius());
-      printf("\033[1;34;36m  Water T: %.1f °C\033[0m\n",
-             reactor->get_water_temperature_celcius());
+    if (reactor->get_in_scram()) {
+      printf("\033[1;34;31m  !! IN SCRAM !!\033[0m\n");
+    }
 
-      if (reactor->get_active_cooling_system_enabled()) {
-        printf("\033[1;34;36m  Active cooling: Y\033[0m\n");
-      } else {
-        printf("\033[1;34;36m  Active cooling: N\033[0m\n");
-      }
+    printf("\033[1;34;34m  %.0f seconds (%.0e steps) since reactor "
+           "start\033[0m\n",
+           reactor->get_time_elapsed_seconds(),
+           (double)reactor->get_steps_elapsed());
+
+    printf("\n");
+
+    printf("\033[1;34;33m  Reactor\033[0m\n");
+    printf("\033[1;34;33m  Neutrons: %.2e\033[0m\n",
+           reactor->get_neutrons_in_core());
+
+    printf("\033[1;34;33m  Thermal power: %.0f W, target %u W\033[0m\n",
+           reactor->get_power_watts(),
+           reactor->get_target_thermal_power_watts());
+    printf("\033[1;34;33m  Decay heat: %.0f W\033[0m\n",
+           (double)reactor->get_decay_heat_watts());
+
+    auto reactivity_pcm = reactor->get_reactivity_pcm();
+    auto reactivity_no_units = reactivity_pcm * 1.0e-5;
+    auto reactivity_k = 1.0 / (1.0 - reactivity_no_units);
+
+    printf("\033[1;34;33m  Reactivity: %.0f pcm (k = %f)\033[0m\n",
+           reactivity_pcm, reactivity_k);
+    printf("\033[1;34;33m  Xenon: -%.1f pcm\033[0m\n",
+           (double)reactor->get_xenon_worth_pcm());
+
+    printf("\n");
+
+    printf("\033[1;34;33m  Rods\033[0m\n");
+
+    printf(
+        "\033[1;34;33m  Positions: s %.4f, r %.4f, c %.4f\033[0m\n",
+        reactor->get_safety_control_rod()->get_current_position_as_fraction(),
+        reactor->get_regulating_control_rod()
+            ->get_current_position_as_fraction(),
+        reactor->get_compensating_control_rod()
+            ->get_current_position_as_fraction());
+    printf(
+        "\033[1;34;33m  Targets:   s %.4f, r %.4f, c %.4f\033[0m\n",
+        reactor->get_safety_control_rod()->get_target_position_as_fraction(),
+        reactor->get_regulating_control_rod()
+            ->get_target_position_as_fraction(),
+        reactor->get_compensating_control_rod()
+            ->get_target_position_as_fraction());
+
+    printf("\n");
+
+    printf("\033[1;34;36m  Thermal data\033[0m\n");
+
+    printf("\033[1;34;36m  Fuel  T: %.1f °C\033[0m\n",
+           reactor->get_fuel_temperature_celcius());
+    printf("\033[1;34;36m  Hottest fuel T: %.1f °C\033[0m\n",
+           reactor->get_hottest_fuel_temperature_celcius());
+    printf("\033[1;34;36m  Water T: %.1f °C\033[0m\n",
+           reactor->get_water_temperature_celcius());
+
+    if (reactor->get_active_cooling_system_enabled()) {
+      printf("\033[1;34;36m  Active cooling: Y\033[0m\n");
+    } else {
+      printf("\033[1;34;36m  Active cooling: N\033[0m\n");
     }
 
-    auto next_tick = current_clock +
-                     std::chrono::nanoseconds(
-                         (uint64_t)(reactor->get_time_delta_seconds() * 1e9f));
+    auto next_tick =
+        current_clock +
+        std::chrono::nanoseconds((uint64_t)(
+            (reactor->get_time_elapsed_seconds() - seconds_before_ticks) /
+            speed * 1e9));
 
     std::this_thread::sleep_until(next_tick);
   }
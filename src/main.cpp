@@ -2,10 +2,12 @@
 #include "constants.hpp"
 #include "hardware/adc.h"
 #include "hardware/clocks.h"
+#include "hardware/flash.h"
 #include "hardware/gpio.h"
 #include "hardware/pll.h"
 #include "hardware/pwm.h"
 #include "hardware/structs/pll.h"
+#include "hardware/sync.h"
 #include "intercore.hpp"
 #include "lcd.hpp"
 #include "packets.hpp"
@@ -13,9 +15,12 @@
 #include "pico/multicore.h"
 #include "pico/stdlib.h"
 #include "reactor.hpp"
+#include "reactor_presets.hpp"
 #include "seven_segment.hpp"
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <format>
 #include <hardware/regs/io_bank0.h>
 #include <hardware/structs/io_bank0.h>
@@ -256,8 +261,63 @@ void set_cherenkov_on_percentage(uint16_t slice_of_max) {
   pwm_set_chan_level(slice_num, PWM_CHAN_A, slice_of_max);
 }
 
+/// Flash set aside for a reactor snapshot, whole sectors at the end of flash
+const uint32_t SNAPSHOT_FLASH_SIZE =
+    (sizeof(Reactor::ReactorSnapshot) + FLASH_SECTOR_SIZE - 1) /
+    FLASH_SECTOR_SIZE * FLASH_SECTOR_SIZE;
+const uint32_t SNAPSHOT_FLASH_OFFSET =
+    PICO_FLASH_SIZE_BYTES - SNAPSHOT_FLASH_SIZE;
+
+/// The reactor as it was when the SCRAM button was last pressed, sealed and
+/// saved to flash if the button is held. Static, it's far too big for the stack
+static Reactor::ReactorSnapshot button_snapshot;
+
+/// The reactor before its last quiescent tick, which runs ahead of real time.
+/// Static, it's too big for the stack
+static Reactor::ReactorState state_before_quiescent_tick;
+
+/// Writes a snapshot to its flash sectors.
+///
+/// Neither core can run from flash while it's written, so the other core is
+/// paused and interrupts are off, for the tens of milliseconds it takes to
+/// erase and program. The simulation falls that far behind real time once
+void write_snapshot_to_flash(const Reactor::ReactorSnapshot &snapshot) {
+  const uint32_t whole_pages_size =
+      sizeof(snapshot) / FLASH_PAGE_SIZE * FLASH_PAGE_SIZE;
+  const uint32_t last_page_size = sizeof(snapshot) - whole_pages_size;
+
+  // Flash is programmed in whole pages, so the end of the snapshot goes
+  // through a page sized buffer
+  uint8_t last_page[FLASH_PAGE_SIZE];
+  memset(last_page, 0xFF, FLASH_PAGE_SIZE);
+  memcpy(last_page, (const uint8_t *)&snapshot + whole_pages_size,
+         last_page_size);
+
+  multicore_lockout_start_blocking();
+  uint32_t interrupts = save_and_disable_interrupts();
+
+  flash_range_erase(SNAPSHOT_FLASH_OFFSET, SNAPSHOT_FLASH_SIZE);
+  flash_range_program(SNAPSHOT_FLASH_OFFSET, (const uint8_t *)&snapshot,
+                      whole_pages_size);
+  if (last_page_size > 0) {
+    flash_range_program(SNAPSHOT_FLASH_OFFSET + whole_pages_size, last_page,
+                        FLASH_PAGE_SIZE);
+  }
+
+  restore_interrupts(interrupts);
+  multicore_lockout_end_blocking();
+}
+
+/// The snapshot in flash, read where it is through XIP. Only a snapshot if
+/// load_snapshot says so, erased flash is all 0xFF
+const Reactor::ReactorSnapshot &get_flash_snapshot() {
+  return *(const Reactor::ReactorSnapshot *)(XIP_BASE + SNAPSHOT_FLASH_OFFSET);
+}
+
 /// Main for core 2 of the simulator pico
 void main_core_2() {
+  // Lets core 1 pause this core while the snapshot is written to flash
+  multicore_lockout_victim_init();
 
   adc_init();
   adc_gpio_init(MAIN_PIN_SAFETY_ROD_INPUT);
@@ -277,6 +337,20 @@ void main_core_2() {
 
   absolute_time_t last_lcd_update = nil_time;
 
+  // The report of the last pulse is shown for a while after it ends
+  uint32_t pulses_ended = 0;
+  uint32_t pulses_ended_shown = 0;
+  absolute_time_t last_pulse_ended_time = nil_time;
+  double last_pulse_peak_power_watts = 0;
+  double last_pulse_energy_J = 0;
+  double last_pulse_peak_fuel_temperature_celcius = 0;
+
+  uint32_t real_time_dropped_ms = 0;
+
+  // Why the snapshot wasn't loaded is shown for a while after start
+  const char *snapshot_failure = nullptr;
+  absolute_time_t snapshot_failure_time = nil_time;
+
   double neutrons_in_core = 0;
   int16_t reactivity_pcm = 0;
   double power_watts = 0;
@@ -337,8 +411,29 @@ void main_core_2() {
 
     in_scram = intercore_memory.in_scram;
 
+    pulses_ended = intercore_memory.pulses_ended;
+    last_pulse_peak_power_watts = intercore_memory.last_pulse_peak_power_watts;
+    last_pulse_energy_J = intercore_memory.last_pulse_energy_J;
+    last_pulse_peak_fuel_temperature_celcius =
+        intercore_memory.last_pulse_peak_fuel_temperature_celcius;
+
+    real_time_dropped_ms = intercore_memory.real_time_dropped_ms;
+
+    bool snapshot_failed = snapshot_failure == nullptr &&
+                           intercore_memory.snapshot_failure != nullptr;
+    snapshot_failure = intercore_memory.snapshot_failure;
+
     mutex_exit(&intercore_memory.reactor_data_mutex);
 
+    if (pulses_ended != pulses_ended_shown) {
+      pulses_ended_shown = pulses_ended;
+      last_pulse_ended_time = current_time;
+    }
+
+    if (snapshot_failed) {
+      snapshot_failure_time = current_time;
+    }
+
     mutex_enter_blocking(&intercore_memory.rod_target_positions_mutex);
     if (use_adc) {
 
@@ -423,6 +518,55 @@ void main_core_2() {
       line_2.resize(20, ' ');
 
       std::string line_3 = std::format("rho: {:+d} pcm", reactivity_pcm);
+
+      // The peak power, energy and peak fuel temperature instead of the
+      // neutrons and reactivity
+      bool show_pulse_report =
+          pulses_ended > 0 &&
+          absolute_time_diff_us(last_pulse_ended_time, current_time) <
+              (int64_t)MAIN_PULSE_REPORT_DISPLAY_MS * 1000;
+
+      if (show_pulse_report) {
+        line_0 = std::format("pk : {:.2e} W", last_pulse_peak_power_watts);
+        line_3 = std::format("E: {:.1f}MJ Tf: {:.0f}C",
+                             last_pulse_energy_J / 1e6,
+                             last_pulse_peak_fuel_temperature_celcius);
+        line_0.resize(20, ' ');
+      }
+
+      // Instead of the neutrons and reactivity too, the reason scrolls by
+      // when it's wider than the LCD
+      int64_t snapshot_failure_shown_us =
+          absolute_time_diff_us(snapshot_failure_time, current_time);
+      bool show_snapshot_failure =
+          snapshot_failure != nullptr &&
+          snapshot_failure_shown_us <
+              (int64_t)MAIN_SNAPSHOT_STATUS_DISPLAY_MS * 1000;
+
+      if (show_snapshot_failure) {
+        std::string reason = snapshot_failure;
+
+        if (reason.size() > 20) {
+          size_t offset = (size_t)(snapshot_failure_shown_us /
+                                   (one_lcd_update_ms * 3 * 1000)) %
+                          (reason.size() - 20 + 1);
+          reason = reason.substr(offset, 20);
+        }
+
+        line_0 = "snapshot not loaded:";
+        line_3 = reason;
+      }
+
+      // How far the reactor is behind real time, in whole seconds at the
+      // right of the last line once it has dropped any
+      if (real_time_dropped_ms > 0) {
+        uint32_t dropped_seconds =
+            std::min((real_time_dropped_ms + 999) / 1000, (uint32_t)999);
+        std::string dropped = std::format(" -{}s", dropped_seconds);
+        line_3.resize(20 - dropped.size(), ' ');
+        line_3 += dropped;
+      }
+
       line_3.resize(20, ' ');
 
       // Write to the lcd
@@ -456,8 +600,8 @@ void main_core_2() {
 int main() {
 
   // Initialize all gpio pins we'll be using
-  gpio_init_mask(0b111111001100111111111000);
-  gpio_set_dir_masked(0b111111001100111111111000, 0b100001001100111111111000);
+  gpio_init_mask(0b111111001100111111111100);
+  gpio_set_dir_masked(0b111111001100111111111100, 0b100001001100111111111000);
 
   // Set GPIO 23 to high to reduce ADC noise
   gpio_put(23, true);
@@ -467,6 +611,7 @@ int main() {
   gpio_pull_up(MAIN_PIN_MANUAL_AUTOMATIC_CONTROL_SWITCH);
   gpio_pull_up(MAIN_PIN_ENABLE_SCRAMS_SWITCH);
   gpio_pull_up(MAIN_PIN_SCRAM_BUTTON);
+  gpio_pull_up(MAIN_PIN_PULSE_BUTTON);
 
   // Initialize intercore mutexes
   mutex_init(&intercore_memory.reactor_data_mutex);
@@ -494,26 +639,112 @@ int main() {
   bool scram_led_on = false;
 
   Reactor *reactor = new Reactor();
+  // The cube and square roots of the fuel and water cooling are the slowest
+  // math in a tick without a double precision FPU
+  reactor->approximate_thermal_math = true;
+  // Start at the source level with the rods in, rather than waiting for the
+  // precursors to build up from nothing
+  reactor->load_equilibrium(SOURCE_LEVEL_SHUTDOWN_PRESET);
+  // Tick less often while nothing is happening, like sitting shut down
+  reactor->adaptive_tick_rate = true;
+  // The xenon builds up over a day of running, and holds the reactor down for
+  // hours after it's shut down
+  reactor->xenon_poisoning = true;
+  // The fuel and water keep heating after a SCRAM, about 6 % of the power
+  // at first
+  reactor->decay_heat = true;
+  // fuel_element_temperatures stays off, its 236 nodes need the vector units
+  // and double precision FPU the RP2350's Cortex-M33 doesn't have
+
+  // Carry on from the snapshot in flash if the SCRAM button is held at start,
+  // and wait for it to be let go so it doesn't SCRAM the reactor
+  if (!gpio_get(MAIN_PIN_SCRAM_BUTTON)) {
+    SnapshotStatus snapshot_status =
+        reactor->load_snapshot(get_flash_snapshot());
+
+    // The reactor stays at the source level, the LCD says why
+    if (snapshot_status != SnapshotStatus::LOADED) {
+      mutex_enter_blocking(&intercore_memory.reactor_data_mutex);
+      intercore_memory.snapshot_failure =
+          describe_snapshot_status(snapshot_status);
+      mutex_exit(&intercore_memory.reactor_data_mutex);
+    }
+
+    while (!gpio_get(MAIN_PIN_SCRAM_BUTTON)) {
+      sleep_ms(10);
+    }
+  }
+
+  bool scram_button_held = false;
+  bool pulse_button_held = false;
+  bool button_snapshot_written = false;
+  auto scram_button_pressed_time = get_absolute_time();
+
+  // The loop counts its own iterations, the reactor takes fewer and longer
+  // steps when it's quiescent
+  uint64_t loops = 0;
+  // Full rate ticks the reactor is behind the loop, negative when a quiescent
+  // tick took it ahead
+  int32_t ticks_owed = 0;
+  // Real time dropped by giving up on catching up, the simulated time is
+  // behind the wall clock by this much for good
+  uint64_t real_time_dropped_us = 0;
+  Reactor::ReactorInputs previous_inputs = reactor->get_inputs();
+  bool previous_scrams_enabled = reactor->scrams_enabled;
+  auto next_loop_time = get_absolute_time();
 
   while (1) {
 
     auto current_time = get_absolute_time();
 
-    reactor->tick();
+    // The reactor ticks MAIN_TICKS_PER_LOOP times in one batch, and the
+    // inputs and outputs below are handled once for all of them. A batch
+    // stops early at a SCRAM or when a rod gets to its target, and the ticks
+    // it didn't take are taken with the next one.
+    //
+    // A quiescent tick covers QUIESCENT_TICKS_PER_TICK full rate ticks, so
+    // it's only taken every few loops, which leaves core 0 free in between
+    ticks_owed += MAIN_TICKS_PER_LOOP;
+
+    if (ticks_owed > 0) {
+      bool quiescent = reactor->get_quiescent();
+
+      // Kept to roll back to, if an input comes in before real time has
+      // caught up with the tick
+      if (quiescent) {
+        state_before_quiescent_tick = reactor->get_state();
+      }
 
-    // note: 1e-4 seconds between each, * 1e6 for micros
-    auto micros_between_each_loop = 1e-4 * 1e6;
+      double seconds_before_ticks = reactor->get_time_elapsed_seconds();
+      reactor->tick_n(quiescent ? 1 : (uint32_t)ticks_owed);
 
-    auto next_loop_time = delayed_by_us(current_time, micros_between_each_loop);
+      // note: 1e-4 seconds for each full rate tick
+      ticks_owed -= (int32_t)std::lround(
+          (reactor->get_time_elapsed_seconds() - seconds_before_ticks) / 1e-4);
+    }
+
+    // note: 1e-4 seconds between each tick, * 1e6 for micros
+    auto micros_between_each_loop = MAIN_TICKS_PER_LOOP * 1e-4 * 1e6;
+
+    // On a fixed schedule rather than from when this loop started, so when
+    // a loop overruns, like with the sub-stepped ticks of a pulse, the ones
+    // after it run back to back until the reactor is back on real time
+    next_loop_time = delayed_by_us(next_loop_time, micros_between_each_loop);
+
+    int64_t behind_us = absolute_time_diff_us(next_loop_time, current_time);
+
+    if (behind_us > (int64_t)MAIN_MAX_CATCH_UP_MS * 1000) {
+      real_time_dropped_us += (uint64_t)behind_us;
+      next_loop_time = delayed_by_us(current_time, micros_between_each_loop);
+    }
 
     // Manage the SCRAM led
     //
     // Pulse 0.5s / 0.5s on and off when in scram
     // set to off when not in scram
     if (reactor->get_in_scram()) {
-      if (reactor->get_steps_since_scram_started() % 5000 == 0) {
-        scram_led_on = !scram_led_on;
-      }
+      // The batches don't have to land on the 5000th tick
+      scram_led_on = reactor->get_steps_since_scram_started() / 5000 % 2 == 0;
     } else {
       scram_led_on = false;
     }
@@ -523,19 +754,52 @@ int main() {
     // Set the cherenkov leds
     // linearly set the power with PWM from 0 to SCRAM watts
     double cherenkov_percentage =
-        reactor->calculate_power_watts() / (double)reactor->get_target_thermal_power_watts();
+        reactor->get_power_watts() / (double)reactor->get_target_thermal_power_watts();
     set_cherenkov_on_percentage(
         (uint16_t)(cherenkov_percentage * (double)1000));
 
-    if (reactor->get_steps_elapsed() % 10000 == 0) {
+    if (loops % (10000 / MAIN_TICKS_PER_LOOP) == 0) {
       led_on = !led_on;
       gpio_put(PIN_LED, led_on);
     }
 
     // Check digital GPIO inputs
     // Note: these are inverted, since we pull them up
-    if (!gpio_get(MAIN_PIN_SCRAM_BUTTON) && !reactor->get_in_scram()) {
-      reactor->scram();
+    //
+    // The SCRAM comes first. The reactor is then copied as it was when the
+    // button was pressed, and the checksum only worked out when it's held
+    // long enough to be written to flash
+    if (!gpio_get(MAIN_PIN_SCRAM_BUTTON)) {
+      if (!reactor->get_in_scram()) {
+        reactor->scram();
+      }
+
+      if (!scram_button_held) {
+        scram_button_held = true;
+        button_snapshot_written = false;
+        scram_button_pressed_time = current_time;
+        reactor->save_snapshot_unsealed(button_snapshot);
+      } else if (!button_snapshot_written &&
+                 absolute_time_diff_us(scram_button_pressed_time,
+                                       current_time) >=
+                     (int64_t)MAIN_SNAPSHOT_SAVE_HOLD_MS * 1000) {
+        Reactor::seal_snapshot(button_snapshot);
+        write_snapshot_to_flash(button_snapshot);
+        button_snapshot_written = true;
+      }
+    } else {
+      scram_button_held = false;
+    }
+
+    // Fired when the pulse button goes down, the reactor turns it down when
+    // it can't pulse
+    if (!gpio_get(MAIN_PIN_PULSE_BUTTON)) {
+      if (!pulse_button_held) {
+        pulse_button_held = true;
+        reactor->fire_pulse();
+      }
+    } else {
+      pulse_button_held = false;
     }
 
     reactor->scrams_enabled = gpio_get(MAIN_PIN_ENABLE_SCRAMS_SWITCH);
@@ -555,9 +819,9 @@ int main() {
     reactor->automatic_control = new_automatic_control;
 
     // 10x per second, send to UART
-    if (reactor->get_steps_elapsed() % 100 == 0) {
+    if (loops % (1000 / MAIN_TICKS_PER_LOOP) == 0) {
 
-      uint32_t thermal_power_watts = (uint32_t)reactor->calculate_power_watts();
+      uint32_t thermal_power_watts = (uint32_t)reactor->get_power_watts();
 		thermal_power_watts = std::clamp<uint32_t>(thermal_power_watts, 0, 999999);
 
       uart_putc(uart0, (char)(OPCODE_UPDATE_POWER));
@@ -585,7 +849,7 @@ int main() {
 
     intercore_memory.neutrons_in_core = reactor->get_neutrons_in_core();
     intercore_memory.reactivity_pcm = (int16_t)(reactor->get_reactivity_pcm());
-    intercore_memory.power_watts = reactor->calculate_power_watts();
+    intercore_memory.power_watts = reactor->get_power_watts();
 
     intercore_memory.safety_rod_current_position =
         reactor->get_safety_control_rod()->get_current_position();
@@ -596,10 +860,23 @@ int main() {
 
     intercore_memory.in_scram = reactor->get_in_scram();
 
+    PulseReport last_pulse = reactor->get_last_pulse();
+    intercore_memory.pulses_ended =
+        reactor->get_pulses_fired() - (reactor->get_pulse_in_progress() ? 1 : 0);
+    intercore_memory.last_pulse_peak_power_watts = last_pulse.peak_power_watts;
+    intercore_memory.last_pulse_energy_J = last_pulse.energy_J;
+    intercore_memory.last_pulse_peak_fuel_temperature_celcius =
+        last_pulse.peak_fuel_temperature_celcius;
+    intercore_memory.real_time_dropped_ms =
+        (uint32_t)(real_time_dropped_us / 1000);
+
     mutex_exit(&intercore_memory.reactor_data_mutex);
 
+    // The transient rod stays out for the pulse, whatever the potentiometers
+    // say
     mutex_enter_blocking(&intercore_memory.rod_target_positions_mutex);
-    if (!reactor->automatic_control && !reactor->get_in_scram()) {
+    if (!reactor->automatic_control && !reactor->get_in_scram() &&
+        !reactor->get_pulse_in_progress()) {
       reactor->get_safety_control_rod()->set_target_position(
           intercore_memory.safety_rod_target_position);
       reactor->get_regulating_control_rod()->set_target_position(
@@ -618,6 +895,45 @@ int main() {
 
     mutex_exit(&intercore_memory.rod_target_positions_mutex);
 
+    // Any input brings the reactor back to full rate for the next batch,
+    // without waiting out the rest of a quiescent tick
+    Reactor::ReactorInputs inputs = reactor->get_inputs();
+
+    if (reactor->get_quiescent() &&
+        (inputs != previous_inputs ||
+         reactor->scrams_enabled != previous_scrams_enabled ||
+         reactor->get_in_scram())) {
+      // A quiescent tick ahead of real time ran on without the input. The
+      // reactor goes back to before it, takes the input, SCRAM or pulse
+      // there, and the next batch ticks up to real time again at full rate
+      if (ticks_owed < 0) {
+        bool in_scram = reactor->get_in_scram();
+        bool pulse_in_progress = reactor->get_pulse_in_progress();
+
+        // note: 1e-4 seconds for each full rate tick
+        ticks_owed += (int32_t)std::lround(
+            (reactor->get_time_elapsed_seconds() -
+             state_before_quiescent_tick.time_elapsed_seconds) /
+            1e-4);
+
+        Reactor::ReactorInputs rolled_back_inputs = inputs;
+        rolled_back_inputs.scram = in_scram;
+
+        reactor->set_state(state_before_quiescent_tick);
+        reactor->set_inputs(rolled_back_inputs);
+
+        if (pulse_in_progress) {
+          reactor->fire_pulse();
+        }
+      }
+
+      reactor->leave_quiescence();
+    }
+
+    previous_inputs = inputs;
+    previous_scrams_enabled = reactor->scrams_enabled;
+    loops++;
+
     // Sleep until next loop
     sleep_until(next_loop_time);
   }
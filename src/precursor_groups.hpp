@@ -0,0 +1,245 @@
+#ifndef PRECURSOR_GROUPS_HPP
+#define PRECURSOR_GROUPS_HPP
+
+#include "constants.hpp"
+#include <array>
+#include <cmath>
+#include <stdint.h>
+
+/// How the precursor groups are moved forward by one time step
+enum class PrecursorIntegration {
+  /// Forward euler, Ci += dCi/dt * dt. Only accurate for small steps
+  EULER,
+  /// Exact solution of each group's linear equation over the step, with the
+  /// neutron population interpolated linearly from the start to the end of
+  /// the step
+  EXPONENTIAL,
+};
+
+/// The constants of the delayed neutron precursor groups, worked out once
+/// from the group data and kept with the rest of the parameters.
+///
+/// The group count is a template parameter, so both the 6 group data from
+/// table 1 and 8 group sets can be used. The constants are worked out in
+/// double first and then converted to Scalar
+template <uint8_t GROUPS, typename Scalar = double>
+struct PrecursorGroupConstants {
+  /// beta_i
+  std::array<Scalar, GROUPS> delayed_neutron_fractions;
+  /// lambda_i, used as 1/s
+  std::array<Scalar, GROUPS> decay_times;
+  /// The decay times before conversion, for PrecursorStepExponentials
+  std::array<double, GROUPS> decay_times_double;
+  /// beta_i / prompt neutron lifetime, the source term of each group
+  std::array<Scalar, GROUPS> fractions_over_lifetime;
+  /// The sum of all delayed neutron fractions, beta
+  Scalar effective_delayed_neutron_fraction;
+
+  /// Works out the constants from the delayed neutron fraction (beta_i) and
+  /// decay time (lambda_i, used as 1/s) of each group
+  static constexpr PrecursorGroupConstants
+  calculate(const std::array<double, GROUPS> &fractions,
+            const std::array<double, GROUPS> &times,
+            double prompt_neutron_lifetime_seconds) {
+    PrecursorGroupConstants constants = {};
+    constants.decay_times_double = times;
+
+    // "Delayed neutron fractions are directly used as a sum to calculate the
+    // effective delayed neutron fraction."
+    //
+    // This never changes, so only sum it once
+    double fraction_sum = 0.0;
+
+    for (uint8_t i = 0; i < GROUPS; i++) {
+      constants.delayed_neutron_fractions[i] = Scalar(fractions[i]);
+      constants.decay_times[i] = Scalar(times[i]);
+      constants.fractions_over_lifetime[i] =
+          Scalar(fractions[i] / prompt_neutron_lifetime_seconds);
+      fraction_sum += fractions[i];
+    }
+
+    constants.effective_delayed_neutron_fraction = Scalar(fraction_sum);
+
+    return constants;
+  }
+};
+
+/// The per step exponentials of PrecursorIntegration::EXPONENTIAL, for the
+/// time step they were last worked out for.
+///
+/// Always worked out in double, e^(-lambda dt) is too close to 1 for float
+template <uint8_t GROUPS, typename Scalar = double>
+struct PrecursorStepExponentials {
+  using Constants = PrecursorGroupConstants<GROUPS, Scalar>;
+
+  /// The step they're for, 0 before they're first worked out
+  double time_delta_seconds = 0.0;
+  /// e^(-lambda_i dt)
+  std::array<Scalar, GROUPS> decay_factors;
+  /// Weights of the start and end of step populations, when interpolated
+  std::array<Scalar, GROUPS> start_source_weights;
+  std::array<Scalar, GROUPS> end_source_weights;
+
+  /// Recalculates the exponentials for a time step, unless they're for it
+  /// already
+  void set_time_delta_seconds(double new_time_delta_seconds,
+                              const Constants &constants) {
+    if (new_time_delta_seconds == time_delta_seconds) {
+      return;
+    }
+
+    time_delta_seconds = new_time_delta_seconds;
+
+    for (uint8_t i = 0; i < GROUPS; i++) {
+      double decay_time = constants.decay_times_double[i];
+      double decay_per_step = decay_time * time_delta_seconds;
+      double fraction_over_lifetime =
+          (double)constants.fractions_over_lifetime[i];
+
+      // Ci(t + dt) = Ci(t) * e^(-lambda dt) + a * integral of
+      // e^(-lambda (dt - s)) N(t + s) ds over the step, a = beta_i / lifetime
+      decay_factors[i] = Scalar(std::exp(-decay_per_step));
+
+      // Integral of e^(-lambda (dt - s)) ds, (1 - e^(-lambda dt)) / lambda,
+      // the weight of a constant population
+      double constant_source_integral =
+          -std::expm1(-decay_per_step) / decay_time;
+
+      // Integral of e^(-lambda (dt - s)) s / dt ds, the weight of the end of
+      // step population when it's interpolated linearly
+      double linear_source_integral =
+          time_delta_seconds * calculate_phi_2(decay_per_step);
+
+      double source_weight = fraction_over_lifetime * constant_source_integral;
+      double end_source_weight =
+          fraction_over_lifetime * linear_source_integral;
+
+      end_source_weights[i] = Scalar(end_source_weight);
+      start_source_weights[i] = Scalar(source_weight - end_source_weight);
+    }
+  }
+
+  /// Drops the exponentials, for when the constants changed
+  void clear() { time_delta_seconds = 0.0; }
+
+protected:
+  /// (e^(-x) - 1 + x) / x^2, without the cancellation for small x
+  static double calculate_phi_2(double x) {
+    if (x < 1e-3) {
+      return 0.5 - x / 6.0 + x * x / 24.0 - x * x * x / 120.0;
+    }
+
+    return (std::expm1(-x) + x) / (x * x);
+  }
+};
+
+/// Populations of the delayed neutron precursor groups, Ci(t).
+///
+/// Only the populations change as the reactor runs. The constants of each
+/// group are kept apart, with the rest of the parameters, and are passed in.
+/// All the loops below have a fixed trip count the compiler can unroll or
+/// vectorize, and the populations and per step math use Scalar.
+///
+/// See the second kinetic point equation in
+/// https://www.sciencedirect.com/science/article/pii/S0306454920303285#t0005
+template <uint8_t GROUPS, typename Scalar = double> class PrecursorGroups {
+public:
+  using Constants = PrecursorGroupConstants<GROUPS, Scalar>;
+  using StepExponentials = PrecursorStepExponentials<GROUPS, Scalar>;
+
+  static constexpr uint8_t get_group_count() { return GROUPS; }
+
+  /// Gets the population of a group, between 0 and GROUPS - 1
+  Scalar get_population(uint8_t i) { return populations[i]; }
+  /// Sets the population of a group, between 0 and GROUPS - 1
+  void set_population(uint8_t i, Scalar population) {
+    populations[i] = population;
+    compensations[i] = Scalar(0.0);
+  }
+  /// Takes a fraction of every population away, Ci -= Ci * fraction.
+  ///
+  /// Unlike multiplying by 1 - fraction, tiny fractions don't get rounded
+  void shrink_populations(Scalar fraction) {
+    for (uint8_t i = 0; i < GROUPS; i++) {
+      populations[i] -= populations[i] * fraction;
+    }
+  }
+
+  /// Calculates the neutrons the precursors emit per second, the sum of
+  /// lambda_i * Ci(t) in the first kinetic point equation
+  Scalar calculate_delayed_neutron_source(const Constants &constants) {
+    Scalar neutrons_from_population = Scalar(0.0);
+
+    for (uint8_t i = 0; i < GROUPS; i++) {
+      neutrons_from_population += constants.decay_times[i] * populations[i];
+    }
+
+    return neutrons_from_population;
+  }
+
+  /// Calculates the second kinetic point equation, dCi(t)/dt, for one group
+  Scalar calculate_dCi_dt(uint8_t i, Scalar neutrons_in_core,
+                          const Constants &constants) {
+    return constants.fractions_over_lifetime[i] * neutrons_in_core -
+           constants.decay_times[i] * populations[i];
+  }
+
+  /// Moves all groups forward by one forward euler step
+  void integrate_euler(Scalar neutrons_in_core, Scalar time_delta_seconds,
+                       const Constants &constants) {
+    for (uint8_t i = 0; i < GROUPS; i++) {
+      populations[i] +=
+          (constants.fractions_over_lifetime[i] * neutrons_in_core -
+           constants.decay_times[i] * populations[i]) *
+          time_delta_seconds;
+    }
+  }
+
+  /// Moves all groups forward by one forward euler step, with the
+  /// populations relative to the neutrons, which changed by a factor of
+  /// 1 / (1 - shrink_fraction) over the step.
+  ///
+  /// In the relative form the populations hardly change from step to step, so
+  /// the same rounding would pile up every step. The changes are added with
+  /// compensated (Kahan) sums instead
+  void integrate_euler_relative(Scalar shrink_fraction,
+                                Scalar time_delta_seconds,
+                                const Constants &constants) {
+    for (uint8_t i = 0; i < GROUPS; i++) {
+      // Relative to the end of step neutrons
+      Scalar shrink = populations[i] * shrink_fraction;
+
+      Scalar change = (constants.fractions_over_lifetime[i] -
+                       constants.decay_times[i] * (populations[i] - shrink)) *
+                          time_delta_seconds -
+                      shrink - compensations[i];
+      Scalar sum = populations[i] + change;
+
+      compensations[i] = (sum - populations[i]) - change;
+      populations[i] = sum;
+    }
+  }
+
+  /// Moves all groups forward by one step with the exact solution of their
+  /// equations, with the neutron population going linearly from its start of
+  /// step value to its end of step value. The same at both ends holds it
+  /// constant.
+  ///
+  /// Needs the exponentials to have been worked out for the step
+  void integrate_exponential(Scalar neutrons_at_start, Scalar neutrons_at_end,
+                             const StepExponentials &exponentials) {
+    for (uint8_t i = 0; i < GROUPS; i++) {
+      populations[i] = exponentials.decay_factors[i] * populations[i] +
+                       exponentials.start_source_weights[i] *
+                           neutrons_at_start +
+                       exponentials.end_source_weights[i] * neutrons_at_end;
+    }
+  }
+
+protected:
+  std::array<Scalar, GROUPS> populations = {};
+  /// What the compensated sums of integrate_euler_relative lost to rounding,
+  /// negated
+  std::array<Scalar, GROUPS> compensations = {};
+};
+#endif
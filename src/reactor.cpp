@@ -4,201 +4,636 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+BasicReactor<Scalar, CONFIGURATION>::BasicReactor()
+    : Model(Switches(), reactor_state, reactor_time_step_coefficients) {
+  point_model_at_members();
 
-Reactor::Reactor() {
 	// Note: change back to 4e6 at some point
-  safety_control_rod = ControlRod(0);
-  safety_control_rod.set_speed_steps_per_second(SAFETY_ROD_SPEED_PER_SECOND);
-  safety_control_rod.set_target_position(0);
+  state.safety_control_rod = ControlRod(0);
+  state.safety_control_rod.set_target_position(0);
+
+  state.regulating_control_rod = ControlRod(24e5);
+  state.regulating_control_rod.set_target_position(24e5);
+
+  state.compensating_control_rod = ControlRod(0);
+  state.compensating_control_rod.set_target_position(0);
+
+  set_control_rod_parameters(CONFIGURATION);
+  fuel_element_nodes.set_geometry(CONFIGURATION.fuel_elements_in_core,
+                                  CONFIGURATION.fuel_element_length_cm);
+
+  if constexpr (PARAMETERS_AT_RUNTIME) {
+    runtime_parameters = {CONFIGURATION, CONFIGURATION_COEFFICIENTS,
+                          POWER_EXCHANGED_APPROXIMATION<Math, CONFIGURATION>};
+    point_model_at_members();
+  }
+
+  update_derived_reactivity();
+  update_derived_power();
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+BasicReactor<Scalar, CONFIGURATION>::BasicReactor(const BasicReactor &other)
+    : Model(other, reactor_state, reactor_time_step_coefficients),
+      fuel_element_nodes(other.fuel_element_nodes),
+      runtime_parameters(other.runtime_parameters),
+      reactor_state(other.reactor_state),
+      reactor_time_step_coefficients(other.reactor_time_step_coefficients) {
+  target_thermal_power_watts = other.target_thermal_power_watts;
+  point_model_at_members();
+}
+
+/// The model only refers to the state and time step coefficients, which are
+/// this reactor's own whatever is copied
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+BasicReactor<Scalar, CONFIGURATION> &
+BasicReactor<Scalar, CONFIGURATION>::operator=(const BasicReactor &other) {
+  Switches::operator=(other);
+  target_thermal_power_watts = other.target_thermal_power_watts;
+  fuel_element_nodes = other.fuel_element_nodes;
+  runtime_parameters = other.runtime_parameters;
+  reactor_state = other.reactor_state;
+  reactor_time_step_coefficients = other.reactor_time_step_coefficients;
+  point_model_at_members();
+
+  return *this;
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactor<Scalar, CONFIGURATION>::point_model_at_members() {
+  fuel_elements = &fuel_element_nodes;
+
+  if constexpr (PARAMETERS_AT_RUNTIME) {
+    runtime_coefficients = &runtime_parameters.coefficients;
+    runtime_parameters.coefficients.power_exchanged_approximation =
+        &runtime_parameters.power_exchanged_approximation;
+  }
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+const typename BasicReactor<Scalar, CONFIGURATION>::Configuration &
+BasicReactor<Scalar, CONFIGURATION>::get_parameters() {
+  if constexpr (PARAMETERS_AT_RUNTIME) {
+    return runtime_parameters.parameters;
+  } else {
+    return CONFIGURATION;
+  }
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+const typename BasicReactorModel<Scalar, CONFIGURATION>::Coefficients &
+BasicReactorModel<Scalar, CONFIGURATION>::get_coefficients() {
+  if constexpr (PARAMETERS_AT_RUNTIME) {
+    return *runtime_coefficients;
+  } else {
+    return CONFIGURATION_COEFFICIENTS;
+  }
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+const PiecewiseCubic<typename BasicReactorModel<Scalar, CONFIGURATION>::Math, 256> &
+BasicReactorModel<Scalar, CONFIGURATION>::get_power_exchanged_approximation() {
+  if constexpr (PARAMETERS_AT_RUNTIME) {
+    return *runtime_coefficients->power_exchanged_approximation;
+  } else {
+    return POWER_EXCHANGED_APPROXIMATION<Math, CONFIGURATION>;
+  }
+}
+
+/// Switches to other parameters and works out everything derived from them
+///
+/// Everything a tick reads is in the coefficients and the control rods' worth,
+/// so those are all that need working out again. The precursor and decay heat
+/// groups keep their populations and energies, their constants are in the new
+/// coefficients
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactor<Scalar, CONFIGURATION>::apply_parameters(
+    const Configuration &parameters)
+  requires PARAMETERS_AT_RUNTIME
+{
+  runtime_parameters.parameters = parameters;
+  runtime_parameters.parameters.parameters_at_runtime = true;
+  runtime_parameters.power_exchanged_approximation =
+      calculate_power_exchanged_approximation(parameters)
+          .template convert<Math>();
+  runtime_parameters.coefficients = Coefficients::calculate(
+      parameters, &runtime_parameters.power_exchanged_approximation);
+
+  // Worked out from the old coefficients
+  time_step_coefficients.clear();
+
+  set_control_rod_parameters(parameters);
+
+  // The power map of the new core, the nodes start from the fuel temperature
+  // again
+  fuel_element_nodes.set_geometry(parameters.fuel_elements_in_core,
+                                  parameters.fuel_element_length_cm);
+  state.fuel_elements_current = false;
+
+  // The feedback coefficients changed even if the temperature didn't, and
+  // so did the xenon's worth
+  state.fuel_temperature_feedback_calculated = false;
+  state.xenon_worth_pcm =
+      Scalar(state.xenon_atoms_per_cm3 *
+             get_coefficients().xenon_pcm_per_atom_per_cm3);
+
+  update_derived_reactivity();
+  update_derived_power();
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::set_control_rod_parameters(
+    const Configuration &parameters) {
+  for (ControlRod *rod :
+       {&state.safety_control_rod, &state.regulating_control_rod,
+        &state.compensating_control_rod}) {
+    rod->set_full_worth_pcm(Scalar(parameters.control_rod_worth_pcm));
+  }
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+const typename BasicReactorModel<Scalar, CONFIGURATION>::ReactorState &
+BasicReactorModel<Scalar, CONFIGURATION>::get_state() {
+  return state;
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::set_state(
+    const ReactorState &new_state) {
+  state = new_state;
+  state.fuel_elements_current = false;
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+typename BasicReactor<Scalar, CONFIGURATION>::FuelElements *
+BasicReactor<Scalar, CONFIGURATION>::get_fuel_elements() {
+  return &fuel_element_nodes;
+}
+
+/// The CRC-32 of each byte on its own, worked out when compiling
+static constexpr std::array<uint32_t, 256> CRC32_TABLE = []() {
+  std::array<uint32_t, 256> table = {};
+
+  for (uint32_t byte = 0; byte < 256; byte++) {
+    uint32_t crc = byte;
+
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+
+    table[byte] = crc;
+  }
+
+  return table;
+}();
+
+/// CRC-32 (IEEE 802.3) of some bytes, a byte at a time with CRC32_TABLE
+static uint32_t calculate_crc32(const void *data, size_t size) {
+  const uint8_t *bytes = (const uint8_t *)data;
+  uint32_t crc = 0xFFFFFFFF;
+
+  for (size_t i = 0; i < size; i++) {
+    crc = (crc >> 8) ^ CRC32_TABLE[(crc ^ bytes[i]) & 0xFF];
+  }
+
+  return ~crc;
+}
+
+/// CRC-32 of the bytes of a snapshot before its checksum
+template <typename Snapshot>
+static uint32_t calculate_snapshot_checksum(const Snapshot &snapshot) {
+  const uint8_t *start = (const uint8_t *)&snapshot;
+  const uint8_t *checksum = (const uint8_t *)&snapshot.checksum;
+
+  return calculate_crc32(start, (size_t)(checksum - start));
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactor<Scalar, CONFIGURATION>::save_snapshot(
+    ReactorSnapshot &snapshot) {
+  save_snapshot_unsealed(snapshot);
+  seal_snapshot(snapshot);
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactor<Scalar, CONFIGURATION>::save_snapshot_unsealed(
+    ReactorSnapshot &snapshot) {
+  // Zeroed first, so the padding between the fields is saved as zeros
+  memset((void *)&snapshot, 0, sizeof(snapshot));
+
+  snapshot.magic = REACTOR_SNAPSHOT_MAGIC;
+  snapshot.version = REACTOR_SNAPSHOT_VERSION;
+  snapshot.size = sizeof(ReactorSnapshot);
+  snapshot.scalar_size = sizeof(Scalar);
+  snapshot.scalar_is_floating_point = std::is_floating_point_v<Scalar>;
+
+  snapshot.state = state;
+
+  std::array<ControlRod *, 3> rods = {&state.safety_control_rod,
+                                      &state.regulating_control_rod,
+                                      &state.compensating_control_rod};
+
+  for (uint8_t i = 0; i < 3; i++) {
+    rods[i]->get_worth_curve(snapshot.control_rod_worth_curves[i]);
+  }
+
+  snapshot.active_cooling_system_enabled = active_cooling_system_enabled;
+  snapshot.automatic_control = automatic_control;
+  snapshot.scrams_enabled = scrams_enabled;
+  snapshot.precursor_integration = precursor_integration;
+  snapshot.integrator = integrator;
+  snapshot.prompt_jump = prompt_jump;
+  snapshot.fuel_temperature_update_interval_ticks =
+      fuel_temperature_update_interval_ticks;
+  snapshot.water_temperature_update_interval_ticks =
+      water_temperature_update_interval_ticks;
+  snapshot.fuel_temperature_feedback_tolerance_celcius =
+      fuel_temperature_feedback_tolerance_celcius;
+  snapshot.approximate_thermal_math = approximate_thermal_math;
+  snapshot.adaptive_tick_rate = adaptive_tick_rate;
+  snapshot.xenon_poisoning = xenon_poisoning;
+  snapshot.decay_heat = decay_heat;
+  snapshot.fuel_element_temperatures = fuel_element_temperatures;
+  snapshot.target_thermal_power_watts = target_thermal_power_watts;
+
+  snapshot.parameters = get_parameters();
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactor<Scalar, CONFIGURATION>::seal_snapshot(
+    ReactorSnapshot &snapshot) {
+  snapshot.checksum = calculate_snapshot_checksum(snapshot);
+}
 
-  regulating_control_rod = ControlRod(24e5);
-  regulating_control_rod.set_speed_steps_per_second(
-      REGULATING_ROD_SPEED_PER_SECOND);
-  regulating_control_rod.set_target_position(24e5);
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+SnapshotStatus BasicReactor<Scalar, CONFIGURATION>::load_snapshot(
+    const ReactorSnapshot &snapshot) {
+  if (snapshot.magic != REACTOR_SNAPSHOT_MAGIC) {
+    return SnapshotStatus::NOT_A_SNAPSHOT;
+  }
+
+  if (snapshot.version != REACTOR_SNAPSHOT_VERSION) {
+    return SnapshotStatus::OTHER_VERSION;
+  }
+
+  if (snapshot.size != sizeof(ReactorSnapshot) ||
+      snapshot.scalar_size != sizeof(Scalar) ||
+      snapshot.scalar_is_floating_point != std::is_floating_point_v<Scalar>) {
+    return SnapshotStatus::OTHER_REACTOR;
+  }
+
+  if (snapshot.checksum != calculate_snapshot_checksum(snapshot)) {
+    return SnapshotStatus::CORRUPTED;
+  }
+
+  if constexpr (!PARAMETERS_AT_RUNTIME) {
+    if (!(snapshot.parameters == CONFIGURATION)) {
+      return SnapshotStatus::OTHER_PARAMETERS;
+    }
+  }
+
+  // The rods' curves go into this program's worth curves, which may be others
+  // than the ones of the program that saved it
+  std::array<ControlRod, 3> rods = {snapshot.state.safety_control_rod,
+                                    snapshot.state.regulating_control_rod,
+                                    snapshot.state.compensating_control_rod};
+
+  for (uint8_t i = 0; i < 3; i++) {
+    if (rods[i].get_worth_curve_loaded() &&
+        !rods[i].set_worth_curve_table(snapshot.control_rod_worth_curves[i])) {
+      return SnapshotStatus::TOO_MANY_WORTH_CURVES;
+    }
+  }
+
+  if constexpr (PARAMETERS_AT_RUNTIME) {
+    // Works out the coefficients and the table again, the state saved with
+    // them replaces everything it sets in the state
+    apply_parameters(snapshot.parameters);
+  }
 
-  compensating_control_rod = ControlRod(0);
-  compensating_control_rod.set_speed_steps_per_second(
-      COMPENSATING_ROD_SPEED_PER_SECOND);
-  regulating_control_rod.set_target_position(0);
+  state = snapshot.state;
+  state.safety_control_rod = rods[0];
+  state.regulating_control_rod = rods[1];
+  state.compensating_control_rod = rods[2];
+  // The fuel element nodes aren't saved, they start from the fuel temperature
+  state.fuel_elements_current = false;
+
+  active_cooling_system_enabled = snapshot.active_cooling_system_enabled;
+  automatic_control = snapshot.automatic_control;
+  scrams_enabled = snapshot.scrams_enabled;
+  precursor_integration = snapshot.precursor_integration;
+  integrator = snapshot.integrator;
+  prompt_jump = snapshot.prompt_jump;
+  fuel_temperature_update_interval_ticks =
+      snapshot.fuel_temperature_update_interval_ticks;
+  water_temperature_update_interval_ticks =
+      snapshot.water_temperature_update_interval_ticks;
+  fuel_temperature_feedback_tolerance_celcius =
+      snapshot.fuel_temperature_feedback_tolerance_celcius;
+  approximate_thermal_math = snapshot.approximate_thermal_math;
+  adaptive_tick_rate = snapshot.adaptive_tick_rate;
+  xenon_poisoning = snapshot.xenon_poisoning;
+  decay_heat = snapshot.decay_heat;
+  fuel_element_temperatures = snapshot.fuel_element_temperatures;
+  target_thermal_power_watts = snapshot.target_thermal_power_watts;
+
+  return SnapshotStatus::LOADED;
 }
 
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+typename BasicReactorModel<Scalar, CONFIGURATION>::ReactorInputs
+BasicReactorModel<Scalar, CONFIGURATION>::get_inputs() {
+  return {
+      .control_rod_target_positions =
+          {state.safety_control_rod.get_target_position(),
+           state.regulating_control_rod.get_target_position(),
+           state.compensating_control_rod.get_target_position()},
+      .target_thermal_power_watts = target_thermal_power_watts,
+      .automatic_control = automatic_control,
+      .active_cooling_system_enabled = active_cooling_system_enabled,
+      .scram = false,
+  };
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::set_inputs(
+    const ReactorInputs &inputs) {
+  state.safety_control_rod.set_target_position(
+      inputs.control_rod_target_positions[0]);
+  state.regulating_control_rod.set_target_position(
+      inputs.control_rod_target_positions[1]);
+  state.compensating_control_rod.set_target_position(
+      inputs.control_rod_target_positions[2]);
+
+  target_thermal_power_watts = inputs.target_thermal_power_watts;
+  automatic_control = inputs.automatic_control;
+  active_cooling_system_enabled = inputs.active_cooling_system_enabled;
+
+  if (inputs.scram && !state.in_scram) {
+    scram();
+  }
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+BasicReactorModel<Scalar, CONFIGURATION>::BasicReactorModel(
+    const Switches &switches, ReactorState &state,
+    TimeStepCoefficients &time_step_coefficients)
+    : Switches(switches), state(state),
+      time_step_coefficients(time_step_coefficients) {}
+
+/// A model of the state on the stack, only a few pointers and the switches,
+/// with time step coefficients of its own. They're only worked out for what
+/// the tick uses, and the same as a reactor's for the same step
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+bool BasicReactorModel<Scalar, CONFIGURATION>::step(
+    const Coefficients &coefficients, const Switches &switches,
+    const ReactorState &from, const ReactorInputs &inputs, ReactorState &to) {
+  if (switches.fuel_element_temperatures) {
+    return false;
+  }
+
+  if constexpr (!PARAMETERS_AT_RUNTIME) {
+    if (&coefficients != &CONFIGURATION_COEFFICIENTS) {
+      return false;
+    }
+  }
+
+  if (&to != &from) {
+    to = from;
+  }
+
+  TimeStepCoefficients time_step_coefficients;
+  BasicReactorModel model(switches, to, time_step_coefficients);
+  model.runtime_coefficients = &coefficients;
+  model.set_inputs(inputs);
+  model.tick();
 
+  // Nodes only a BasicReactor has
+  to.fuel_elements_current = false;
+
+  return true;
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+bool BasicReactor<Scalar, CONFIGURATION>::step(const ReactorState &from,
+                                               const ReactorInputs &inputs,
+                                               ReactorState &to) const {
+  if constexpr (PARAMETERS_AT_RUNTIME) {
+    return step(runtime_parameters.coefficients, *this, from, inputs, to);
+  } else {
+    return step(CONFIGURATION_COEFFICIENTS, *this, from, inputs, to);
+  }
+}
 
-ControlRod *Reactor::get_safety_control_rod() { return &safety_control_rod; }
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+typename BasicReactorModel<Scalar, CONFIGURATION>::ControlRod *
+BasicReactorModel<Scalar, CONFIGURATION>::get_safety_control_rod() {
+  return &state.safety_control_rod;
+}
 
-ControlRod *Reactor::get_regulating_control_rod() {
-  return &regulating_control_rod;
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+typename BasicReactorModel<Scalar, CONFIGURATION>::ControlRod *
+BasicReactorModel<Scalar, CONFIGURATION>::get_regulating_control_rod() {
+  return &state.regulating_control_rod;
 }
 
-ControlRod *Reactor::get_compensating_control_rod() {
-  return &compensating_control_rod;
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+typename BasicReactorModel<Scalar, CONFIGURATION>::ControlRod *
+BasicReactorModel<Scalar, CONFIGURATION>::get_compensating_control_rod() {
+  return &state.compensating_control_rod;
 }
 
 /// Same as compensating control rod
-ControlRod *Reactor::get_shim_control_rod() {
-  return &compensating_control_rod;
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+typename BasicReactorModel<Scalar, CONFIGURATION>::ControlRod *
+BasicReactorModel<Scalar, CONFIGURATION>::get_shim_control_rod() {
+  return &state.compensating_control_rod;
 }
 
 /// Sets the power the RCS should try to keep the reactor at
-void Reactor::set_target_thermal_power_watts(uint32_t target) {
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::set_target_thermal_power_watts(
+    uint32_t target) {
   target_thermal_power_watts = target;
 }
 
 /// Gets the power the RCS is trying to keep the reactor at
-uint32_t Reactor::get_target_thermal_power_watts() {
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+uint32_t BasicReactorModel<Scalar, CONFIGURATION>::get_target_thermal_power_watts() {
   return target_thermal_power_watts;
 }
 
-float Reactor::get_time_delta_seconds() { return time_delta_seconds; }
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+float BasicReactorModel<Scalar, CONFIGURATION>::get_time_delta_seconds() {
+  return state.time_delta_seconds;
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::set_time_delta_seconds(
+    float new_time_delta_s) {
+  // The new step is the full rate one
+  leave_quiescence();
+  change_time_delta_seconds(new_time_delta_s);
+  state.adaptive_time_delta_seconds = 0.0;
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+float BasicReactorModel<Scalar, CONFIGURATION>::get_adaptive_time_delta_seconds() {
+  return state.adaptive_time_delta_seconds;
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::change_time_delta_seconds(
+    float new_time_delta_s) {
+  Scalar old_time_delta_seconds = Scalar(state.time_delta_seconds);
+  state.time_delta_seconds = new_time_delta_s;
 
-void Reactor::set_time_delta_seconds(float new_time_delta_s) {
-  time_delta_seconds = new_time_delta_s;
+  // The time step coefficients follow the step by themselves, the rods'
+  // velocities are per step
+  rescale_control_rod_velocities(old_time_delta_seconds,
+                                 Scalar(state.time_delta_seconds));
 }
 
-double Reactor::get_time_elapsed_seconds() {
-  return (double)steps_elapsed * (double)time_delta_seconds;
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+double BasicReactorModel<Scalar, CONFIGURATION>::get_time_elapsed_seconds() {
+  return state.time_elapsed_seconds;
 }
 
-uint64_t Reactor::get_steps_elapsed() { return steps_elapsed; }
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+uint64_t BasicReactorModel<Scalar, CONFIGURATION>::get_steps_elapsed() {
+  return state.steps_elapsed;
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar BasicReactorModel<Scalar, CONFIGURATION>::get_fuel_temperature_celcius() {
+  return state.fuel_temperature_celcius;
+}
 
-double Reactor::get_fuel_temperature_celcius() {
-  return fuel_temperature_celcius;
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar BasicReactorModel<Scalar, CONFIGURATION>::get_water_temperature_celcius() {
+  return state.water_temperature_celcius;
 }
 
-double Reactor::get_water_temperature_celcius() {
-  return water_temperature_celcius;
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar
+BasicReactorModel<Scalar, CONFIGURATION>::get_hottest_fuel_temperature_celcius() {
+  if (fuel_element_temperatures && state.fuel_elements_current) {
+    return Scalar(fuel_elements->get_hottest_temperature_celcius());
+  }
+
+  return state.fuel_temperature_celcius;
 }
 
-double Reactor::get_reactivity_pcm() { return reactivity_pcm; }
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar BasicReactorModel<Scalar, CONFIGURATION>::get_reactivity_pcm() {
+  return state.reactivity_pcm;
+}
 
-double Reactor::get_reactivity_no_units() { return reactivity_pcm * 1e-5; }
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar BasicReactorModel<Scalar, CONFIGURATION>::get_reactivity_no_units() {
+  return state.reactivity_pcm * Scalar(1e-5);
+}
 
-double Reactor::get_neutrons_in_core() { return neutrons_in_core; }
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+double BasicReactorModel<Scalar, CONFIGURATION>::get_neutrons_in_core() {
+  return (double)state.neutrons_in_core * Traits::NEUTRONS_PER_UNIT;
+}
 
-bool Reactor::get_in_scram() { return in_scram; }
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+bool BasicReactorModel<Scalar, CONFIGURATION>::get_in_scram() {
+  return state.in_scram;
+}
 
-bool Reactor::get_active_cooling_system_enabled() {
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+bool BasicReactorModel<Scalar, CONFIGURATION>::get_active_cooling_system_enabled() {
   return active_cooling_system_enabled;
 }
 
-void Reactor::set_active_cooling_system_enabled(bool enabled) {
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::set_active_cooling_system_enabled(
+    bool enabled) {
   active_cooling_system_enabled = enabled;
 }
 
-uint64_t Reactor::get_steps_since_scram_started() {
-  return steps_elapsed - step_scram_started;
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+uint64_t BasicReactorModel<Scalar, CONFIGURATION>::get_steps_since_scram_started() {
+  return state.steps_elapsed - state.step_scram_started;
 }
 
-double Reactor::get_neutron_population_for_group(uint8_t group) {
-  switch (group) {
-  case 1:
-    return neutron_population_group_1;
-    break;
-  case 2:
-    return neutron_population_group_2;
-    break;
-  case 3:
-    return neutron_population_group_3;
-    break;
-  case 4:
-    return neutron_population_group_4;
-    break;
-  case 5:
-    return neutron_population_group_5;
-    break;
-  case 6:
-    return neutron_population_group_6;
-    break;
-  default:
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+double BasicReactorModel<Scalar, CONFIGURATION>::get_neutron_population_for_group(
+    uint8_t group) {
+  if (group < 1 || group > GROUPS) {
     return 0.0;
-    break;
   }
+
+  if (state.logarithmic_neutron_population) {
+    return (double)state.precursor_groups.get_population(group - 1) *
+           std::exp((double)state.log_neutrons_in_core -
+                    (double)state.log_neutrons_in_core_compensation);
+  }
+
+  return (double)state.precursor_groups.get_population(group - 1) *
+         Traits::NEUTRONS_PER_UNIT;
 }
 
-double Reactor::get_delayed_neutron_fraction_for_group(uint8_t group) {
-  switch (group) {
-  case 1:
-    return DELAYED_NEUTRON_FRACTION_GROUP_1;
-    break;
-  case 2:
-    return DELAYED_NEUTRON_FRACTION_GROUP_2;
-    break;
-  case 3:
-    return DELAYED_NEUTRON_FRACTION_GROUP_3;
-    break;
-  case 4:
-    return DELAYED_NEUTRON_FRACTION_GROUP_4;
-    break;
-  case 5:
-    return DELAYED_NEUTRON_FRACTION_GROUP_5;
-    break;
-  case 6:
-    return DELAYED_NEUTRON_FRACTION_GROUP_6;
-    break;
-  default:
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar
+BasicReactorModel<Scalar, CONFIGURATION>::get_delayed_neutron_fraction_for_group(
+    uint8_t group) {
+  if (group < 1 || group > GROUPS) {
     return 0.0;
-    break;
   }
+
+  return get_coefficients()
+      .precursor_groups.delayed_neutron_fractions[group - 1];
 }
 
-double Reactor::get_neutron_decay_time_for_group(uint8_t group) {
-  switch (group) {
-  case 1:
-    return DECAY_TIME_GROUP_1;
-    break;
-  case 2:
-    return DECAY_TIME_GROUP_2;
-    break;
-  case 3:
-    return DECAY_TIME_GROUP_3;
-    break;
-  case 4:
-    return DECAY_TIME_GROUP_4;
-    break;
-  case 5:
-    return DECAY_TIME_GROUP_5;
-    break;
-  case 6:
-    return DECAY_TIME_GROUP_6;
-    break;
-  default:
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar BasicReactorModel<Scalar, CONFIGURATION>::get_neutron_decay_time_for_group(
+    uint8_t group) {
+  if (group < 1 || group > GROUPS) {
     return 0.0;
-    break;
   }
+
+  return get_coefficients().precursor_groups.decay_times[group - 1];
 }
 
 // Physical steps
 /// Calculates the first kinetic point equation, dN(t)/dt
-double Reactor::calculate_dN_dt() {
-  double neutrons_from_activity = NEUTRON_SOURCE_INTENSITY_NEUTRONS_PER_SECOND;
-
-  double neutrons_from_population =
-      DECAY_TIME_GROUP_1 * neutron_population_group_1;
-  neutrons_from_population += DECAY_TIME_GROUP_2 * neutron_population_group_2;
-  neutrons_from_population += DECAY_TIME_GROUP_3 * neutron_population_group_3;
-  neutrons_from_population += DECAY_TIME_GROUP_4 * neutron_population_group_4;
-  neutrons_from_population += DECAY_TIME_GROUP_5 * neutron_population_group_5;
-  neutrons_from_population += DECAY_TIME_GROUP_6 * neutron_population_group_6;
-
-  // "Delayed neutron fractions are directly used as a sum to calculate the
-  // effective delayed neutron fraction."
-  double effective_delayed_neutron_fraction =
-      DELAYED_NEUTRON_FRACTION_GROUP_1 + DELAYED_NEUTRON_FRACTION_GROUP_2 +
-      DELAYED_NEUTRON_FRACTION_GROUP_3 + DELAYED_NEUTRON_FRACTION_GROUP_4 +
-      DELAYED_NEUTRON_FRACTION_GROUP_5 + DELAYED_NEUTRON_FRACTION_GROUP_6;
-
-  double reactivity_no_unit = get_reactivity_no_units();
-
-  double balanced_reactivity =
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar BasicReactorModel<Scalar, CONFIGURATION>::calculate_dN_dt() {
+  if (state.logarithmic_neutron_population) {
+    return state.neutrons_in_core * calculate_logarithmic_dN_dt();
+  }
+
+  Scalar neutrons_from_activity =
+      get_coefficients().source_neutron_units_per_second;
+
+  Scalar neutrons_from_population =
+      state.precursor_groups.calculate_delayed_neutron_source(
+          get_coefficients().precursor_groups);
+
+  // Summed once with the coefficients
+  Scalar effective_delayed_neutron_fraction =
+      get_coefficients().precursor_groups.effective_delayed_neutron_fraction;
+
+  Scalar reactivity_no_unit = get_reactivity_no_units();
+
+  Scalar balanced_reactivity =
       reactivity_no_unit - effective_delayed_neutron_fraction;
 
-  double neutron_multiplier =
-      balanced_reactivity / PROMPT_NEUTRON_LIFETIME_SECONDS;
+  Scalar neutron_multiplier =
+      balanced_reactivity / get_coefficients().prompt_neutron_lifetime_seconds;
 
-  double current_neutrons_times_stuff = neutrons_in_core * neutron_multiplier;
+  Scalar current_neutrons_times_stuff =
+      state.neutrons_in_core * neutron_multiplier;
 
   /*printf("dN/dt => Nc = %f; balanced Rho = %f, mult = %f, Nc' = %f \n",
-         neutrons_in_core, balanced_reactivity, neutron_multiplier,
+         state.neutrons_in_core, balanced_reactivity, neutron_multiplier,
          current_neutrons_times_stuff);
   printf("dN/dt => N' = Nc' (%f) + CN (%f) + An (%f) \n",
          current_neutrons_times_stuff, neutrons_from_population,
@@ -209,10 +644,10 @@ double Reactor::calculate_dN_dt() {
   printf("dN => %f / %f s = %f \n",
          current_neutrons_times_stuff + neutrons_from_population +
              neutrons_from_activity,
-         time_delta_seconds,
+         state.time_delta_seconds,
          (current_neutrons_times_stuff + neutrons_from_population +
           neutrons_from_activity) *
-             time_delta_seconds);*/
+             state.time_delta_seconds);*/
 
   return current_neutrons_times_stuff + neutrons_from_population +
          neutrons_from_activity;
@@ -220,67 +655,260 @@ double Reactor::calculate_dN_dt() {
 
 /// Calculates the second kinetic point equation, dCi(t)/dt, which represents
 /// the neutron populations of individual groups
-double Reactor::calculate_dCi_dt(uint8_t i) {
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar BasicReactorModel<Scalar, CONFIGURATION>::calculate_dCi_dt(uint8_t i) {
+  if (i < 1 || i > GROUPS) {
+    return 0.0;
+  }
+
+  const auto &constants = get_coefficients().precursor_groups;
+
+  if (state.logarithmic_neutron_population) {
+    return state.precursor_groups.calculate_dCi_dt(i - 1, Scalar(1.0),
+                                                   constants) *
+           state.neutrons_in_core;
+  }
+
+  return state.precursor_groups.calculate_dCi_dt(i - 1, state.neutrons_in_core,
+                                                 constants);
+}
+
+/// Calculates the neutrons in the core with the prompt jump approximation,
+/// solving the first kinetic point equation for dN(t)/dt = 0
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar BasicReactorModel<Scalar, CONFIGURATION>::calculate_prompt_jump_neutrons() {
+  const auto &constants = get_coefficients().precursor_groups;
+
+  if (state.logarithmic_neutron_population) {
+    return calculate_prompt_jump_neutrons(
+        state.precursor_groups.calculate_delayed_neutron_source(constants) *
+        state.neutrons_in_core);
+  }
+
+  return calculate_prompt_jump_neutrons(
+      state.precursor_groups.calculate_delayed_neutron_source(constants));
+}
 
-  double delayed_neutron_fraction = get_delayed_neutron_fraction_for_group(i);
+/// Calculates the prompt jump neutrons for a given delayed neutron source
+///
+/// With a prompt neutron lifetime of zero, the first kinetic point equation
+/// becomes N = lifetime * (sum of lambda_i Ci + S) / (beta - rho)
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar BasicReactorModel<Scalar, CONFIGURATION>::calculate_prompt_jump_neutrons(
+    Scalar delayed_neutron_source) {
+  Scalar effective_delayed_neutron_fraction =
+      get_coefficients().precursor_groups.effective_delayed_neutron_fraction;
+
+  const Coefficients &coefficients = get_coefficients();
+
+  return coefficients.prompt_neutron_lifetime_seconds *
+         (delayed_neutron_source +
+          coefficients.source_neutron_units_per_second) /
+         (effective_delayed_neutron_fraction - get_reactivity_no_units());
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+bool BasicReactorModel<Scalar, CONFIGURATION>::get_prompt_jump_active() {
+  return state.prompt_jump_active;
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::set_logarithmic_neutron_population(
+    bool enabled) {
+  if (enabled && !state.logarithmic_neutron_population) {
+    convert_to_logarithmic_neutron_population();
+  } else if (!enabled && state.logarithmic_neutron_population) {
+    convert_to_linear_neutron_population();
+  }
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+bool BasicReactorModel<Scalar, CONFIGURATION>::get_logarithmic_neutron_population() {
+  return state.logarithmic_neutron_population;
+}
+
+/// Calculates the relative rate of change of the neutrons, dN(t)/dt / N(t),
+/// which is the rate of change of ln(N(t))
+///
+/// The first kinetic point equation divided by N, with the precursors
+/// already relative to N
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar BasicReactorModel<Scalar, CONFIGURATION>::calculate_logarithmic_dN_dt() {
+  Scalar balanced_reactivity =
+      get_reactivity_no_units() -
+      get_coefficients().precursor_groups.effective_delayed_neutron_fraction;
+
+  // S / N, in float for fixed point as the source dwarfs a few neutrons
+  Scalar activity_per_neutron =
+      Scalar(get_coefficients().source_neutrons_per_second *
+             std::exp(-Math(state.log_neutrons_in_core)));
+
+  return balanced_reactivity /
+             get_coefficients().prompt_neutron_lifetime_seconds +
+         state.precursor_groups.calculate_delayed_neutron_source(
+             get_coefficients().precursor_groups) +
+         activity_per_neutron;
+}
+
+/// Moves the kinetics forward by one forward euler step, in the logarithmic
+/// representation
+///
+/// The same step as the linear one, N(t + dt) = N(t) (1 + dN/dt / N dt),
+/// taken as ln(N(t + dt)) = ln(N(t)) + ln(1 + dN/dt / N dt)
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::integrate_logarithmic_kinetics() {
+  Scalar relative_change =
+      calculate_logarithmic_dN_dt() * Scalar(state.time_delta_seconds);
+
+  // Compensated (Kahan) sum, ln(N) goes up to about 35 so a float would
+  // round away most of each step's change
+  Scalar log_change = Scalar(std::log1p(Math(relative_change))) -
+                      state.log_neutrons_in_core_compensation;
+  Scalar log_neutrons_at_step_end = state.log_neutrons_in_core + log_change;
+
+  state.log_neutrons_in_core_compensation =
+      (log_neutrons_at_step_end - state.log_neutrons_in_core) - log_change;
+  state.log_neutrons_in_core = log_neutrons_at_step_end;
+
+  // Relative to the end of step neutrons, the start of step neutrons and the
+  // precursors are N(t) / N(t + dt) = 1 - x / (1 + x) of what they were, with
+  // x the relative change. Only taking the x / (1 + x) away keeps it from
+  // being rounded every step
+  Scalar shrink_fraction =
+      relative_change / (Scalar(1.0) + relative_change);
+
+  if (precursor_integration == PrecursorIntegration::EULER) {
+    state.precursor_groups.integrate_euler_relative(
+        shrink_fraction, Scalar(state.time_delta_seconds),
+        get_coefficients().precursor_groups);
+  } else {
+    state.precursor_groups.shrink_populations(shrink_fraction);
+    integrate_precursor_groups(Scalar(1.0) - shrink_fraction, Scalar(1.0));
+  }
+
+  // e^(-compensation) is 1 - compensation to well below its rounding
+  state.neutrons_in_core = Scalar(
+      std::exp(Math(state.log_neutrons_in_core)) *
+      (Math(1.0) - Math(state.log_neutrons_in_core_compensation)) /
+      Math(Traits::NEUTRONS_PER_UNIT));
+}
+
+/// Switches to the logarithmic representation, from at least one neutron
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void
+BasicReactorModel<Scalar, CONFIGURATION>::convert_to_logarithmic_neutron_population() {
+  double neutrons =
+      std::max((double)state.neutrons_in_core * Traits::NEUTRONS_PER_UNIT, 1.0);
+
+  state.log_neutrons_in_core = Scalar(std::log(neutrons));
+  state.log_neutrons_in_core_compensation = Scalar(0.0);
+  state.neutrons_in_core = Scalar(neutrons / Traits::NEUTRONS_PER_UNIT);
+
+  for (uint8_t i = 0; i < GROUPS; i++) {
+    state.precursor_groups.set_population(
+        i, Scalar((double)state.precursor_groups.get_population(i) *
+                  Traits::NEUTRONS_PER_UNIT / neutrons));
+  }
 
-  double a = delayed_neutron_fraction / PROMPT_NEUTRON_LIFETIME_SECONDS;
+  state.logarithmic_neutron_population = true;
+  update_derived_power();
+}
 
-  double decay_time = get_neutron_decay_time_for_group(i);
-  double neutron_population = get_neutron_population_for_group(i);
+/// Switches back to integrating the neutrons themselves
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void
+BasicReactorModel<Scalar, CONFIGURATION>::convert_to_linear_neutron_population() {
+  double neutrons = std::exp((double)state.log_neutrons_in_core -
+                             (double)state.log_neutrons_in_core_compensation);
 
-  double neutrons = a * neutrons_in_core - decay_time * neutron_population;
+  state.neutrons_in_core = Scalar(neutrons / Traits::NEUTRONS_PER_UNIT);
 
-  /*printf("dCi/dt = a: %f, nic: %f, dec: %f, np: %f\n", a, neutrons_in_core,
-         decay_time, neutron_population);
-  printf("dCi/dt = a: %f, b: %f\n", a * neutrons_in_core,
-         decay_time * neutron_population);*/
+  for (uint8_t i = 0; i < GROUPS; i++) {
+    state.precursor_groups.set_population(
+        i, Scalar((double)state.precursor_groups.get_population(i) * neutrons /
+                  Traits::NEUTRONS_PER_UNIT));
+  }
 
-  return neutrons;
+  state.logarithmic_neutron_population = false;
+  update_derived_power();
 }
 
 /// Calculates the temperature dependent fuel capacity, marked as Cp(t)
-double Reactor::calculate_temperature_dependent_fuel_capacity_J_per_kgK(
-    double fuel_temperature_celcius) {
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar
+BasicReactorModel<Scalar, CONFIGURATION>::calculate_temperature_dependent_fuel_capacity_J_per_kgK(
+    Scalar fuel_temperature_celcius) {
+  if (approximate_thermal_math) {
+    return Scalar(FUEL_CAPACITY_J_PER_KG_K_C0) +
+           Scalar(FUEL_CAPACITY_J_PER_KG_K_C1) * fuel_temperature_celcius;
+  }
+
   // Their paper does fuel temperature as kelvin - 273 K
   // so literally
   // C + 273.15 K to get kelvin and then - 273 K
-  double fuel_temperature_sorta_kelvin = fuel_temperature_celcius + 0.15;
+  Scalar fuel_temperature_sorta_kelvin =
+      fuel_temperature_celcius + Scalar(0.15);
 
-  double result = 333     // J/kgK
-                  + 0.678 // J/kgK^2
+  Scalar result = Scalar(333)     // J/kgK
+                  + Scalar(0.678) // J/kgK^2
                         * fuel_temperature_sorta_kelvin;
   return result;
 }
 
 /// Calculates the temperature dependent fuel capacity, marked as Cp(t),
 /// normalized to the mass of the fuel
-double Reactor::calculate_temperature_dependent_fuel_capacity_J_per_K(
-    double fuel_temperature_celcius) {
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar
+BasicReactorModel<Scalar, CONFIGURATION>::calculate_temperature_dependent_fuel_capacity_J_per_K(
+    Scalar fuel_temperature_celcius) {
+  if (approximate_thermal_math) {
+    return get_coefficients().fuel_capacity_J_per_K_c0 +
+           get_coefficients().fuel_capacity_J_per_K_c1 *
+               fuel_temperature_celcius;
+  }
 
-  double J_per_kg_K = calculate_temperature_dependent_fuel_capacity_J_per_kgK(
+  Scalar J_per_kg_K = calculate_temperature_dependent_fuel_capacity_J_per_kgK(
       fuel_temperature_celcius);
 
   // In RSS/src/Simulator.cpp, L513, they multiply with 0.858??
 
-  double result_J_per_K = J_per_kg_K * FUEL_MASS_KG;
+  Scalar result_J_per_K =
+      J_per_kg_K * get_coefficients().fuel_mass_kg;
   return result_J_per_K;
 }
 
 /// Calculates the change to fuel temperature in one time step, in degrees
 /// celcius
-double Reactor::calculate_fuel_temperature_change_celcius() {
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar
+BasicReactorModel<Scalar, CONFIGURATION>::calculate_fuel_temperature_change_celcius() {
+  return calculate_fuel_temperature_change_celcius(state.time_delta_seconds);
+}
 
-  double Cp_J_per_K = calculate_temperature_dependent_fuel_capacity_J_per_K(
-      get_fuel_temperature_celcius());
+/// Calculates the change to fuel temperature over step_seconds at the current
+/// rates, in degrees celcius
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar
+BasicReactorModel<Scalar, CONFIGURATION>::calculate_fuel_temperature_change_celcius(
+    Scalar step_seconds) {
+  return calculate_fuel_temperature_change_celcius(
+      calculate_heat_watts() * step_seconds, step_seconds);
+}
+
+/// Calculates the change to fuel temperature over step_seconds, with the
+/// energy the reactor generated over those seconds, in degrees celcius
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar
+BasicReactorModel<Scalar, CONFIGURATION>::calculate_fuel_temperature_change_celcius(
+    Scalar thermal_power_generated_in_timestep_J, Scalar step_seconds) {
 
-  double thermal_power_generated_in_timestep_J =
-      (calculate_power_joules_per_second() * time_delta_seconds);
+  Scalar Cp_J_per_K = calculate_temperature_dependent_fuel_capacity_J_per_K(
+      get_fuel_temperature_celcius());
 
-  double power_exchanged_J = (calculate_power_exchanged_joule_per_second(
+  Scalar power_exchanged_J = (calculate_power_exchanged_joule_per_second(
                                   get_fuel_temperature_celcius()) *
-                              time_delta_seconds);
-  double difference_kelvin =
+                              step_seconds);
+  Scalar difference_kelvin =
       (thermal_power_generated_in_timestep_J - power_exchanged_J) / Cp_J_per_K;
 
   // printf("Fuel Generated: %.3e J\n", thermal_power_generated_in_timestep_J);
@@ -297,23 +925,31 @@ double Reactor::calculate_fuel_temperature_change_celcius() {
 /// https://www.sciencedirect.com/science/article/pii/S0306454920303285#t0005
 ///
 /// Always assumes the air is at 20 C, we ain't simulating air thermodynamics
-double Reactor::calculate_water_tank_to_air_convection_J_per_second() {
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar
+BasicReactorModel<Scalar, CONFIGURATION>::calculate_water_tank_to_air_convection_J_per_second() {
   auto air_temperature_celcius = 20;
 
   // If the air is hotter than the water, no convection will occur
-  if (air_temperature_celcius > water_temperature_celcius) {
+  if (air_temperature_celcius > state.water_temperature_celcius) {
     return 0.0;
   }
 
-  double temperature_delta_K =
-      water_temperature_celcius -
-      air_temperature_celcius; // They do it the other way around, it doesn't
-                               // matter since we raise it to a power of 4
+  Math temperature_delta_K = Math(
+      state.water_temperature_celcius -
+      air_temperature_celcius); // They do it the other way around, it doesn't
+                                // matter since we raise it to a power of 4
+
+  if (approximate_thermal_math &&
+      AIR_CONVECTION_APPROXIMATION<Math>.contains(temperature_delta_K)) {
+    return Scalar(
+        AIR_CONVECTION_APPROXIMATION<Math>.evaluate(temperature_delta_K));
+  }
 
-  double temperature_delta_to_the_3_4_K =
-      std::cbrt(std::pow(temperature_delta_K, 4)); // to the power of 4/3
+  Math temperature_delta_to_the_3_4_K =
+      std::cbrt(std::pow(temperature_delta_K, Math(4))); // to the power of 4/3
 
-  return 13.6 * temperature_delta_to_the_3_4_K;
+  return Scalar(Math(13.6) * temperature_delta_to_the_3_4_K);
 }
 
 /// Calculates the heat that is exchanged between the water in the reactor tank
@@ -323,9 +959,11 @@ double Reactor::calculate_water_tank_to_air_convection_J_per_second() {
 /// https://www.sciencedirect.com/science/article/pii/S0306454920303285#t0005
 ///
 /// Always assumes the concrete is at 20 C
-double Reactor::calculate_water_tank_to_conrete_heat_exchange_J_per_second() {
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar BasicReactorModel<Scalar, CONFIGURATION>::
+    calculate_water_tank_to_conrete_heat_exchange_J_per_second() {
 
-  double concrete_temperature_celcius = 20.0;
+  Scalar concrete_temperature_celcius = Scalar(20.0);
 
   // They do it the other way around, which I'm pretty sure is wrong if we later
   // use a minus
@@ -333,41 +971,59 @@ double Reactor::calculate_water_tank_to_conrete_heat_exchange_J_per_second() {
   // We're calculating how much went from the water to the concrete, so if water
   // > concrete it should be positive If we later did a plus and calculated the
   // change in the water, then we'd do it the other way around here
-  double temperature_delta_K =
-      water_temperature_celcius - concrete_temperature_celcius;
+  Scalar temperature_delta_K =
+      state.water_temperature_celcius - concrete_temperature_celcius;
 
-  return 250.0 * temperature_delta_K;
+  return Scalar(250.0) * temperature_delta_K;
 }
 
 /// Calculates the change to water tank temperature in one time step, in degress
 /// celcius
 ///
 /// Called after applying fuel_temperature_change_celcius
-double Reactor::calculate_water_temperature_change_celcius() {
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar
+BasicReactorModel<Scalar, CONFIGURATION>::calculate_water_temperature_change_celcius() {
+  return calculate_water_temperature_change_celcius(state.time_delta_seconds);
+}
 
-  double thermal_power_generated_in_timestep_J =
-      (calculate_power_joules_per_second() * time_delta_seconds);
+/// Calculates the change to water tank temperature over step_seconds at the
+/// current rates, in degress celcius
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar
+BasicReactorModel<Scalar, CONFIGURATION>::calculate_water_temperature_change_celcius(
+    Scalar step_seconds) {
+  return calculate_water_temperature_change_celcius(
+      calculate_heat_watts() * step_seconds, step_seconds);
+}
+
+/// Calculates the change to water tank temperature over step_seconds, with
+/// the energy the reactor generated over those seconds, in degress celcius
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar
+BasicReactorModel<Scalar, CONFIGURATION>::calculate_water_temperature_change_celcius(
+    Scalar thermal_power_generated_in_timestep_J, Scalar step_seconds) {
 
-  double convection_to_air_J =
-      calculate_water_tank_to_air_convection_J_per_second() *
-      time_delta_seconds;
+  Scalar convection_to_air_J =
+      calculate_water_tank_to_air_convection_J_per_second() * step_seconds;
 
-  double transfer_to_concrete_J =
+  Scalar transfer_to_concrete_J =
       calculate_water_tank_to_conrete_heat_exchange_J_per_second() *
-      time_delta_seconds;
+      step_seconds;
 
-  double cooling_from_active_cooling_system_J = 0;
+  Scalar cooling_from_active_cooling_system_J = 0;
 
   if (active_cooling_system_enabled) {
     cooling_from_active_cooling_system_J =
-        WATER_ACTIVE_COOLING_POWER_WATTS * time_delta_seconds;
+        get_coefficients().water_active_cooling_power_watts * step_seconds;
   }
 
-  double resultant_J = thermal_power_generated_in_timestep_J -
+  Scalar resultant_J = thermal_power_generated_in_timestep_J -
                        convection_to_air_J - transfer_to_concrete_J -
                        cooling_from_active_cooling_system_J;
 
-  double temperature_change_K = resultant_J / WATER_HEAT_CAPACITY_J_PER_K;
+  Scalar temperature_change_K =
+      resultant_J / get_coefficients().water_heat_capacity_J_per_K;
 
   // printf("Water Generated: %.3e J\n", thermal_power_generated_in_timestep_J);
   // printf("Water Convection to air: %.3e J\n", convection_to_air_J);
@@ -387,29 +1043,34 @@ double Reactor::calculate_water_temperature_change_celcius() {
 ///
 /// This was essentially stolen from RRS/src/simulator.cpp,
 /// Simulator::getCoolingFromTemperature (L521)
-double Reactor::calculate_power_exchanged_joule_per_second(
-    double fuel_temperature_celcius) {
-  double temperature_difference_kelvin =
-      water_temperature_celcius - fuel_temperature_celcius;
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar
+BasicReactorModel<Scalar, CONFIGURATION>::calculate_power_exchanged_joule_per_second(
+    Scalar fuel_temperature_celcius) {
+  Math temperature_difference_kelvin =
+      Math(state.water_temperature_celcius - fuel_temperature_celcius);
 
   // printf("T diff = %f C\n", temperature_difference_kelvin);
 
-  double first = TEMPERATURE_FE_STAT_A1 * TEMPERATURE_FE_STAT_A1 -
-                 3.0 * TEMPERATURE_FE_STAT_A0 * TEMPERATURE_FE_STAT_A2;
-  double second = 2.0 * TEMPERATURE_FE_STAT_A1 * TEMPERATURE_FE_STAT_A1 *
-                      TEMPERATURE_FE_STAT_A1 -
-                  9.0 * TEMPERATURE_FE_STAT_A0 * TEMPERATURE_FE_STAT_A1 *
-                      TEMPERATURE_FE_STAT_A2 +
-                  27.0 * TEMPERATURE_FE_STAT_A2 * TEMPERATURE_FE_STAT_A2 *
-                      temperature_difference_kelvin;
-  double root = std::cbrt(
-      (second + std::sqrt(second * second - 4.0 * first * first * first)) /
-      2.0);
-  double result = -FUEL_ELEMENTS_IN_CORE *
-                  (1.0 / (3.0 * TEMPERATURE_FE_STAT_A2)) *
-                  (TEMPERATURE_FE_STAT_A1 + root + (first / root));
+  if (approximate_thermal_math &&
+      get_power_exchanged_approximation().contains(
+          temperature_difference_kelvin)) {
+    return Scalar(get_power_exchanged_approximation().evaluate(
+        temperature_difference_kelvin));
+  }
 
-  return result;
+  const Coefficients &coefficients = get_coefficients();
+
+  Math first = coefficients.cardano_first;
+  Math second = coefficients.cardano_second_constant +
+                coefficients.cardano_second_per_K *
+                    temperature_difference_kelvin;
+  Math discriminant = second * second - Math(4.0) * first * first * first;
+  Math root = std::cbrt((second + std::sqrt(discriminant)) / Math(2.0));
+  Math result = coefficients.cardano_result_scale *
+                (coefficients.temperature_fe_stat_a1 + root + (first / root));
+
+  return Scalar(result);
 }
 
 /// Calcuates the temperature of the fuel element in stationary conditions,
@@ -417,41 +1078,37 @@ double Reactor::calculate_power_exchanged_joule_per_second(
 ///
 /// See fig 6
 /// https://www.sciencedirect.com/science/article/pii/S0306454920303285#b0070
-double Reactor::calculate_stationary_fuel_temperature() {
-  double power_normalized_joule_per_second =
-      calculate_normalized_power_joule_per_second();
-
-  return TEMPERATURE_FE_STAT_A0 * power_normalized_joule_per_second +
-         TEMPERATURE_FE_STAT_A1 * power_normalized_joule_per_second *
-             power_normalized_joule_per_second +
-         TEMPERATURE_FE_STAT_A2 * power_normalized_joule_per_second *
-             power_normalized_joule_per_second *
-             power_normalized_joule_per_second +
-         water_temperature_celcius;
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar
+BasicReactorModel<Scalar, CONFIGURATION>::calculate_stationary_fuel_temperature() {
+  return calculate_stationary_fuel_temperature(
+      get_coefficients(), get_power_watts(), state.water_temperature_celcius);
 }
 
 /// Calculates the power produced by each element, P_el
-double Reactor::calculate_normalized_power_joule_per_second() {
-  return calculate_power_joules_per_second() / FUEL_ELEMENTS_IN_CORE;
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar
+BasicReactorModel<Scalar, CONFIGURATION>::calculate_normalized_power_joule_per_second() {
+  return get_power_watts() / get_coefficients().fuel_elements_in_core;
 }
 
 /// Calculates the reactivity of the reactor
-double Reactor::calculate_reactivity_pcm() {
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar BasicReactorModel<Scalar, CONFIGURATION>::calculate_reactivity_pcm() {
 
-  double control_rod_worths_pcm =
-      safety_control_rod.calculate_worth_pcm() +
-      regulating_control_rod.calculate_worth_pcm() +
-      compensating_control_rod.calculate_worth_pcm();
+  Scalar control_rod_worths_pcm = calculate_control_rod_worths_pcm();
 
   // See RRS/src/Simulator.cpp:867 and RRS/src/Simulator.cpp:774
   // However they are doing some goofy things
-  double cold_core_reactivity_pcm =
-      EXCESS_REACTIVITY_PCM - control_rod_worths_pcm;
+  Scalar cold_core_reactivity_pcm =
+      get_coefficients().excess_reactivity_pcm - control_rod_worths_pcm;
 
-  double fuel_t_feedback_pcm = calculate_fuel_temperature_feedback_pcm();
+  Scalar fuel_t_feedback_pcm = calculate_fuel_temperature_feedback_pcm();
 
-  // Note: we don't model xenon poisoning
-  double reactivity_pcm = cold_core_reactivity_pcm - fuel_t_feedback_pcm;
+  // The xenon is only updated every XENON_UPDATE_INTERVAL_SECONDS, and 0
+  // without xenon_poisoning
+  Scalar reactivity_pcm =
+      (cold_core_reactivity_pcm - fuel_t_feedback_pcm) - state.xenon_worth_pcm;
 
   // printf("Rods: -%f pcm\n", control_rod_worths_pcm);
   // printf("Cold core: %f pcm\n", cold_core_reactivity_pcm);
@@ -462,134 +1119,625 @@ double Reactor::calculate_reactivity_pcm() {
   return reactivity_pcm;
 }
 
-/// Calculates the reactor power from the number of neutrons and constants
-double Reactor::calculate_power_MeV_per_second() {
-  // Stolen from
-  // <https://github.com/ijs-f8/Research-Reactor-Simulator/blob/dee250af1809909bb759b4381595a5a489fe5690/include/Simulator.h#L67C19-L67C31>
-  double macroscopic_cross_section_for_fission_1_per_meter = 0.56;
-
-  return neutrons_in_core * macroscopic_cross_section_for_fission_1_per_meter *
-         (double)NEUTRON_VELOCITY_METERS_PER_SECOND *
-         NEUTRON_FISSION_ENERGY_RELEASED_MEV;
-}
+/// Updates the reactivity, recalculating the control rod worths and the fuel
+/// temperature feedback it's made of when they changed
+///
+/// The same sums as calculate_reactivity_pcm, so with no tolerance the result
+/// is the same to the bit
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::update_derived_reactivity() {
+  using std::abs;
+
+  // The positions are compared rather than the rods marking themselves as
+  // moved, so rods moved from outside (main.cpp, the SCRAM, the Runge-Kutta
+  // restoring them) are caught too. Loading a worth curve changes the rod's
+  // curve revision
+  std::array<ControlRod *, 3> rods = {
+      &state.safety_control_rod, &state.regulating_control_rod,
+      &state.compensating_control_rod};
+  bool rods_moved = false;
+
+  for (uint8_t i = 0; i < 3; i++) {
+    uint32_t position = rods[i]->get_current_position();
+    uint32_t curve_revision = rods[i]->get_worth_curve_revision();
+
+    if (position != state.control_rod_positions_at_worths[i] ||
+        curve_revision != state.control_rod_curve_revisions_at_worths[i]) {
+      state.control_rod_positions_at_worths[i] = position;
+      state.control_rod_curve_revisions_at_worths[i] = curve_revision;
+      state.control_rod_worths_pcm[i] = rods[i]->calculate_worth_pcm();
+      state.reactivity_recalculations.control_rod_worths[i] += 1;
+      rods_moved = true;
+    }
+  }
 
-double Reactor::calculate_power_watts() {
+  if (rods_moved) {
+    state.derived_quantities.control_rod_worths_pcm =
+        state.control_rod_worths_pcm[0] + state.control_rod_worths_pcm[1] +
+        state.control_rod_worths_pcm[2];
+  }
 
-  double in_MeV_per_second = calculate_power_MeV_per_second();
+  if (!state.fuel_temperature_feedback_calculated ||
+      abs(state.fuel_temperature_celcius -
+          state.fuel_temperature_at_feedback_celcius) >
+          fuel_temperature_feedback_tolerance_celcius) {
+    state.fuel_temperature_at_feedback_celcius = state.fuel_temperature_celcius;
+    state.fuel_temperature_feedback_calculated = true;
+    state.derived_quantities.fuel_temperature_feedback_pcm =
+        calculate_fuel_temperature_feedback_pcm();
+    state.reactivity_recalculations.fuel_temperature_feedback += 1;
+  }
 
-  double MeV_per_second_to_watt = 1.6022e-13;
+  state.reactivity_recalculations.reactivity += 1;
 
-  return in_MeV_per_second * MeV_per_second_to_watt;
+  state.reactivity_pcm =
+      ((get_coefficients().excess_reactivity_pcm -
+        state.derived_quantities.control_rod_worths_pcm) -
+       state.derived_quantities.fuel_temperature_feedback_pcm) -
+      state.xenon_worth_pcm;
 }
 
-double Reactor::calculate_power_joules_per_second() {
-  // A joule per second is a watt
-  return calculate_power_watts();
+/// Calculates the worth of all three control rods, in pcm
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar BasicReactorModel<Scalar, CONFIGURATION>::calculate_control_rod_worths_pcm() {
+  return state.safety_control_rod.calculate_worth_pcm() +
+         state.regulating_control_rod.calculate_worth_pcm() +
+         state.compensating_control_rod.calculate_worth_pcm();
 }
 
-/// Calculates the reactor flux
-double Reactor::calculate_flux() {
-
-  double core_volume_cubic_centimeters =
-      CORE_VOLUME_LITERS * 10.0 * 10.0 * 10.0;
-
-  double neutron_velocity_cm_per_second =
-      NEUTRON_VELOCITY_METERS_PER_SECOND * 100.0;
+/// Recalculates the power and the flux, after the neutrons changed
+///
+/// Everything in a tick that needs the power reads it from here, instead of
+/// working it out again
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::update_derived_power() {
+  state.derived_quantities.power_watts = calculate_power_watts();
+  state.derived_quantities.power_MeV_per_second =
+      calculate_power_MeV_per_second();
+  state.derived_quantities.flux = calculate_flux();
+}
 
-  return neutrons_in_core *
-         (neutron_velocity_cm_per_second / core_volume_cubic_centimeters);
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar BasicReactorModel<Scalar, CONFIGURATION>::get_power_watts() {
+  return state.derived_quantities.power_watts;
 }
 
-/// Calculates the pcm feedback from the fuel temperature (based on the fuel
-/// temperature feedback coefficients)
-double Reactor::calculate_fuel_temperature_feedback_pcm() {
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+double BasicReactorModel<Scalar, CONFIGURATION>::get_power_MeV_per_second() {
+  return state.derived_quantities.power_MeV_per_second;
+}
 
-  // If cold, there is no feedback
-  if (fuel_temperature_celcius <= 0.0) {
-    return 0.0;
-  }
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+double BasicReactorModel<Scalar, CONFIGURATION>::get_flux() {
+  return state.derived_quantities.flux;
+}
 
-  // Between 0 and 240, linerally interpolate
-  if (fuel_temperature_celcius <= 240.0) {
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar BasicReactorModel<Scalar, CONFIGURATION>::get_control_rod_worths_pcm() {
+  return state.derived_quantities.control_rod_worths_pcm;
+}
 
-    double fraction_to_240_celcius = fuel_temperature_celcius / 240.0;
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar
+BasicReactorModel<Scalar, CONFIGURATION>::get_fuel_temperature_feedback_pcm() {
+  return state.derived_quantities.fuel_temperature_feedback_pcm;
+}
 
-    double coefficient_difference_pcm_per_c =
-        FUEL_T_FEEDBACK_COEFFICIENT_240_C_PCM_PER_C -
-        FUEL_T_FEEDBACK_COEFFICIENT_0_C_PCM_PER_C;
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar BasicReactorModel<Scalar, CONFIGURATION>::get_xenon_worth_pcm() {
+  return state.xenon_worth_pcm;
+}
 
-    return fuel_temperature_celcius *
-           (FUEL_T_FEEDBACK_COEFFICIENT_0_C_PCM_PER_C +
-            coefficient_difference_pcm_per_c * fraction_to_240_celcius);
-  }
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+double BasicReactorModel<Scalar, CONFIGURATION>::get_iodine_atoms_per_cm3() {
+  return state.iodine_atoms_per_cm3;
+}
 
-  // Above 240, calculate with peak
-  double how_far_above_240_celcius = fuel_temperature_celcius - 240.0;
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+double BasicReactorModel<Scalar, CONFIGURATION>::get_xenon_atoms_per_cm3() {
+  return state.xenon_atoms_per_cm3;
+}
 
-  double coefficient_at_temperature =
-      FUEL_T_FEEDBACK_COEFFICIENT_240_C_PCM_PER_C +
-      FUEL_T_FEEDBACK_COEFFICIENT_SLOPE_AFTER_PEAK_PCM_PER_C_SQUARED *
-          how_far_above_240_celcius;
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::set_fission_products_at_equilibrium(
+    Scalar power_watts) {
+  load_fission_products(calculate_fission_products_at_equilibrium(
+      get_coefficients(), power_watts));
+  set_decay_heat_at_equilibrium(power_watts);
 
-  return fuel_temperature_celcius * coefficient_at_temperature;
+  update_derived_reactivity();
 }
 
-void Reactor::tick() {
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::load_fission_products(
+    const FissionProducts &fission_products) {
+  state.iodine_atoms_per_cm3 = fission_products.iodine_atoms_per_cm3;
+  state.xenon_atoms_per_cm3 = fission_products.xenon_atoms_per_cm3;
+  state.xenon_worth_pcm = Scalar(fission_products.xenon_worth_pcm);
 
-  // https://www.sciencedirect.com/science/article/pii/S0306454920303285
-  //
-  // IJS Triga Reserach reactor simulator developer's manual:
-  //
-  // We won't calculate pulse mode
-  // 1. Re-calculate the fuel temperature based on power from the previous
-  fuel_temperature_celcius += calculate_fuel_temperature_change_celcius();
+  state.fission_products_energy_since_update_J = 0.0;
+  state.fission_products_seconds_since_update = 0.0;
+}
 
-  // 2. Move control rods
+/// The iodine is made by the fissions and decays into the xenon, which is
+/// also made by the fissions, decays, and burns up absorbing neutrons:
+///
+///   dI/dt = y_I F - l_I I
+///   dX/dt = y_X F + l_I I - (l_X + sigma_X flux) X
+///
+/// With the power held at its average both are linear with constant
+/// coefficients, and solved exactly over the interval
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::update_fission_products() {
+  const Coefficients &coefficients = get_coefficients();
+  double seconds = state.fission_products_seconds_since_update;
+  double power_watts = state.fission_products_energy_since_update_J / seconds;
+  double fissions_per_cm3_per_second =
+      power_watts * coefficients.fissions_per_cm3_per_joule;
+  double flux = power_watts * coefficients.thermal_flux_per_watt;
+
+  double iodine_decay = IODINE_135_DECAY_CONSTANT_PER_SECOND;
+  double xenon_removal = XENON_135_DECAY_CONSTANT_PER_SECOND +
+                         XENON_135_ABSORPTION_CROSS_SECTION_CM2 * flux;
+
+  double iodine_equilibrium =
+      IODINE_135_FISSION_YIELD * fissions_per_cm3_per_second / iodine_decay;
+  double xenon_equilibrium =
+      (XENON_135_FISSION_YIELD * fissions_per_cm3_per_second +
+       iodine_decay * iodine_equilibrium) /
+      xenon_removal;
+  double iodine_excess = state.iodine_atoms_per_cm3 - iodine_equilibrium;
+
+  double iodine_remaining = std::exp(-iodine_decay * seconds);
+  double xenon_remaining = std::exp(-xenon_removal * seconds);
+
+  // (exp(-l_I t) - exp(-(l_X + sigma_X flux) t)) / (l_X + sigma_X flux - l_I),
+  // with expm1 so it stays accurate where the two rates cross
+  double rate_difference = xenon_removal - iodine_decay;
+  double iodine_into_xenon_seconds =
+      rate_difference == 0.0
+          ? seconds * iodine_remaining
+          : iodine_remaining * -std::expm1(-rate_difference * seconds) /
+                rate_difference;
+
+  state.iodine_atoms_per_cm3 =
+      iodine_equilibrium + iodine_excess * iodine_remaining;
+  state.xenon_atoms_per_cm3 =
+      xenon_equilibrium +
+      (state.xenon_atoms_per_cm3 - xenon_equilibrium) * xenon_remaining +
+      iodine_decay * iodine_excess * iodine_into_xenon_seconds;
+  state.xenon_worth_pcm = Scalar(state.xenon_atoms_per_cm3 *
+                                 coefficients.xenon_pcm_per_atom_per_cm3);
+
+  state.fission_products_energy_since_update_J = 0.0;
+  state.fission_products_seconds_since_update = 0.0;
+}
 
-  // 2.1 to their target positions
-  safety_control_rod.move_towards_target(time_delta_seconds);
-  regulating_control_rod.move_towards_target(time_delta_seconds);
-  compensating_control_rod.move_towards_target(time_delta_seconds);
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar BasicReactorModel<Scalar, CONFIGURATION>::get_decay_heat_watts() {
+  return state.decay_heat_watts;
+}
 
-  // 2.2 to balance target power
-  if (!in_scram && automatic_control) {
-    balance_control_rods();
+/// Without decay_heat all of the power heats the fuel and water straight
+/// away, as in the paper
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar BasicReactorModel<Scalar, CONFIGURATION>::calculate_heat_watts() {
+  if (!decay_heat) {
+    return get_power_watts();
   }
 
-  // 3. Recalculate the reactivity
-  reactivity_pcm = calculate_reactivity_pcm();
+  return get_power_watts() * get_coefficients().prompt_heat_fraction +
+         state.decay_heat_watts;
+}
 
-  // 4. Numerically evaluate the point kinetic equations
+/// Every group's balance of update_decay_heat with nothing changing, so the
+/// power's prompt part and the decay heat add up to the power
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::set_decay_heat_at_equilibrium(
+    Scalar power_watts) {
+  const auto &constants = get_coefficients().decay_heat_groups;
+  state.decay_heat_groups.set_at_equilibrium((double)power_watts, constants);
+  state.decay_heat_watts =
+      Scalar(state.decay_heat_groups.calculate_decay_heat_watts(constants));
+
+  state.decay_heat_energy_since_update_J = 0.0;
+  state.decay_heat_seconds_since_update = 0.0;
+  state.decay_heat_microseconds_since_update = 0;
+}
 
-  // Uhmmm yes it's called numerical evaluation, didn't you know?
-  neutrons_in_core += calculate_dN_dt() * time_delta_seconds;
+/// The groups are linear with the power held at its average, and solved
+/// exactly over the interval. The decay heat is then held until the next
+/// update, at most DECAY_HEAT_UPDATE_INTERVAL_SECONDS later
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::update_decay_heat() {
+  double seconds = state.decay_heat_seconds_since_update;
+
+  const auto &constants = get_coefficients().decay_heat_groups;
+
+  // Cached, every interval at the full tick rate is the same length
+  auto &exponentials = time_step_coefficients.decay_heat_interval_exponentials;
+  exponentials.set_interval_seconds(seconds, constants);
+  state.decay_heat_groups.integrate_exponential(
+      state.decay_heat_energy_since_update_J / seconds, exponentials);
+  state.decay_heat_watts =
+      Scalar(state.decay_heat_groups.calculate_decay_heat_watts(constants));
+
+  state.decay_heat_energy_since_update_J = 0.0;
+  state.decay_heat_seconds_since_update = 0.0;
+  state.decay_heat_microseconds_since_update = 0;
+}
 
-  neutron_population_group_1 += calculate_dCi_dt(1) * time_delta_seconds;
-  neutron_population_group_2 += calculate_dCi_dt(2) * time_delta_seconds;
-  neutron_population_group_3 += calculate_dCi_dt(3) * time_delta_seconds;
-  neutron_population_group_4 += calculate_dCi_dt(4) * time_delta_seconds;
-  neutron_population_group_5 += calculate_dCi_dt(5) * time_delta_seconds;
-  neutron_population_group_6 += calculate_dCi_dt(6) * time_delta_seconds;
+/// The nodes pick up from the lumped temperature whenever it moved without
+/// them. They always work out P_fe_stat with the cube root, vectorized,
+/// whatever approximate_thermal_math is
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::update_fuel_element_temperatures() {
+  const Coefficients &coefficients = get_coefficients();
+
+  if (!state.fuel_elements_current) {
+    fuel_elements->set_temperatures_celcius(
+        (double)state.fuel_temperature_celcius);
+    state.fuel_elements_current = true;
+  }
 
-  // 5. Propagate the temperature of the water in the fuel tank
-  water_temperature_celcius += calculate_water_temperature_change_celcius();
+  fuel_elements->integrate(
+      (double)state.fuel_energy_since_update_J,
+      (double)state.fuel_seconds_since_update,
+      (double)state.water_temperature_celcius,
+      {
+          .cardano_first = (double)coefficients.cardano_first,
+          .cardano_second_constant =
+              (double)coefficients.cardano_second_constant,
+          .cardano_second_per_K = (double)coefficients.cardano_second_per_K,
+          .cardano_result_scale = (double)coefficients.cardano_result_scale,
+          .temperature_fe_stat_a1 = (double)coefficients.temperature_fe_stat_a1,
+          .capacity_J_per_K_c0 = (double)coefficients.fuel_capacity_J_per_K_c0,
+          .capacity_J_per_K_c1 = (double)coefficients.fuel_capacity_J_per_K_c1,
+      });
+
+  state.fuel_temperature_celcius =
+      Scalar(fuel_elements->get_average_temperature_celcius());
+}
 
-  if (water_temperature_celcius < 20.0) {
-    water_temperature_celcius = 20.0;
+/// A node is stationary when its share of the power is what it passes to the
+/// water, 1 / nodes of P_fe_stat. So it's at the stationary temperature of
+/// the whole core at the power times its share times the nodes
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::set_fuel_elements_at_equilibrium(
+    Scalar power_watts) {
+  size_t nodes = fuel_elements->get_node_count();
+
+  for (size_t node = 0; node < nodes; node++) {
+    double node_power_watts =
+        (double)power_watts * fuel_elements->get_power_share(node) * nodes;
+
+    fuel_elements->set_temperature_celcius(
+        node, (double)calculate_stationary_fuel_temperature(
+                  get_coefficients(), Scalar(node_power_watts),
+                  state.water_temperature_celcius));
   }
 
-  // 6. Check operational limits and start SCRAM
-
-  // If we're in a scram, stop after a while
-  if (in_scram) {
+  fuel_elements->update_summary();
+  state.fuel_elements_current = true;
+  state.fuel_temperature_celcius =
+      Scalar(fuel_elements->get_average_temperature_celcius());
+}
 
-    // Allow a quick restart by toggling the enable SCRAMs switch
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+typename BasicReactorModel<Scalar, CONFIGURATION>::ReactivityRecalculations
+BasicReactorModel<Scalar, CONFIGURATION>::get_reactivity_recalculations() {
+  return state.reactivity_recalculations;
+}
 
-    uint32_t power_watts = calculate_power_watts();
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::reset_reactivity_recalculations() {
+  state.reactivity_recalculations = {};
+}
+
+/// Calculates the reactor power from the number of neutrons and constants
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+double BasicReactorModel<Scalar, CONFIGURATION>::calculate_power_MeV_per_second() {
+  // Stolen from
+  // <https://github.com/ijs-f8/Research-Reactor-Simulator/blob/dee250af1809909bb759b4381595a5a489fe5690/include/Simulator.h#L67C19-L67C31>
+  double macroscopic_cross_section_for_fission_1_per_meter = 0.56;
+
+  return (double)state.neutrons_in_core * Traits::NEUTRONS_PER_UNIT *
+         macroscopic_cross_section_for_fission_1_per_meter *
+         get_coefficients().neutron_velocity_meters_per_second_double *
+         get_coefficients().neutron_fission_energy_released_MeV_double;
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar BasicReactorModel<Scalar, CONFIGURATION>::calculate_power_watts() {
+  return calculate_power_watts(get_coefficients(), state.neutrons_in_core);
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar
+BasicReactorModel<Scalar, CONFIGURATION>::calculate_power_joules_per_second() {
+  // A joule per second is a watt
+  return calculate_power_watts();
+}
+
+/// Calculates the reactor flux
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+double BasicReactorModel<Scalar, CONFIGURATION>::calculate_flux() {
+  // Neutron velocity in cm/s over the core volume in cm^3
+  return (double)state.neutrons_in_core * Traits::NEUTRONS_PER_UNIT *
+         get_coefficients().flux_per_neutron;
+}
+
+/// Calculates the pcm feedback from the fuel temperature (based on the fuel
+/// temperature feedback coefficients)
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+Scalar
+BasicReactorModel<Scalar, CONFIGURATION>::calculate_fuel_temperature_feedback_pcm() {
+  return calculate_fuel_temperature_feedback_pcm(
+      get_coefficients(), state.fuel_temperature_celcius,
+      approximate_thermal_math);
+}
+
+/// Gets the continuous state, N, Ci and the temperatures
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+typename BasicReactorModel<Scalar, CONFIGURATION>::StateVector
+BasicReactorModel<Scalar, CONFIGURATION>::get_state_vector() {
+  StateVector state_vector;
+
+  state_vector[0] = state.neutrons_in_core;
+
+  for (uint8_t i = 0; i < GROUPS; i++) {
+    state_vector[1 + i] = state.precursor_groups.get_population(i);
+
+    if (state.logarithmic_neutron_population) {
+      state_vector[1 + i] *= state.neutrons_in_core;
+    }
+  }
+
+  state_vector[GROUPS + 1] = state.fuel_temperature_celcius;
+  state_vector[GROUPS + 2] = state.water_temperature_celcius;
+
+  return state_vector;
+}
+
+/// Sets the continuous state, N, Ci and the temperatures
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::set_state_vector(
+    const StateVector &state_vector) {
+  state.neutrons_in_core = state_vector[0];
+
+  for (uint8_t i = 0; i < GROUPS; i++) {
+    state.precursor_groups.set_population(i, state_vector[1 + i]);
+  }
+
+  state.fuel_temperature_celcius = state_vector[GROUPS + 1];
+  state.water_temperature_celcius = state_vector[GROUPS + 2];
+  // The lumped temperature moved without the fuel element nodes
+  state.fuel_elements_current = false;
+
+  // The state is always the neutrons themselves
+  if (state.logarithmic_neutron_population) {
+    state.logarithmic_neutron_population = false;
+    convert_to_logarithmic_neutron_population();
+  } else {
+    update_derived_power();
+  }
+}
+
+/// Calculates the time derivative of a continuous state with the control rods
+/// where they are now
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+typename BasicReactorModel<Scalar, CONFIGURATION>::StateVector
+BasicReactorModel<Scalar, CONFIGURATION>::calculate_state_derivative(
+    const StateVector &state_vector) {
+  set_state_vector(state_vector);
+
+  // The fuel temperature feedback changes with the state
+  update_derived_reactivity();
+
+  StateVector derivative;
+
+  derivative[0] = calculate_dN_dt();
+
+  for (uint8_t group = 1; group <= GROUPS; group++) {
+    derivative[group] = calculate_dCi_dt(group);
+  }
+
+  // The change over one second at the current rates is the rate
+  derivative[GROUPS + 1] =
+      calculate_fuel_temperature_change_celcius(1.0);
+  derivative[GROUPS + 2] =
+      calculate_water_temperature_change_celcius(1.0);
+
+  return derivative;
+}
+
+/// Works the motions out again only when the step changed, which is every
+/// tick with the adaptive integrators
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+const std::array<
+    typename BasicReactorModel<Scalar, CONFIGURATION>::ControlRod::Motion, 3> &
+BasicReactorModel<Scalar, CONFIGURATION>::get_control_rod_motions(
+    Scalar step_seconds) {
+  if (time_step_coefficients.control_rods_time_delta_seconds != step_seconds) {
+    const auto &speeds = get_coefficients().control_rod_speeds_steps_per_second;
+    const auto &accelerations =
+        get_coefficients().control_rod_accelerations_steps_per_second_squared;
+
+    // The safety rod doubles as the transient rod of pulse mode
+    time_step_coefficients.control_rod_motions = {
+        ControlRod::Motion::calculate(
+            speeds[0], accelerations[0],
+            TRANSIENT_ROD_EJECTION_ACCELERATION_STEPS_PER_SECOND_SQUARED,
+            step_seconds),
+        ControlRod::Motion::calculate(speeds[1], accelerations[1], 0,
+                                      step_seconds),
+        ControlRod::Motion::calculate(speeds[2], accelerations[2], 0,
+                                      step_seconds),
+    };
+    time_step_coefficients.control_rods_time_delta_seconds = step_seconds;
+  }
+
+  return time_step_coefficients.control_rod_motions;
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::rescale_control_rod_velocities(
+    Scalar from_step_seconds, Scalar to_step_seconds) {
+  for (ControlRod *rod :
+       {&state.safety_control_rod, &state.regulating_control_rod,
+        &state.compensating_control_rod}) {
+    rod->rescale_velocity(from_step_seconds, to_step_seconds);
+  }
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+const PrecursorStepExponentials<
+    BasicReactorModel<Scalar, CONFIGURATION>::GROUPS, Scalar> &
+BasicReactorModel<Scalar, CONFIGURATION>::get_precursor_step_exponentials() {
+  auto &exponentials = time_step_coefficients.precursor_step_exponentials;
+  exponentials.set_time_delta_seconds(state.time_delta_seconds,
+                                      get_coefficients().precursor_groups);
+
+  return exponentials;
+}
+
+/// Moves the control rods for a tick, to their targets and to balance the
+/// target power
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::move_control_rods() {
+  // 2.1 to their target positions, integer math only
+  uint8_t reached_target =
+      move_control_rods_towards_targets(Scalar(state.time_delta_seconds));
+
+  // 2.2 to balance target power, when the controller takes a sample
+  if (sample_control_system()) {
+    // A rod the controller gave a new target hasn't stopped
+    if (reached_target != 0) {
+      reached_target &= ~calculate_control_rods_moving();
+    }
+  }
+
+  state.control_rods_reached_target = reached_target;
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+uint8_t
+BasicReactorModel<Scalar, CONFIGURATION>::move_control_rods_towards_targets(
+    Scalar step_seconds) {
+  const auto &motions = get_control_rod_motions(step_seconds);
+
+  bool safety = state.safety_control_rod.move_towards_target(motions[0]);
+  bool regulating =
+      state.regulating_control_rod.move_towards_target(motions[1]);
+  bool compensating =
+      state.compensating_control_rod.move_towards_target(motions[2]);
+
+  return (uint8_t)safety | (uint8_t)(regulating << 1) |
+         (uint8_t)(compensating << 2);
+}
+
+/// The controller runs at its own rate, so how the power is held doesn't
+/// depend on the tick or the integrator's step
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+bool BasicReactorModel<Scalar, CONFIGURATION>::sample_control_system() {
+  if (state.in_scram || !automatic_control ||
+      state.rcs_microseconds_since_sample < RCS_SAMPLE_PERIOD_MICROSECONDS) {
+    return false;
+  }
+
+  balance_control_rods();
+  state.rcs_microseconds_since_sample = 0;
+  return true;
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::tick() {
+  double time_elapsed_at_tick_start = state.time_elapsed_seconds;
+  double power_at_tick_start_watts =
+      state.pulse_in_progress ? (double)get_power_watts() : 0.0;
+
+  // Anything changed from outside since the ticks got longer brings this one
+  // back to full rate
+  if (state.quiescent &&
+      (!adaptive_tick_rate || integrator != Integrator::EULER ||
+       state.in_scram || get_inputs() != state.inputs_at_quiescence)) {
+    leave_quiescence();
+  }
+
+  // Only the plain euler kinetics integrate the logarithmic representation
+  bool linear_for_tick =
+      state.logarithmic_neutron_population &&
+      (integrator != Integrator::EULER || prompt_jump || state.quiescent);
+
+  if (linear_for_tick) {
+    convert_to_linear_neutron_population();
+  }
+
+  switch (integrator) {
+  case Integrator::EULER:
+    tick_euler();
+    break;
+  case Integrator::RK4:
+  case Integrator::RK45:
+  case Integrator::ROSENBROCK23:
+    tick_runge_kutta();
+    break;
+  }
+
+  if (linear_for_tick) {
+    convert_to_logarithmic_neutron_population();
+  }
+
+  double tick_seconds = state.time_elapsed_seconds - time_elapsed_at_tick_start;
+
+  state.rcs_microseconds_since_sample = std::min(
+      state.rcs_microseconds_since_sample +
+          (uint32_t)std::llround(tick_seconds * 1e6),
+      RCS_SAMPLE_PERIOD_MICROSECONDS);
+
+  // The iodine and xenon only change over hours, a tick just adds up its
+  // energy for the next update
+  if (xenon_poisoning) {
+    state.fission_products_energy_since_update_J +=
+        (double)get_power_watts() * tick_seconds;
+    state.fission_products_seconds_since_update += tick_seconds;
+
+    if (state.fission_products_seconds_since_update >=
+        XENON_UPDATE_INTERVAL_SECONDS) {
+      update_fission_products();
+    }
+  }
+
+  // The same for the decay heat, only more often
+  if (decay_heat) {
+    state.decay_heat_energy_since_update_J +=
+        (double)get_power_watts() * tick_seconds;
+    state.decay_heat_seconds_since_update += tick_seconds;
+    state.decay_heat_microseconds_since_update +=
+        (uint32_t)std::llround(tick_seconds * 1e6);
+
+    if (state.decay_heat_microseconds_since_update >=
+        DECAY_HEAT_UPDATE_INTERVAL_MICROSECONDS) {
+      update_decay_heat();
+    }
+  }
+
+  if (state.pulse_in_progress) {
+    update_pulse(power_at_tick_start_watts, tick_seconds);
+  }
+
+  // 6. Check operational limits and start SCRAM
+
+  // If we're in a scram, stop after a while
+  if (state.in_scram) {
+
+    // Allow a quick restart by toggling the enable SCRAMs switch
+
+    uint32_t power_watts = (uint32_t)get_power_watts();
 
     if (power_watts <= 1 || !scrams_enabled) {
-      in_scram = false;
-      step_scram_started = 0;
+      state.in_scram = false;
+      state.step_scram_started = 0;
 
       if (automatic_control) {
         get_safety_control_rod()->set_target_position(0.0);
@@ -598,59 +1746,623 @@ void Reactor::tick() {
     }
   }
 
-  if (scrams_enabled) {
+  if (scrams_enabled && calculate_scram_limits_exceeded()) {
+    scram();
+  }
 
-    if (calculate_power_watts() >= (double)POWER_SCRAM_WATTS) {
-      scram();
+  state.steps_elapsed += 1;
+
+  if (adaptive_tick_rate && integrator == Integrator::EULER) {
+    update_quiescence();
+  }
+}
+
+/// Events are found by comparing the reactor before and after each tick.
+/// Nothing but the ticks changes it in between, so what it was after one tick
+/// is what it was before the next
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+TickBatch BasicReactorModel<Scalar, CONFIGURATION>::tick_n(uint32_t ticks) {
+  TickBatch batch = {0, TickBatchStop::COMPLETED};
+
+  while (batch.ticks < ticks) {
+    bool was_in_scram = state.in_scram;
+    bool was_quiescent = state.quiescent;
+    bool was_pulsing = state.pulse_in_progress;
+
+    tick();
+    batch.ticks++;
+
+    if (state.in_scram != was_in_scram) {
+      batch.stop = state.in_scram ? TickBatchStop::SCRAM_STARTED
+                                  : TickBatchStop::SCRAM_ENDED;
+      break;
     }
 
-    if (water_temperature_celcius >= (double)WATER_TEMPERATURE_SCRAM_CELCIUS) {
-      scram();
+    if (was_pulsing && !state.pulse_in_progress) {
+      batch.stop = TickBatchStop::PULSE_ENDED;
+      break;
     }
 
-    if (fuel_temperature_celcius >= (double)FUEL_TEMPERATURE_SCRAM_CELCIUS) {
-      scram();
+    // Noted by the rods as they moved, see move_control_rods
+    if (state.control_rods_reached_target != 0) {
+      batch.stop = TickBatchStop::CONTROL_ROD_REACHED_TARGET;
+      break;
+    }
+
+    if (state.quiescent != was_quiescent) {
+      batch.stop = TickBatchStop::TICK_LENGTH_CHANGED;
+      break;
+    }
+  }
+
+  return batch;
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+uint8_t BasicReactorModel<Scalar, CONFIGURATION>::calculate_control_rods_moving() {
+  auto moving = [](ControlRod &rod) {
+    return (uint8_t)(rod.get_current_position() != rod.get_target_position());
+  };
+
+  return (uint8_t)(moving(state.safety_control_rod) |
+                   moving(state.regulating_control_rod) << 1 |
+                   moving(state.compensating_control_rod) << 2);
+}
+
+/// Neutrons that hold still in the full kinetics have dN/dt near 0, but the
+/// prompt jump approximation of the long ticks holds it at 0 whatever the
+/// precursors do. The precursors' delayed neutron source, which the neutrons
+/// follow, is checked too
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+bool BasicReactorModel<Scalar, CONFIGURATION>::calculate_quiescent() {
+  if (state.in_scram) {
+    return false;
+  }
+
+  if (calculate_control_rods_moving() != 0) {
+    return false;
+  }
+
+  double max_relative_rate_per_second =
+      QUIESCENCE_MAX_RELATIVE_NEUTRON_RATE_PER_SECOND;
+  double neutrons = (double)state.neutrons_in_core;
+
+  // Written so a NaN isn't quiescent
+  if (!(std::fabs((double)calculate_dN_dt()) <=
+        max_relative_rate_per_second * neutrons)) {
+    return false;
+  }
+
+  double delayed_neutron_source =
+      (double)state.precursor_groups.calculate_delayed_neutron_source(
+          get_coefficients().precursor_groups);
+
+  if (state.logarithmic_neutron_population) {
+    delayed_neutron_source *= neutrons;
+  }
+
+  double delayed_neutron_source_rate = 0.0;
+
+  for (uint8_t group = 1; group <= GROUPS; group++) {
+    delayed_neutron_source_rate +=
+        (double)get_neutron_decay_time_for_group(group) *
+        (double)calculate_dCi_dt(group);
+  }
+
+  if (!(std::fabs(delayed_neutron_source_rate) <=
+        max_relative_rate_per_second *
+            (delayed_neutron_source +
+             (double)get_coefficients().source_neutron_units_per_second))) {
+    return false;
+  }
+
+  double max_temperature_rate_celcius_per_second =
+      QUIESCENCE_MAX_TEMPERATURE_RATE_CELCIUS_PER_SECOND;
+  double fuel_temperature_rate_celcius_per_second =
+      (double)calculate_fuel_temperature_change_celcius(Scalar(1.0));
+  double water_temperature_rate_celcius_per_second =
+      (double)calculate_water_temperature_change_celcius(Scalar(1.0));
+
+  // The water doesn't cool below 20 C
+  if (state.water_temperature_celcius <= 20.0 &&
+      water_temperature_rate_celcius_per_second < 0.0) {
+    water_temperature_rate_celcius_per_second = 0.0;
+  }
+
+  return std::fabs(fuel_temperature_rate_celcius_per_second) <=
+             max_temperature_rate_celcius_per_second &&
+         std::fabs(water_temperature_rate_celcius_per_second) <=
+             max_temperature_rate_celcius_per_second;
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+bool BasicReactorModel<Scalar, CONFIGURATION>::get_quiescent() {
+  return state.quiescent;
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::leave_quiescence() {
+  state.quiescent_checks_passed = 0;
+
+  if (!state.quiescent) {
+    return;
+  }
+
+  state.quiescent = false;
+  change_time_delta_seconds(state.full_rate_time_delta_seconds);
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::update_quiescence() {
+  if (state.quiescent) {
+    if (!calculate_quiescent()) {
+      leave_quiescence();
+    }
+
+    return;
+  }
+
+  if (state.steps_elapsed % QUIESCENCE_CHECK_INTERVAL_TICKS != 0) {
+    return;
+  }
+
+  if (!calculate_quiescent()) {
+    state.quiescent_checks_passed = 0;
+    return;
+  }
+
+  state.quiescent_checks_passed += 1;
+
+  if (state.quiescent_checks_passed < QUIESCENCE_CHECKS_BEFORE_SLOWING) {
+    return;
+  }
+
+  state.quiescent = true;
+  state.full_rate_time_delta_seconds = state.time_delta_seconds;
+  state.inputs_at_quiescence = get_inputs();
+  change_time_delta_seconds(state.time_delta_seconds *
+                            (float)QUIESCENT_TICKS_PER_TICK);
+}
+
+/// The long quiescent ticks need the exponentials, which stay accurate over
+/// them
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+PrecursorIntegration
+BasicReactorModel<Scalar, CONFIGURATION>::get_precursor_integration_for_tick() {
+  if (state.quiescent) {
+    return PrecursorIntegration::EXPONENTIAL;
+  }
+
+  return precursor_integration;
+}
+
+/// One tick of the original forward euler scheme
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::tick_euler() {
+
+  // https://www.sciencedirect.com/science/article/pii/S0306454920303285
+  //
+  // IJS Triga Reserach reactor simulator developer's manual:
+  //
+  // We won't calculate pulse mode
+  // 1. Re-calculate the fuel temperature based on power from the previous
+  //
+  // Only every fuel_temperature_update_interval_ticks ticks, with all the
+  // energy generated since the last update
+  state.fuel_energy_since_update_J +=
+      calculate_heat_watts() * state.time_delta_seconds;
+  state.fuel_seconds_since_update += state.time_delta_seconds;
+  state.fuel_ticks_since_update += 1;
+
+  if (state.fuel_ticks_since_update >= fuel_temperature_update_interval_ticks) {
+    if (fuel_element_temperatures && fuel_elements != nullptr) {
+      update_fuel_element_temperatures();
+    } else {
+      state.fuel_temperature_celcius +=
+          calculate_fuel_temperature_change_celcius(
+              state.fuel_energy_since_update_J,
+              state.fuel_seconds_since_update);
+      state.fuel_elements_current = false;
+    }
+
+    state.fuel_energy_since_update_J = 0.0;
+    state.fuel_seconds_since_update = 0.0;
+    state.fuel_ticks_since_update = 0;
+  }
+
+  // 2. Move control rods
+  move_control_rods();
+
+  // 3. Recalculate the reactivity
+  update_derived_reactivity();
+
+  // 4. Numerically evaluate the point kinetic equations
+  Scalar prompt_critical_reactivity =
+      get_coefficients().precursor_groups.effective_delayed_neutron_fraction;
+
+  // The long quiescent ticks are only valid with the prompt jump
+  bool prompt_jump_for_tick = prompt_jump || state.quiescent;
+
+  state.prompt_jump_active =
+      prompt_jump_for_tick && get_reactivity_no_units() <
+                         Scalar(PROMPT_JUMP_MAX_REACTIVITY_DOLLARS) *
+                             prompt_critical_reactivity;
+
+  if (state.prompt_jump_active) {
+    integrate_prompt_jump_kinetics();
+  } else if (prompt_jump_for_tick) {
+    integrate_full_kinetics_in_sub_steps();
+  } else if (state.logarithmic_neutron_population) {
+    // Exact for the exponential growth above prompt critical, so it needs no
+    // sub-steps
+    integrate_logarithmic_kinetics();
+  } else if (calculate_prompt_period_sub_steps() > 1) {
+    // Above prompt critical, like in a pulse
+    integrate_full_kinetics_in_sub_steps();
+  } else {
+    // Uhmmm yes it's called numerical evaluation, didn't you know?
+    Scalar neutrons_at_step_start = state.neutrons_in_core;
+
+    state.neutrons_in_core += calculate_dN_dt() * state.time_delta_seconds;
+
+    integrate_precursor_groups(neutrons_at_step_start, state.neutrons_in_core);
+  }
+
+  // The power and flux only change with the neutrons
+  update_derived_power();
+
+  // 5. Propagate the temperature of the water in the fuel tank
+  //
+  // Only every water_temperature_update_interval_ticks ticks, like the fuel
+  state.water_energy_since_update_J +=
+      calculate_heat_watts() * state.time_delta_seconds;
+  state.water_seconds_since_update += state.time_delta_seconds;
+  state.water_ticks_since_update += 1;
+
+  if (state.water_ticks_since_update >=
+      water_temperature_update_interval_ticks) {
+    state.water_temperature_celcius +=
+        calculate_water_temperature_change_celcius(
+            state.water_energy_since_update_J,
+            state.water_seconds_since_update);
+
+    if (state.water_temperature_celcius < 20.0) {
+      state.water_temperature_celcius = 20.0;
+    }
+
+    state.water_energy_since_update_J = 0.0;
+    state.water_seconds_since_update = 0.0;
+    state.water_ticks_since_update = 0;
+  }
+
+  state.time_elapsed_seconds += state.time_delta_seconds;
+}
+
+/// Moves the precursor groups forward by one step with precursor_integration,
+/// or the exponentials when the ticks are quiescent
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::integrate_precursor_groups(
+    Scalar neutrons_at_step_start, Scalar neutrons_at_step_end) {
+  switch (get_precursor_integration_for_tick()) {
+  case PrecursorIntegration::EULER:
+    state.precursor_groups.integrate_euler(neutrons_at_step_end,
+                                           state.time_delta_seconds,
+                                           get_coefficients().precursor_groups);
+    break;
+  case PrecursorIntegration::EXPONENTIAL:
+    state.precursor_groups.integrate_exponential(
+        neutrons_at_step_start, neutrons_at_step_end,
+        get_precursor_step_exponentials());
+    break;
+  }
+}
+
+/// Moves the kinetics forward by one step with the prompt jump approximation
+///
+/// Only the precursors are integrated, the neutrons follow them instantly
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::integrate_prompt_jump_kinetics() {
+  Scalar neutrons_at_step_start = calculate_prompt_jump_neutrons();
+  Scalar neutrons_at_step_end = neutrons_at_step_start;
+
+  if (get_precursor_integration_for_tick() ==
+      PrecursorIntegration::EXPONENTIAL) {
+    // Predict the end of step precursors with the start of step neutrons, to
+    // get the end of step neutrons the linear source needs
+    PrecursorGroups<GROUPS, Scalar> predicted_groups =
+        state.precursor_groups;
+    predicted_groups.integrate_exponential(neutrons_at_step_start,
+                                           neutrons_at_step_start,
+                                           get_precursor_step_exponentials());
+
+    neutrons_at_step_end = calculate_prompt_jump_neutrons(
+        predicted_groups.calculate_delayed_neutron_source(
+            get_coefficients().precursor_groups));
+  }
+
+  integrate_precursor_groups(neutrons_at_step_start, neutrons_at_step_end);
+
+  state.neutrons_in_core = calculate_prompt_jump_neutrons();
+}
+
+/// Moves the full kinetics forward by one step, in sub-steps of at most
+/// PROMPT_JUMP_FALLBACK_TIME_DELTA_SECONDS, and more above prompt critical
+///
+/// Near prompt critical the neutrons change too fast for the long steps of
+/// the prompt jump mode, and above it too fast for a full rate step. The
+/// cached exponentials are for the whole step, so the precursors use euler
+/// here. The rods and the reactivity stay put for the step
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void
+BasicReactorModel<Scalar, CONFIGURATION>::integrate_full_kinetics_in_sub_steps() {
+  // The time step is a float, so allow it to be a hair over a whole number
+  // of sub-steps
+  uint32_t sub_steps = std::max(
+      (uint32_t)std::ceil(state.time_delta_seconds /
+                              PROMPT_JUMP_FALLBACK_TIME_DELTA_SECONDS -
+                          1e-6),
+      calculate_prompt_period_sub_steps());
+  Scalar sub_step_seconds =
+      Scalar(state.time_delta_seconds / (double)sub_steps);
+
+  for (uint32_t i = 0; i < sub_steps; i++) {
+    state.neutrons_in_core += calculate_dN_dt() * sub_step_seconds;
+    state.precursor_groups.integrate_euler(state.neutrons_in_core,
+                                           sub_step_seconds,
+                                           get_coefficients().precursor_groups);
+  }
+}
+
+/// Above prompt critical the neutrons grow as exp(t / period), with the
+/// prompt period lifetime / (rho - beta), a few ms in a pulse. A forward euler
+/// step only follows that while it's a small part of the period
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+uint32_t
+BasicReactorModel<Scalar, CONFIGURATION>::calculate_prompt_period_sub_steps() {
+  Scalar reactivity_above_prompt_critical =
+      get_reactivity_no_units() -
+      get_coefficients().precursor_groups.effective_delayed_neutron_fraction;
+
+  // Almost every tick
+  if (reactivity_above_prompt_critical <= Scalar(0.0)) {
+    return 1;
+  }
+
+  double steps_per_tick =
+      (double)reactivity_above_prompt_critical /
+      (double)get_coefficients().prompt_neutron_lifetime_seconds *
+      state.time_delta_seconds * KINETICS_SUB_STEPS_PER_PROMPT_PERIOD;
+
+  return (uint32_t)std::clamp(std::ceil(steps_per_tick), 1.0,
+                              (double)MAX_KINETICS_SUB_STEPS_PER_TICK);
+}
+
+/// One tick of Integrator::RK4, Integrator::RK45 or Integrator::ROSENBROCK23
+///
+/// The controller takes its sample at the start of the tick, when one is
+/// due, and an adaptive step ends at the next one. The control rods move
+/// first and then stay put for the step, while the kinetics and both
+/// temperatures are integrated together
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::tick_runge_kutta() {
+  sample_control_system();
+
+  const StateVector state_at_start = get_state_vector();
+  const std::array<ControlRod, 3> rods_at_start = {
+      state.safety_control_rod, state.regulating_control_rod,
+      state.compensating_control_rod};
+
+  bool adaptive = integrator == Integrator::RK45 ||
+                  integrator == Integrator::ROSENBROCK23;
+
+  // The adaptive step is kept apart from time_delta_seconds, which the other
+  // integrators still tick with
+  Scalar step_seconds = adaptive && state.adaptive_time_delta_seconds > 0.0f
+                            ? Scalar(state.adaptive_time_delta_seconds)
+                            : Scalar(state.time_delta_seconds);
+  Scalar next_step_seconds = step_seconds;
+
+  // Cut short for the controller's next sample, which doesn't shorten the
+  // step after it
+  Scalar step_seconds_before_sample = step_seconds;
+
+  if (adaptive && automatic_control && !state.in_scram) {
+    step_seconds = std::min(
+        step_seconds,
+        Scalar((RCS_SAMPLE_PERIOD_MICROSECONDS -
+                state.rcs_microseconds_since_sample) *
+               1e-6));
+  }
+
+  StateVector error;
+  StateVector state_at_end =
+      take_runge_kutta_step(state_at_start, rods_at_start, step_seconds, error);
+
+  if (adaptive) {
+    // The error estimates are of order 5 and 3
+    double error_exponent = integrator == Integrator::RK45 ? -1.0 / 5.0
+                                                           : -1.0 / 3.0;
+
+
+    std::array<double, STATE_VECTOR_SIZE> absolute_tolerance;
+    absolute_tolerance.fill(ADAPTIVE_ABSOLUTE_TOLERANCE_NEUTRONS);
+    absolute_tolerance[GROUPS + 1] =
+        ADAPTIVE_ABSOLUTE_TOLERANCE_CELCIUS;
+    absolute_tolerance[GROUPS + 2] =
+        ADAPTIVE_ABSOLUTE_TOLERANCE_CELCIUS;
+
+    while (true) {
+      double error_norm =
+          calculate_error_norm(error, state_at_start, state_at_end,
+                               absolute_tolerance, ADAPTIVE_RELATIVE_TOLERANCE);
+
+      // Standard step size control, with a safety factor and limits on how
+      // fast the step changes
+      double step_factor = 5.0;
+
+      if (error_norm > 0.0) {
+        step_factor =
+            std::clamp(0.9 * std::pow(error_norm, error_exponent), 0.2, 5.0);
+      }
+
+      if (error_norm <= 1.0 ||
+          step_seconds <= ADAPTIVE_MIN_TIME_DELTA_SECONDS) {
+        next_step_seconds = std::max(Scalar(step_seconds * step_factor),
+                                     step_seconds_before_sample);
+        break;
+      }
+
+      // Rejected, retry with a smaller step
+      step_seconds_before_sample = Scalar(0.0);
+      step_seconds = std::max(Scalar(step_seconds * step_factor),
+                              Scalar(ADAPTIVE_MIN_TIME_DELTA_SECONDS));
+      state_at_end = take_runge_kutta_step(state_at_start, rods_at_start,
+                                           step_seconds, error);
+    }
+  }
+
+  // With long steps the power or temperatures can go well past their limits
+  // inside one step, so bisect for the moment they're first crossed and end
+  // the step there
+  set_state_vector(state_at_start);
+  bool limits_exceeded_at_start = calculate_scram_limits_exceeded();
+
+  set_state_vector(state_at_end);
+
+  if (scrams_enabled && !state.in_scram && !limits_exceeded_at_start &&
+      calculate_scram_limits_exceeded()) {
+    Scalar lower_step_seconds = Scalar(0.0);
+    Scalar upper_step_seconds = step_seconds;
+
+    while (upper_step_seconds - lower_step_seconds >
+           SCRAM_LOCATION_TOLERANCE_SECONDS) {
+      Scalar middle_step_seconds =
+          Scalar(0.5) * (lower_step_seconds + upper_step_seconds);
+
+      set_state_vector(take_runge_kutta_step(
+          state_at_start, rods_at_start, middle_step_seconds, error));
+
+      if (calculate_scram_limits_exceeded()) {
+        upper_step_seconds = middle_step_seconds;
+      } else {
+        lower_step_seconds = middle_step_seconds;
+      }
     }
+
+    // Also leaves the control rods where they are after the shorter step
+    step_seconds = upper_step_seconds;
+    state_at_end = take_runge_kutta_step(state_at_start, rods_at_start,
+                                         step_seconds, error);
+    set_state_vector(state_at_end);
+  }
+
+  update_derived_reactivity();
+
+  if (state.water_temperature_celcius < 20.0) {
+    state.water_temperature_celcius = 20.0;
+  }
+
+  state.time_elapsed_seconds += (double)step_seconds;
+
+  // The rods moved with the step's length
+  rescale_control_rod_velocities(step_seconds,
+                                 Scalar(state.time_delta_seconds));
+
+  if (adaptive) {
+    state.adaptive_time_delta_seconds = (float)std::clamp(
+        (double)next_step_seconds, ADAPTIVE_MIN_TIME_DELTA_SECONDS,
+        ADAPTIVE_MAX_TIME_DELTA_SECONDS);
+  }
+}
+
+/// Moves the control rods and the state forward by one Runge-Kutta step,
+/// starting from the given state and control rods
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+typename BasicReactorModel<Scalar, CONFIGURATION>::StateVector
+BasicReactorModel<Scalar, CONFIGURATION>::take_runge_kutta_step(
+    const StateVector &state_vector, const std::array<ControlRod, 3> &rods,
+    Scalar step_seconds, StateVector &error) {
+  set_state_vector(state_vector);
+
+  state.safety_control_rod = rods[0];
+  state.regulating_control_rod = rods[1];
+  state.compensating_control_rod = rods[2];
+
+  rescale_control_rod_velocities(Scalar(state.time_delta_seconds),
+                                 step_seconds);
+  state.control_rods_reached_target =
+      move_control_rods_towards_targets(step_seconds);
+
+  auto calculate_derivative = [this](const StateVector &stage) {
+    return calculate_state_derivative(stage);
+  };
+
+  switch (integrator) {
+  case Integrator::RK45:
+    return integrate_dormand_prince(calculate_derivative, state_vector,
+                                    step_seconds, error);
+  case Integrator::ROSENBROCK23:
+    return integrate_rosenbrock_23(calculate_derivative, state_vector,
+                                   step_seconds, error);
+  default:
+    return integrate_rk4(calculate_derivative, state_vector, step_seconds);
   }
+}
 
-  steps_elapsed += 1;
+/// Whether the power or a temperature is over its SCRAM limit
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+bool BasicReactorModel<Scalar, CONFIGURATION>::calculate_scram_limits_exceeded() {
+  const Coefficients &coefficients = get_coefficients();
+
+  // A pulse goes far over full power on purpose, for a few ms
+  return (!state.pulse_in_progress &&
+          get_power_watts() >= coefficients.power_scram_watts) ||
+         state.water_temperature_celcius >=
+             coefficients.water_temperature_scram_celcius ||
+         get_hottest_fuel_temperature_celcius() >=
+             coefficients.fuel_temperature_scram_celcius;
 }
 
 // Reactor control system
 /// Moves the control rods to try to reach the target power
-void Reactor::balance_control_rods() {
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::balance_control_rods() {
 
   // Limits of the RCS when balancing rods
   uint32_t max_position = 4e6;
   uint32_t min_position = 24e5; // 60 %
 
-  int16_t step = 4000; // 10 mm at a time 1e-3 out of 1.0
-
   // Remove the two other rods, if they aren't already
-  if (safety_control_rod.get_target_position() != 0) {
-    safety_control_rod.set_target_position(0);
+  if (state.safety_control_rod.get_target_position() != 0) {
+    state.safety_control_rod.set_target_position(0);
   }
 
-  if (compensating_control_rod.get_target_position() != 0) {
-    compensating_control_rod.set_target_position(0);
+  if (state.compensating_control_rod.get_target_position() != 0) {
+    state.compensating_control_rod.set_target_position(0);
   }
 
-  bool safety_in_position = safety_control_rod.get_current_position() == 0;
+  bool safety_in_position =
+      state.safety_control_rod.get_current_position() == 0;
   bool compensating_in_position =
-      compensating_control_rod.get_current_position() == 0;
+      state.compensating_control_rod.get_current_position() == 0;
 
   if (!safety_in_position || !compensating_in_position) {
     return;
   }
 
   // Compensate the regulating rod
-  uint32_t thermal_power_watts = (uint32_t)calculate_power_watts();
-  uint32_t thermal_power_delta =
-      target_thermal_power_watts - thermal_power_watts;
+  uint32_t thermal_power_watts = (uint32_t)get_power_watts();
 
   auto rod = get_regulating_control_rod();
 
-  int16_t delta_position = 0;
+  // As far as the rod gets until the next sample, and a time step more so it
+  // doesn't stop short of it while the power is off target
+  uint32_t speed = get_coefficients().control_rod_speeds_steps_per_second[1];
+  int64_t step =
+      (int64_t)((uint64_t)speed * RCS_SAMPLE_PERIOD_MICROSECONDS / 1000000) +
+      get_control_rod_motions(Scalar(state.time_delta_seconds))[1]
+          .max_steps_per_time_delta;
+  int64_t delta_position = 0;
 
   if (thermal_power_watts > target_thermal_power_watts) {
     delta_position = step;
@@ -659,23 +2371,242 @@ void Reactor::balance_control_rods() {
     delta_position = -step;
   }
 
-  rod->set_target_position(
-      std::clamp((uint32_t)(rod->get_current_position() + delta_position),
-                 min_position, max_position));
+  // In 64 bits, a rod below the step would wrap around to fully inserted in
+  // 32 bits
+  rod->set_target_position((uint32_t)std::clamp(
+      (int64_t)rod->get_current_position() + delta_position,
+      (int64_t)min_position, (int64_t)max_position));
+}
+
+/// Puts the reactor straight into the steady state at a power, see
+/// calculate_equilibrium, with the regulating rod placed on the rod itself so
+/// a worth curve is followed
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+bool BasicReactor<Scalar, CONFIGURATION>::initialize_at_equilibrium(
+    uint32_t power_watts, Scalar water_temperature_celcius) {
+  if (power_watts == 0) {
+    return false;
+  }
+
+  Equilibrium equilibrium = calculate_equilibrium(
+      get_coefficients(), get_parameters(), Scalar(power_watts),
+      water_temperature_celcius, approximate_thermal_math, xenon_poisoning);
+
+  double regulating_rod_worth_pcm =
+      equilibrium.control_rod_worths_pcm -
+      (double)state.safety_control_rod.calculate_worth_pcm() -
+      (double)state.compensating_control_rod.calculate_worth_pcm();
+
+  ControlRod rod = state.regulating_control_rod;
+  uint32_t position = calculate_control_rod_position_for_worth(
+      regulating_rod_worth_pcm, [&rod](uint32_t position) {
+        rod.set_current_position(position);
+        return rod.calculate_worth_pcm();
+      });
+
+  if (position == UINT32_MAX) {
+    return false;
+  }
+
+  equilibrium.control_rod_positions = {
+      state.safety_control_rod.get_current_position(), position,
+      state.compensating_control_rod.get_current_position()};
+
+  load_equilibrium(equilibrium);
+  return true;
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::load_equilibrium(
+    const Equilibrium &equilibrium) {
+  state.neutrons_in_core = equilibrium.neutrons_in_core;
+  state.water_temperature_celcius = equilibrium.water_temperature_celcius;
+  state.fuel_temperature_celcius = equilibrium.fuel_temperature_celcius;
+
+  ControlRod *rods[3] = {&state.safety_control_rod,
+                         &state.regulating_control_rod,
+                         &state.compensating_control_rod};
+
+  for (uint8_t i = 0; i < 3; i++) {
+    rods[i]->set_current_position(equilibrium.control_rod_positions[i]);
+    rods[i]->set_target_position(equilibrium.control_rod_positions[i]);
+  }
+
+  if (equilibrium.critical) {
+    target_thermal_power_watts = (uint32_t)equilibrium.power_watts;
+  }
+
+  // Set in the linear representation, and converted if the logarithm is
+  // integrated
+  bool logarithmic = state.logarithmic_neutron_population;
+  state.logarithmic_neutron_population = false;
+
+  for (uint8_t i = 0; i < GROUPS; i++) {
+    state.precursor_groups.set_population(
+        i, equilibrium.precursor_populations[i]);
+  }
+
+  if (logarithmic) {
+    convert_to_logarithmic_neutron_population();
+  }
+
+  // Nothing left over from before
+  state.in_scram = false;
+  state.prompt_jump_active = false;
+  state.fuel_energy_since_update_J = 0.0;
+  state.fuel_seconds_since_update = 0.0;
+  state.fuel_ticks_since_update = 0;
+  state.water_energy_since_update_J = 0.0;
+  state.water_seconds_since_update = 0.0;
+  state.water_ticks_since_update = 0;
+  state.fuel_temperature_feedback_calculated = false;
+  // After a long run, with the xenon it was worked out with, which the rods
+  // were placed for, and the fission products' decay heat making up its part
+  // of the power
+  load_fission_products(equilibrium.fission_products);
+  set_decay_heat_at_equilibrium(equilibrium.power_watts);
+
+  // Each fuel element node at its own share of the power. Their average is
+  // a little off the lumped temperature the rods were placed for, the RCS
+  // takes up the difference
+  if (fuel_element_temperatures && fuel_elements != nullptr) {
+    set_fuel_elements_at_equilibrium(equilibrium.power_watts);
+  }
+
+  update_derived_reactivity();
+  update_derived_power();
 }
 
 /// Initiates an emergency shutdown that lasts 6 seconds
-void Reactor::scram() {
-  in_scram = true;
-  step_scram_started = steps_elapsed;
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::scram() {
+  if (state.pulse_in_progress) {
+    end_pulse();
+  }
+
+  state.in_scram = true;
+  state.step_scram_started = state.steps_elapsed;
 
   // Slam all da control rods in
-  safety_control_rod.set_current_position(4e6);
-  safety_control_rod.set_target_position(4e6);
+  state.safety_control_rod.set_current_position(4e6);
+  state.safety_control_rod.set_target_position(4e6);
 
-  regulating_control_rod.set_current_position(4e6);
-  regulating_control_rod.set_target_position(4e6);
+  state.regulating_control_rod.set_current_position(4e6);
+  state.regulating_control_rod.set_target_position(4e6);
 
-  compensating_control_rod.set_current_position(4e6);
-  compensating_control_rod.set_target_position(4e6);
+  state.compensating_control_rod.set_current_position(4e6);
+  state.compensating_control_rod.set_target_position(4e6);
 }
+
+// Pulse mode
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+bool BasicReactorModel<Scalar, CONFIGURATION>::fire_pulse() {
+  if (automatic_control || state.in_scram || state.pulse_in_progress) {
+    return false;
+  }
+
+  double inserted_reactivity_pcm =
+      (double)state.safety_control_rod.calculate_worth_pcm();
+
+  if (!state.safety_control_rod.eject(
+          get_control_rod_motions(Scalar(state.time_delta_seconds))[0])) {
+    return false;
+  }
+
+  state.pulse_in_progress = true;
+  state.pulse_fired_seconds = state.time_elapsed_seconds;
+  state.pulse = {
+      .inserted_reactivity_pcm = inserted_reactivity_pcm,
+      .peak_power_watts = (double)get_power_watts(),
+      .seconds_to_peak = 0.0,
+      .energy_J = 0.0,
+      .peak_fuel_temperature_celcius =
+          (double)get_hottest_fuel_temperature_celcius(),
+      .most_kinetics_sub_steps = 1,
+  };
+  state.pulses_fired++;
+
+  leave_quiescence();
+  return true;
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+bool BasicReactorModel<Scalar, CONFIGURATION>::get_pulse_in_progress() {
+  return state.pulse_in_progress;
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+PulseReport BasicReactorModel<Scalar, CONFIGURATION>::get_pulse() {
+  return state.pulse;
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+PulseReport BasicReactorModel<Scalar, CONFIGURATION>::get_last_pulse() {
+  return state.last_pulse;
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+uint32_t BasicReactorModel<Scalar, CONFIGURATION>::get_pulses_fired() {
+  return state.pulses_fired;
+}
+
+/// The peak is the highest power at the end of a tick. The sub-steps keep the
+/// ticks short against the period, so it's within a fraction of a percent
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::update_pulse(
+    double power_at_tick_start_watts, double tick_seconds) {
+  double power_watts = (double)get_power_watts();
+  double seconds_since_fired =
+      state.time_elapsed_seconds - state.pulse_fired_seconds;
+
+  // The trapezoidal rule, the power changes a lot in a tick on the way up
+  state.pulse.energy_J +=
+      0.5 * (power_at_tick_start_watts + power_watts) * tick_seconds;
+
+  if (power_watts > state.pulse.peak_power_watts) {
+    state.pulse.peak_power_watts = power_watts;
+    state.pulse.seconds_to_peak = seconds_since_fired;
+  }
+
+  state.pulse.peak_fuel_temperature_celcius =
+      std::max(state.pulse.peak_fuel_temperature_celcius,
+               (double)get_hottest_fuel_temperature_celcius());
+  state.pulse.most_kinetics_sub_steps = std::max(
+      state.pulse.most_kinetics_sub_steps, calculate_prompt_period_sub_steps());
+
+  if (seconds_since_fired >= PULSE_DURATION_SECONDS) {
+    if (scrams_enabled) {
+      scram();
+    } else {
+      end_pulse();
+    }
+  }
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+void BasicReactorModel<Scalar, CONFIGURATION>::end_pulse() {
+  state.pulse_in_progress = false;
+  state.last_pulse = state.pulse;
+}
+
+template class BasicReactorModel<double>;
+template class BasicReactorModel<float>;
+template class BasicReactorModel<Q32_32>;
+template class BasicReactor<double>;
+template class BasicReactor<float>;
+template class BasicReactor<Q32_32>;
+
+// Every other configuration has to be instantiated here too
+template class BasicReactorModel<double, EXAMPLE_80_ELEMENT_TRIGA_CONFIGURATION>;
+template class BasicReactorModel<float, EXAMPLE_80_ELEMENT_TRIGA_CONFIGURATION>;
+template class BasicReactor<double, EXAMPLE_80_ELEMENT_TRIGA_CONFIGURATION>;
+template class BasicReactor<float, EXAMPLE_80_ELEMENT_TRIGA_CONFIGURATION>;
+
+// Another number of delayed neutron groups
+template class BasicReactorModel<double, JSI_TRIGA_8_GROUP_CONFIGURATION>;
+template class BasicReactor<double, JSI_TRIGA_8_GROUP_CONFIGURATION>;
+
+// Parameters set at runtime
+template class BasicReactorModel<double, RUNTIME_TRIGA_CONFIGURATION>;
+template class BasicReactor<double, RUNTIME_TRIGA_CONFIGURATION>;
@@ -4,11 +4,762 @@
 // PC-based JSI research reactor simulator -
 // https://www.sciencedirect.com/science/article/pii/S0306454920303285#s0010
 #include "control_rod.hpp"
+#include "decay_heat_groups.hpp"
+#include "fixed_point.hpp"
+#include "fuel_element_temperatures.hpp"
+#include "integrators.hpp"
+#include "precursor_groups.hpp"
+#include "reactor_configuration.hpp"
+#include "thermal_approximations.hpp"
+#include <algorithm>
+#include <array>
 #include <stdint.h>
+#include <type_traits>
+
+/// How the reactor model uses a scalar type
+template <typename Scalar> struct ReactorScalarTraits {
+  /// Type the Cardano cubic and the air convection are worked out in, they go
+  /// through constants far too small for fixed point
+  using Math = Scalar;
+  /// How many neutrons one unit of neutrons_in_core and of the precursor
+  /// populations stands for
+  static constexpr double NEUTRONS_PER_UNIT = 1.0;
+};
+
+/// Q32.32 only goes up to about 2.1e9, far below the 1e15 or so precursors at
+/// full power, so it counts in units of 1e8 neutrons (a resolution of 0.23
+/// neutrons), and does its tiny constant math in float
+template <> struct ReactorScalarTraits<Q32_32> {
+  using Math = float;
+  static constexpr double NEUTRONS_PER_UNIT = 1e8;
+};
+
+/// Format of BasicReactor::ReactorSnapshot, raised whenever what's in a
+/// snapshot or how it's laid out changes
+constexpr uint32_t REACTOR_SNAPSHOT_VERSION = 15;
+/// "VTRS" in the first bytes of a snapshot, on a little endian machine
+constexpr uint32_t REACTOR_SNAPSHOT_MAGIC = 0x53525456;
+
+/// Why a snapshot was or wasn't loaded, see BasicReactor::load_snapshot
+enum class SnapshotStatus {
+  LOADED,
+  /// The data isn't a snapshot at all, like an erased flash sector
+  NOT_A_SNAPSHOT,
+  /// Saved by a version of the simulator with another snapshot format
+  OTHER_VERSION,
+  /// Saved by a reactor with another scalar type or state layout, which
+  /// includes the same reactor built for another platform
+  OTHER_REACTOR,
+  /// Saved with other parameters than the reactor's compile time
+  /// configuration
+  OTHER_PARAMETERS,
+  /// The checksum doesn't match, the data was damaged after it was saved
+  CORRUPTED,
+  /// A rod's worth curve doesn't fit next to the curves already loaded, see
+  /// ControlRod::MAX_WORTH_CURVES
+  TOO_MANY_WORTH_CURVES,
+};
+
+constexpr const char *describe_snapshot_status(SnapshotStatus status) {
+  switch (status) {
+  case SnapshotStatus::LOADED:
+    return "loaded";
+  case SnapshotStatus::NOT_A_SNAPSHOT:
+    return "not a reactor snapshot";
+  case SnapshotStatus::OTHER_VERSION:
+    return "saved in another snapshot format";
+  case SnapshotStatus::OTHER_REACTOR:
+    return "saved by another reactor type or platform";
+  case SnapshotStatus::OTHER_PARAMETERS:
+    return "saved with other reactor parameters";
+  case SnapshotStatus::CORRUPTED:
+    return "checksum mismatch";
+  case SnapshotStatus::TOO_MANY_WORTH_CURVES:
+    return "too many control rod worth curves loaded";
+  }
+
+  return "unknown";
+}
+
+/// Why BasicReactor::tick_n stopped, at the end of the tick it happened in
+enum class TickBatchStop {
+  /// Took all the ticks it was asked to
+  COMPLETED,
+  SCRAM_STARTED,
+  SCRAM_ENDED,
+  /// A rod that was moving got to its target
+  CONTROL_ROD_REACHED_TARGET,
+  /// The reactor became or stopped being quiescent, see adaptive_tick_rate,
+  /// so the ticks after it are of another length
+  TICK_LENGTH_CHANGED,
+  /// A pulse ended without a SCRAM, with SCRAMs off. Its report is ready, see
+  /// BasicReactor::get_last_pulse
+  PULSE_ENDED,
+};
+
+constexpr const char *describe_tick_batch_stop(TickBatchStop stop) {
+  switch (stop) {
+  case TickBatchStop::COMPLETED:
+    return "completed";
+  case TickBatchStop::SCRAM_STARTED:
+    return "SCRAM started";
+  case TickBatchStop::SCRAM_ENDED:
+    return "SCRAM ended";
+  case TickBatchStop::CONTROL_ROD_REACHED_TARGET:
+    return "a control rod reached its target";
+  case TickBatchStop::TICK_LENGTH_CHANGED:
+    return "tick length changed";
+  case TickBatchStop::PULSE_ENDED:
+    return "pulse ended";
+  }
+
+  return "unknown";
+}
+
+/// What BasicReactor::tick_n did
+struct TickBatch {
+  uint32_t ticks;
+  TickBatchStop stop;
+};
+
+/// What a pulse did, from BasicReactor::fire_pulse to its end
+struct PulseReport {
+  /// What the transient rod was worth when it was fired, the reactivity the
+  /// pulse inserts
+  double inserted_reactivity_pcm;
+  double peak_power_watts;
+  /// From firing to the peak power
+  double seconds_to_peak;
+  /// Released from firing to the end of the pulse
+  double energy_J;
+  /// Of the hottest fuel node with fuel_element_temperatures
+  double peak_fuel_temperature_celcius;
+  /// Most sub-steps the kinetics took in a tick, see
+  /// KINETICS_SUB_STEPS_PER_PROMPT_PERIOD
+  uint32_t most_kinetics_sub_steps;
+};
+
+/// Everything the reactor model needs from a ReactorConfiguration, worked out
+/// once and already in the types it's used in.
+///
+/// Only the values a tick reads, folded as far as they can be without changing
+/// the rounding of the math that uses them, and the constants of the precursor
+/// and decay heat groups. For a compile time configuration they are constants,
+/// for runtime parameters they are worked out again whenever the parameters
+/// are applied
+template <typename Scalar, uint8_t GROUPS> struct ReactorCoefficients {
+  using Traits = ReactorScalarTraits<Scalar>;
+  using Math = typename Traits::Math;
+
+  // == Kinetics ==
+  Scalar prompt_neutron_lifetime_seconds;
+  PrecursorGroupConstants<GROUPS, Scalar> precursor_groups;
+  /// The source, S, in neutron units per second
+  Scalar source_neutron_units_per_second;
+  /// The source in neutrons per second, for the logarithmic representation
+  Math source_neutrons_per_second;
+
+  // == Power and flux ==
+  // Kept apart, the neutrons are multiplied in first
+  Math neutron_velocity_meters_per_second;
+  Math neutron_fission_energy_released_MeV;
+  double neutron_velocity_meters_per_second_double;
+  double neutron_fission_energy_released_MeV_double;
+  /// Neutron velocity over the core volume, in 1/(cm^2 s)
+  double flux_per_neutron;
+
+  // == Fuel ==
+  Scalar fuel_elements_in_core;
+  Scalar fuel_mass_kg;
+  /// Cp(T) times the fuel mass, c0 + c1 T, see approximate_thermal_math
+  Scalar fuel_capacity_J_per_K_c0;
+  Scalar fuel_capacity_J_per_K_c1;
+  /// The stationary fuel temperature polynomial
+  Math temperature_fe_stat_a0;
+  Math temperature_fe_stat_a1;
+  Math temperature_fe_stat_a2;
+  // Cardano's formula for the power exchanged, see
+  // calculate_power_exchanged_joule_per_second
+  Math cardano_first;
+  Math cardano_second_constant;
+  Math cardano_second_per_K;
+  Math cardano_result_scale;
+  /// Fuel temperature feedback, see calculate_fuel_temperature_feedback_pcm
+  Scalar fuel_t_feedback_coefficient_0_c_pcm_per_c;
+  Scalar fuel_t_feedback_coefficient_240_c_pcm_per_c;
+  Scalar fuel_t_feedback_coefficient_difference_pcm_per_c;
+  Scalar fuel_t_feedback_coefficient_slope_after_peak_pcm_per_c_squared;
+  /// The same feedback folded into T (c0 + c1 T) on each side of 240 C
+  Scalar fuel_feedback_below_240_c_c0;
+  Scalar fuel_feedback_below_240_c_c1;
+  Scalar fuel_feedback_above_240_c_c0;
+  Scalar fuel_feedback_above_240_c_c1;
+
+  /// The P_fe_stat table of approximate_thermal_math, for the parameters
+  const PiecewiseCubic<Math, 256> *power_exchanged_approximation;
+
+  // == Water ==
+  Scalar water_active_cooling_power_watts;
+  Scalar water_heat_capacity_J_per_K;
+
+  // == Reactivity and SCRAM limits ==
+  Scalar excess_reactivity_pcm;
+  Scalar power_scram_watts;
+  Scalar fuel_temperature_scram_celcius;
+  Scalar water_temperature_scram_celcius;
+
+  // == Control rods ==
+  /// Safety, regulating and compensating rod, in that order
+  std::array<uint32_t, 3> control_rod_speeds_steps_per_second;
+  std::array<uint32_t, 3> control_rod_accelerations_steps_per_second_squared;
+
+  // == Fission products ==
+  /// Fissions in each cm^3 of the core for each joule, the xenon poisoning's
+  /// source
+  double fissions_per_cm3_per_joule;
+  double thermal_flux_per_watt;
+  /// Reactivity taken away by each atom of Xe-135 in a cm^3,
+  /// sigma_Xe / (nu Sigma_f)
+  double xenon_pcm_per_atom_per_cm3;
+  /// Part of the power that heats the fuel the moment it's generated, the
+  /// rest is decay heat
+  Scalar prompt_heat_fraction;
+  DecayHeatGroupConstants<DECAY_HEAT_GROUPS> decay_heat_groups;
+
+  /// Works out the coefficients of a configuration, with the P_fe_stat table
+  /// worked out from it
+  static constexpr ReactorCoefficients
+  calculate(const BasicReactorConfiguration<GROUPS> &configuration,
+            const PiecewiseCubic<Math, 256> *power_exchanged_approximation) {
+    double A0 = configuration.temperature_fe_stat_a0;
+    double A1 = configuration.temperature_fe_stat_a1;
+    double A2 = configuration.temperature_fe_stat_a2;
+
+    return {
+        .prompt_neutron_lifetime_seconds =
+            Scalar(configuration.prompt_neutron_lifetime_seconds),
+        .precursor_groups = PrecursorGroupConstants<GROUPS, Scalar>::calculate(
+            configuration.delayed_neutron_fractions, configuration.decay_times,
+            configuration.prompt_neutron_lifetime_seconds),
+        .source_neutron_units_per_second =
+            Scalar(configuration.neutron_source_intensity_neutrons_per_second /
+                   Traits::NEUTRONS_PER_UNIT),
+        .source_neutrons_per_second =
+            Math(configuration.neutron_source_intensity_neutrons_per_second),
+
+        .neutron_velocity_meters_per_second =
+            Math(configuration.neutron_velocity_meters_per_second),
+        .neutron_fission_energy_released_MeV =
+            Math(configuration.neutron_fission_energy_released_MeV),
+        .neutron_velocity_meters_per_second_double =
+            configuration.neutron_velocity_meters_per_second,
+        .neutron_fission_energy_released_MeV_double =
+            configuration.neutron_fission_energy_released_MeV,
+        .flux_per_neutron =
+            (configuration.neutron_velocity_meters_per_second * 100.0) /
+            (configuration.core_volume_liters * 10.0 * 10.0 * 10.0),
+
+        .fuel_elements_in_core = Scalar(configuration.fuel_elements_in_core),
+        .fuel_mass_kg = Scalar(configuration.calculate_fuel_mass_kg()),
+        .fuel_capacity_J_per_K_c0 =
+            Scalar(calculate_fuel_capacity_J_per_K_c0(configuration)),
+        .fuel_capacity_J_per_K_c1 =
+            Scalar(calculate_fuel_capacity_J_per_K_c1(configuration)),
+        .temperature_fe_stat_a0 = Math(A0),
+        .temperature_fe_stat_a1 = Math(A1),
+        .temperature_fe_stat_a2 = Math(A2),
+        .cardano_first = Math(A1 * A1 - 3.0 * A0 * A2),
+        .cardano_second_constant =
+            Math(2.0 * A1 * A1 * A1 - 9.0 * A0 * A1 * A2),
+        .cardano_second_per_K = Math(27.0 * A2 * A2),
+        .cardano_result_scale =
+            Math(-(double)configuration.fuel_elements_in_core *
+                 (1.0 / (3.0 * A2))),
+        .fuel_t_feedback_coefficient_0_c_pcm_per_c =
+            Scalar(configuration.fuel_t_feedback_coefficient_0_c_pcm_per_c),
+        .fuel_t_feedback_coefficient_240_c_pcm_per_c =
+            Scalar(configuration.fuel_t_feedback_coefficient_240_c_pcm_per_c),
+        .fuel_t_feedback_coefficient_difference_pcm_per_c =
+            Scalar(configuration.fuel_t_feedback_coefficient_240_c_pcm_per_c -
+                   configuration.fuel_t_feedback_coefficient_0_c_pcm_per_c),
+        .fuel_t_feedback_coefficient_slope_after_peak_pcm_per_c_squared =
+            Scalar(configuration
+                       .fuel_t_feedback_coefficient_slope_after_peak_pcm_per_c_squared),
+        .fuel_feedback_below_240_c_c0 =
+            Scalar(calculate_fuel_feedback_below_240_c_c0(configuration)),
+        .fuel_feedback_below_240_c_c1 =
+            Scalar(calculate_fuel_feedback_below_240_c_c1(configuration)),
+        .fuel_feedback_above_240_c_c0 =
+            Scalar(calculate_fuel_feedback_above_240_c_c0(configuration)),
+        .fuel_feedback_above_240_c_c1 =
+            Scalar(calculate_fuel_feedback_above_240_c_c1(configuration)),
+        .power_exchanged_approximation = power_exchanged_approximation,
+
+        .water_active_cooling_power_watts =
+            Scalar(configuration.water_active_cooling_power_watts),
+        .water_heat_capacity_J_per_K =
+            Scalar(configuration.calculate_water_heat_capacity_J_per_K()),
+
+        .excess_reactivity_pcm = Scalar(configuration.excess_reactivity_pcm),
+        .power_scram_watts = Scalar(configuration.power_scram_watts),
+        .fuel_temperature_scram_celcius =
+            Scalar(configuration.fuel_temperature_scram_celcius),
+        .water_temperature_scram_celcius =
+            Scalar(configuration.water_temperature_scram_celcius),
+
+        .control_rod_speeds_steps_per_second =
+            {configuration.safety_rod_speed_per_second,
+             configuration.regulating_rod_speed_per_second,
+             configuration.compensating_rod_speed_per_second},
+        .control_rod_accelerations_steps_per_second_squared =
+            {configuration.safety_rod_acceleration_per_second_squared,
+             configuration.regulating_rod_acceleration_per_second_squared,
+             configuration.compensating_rod_acceleration_per_second_squared},
+
+        .fissions_per_cm3_per_joule =
+            configuration.calculate_fissions_per_cm3_per_joule(),
+        .thermal_flux_per_watt = configuration.thermal_flux_per_watt,
+        // Sigma_f is the fissions over the flux, both per watt
+        .xenon_pcm_per_atom_per_cm3 =
+            1e5 * XENON_135_ABSORPTION_CROSS_SECTION_CM2 *
+            configuration.thermal_flux_per_watt /
+            (NEUTRONS_PER_FISSION *
+             configuration.calculate_fissions_per_cm3_per_joule()),
+        .prompt_heat_fraction =
+            Scalar(1.0 - configuration.calculate_decay_heat_fraction()),
+        .decay_heat_groups = DecayHeatGroupConstants<DECAY_HEAT_GROUPS>::
+            calculate(DECAY_HEAT_GROUP_POWERS_MEV_PER_SECOND,
+                      DECAY_HEAT_DECAY_CONSTANTS_PER_SECOND,
+                      configuration.neutron_fission_energy_released_MeV),
+    };
+  }
+};
+
+/// What a tick works out from the coefficients for the length of its steps:
+/// how far the control rods move, and the exponentials of the precursor and
+/// decay heat groups. Kept outside the state, and only worked out again when
+/// the step changes.
+///
+/// The same step always gives the same values, whatever was cached before, so
+/// a state ticks the same with a cache of its own as with a reactor's
+template <typename Scalar, uint8_t GROUPS> struct ReactorTimeStepCoefficients {
+  using ControlRodMotion = typename BasicControlRod<Scalar>::Motion;
+
+  /// The step the control rod motions are for, 0 before they're worked out
+  Scalar control_rods_time_delta_seconds = Scalar(0.0);
+  /// Safety, regulating and compensating rod, in that order
+  std::array<ControlRodMotion, 3> control_rod_motions;
+  PrecursorStepExponentials<GROUPS, Scalar> precursor_step_exponentials;
+  DecayHeatIntervalExponentials<DECAY_HEAT_GROUPS>
+      decay_heat_interval_exponentials;
+
+  /// Drops everything, for when the coefficients changed
+  void clear() {
+    control_rods_time_delta_seconds = Scalar(0.0);
+    precursor_step_exponentials.clear();
+    decay_heat_interval_exponentials.clear();
+  }
+};
+
+/// The switches a reactor model runs with, which a tick doesn't change and
+/// the state doesn't hold, see BasicReactorModel::step
+template <typename Scalar> struct ReactorSwitches {
+  /// Whether or not to take 200kW out of the cooling loop
+  bool active_cooling_system_enabled = true;
+  /// Whether or not to automatically balance the rods
+  bool automatic_control = true;
+  /// Whether or not to check SCRAM conditions
+  bool scrams_enabled = true;
+  /// How to move the delayed neutron precursors forward each tick.
+  ///
+  /// The exponential one stays accurate at much larger time steps than euler
+  PrecursorIntegration precursor_integration = PrecursorIntegration::EULER;
+  /// How to move the continuous state forward each tick.
+  ///
+  /// precursor_integration only applies to Integrator::EULER, the Runge-Kutta
+  /// integrators move the precursors together with the rest of the state
+  Integrator integrator = Integrator::EULER;
+  /// Whether to calculate the neutrons with the prompt jump approximation,
+  /// so only the slow dynamics are integrated and 5-20 ms steps are valid.
+  ///
+  /// Falls back to the full kinetics with short sub-steps when the
+  /// reactivity nears prompt critical. Only applies to Integrator::EULER
+  bool prompt_jump = false;
+  /// Every how many ticks to update the fuel and water temperatures, with the
+  /// energy generated over all the ticks since their last update.
+  ///
+  /// At the default 0.1 ms step, 10 and 1000 update the fuel at 1 kHz and the
+  /// water at 10 Hz. Only applies to Integrator::EULER
+  uint32_t fuel_temperature_update_interval_ticks = 1;
+  uint32_t water_temperature_update_interval_ticks = 1;
+  /// How far the fuel temperature has to move from where the fuel
+  /// temperature feedback was last calculated before it's calculated again.
+  ///
+  /// The control rod worths are only recalculated when a rod moved. At 0 the
+  /// reactivity is the same as recalculating everything every tick
+  Scalar fuel_temperature_feedback_tolerance_celcius = 0.0;
+  /// Whether to use the compile time approximations of
+  /// thermal_approximations.hpp for the fuel to water power, the convection
+  /// to air, the fuel heat capacity and the fuel temperature feedback,
+  /// instead of the cube and square roots.
+  ///
+  /// The power and convection tables are within 1 W and 0.5 W, the heat
+  /// capacity and feedback are the same polynomials with their constants
+  /// folded. Outside the tables the exact math is used
+  bool approximate_thermal_math = false;
+  /// Whether to tick QUIESCENT_TICKS_PER_TICK times longer once the reactor
+  /// has been quiescent for QUIESCENCE_CHECKS_BEFORE_SLOWING checks, see
+  /// calculate_quiescent.
+  ///
+  /// The long ticks use the prompt jump approximation with
+  /// PrecursorIntegration::EXPONENTIAL, whatever prompt_jump
+  /// and precursor_integration are. The next tick is full rate again as soon
+  /// as a rod target, the target power, the automatic control or cooling
+  /// switch changes, or there is a SCRAM. Only applies to Integrator::EULER
+  bool adaptive_tick_rate = false;
+  /// Whether I-135 and Xe-135 build up from the fissions and the xenon takes
+  /// away reactivity.
+  ///
+  /// Their half lives are hours, so they're only updated every
+  /// XENON_UPDATE_INTERVAL_SECONDS of simulated time, exactly for the average
+  /// power since the last update. A tick only adds up its energy. Turned off,
+  /// the xenon stays where it was. Loading a steady state loads the xenon it
+  /// was worked out with, none unless calculate_equilibrium was asked for it
+  /// (initialize_at_equilibrium asks when this is on)
+  bool xenon_poisoning = false;
+  /// Whether the fission products give off a part of the power later, as
+  /// decay heat, so the fuel and water keep heating after a SCRAM.
+  ///
+  /// DECAY_HEAT_GROUPS groups of the ANS-5.1 fit are fed by the fission
+  /// power, and hold back about 6.6 % of it after a long run. They are
+  /// updated every DECAY_HEAT_UPDATE_INTERVAL_SECONDS of simulated time for
+  /// the average power since the last update, a tick only adds up its
+  /// energy. The steady states of calculate_equilibrium are after a long run,
+  /// loading one sets the groups at equilibrium with the power, with or
+  /// without the xenon
+  bool decay_heat = false;
+  /// Whether the fuel has a temperature for each element, in
+  /// FUEL_ELEMENT_AXIAL_NODES nodes along it, each heated by its share of the
+  /// power, see FuelElementTemperatures.
+  ///
+  /// fuel_temperature_celcius is then their average weighted by the power,
+  /// which the fuel temperature feedback is worked out from, and the fuel
+  /// temperature SCRAM trips on the hottest node. The nodes start from the
+  /// lumped temperature when the switch is turned on, and after set_state or
+  /// load_snapshot, loading a steady state puts each at its own. Their power
+  /// map is for the parameters' elements and fuel length. The update is
+  /// vectorized over all the nodes, see the fuel-elements benchmark, and
+  /// always uses the exact P_fe_stat. Only applies to Integrator::EULER, the
+  /// Runge-Kutta integrators move the lumped temperature
+  bool fuel_element_temperatures = false;
+};
+
+/// The reactor model, all the physics of a tick worked out in Scalar on a
+/// ReactorState, with the switches it runs with.
+///
+/// A tick reads CONFIGURATION's coefficients, folded in as compile time
+/// constants, or with the parameters set at runtime the ones the model is
+/// pointed at. The model only refers to the state and the time step
+/// coefficients it ticks: BasicReactor is the model with them, its parameters
+/// and its fuel element nodes, and step ticks any state
+template <typename Scalar,
+          BasicReactorConfiguration CONFIGURATION = JSI_TRIGA_CONFIGURATION>
+class BasicReactorModel : public ReactorSwitches<Scalar> {
+  static_assert(POWER_EXCHANGED_APPROXIMATION_WITHIN_ERROR<CONFIGURATION>,
+                "The fuel to water power table is too far from Cardano's "
+                "formula for this configuration");
 
-class Reactor {
 public:
-  Reactor();
+  using Switches = ReactorSwitches<Scalar>;
+  using Switches::active_cooling_system_enabled;
+  using Switches::automatic_control;
+  using Switches::scrams_enabled;
+  using Switches::precursor_integration;
+  using Switches::integrator;
+  using Switches::prompt_jump;
+  using Switches::fuel_temperature_update_interval_ticks;
+  using Switches::water_temperature_update_interval_ticks;
+  using Switches::fuel_temperature_feedback_tolerance_celcius;
+  using Switches::approximate_thermal_math;
+  using Switches::adaptive_tick_rate;
+  using Switches::xenon_poisoning;
+  using Switches::decay_heat;
+  using Switches::fuel_element_temperatures;
+
+  /// CONFIGURATION's type, with its number of delayed neutron groups
+  using Configuration = std::remove_cvref_t<decltype(CONFIGURATION)>;
+  /// Number of delayed neutron groups, from CONFIGURATION's group data
+  static constexpr uint8_t GROUPS =
+      CONFIGURATION.delayed_neutron_fractions.size();
+  /// Number of values in the continuous state, see get_state_vector
+  static constexpr uint8_t STATE_VECTOR_SIZE = GROUPS + 3;
+  /// The continuous state of the reactor, N, C1 to Ci, the fuel temperature
+  /// and the water temperature, in that order
+  using StateVector = std::array<Scalar, STATE_VECTOR_SIZE>;
+  using ControlRod = BasicControlRod<Scalar>;
+  using Traits = ReactorScalarTraits<Scalar>;
+  using Math = typename Traits::Math;
+  using Coefficients = ReactorCoefficients<Scalar, GROUPS>;
+  using TimeStepCoefficients = ReactorTimeStepCoefficients<Scalar, GROUPS>;
+  /// The most fuel elements there are nodes for, CONFIGURATION's, or
+  /// FUEL_ELEMENT_TEMPERATURES_MAX_ELEMENTS with the parameters set at
+  /// runtime
+  static constexpr size_t MAX_FUEL_ELEMENTS =
+      CONFIGURATION.parameters_at_runtime
+          ? FUEL_ELEMENT_TEMPERATURES_MAX_ELEMENTS
+          : CONFIGURATION.fuel_elements_in_core;
+  /// A node for each element, see fuel_element_temperatures
+  using FuelElements =
+      FuelElementTemperatures<MAX_FUEL_ELEMENTS, FUEL_ELEMENT_AXIAL_NODES>;
+
+  /// Whether the parameters can be changed with apply_parameters
+  static constexpr bool PARAMETERS_AT_RUNTIME =
+      CONFIGURATION.parameters_at_runtime;
+  /// The coefficients of CONFIGURATION, folded into every tick unless the
+  /// parameters are set at runtime
+  static constexpr Coefficients CONFIGURATION_COEFFICIENTS =
+      Coefficients::calculate(CONFIGURATION,
+                              &POWER_EXCHANGED_APPROXIMATION<Math, CONFIGURATION>);
+
+  /// Quantities worked out from the state, kept so they are only calculated
+  /// once per tick, see get_power_watts
+  struct DerivedQuantities {
+    Scalar power_watts;
+    double power_MeV_per_second;
+    double flux;
+    Scalar control_rod_worths_pcm;
+    Scalar fuel_temperature_feedback_pcm;
+  };
+
+  /// How many times each term of the reactivity was recalculated, see
+  /// fuel_temperature_feedback_tolerance_celcius
+  struct ReactivityRecalculations {
+    /// Times the reactivity was updated from its terms
+    uint64_t reactivity;
+    /// Safety, regulating and compensating rod, in that order
+    std::array<uint64_t, 3> control_rod_worths;
+    uint64_t fuel_temperature_feedback;
+  };
+
+  /// What an operator or the controller sets between ticks
+  struct ReactorInputs {
+    /// Targets of the safety, regulating and compensating rods
+    std::array<uint32_t, 3> control_rod_target_positions;
+    uint32_t target_thermal_power_watts;
+    bool automatic_control;
+    bool active_cooling_system_enabled;
+    /// Starts a SCRAM before the tick, if there isn't one
+    bool scram;
+
+    constexpr bool operator==(const ReactorInputs &) const = default;
+  };
+
+  /// Everything that changes as the reactor runs, in a plain struct, so
+  /// copying, snapshotting and rolling back a reactor is a memcpy.
+  ///
+  /// Only what changes is in it: the precursor and decay heat groups are
+  /// their populations and energies, the control rods their positions and
+  /// velocities. Their constants and speeds are in the coefficients, and what
+  /// is worked out from them for a step in the time step coefficients. The
+  /// rods' worth curves are shared, a rod only keeps which one it uses. The
+  /// parameters, switches and controller aren't in it, see step
+  struct ReactorState {
+    /// Time for each simulation step, in seconds
+    float time_delta_seconds = 1e-4;
+    /// The step Integrator::RK45 and Integrator::ROSENBROCK23 take next,
+    /// which they adapt every tick. 0 until the first of their ticks, which
+    /// starts from time_delta_seconds
+    float adaptive_time_delta_seconds = 0.0;
+    /// How many loops we've calculated
+    uint64_t steps_elapsed = 0;
+    /// Simulated time, the sum of all steps taken
+    double time_elapsed_seconds = 0.0;
+
+    // Scram data
+    /// Is a scram active?
+    bool in_scram = false;
+    /// The step we started the scram
+    uint64_t step_scram_started = 0;
+
+    // Temperatures
+    Scalar water_temperature_celcius = 20.0;
+    Scalar fuel_temperature_celcius = 20.0;
+
+    // Energy and time since the last temperature updates, see
+    // fuel_temperature_update_interval_ticks
+    Scalar fuel_energy_since_update_J = 0.0;
+    Scalar fuel_seconds_since_update = 0.0;
+    uint32_t fuel_ticks_since_update = 0;
+    Scalar water_energy_since_update_J = 0.0;
+    Scalar water_seconds_since_update = 0.0;
+    uint32_t water_ticks_since_update = 0;
+
+    /// Calculated once per tick, see update_derived_power and
+    /// update_derived_reactivity
+    DerivedQuantities derived_quantities = {};
+
+    // What the reactivity terms were last calculated from, see
+    // update_derived_reactivity. No rod can be at UINT32_MAX, so the first
+    // update calculates everything
+    std::array<uint32_t, 3> control_rod_positions_at_worths = {
+        UINT32_MAX, UINT32_MAX, UINT32_MAX};
+    std::array<uint32_t, 3> control_rod_curve_revisions_at_worths = {};
+    std::array<Scalar, 3> control_rod_worths_pcm = {};
+    Scalar fuel_temperature_at_feedback_celcius = 0.0;
+    bool fuel_temperature_feedback_calculated = false;
+    ReactivityRecalculations reactivity_recalculations = {};
+
+    // Reactivity and neutrons
+    /// Calculated by the constructor, once the control rods exist
+    Scalar reactivity_pcm = 0.0;
+    /// In neutron units, see ReactorScalarTraits
+    Scalar neutrons_in_core = 0.0;
+    /// Whether the last tick used the prompt jump approximation
+    bool prompt_jump_active = false;
+
+    /// Whether log_neutrons_in_core is integrated, and the precursor
+    /// populations are relative to the neutrons. neutrons_in_core is then
+    /// worked out from it after every step
+    bool logarithmic_neutron_population = false;
+    /// ln(N), in neutrons whatever the scalar type
+    Scalar log_neutrons_in_core = 0.0;
+    /// What the compensated sum of ln(N) lost to rounding, negated
+    Scalar log_neutrons_in_core_compensation = 0.0;
+
+    /// Delayed neutron precursors, Ci(t), in neutron units. The groups'
+    /// constants are in the coefficients
+    PrecursorGroups<GROUPS, Scalar> precursor_groups = {};
+
+    // Control rods, their velocities per time_delta_seconds. Their speeds are
+    // in the coefficients
+    //
+    // See section 2.7 of
+    // https://www.sciencedirect.com/science/article/pii/S0306454920303285#t0005
+    ControlRod safety_control_rod;
+    ControlRod regulating_control_rod;
+    /// Also called shim sometimes
+    ControlRod compensating_control_rod;
+    /// A bit for each rod that got to its target in the last tick and wasn't
+    /// sent on by the controller, as calculate_control_rods_moving. See
+    /// tick_n
+    uint8_t control_rods_reached_target = 0;
+    /// Simulated time since the controller's last sample, it takes the next
+    /// once this is RCS_SAMPLE_PERIOD_MICROSECONDS. Stops counting there
+    uint32_t rcs_microseconds_since_sample = RCS_SAMPLE_PERIOD_MICROSECONDS;
+
+    // Quiescence, see adaptive_tick_rate
+    /// Whether the ticks are QUIESCENT_TICKS_PER_TICK full rate ticks long
+    bool quiescent = false;
+    /// The step to go back to when the reactor stops being quiescent
+    float full_rate_time_delta_seconds = 1e-4;
+    /// How many checks in a row found the reactor quiescent
+    uint32_t quiescent_checks_passed = 0;
+    /// What the inputs were when the ticks got longer, any change ends it
+    ReactorInputs inputs_at_quiescence = {};
+
+    // Fission product poisoning, see xenon_poisoning
+    /// I-135 and Xe-135 in the core, in atoms per cm^3
+    double iodine_atoms_per_cm3 = 0.0;
+    double xenon_atoms_per_cm3 = 0.0;
+    /// Reactivity the xenon takes away, worked out at each update
+    Scalar xenon_worth_pcm = 0.0;
+    // Energy and time since the last update, see
+    // XENON_UPDATE_INTERVAL_SECONDS
+    double fission_products_energy_since_update_J = 0.0;
+    double fission_products_seconds_since_update = 0.0;
+
+    // Decay heat, see decay_heat. The groups' constants are in the
+    // coefficients
+    DecayHeatGroups<DECAY_HEAT_GROUPS> decay_heat_groups = {};
+    /// The groups' decay heat, worked out at each update
+    Scalar decay_heat_watts = 0.0;
+    // Energy and time since the last update, see
+    // DECAY_HEAT_UPDATE_INTERVAL_MICROSECONDS
+    double decay_heat_energy_since_update_J = 0.0;
+    double decay_heat_seconds_since_update = 0.0;
+    uint32_t decay_heat_microseconds_since_update = 0;
+
+    /// Whether the fuel element nodes, which are kept outside the state,
+    /// moved with fuel_temperature_celcius since they were last set,
+    /// otherwise they start from it again at the next update
+    bool fuel_elements_current = false;
+
+    // Pulse mode, see fire_pulse
+    bool pulse_in_progress = false;
+    /// Simulated time the pulse in progress was fired at
+    double pulse_fired_seconds = 0.0;
+    /// The power at the start of the tick, for the energy of a pulse
+    double pulse_power_at_tick_start_watts = 0.0;
+    /// Of the pulse in progress so far, and of the last one to end
+    PulseReport pulse = {};
+    PulseReport last_pulse = {};
+    uint32_t pulses_fired = 0;
+  };
+  static_assert(std::is_trivially_copyable_v<ReactorState>);
+
+  /// I-135 and Xe-135 in the core, in atoms per cm^3, and the reactivity the
+  /// xenon takes away
+  struct FissionProducts {
+    double iodine_atoms_per_cm3;
+    double xenon_atoms_per_cm3;
+    double xenon_worth_pcm;
+  };
+
+  /// A steady state of the reactor, from calculate_equilibrium or one of the
+  /// presets. Small and worked out in constexpr, so the compiler can solve
+  /// them and keep them as constant data, see reactor_presets.hpp.
+  ///
+  /// Every one is after a long run at its power: the decay heat groups are
+  /// at equilibrium with it, and so is the xenon if it was worked out with
+  /// xenon poisoning. Without, there's no xenon in it, as in a reactor with
+  /// xenon_poisoning off
+  struct Equilibrium {
+    Scalar power_watts;
+    Scalar water_temperature_celcius;
+    Scalar fuel_temperature_celcius;
+    /// In neutron units, see ReactorScalarTraits
+    Scalar neutrons_in_core;
+    std::array<Scalar, GROUPS> precursor_populations;
+    /// The reactivity that holds the neutrons against the source,
+    /// -S * lifetime / N. Kept in double with the rod worths, as the rods are
+    /// placed to a fraction of a step of them
+    double reactivity_pcm;
+    /// What the three rods together are worth at it
+    double control_rod_worths_pcm;
+    /// All 0 without xenon poisoning
+    FissionProducts fission_products;
+    /// Safety, regulating and compensating rod, in that order
+    std::array<uint32_t, 3> control_rod_positions;
+    /// Held at the power by the regulating rod, which the RCS then targets,
+    /// rather than shut down with the rods in
+    bool critical;
+  };
+
+  /// How far a preset is from a steady state, see calculate_preset_residuals
+  struct EquilibriumResiduals {
+    /// Reactivity of the rods where they are, less the one the neutrons need
+    double reactivity_pcm;
+    /// Largest relative difference between beta_i / lifetime * N and
+    /// lambda_i * Ci of the groups, 0 when no dCi/dt is left
+    double precursor_imbalance;
+    /// Power generated less the power the fuel passes to the water,
+    /// P_fe_stat, 0 when the fuel temperature stays put
+    double fuel_power_watts;
+  };
+
+  /// Gets the coefficients worked out from the parameters
+  const Coefficients &get_coefficients();
+  /// Gets everything that changes as the reactor runs
+  const ReactorState &get_state();
+  /// Replaces everything that changes as the reactor runs, with a state from
+  /// get_state or step. The fuel element nodes aren't in it, they start from
+  /// its fuel temperature again
+  void set_state(const ReactorState &new_state);
+
+  /// Gets the rod targets, target power and switches the next tick runs with
+  ReactorInputs get_inputs();
+  /// Sets the rod targets, target power and switches, and SCRAMs if asked to
+  void set_inputs(const ReactorInputs &inputs);
 
   ControlRod *get_safety_control_rod();
   ControlRod *get_regulating_control_rod();
@@ -17,22 +768,31 @@ public:
   ControlRod *get_shim_control_rod();
 
   float get_time_delta_seconds();
+  /// Sets the step, which the adaptive integrators start from again
   void set_time_delta_seconds(float time_delta_s);
+  /// The step the adaptive integrators take next, or 0 before their first
+  float get_adaptive_time_delta_seconds();
 
   double get_time_elapsed_seconds();
   uint64_t get_steps_elapsed();
 
-  double get_fuel_temperature_celcius();
-  double get_water_temperature_celcius();
+  Scalar get_fuel_temperature_celcius();
+  Scalar get_water_temperature_celcius();
+  /// Gets the hottest fuel node with fuel_element_temperatures, as of its
+  /// last update, otherwise the fuel temperature
+  Scalar get_hottest_fuel_temperature_celcius();
 
-  double get_reactivity_pcm();
-  double get_reactivity_no_units();
+  Scalar get_reactivity_pcm();
+  Scalar get_reactivity_no_units();
 
+  /// Gets the neutrons in the core, in neutrons whatever the scalar type
   double get_neutrons_in_core();
 
+  /// Group getters, group is between 1 and GROUPS. The population is in
+  /// neutrons whatever the scalar type
   double get_neutron_population_for_group(uint8_t group);
-  double get_delayed_neutron_fraction_for_group(uint8_t group);
-  double get_neutron_decay_time_for_group(uint8_t group);
+  Scalar get_delayed_neutron_fraction_for_group(uint8_t group);
+  Scalar get_neutron_decay_time_for_group(uint8_t group);
 
   /// Sets the power the RCS should try to keep the reactor at
   void set_target_thermal_power_watts(uint32_t target);
@@ -48,20 +808,43 @@ public:
   uint64_t get_steps_since_scram_started();
 
   // Physical simulation steps
-  /// Calculates the first kinetic point equation, dN(t)/dt
-  double calculate_dN_dt();
+  /// Calculates the first kinetic point equation, dN(t)/dt, in neutron units
+  /// (see ReactorScalarTraits) per second
+  Scalar calculate_dN_dt();
+
+  /// Calculates the second kinetic point equation, dCi(t)/dt, in neutron
+  /// units per second
+  Scalar calculate_dCi_dt(uint8_t i);
 
-  /// Calculates the second kinetic point equation, dCi(t)/dt
-  double calculate_dCi_dt(uint8_t i);
+  /// Calculates the neutrons in the core with the prompt jump approximation,
+  /// solving the first kinetic point equation for dN(t)/dt = 0, in neutron
+  /// units
+  Scalar calculate_prompt_jump_neutrons();
+
+  /// Whether the last tick used the prompt jump approximation, false when it
+  /// is off or fell back to the full kinetics
+  bool get_prompt_jump_active();
+
+  /// Switches between integrating the neutrons in the core and integrating
+  /// their logarithm, with the precursors stored relative to the neutrons.
+  ///
+  /// The logarithm keeps the same relative resolution from the source level
+  /// up to full power, so a fixed point model no longer runs out of range or
+  /// resolution at either end. It takes the same forward euler steps, and
+  /// the neutrons, power and flux are worked out from it as before. Only
+  /// integrated by Integrator::EULER without the prompt jump, the others
+  /// convert back to the neutrons for their ticks
+  void set_logarithmic_neutron_population(bool enabled);
+  bool get_logarithmic_neutron_population();
 
   /// Calculates the temperature dependent fuel capacity, marked as Cp(t)
-  double calculate_temperature_dependent_fuel_capacity_J_per_kgK(
-      double temperature_celcius);
+  Scalar calculate_temperature_dependent_fuel_capacity_J_per_kgK(
+      Scalar temperature_celcius);
 
   /// Calculates the temperature dependent fuel capacity, marked as Cp(t),
   /// normalized to the mass of the fuel
-  double calculate_temperature_dependent_fuel_capacity_J_per_K(
-      double temperature_celcius);
+  Scalar calculate_temperature_dependent_fuel_capacity_J_per_K(
+      Scalar temperature_celcius);
 
   /// Calculates the power exchanged between the fuel and the environment
   /// based on the temperature.
@@ -71,59 +854,150 @@ public:
   ///
   /// This was essentially stolen from RRS/src/simulator.cpp,
   /// Simulator::getCoolingFromTemperature (L521)
-  double
-  calculate_power_exchanged_joule_per_second(double fuel_temperature_celcius);
+  Scalar
+  calculate_power_exchanged_joule_per_second(Scalar fuel_temperature_celcius);
 
   /// Calcuates the temperature of the fuel element in stationary conditions
   ///
   /// See fig 6
   /// https://www.sciencedirect.com/science/article/pii/S0306454920303285#b0070
-  double calculate_stationary_fuel_temperature();
+  Scalar calculate_stationary_fuel_temperature();
 
   /// Calculates the power produced by each element, P_el
-  double calculate_normalized_power_joule_per_second();
+  Scalar calculate_normalized_power_joule_per_second();
 
   /// Calculates the change to fuel temperature in one time step, in degress
   /// celcius
-  double calculate_fuel_temperature_change_celcius();
+  Scalar calculate_fuel_temperature_change_celcius();
+  /// Calculates the change to fuel temperature over step_seconds at the
+  /// current rates, in degress celcius
+  Scalar calculate_fuel_temperature_change_celcius(Scalar step_seconds);
+  /// Calculates the change to fuel temperature over step_seconds, with the
+  /// energy the reactor generated over those seconds, in degress celcius
+  Scalar calculate_fuel_temperature_change_celcius(
+      Scalar thermal_power_generated_in_timestep_J, Scalar step_seconds);
 
   /// Calculates the heat that escapes the water tank by convection to air, Q
   /// air
   ///
   /// See figure 10 in
   /// https://www.sciencedirect.com/science/article/pii/S0306454920303285#t0005
-  double calculate_water_tank_to_air_convection_J_per_second();
+  Scalar calculate_water_tank_to_air_convection_J_per_second();
 
   /// Calculates the heat that is exchanged between the water in the reactor
   /// tank and the concrete reactor wall, Q concrete
   ///
   /// See figure 11 in
   /// https://www.sciencedirect.com/science/article/pii/S0306454920303285#t0005
-  double calculate_water_tank_to_conrete_heat_exchange_J_per_second();
+  Scalar calculate_water_tank_to_conrete_heat_exchange_J_per_second();
 
   /// Calculates the change to water tank temperature in one time step, in
   /// degress celcius
   ///
   /// Called after applying fuel_temperature_change_celcius
-  double calculate_water_temperature_change_celcius();
+  Scalar calculate_water_temperature_change_celcius();
+  /// Calculates the change to water tank temperature over step_seconds at the
+  /// current rates, in degress celcius
+  Scalar calculate_water_temperature_change_celcius(Scalar step_seconds);
+  /// Calculates the change to water tank temperature over step_seconds, with
+  /// the energy the reactor generated over those seconds, in degress celcius
+  Scalar calculate_water_temperature_change_celcius(
+      Scalar thermal_power_generated_in_timestep_J, Scalar step_seconds);
+
+  /// Gets the continuous state, N, Ci (both in neutron units) and the
+  /// temperatures. Also the neutrons themselves in the logarithmic
+  /// representation
+  StateVector get_state_vector();
+  /// Sets the continuous state, N, Ci and the temperatures
+  void set_state_vector(const StateVector &state);
+
+  /// Calculates the time derivative of a continuous state with the control
+  /// rods where they are now, from calculate_dN_dt, calculate_dCi_dt and the
+  /// fuel and water temperature changes.
+  ///
+  /// Loads the state into the reactor to do so
+  StateVector calculate_state_derivative(const StateVector &state);
 
   /// Recalculates the reactivity inside the reactor core
-  double calculate_reactivity_pcm();
+  Scalar calculate_reactivity_pcm();
 
-  /// Calculates the reactor power from the number of neutrons and constants
+  /// Calculates the reactor power from the number of neutrons and constants.
+  ///
+  /// The MeV per second are in double, they don't fit in fixed point
   double calculate_power_MeV_per_second();
-  double calculate_power_watts();
-  double calculate_power_joules_per_second();
+  Scalar calculate_power_watts();
+  Scalar calculate_power_joules_per_second();
 
-  /// Calculates the reactor flux
+  /// Calculates the reactor flux, in double like the neutrons
   double calculate_flux();
 
+  /// Gets the power, as calculated when the neutrons last changed. That is
+  /// right after the kinetics in a tick, so the same value as
+  /// calculate_power_watts() whenever it's read
+  Scalar get_power_watts();
+  double get_power_MeV_per_second();
+  double get_flux();
+  /// Gets the worth of all control rods and the fuel temperature feedback,
+  /// as calculated for the reactivity of the last tick
+  Scalar get_control_rod_worths_pcm();
+  Scalar get_fuel_temperature_feedback_pcm();
+  /// Gets the reactivity the xenon takes away, as of its last update
+  Scalar get_xenon_worth_pcm();
+
+  /// Gets the I-135 and Xe-135 in the core, in atoms per cm^3
+  double get_iodine_atoms_per_cm3();
+  double get_xenon_atoms_per_cm3();
+  /// Sets the iodine and xenon, and the decay heat groups, to what a long run
+  /// at a power builds up, a clean core at 0 W. It's for starting from a
+  /// shutdown right after a long run, the rods are left where they are. A
+  /// reactor held at the power needs the rods placed for the xenon too, see
+  /// initialize_at_equilibrium
+  void set_fission_products_at_equilibrium(Scalar power_watts);
+
+  /// Gets the fission products' decay heat, as of its last update
+  Scalar get_decay_heat_watts();
+  /// Calculates the heat the fuel and water are given, the power, or with
+  /// decay_heat the part of it given off straight away and the decay heat
+  Scalar calculate_heat_watts();
+  /// Sets the decay heat groups to what a long run at a power builds up
+  void set_decay_heat_at_equilibrium(Scalar power_watts);
+
+  /// Calculates the worth of all three control rods, in pcm
+  Scalar calculate_control_rod_worths_pcm();
+
+  /// Gets how many times each term of the reactivity was recalculated since
+  /// the reactor was created or the counts were reset
+  ReactivityRecalculations get_reactivity_recalculations();
+  void reset_reactivity_recalculations();
+
   /// Calculates the pcm feedback from the fuel temperature (based on the fuel
   /// temperature feedback coefficients)
-  double calculate_fuel_temperature_feedback_pcm();
+  Scalar calculate_fuel_temperature_feedback_pcm();
 
-  /// Runs the reactor simulation forward one time_delta_s fraction of time
+  /// Runs the reactor simulation forward one time_delta_s fraction of time.
+  ///
+  /// With the adaptive integrators the time step is then adjusted for the
+  /// next tick, and with all but euler the step ends early at the moment
+  /// a SCRAM limit is crossed
   void tick();
+  /// Ticks up to ticks times in one loop, stopping early after a tick where
+  /// something the caller would react to happened, see TickBatchStop.
+  ///
+  /// The same ticks as calling tick() that many times, for loops that handle
+  /// their inputs and outputs once per batch instead of once per tick
+  TickBatch tick_n(uint32_t ticks);
+
+  /// Whether nothing is changing fast enough to need the full tick rate: no
+  /// rod is moving, there's no SCRAM, the neutrons change by less than
+  /// QUIESCENCE_MAX_RELATIVE_NEUTRON_RATE_PER_SECOND and the fuel and water
+  /// temperatures by less than QUIESCENCE_MAX_TEMPERATURE_RATE_CELCIUS_PER_SECOND
+  bool calculate_quiescent();
+  /// Whether the ticks are longer because the reactor is quiescent, see
+  /// adaptive_tick_rate
+  bool get_quiescent();
+  /// Goes back to full rate ticks from the next tick on, when something the
+  /// reactor doesn't see changed, like a switch it doesn't use
+  void leave_quiescence();
 
   // Reactor control system
   /// Moves the control rods to try to reach the target power
@@ -131,51 +1005,840 @@ public:
   /// Initiates an emergency shutdown that lasts 6 seconds
   void scram();
 
-  // Switches on the model
-  /// Whether or not to take 200kW out of the cooling loop
-  bool active_cooling_system_enabled = true;
-  /// Whether or not to automatically balance the rods
-  bool automatic_control = true;
-  /// Whether or not to check SCRAM conditions
-  bool scrams_enabled = true;
+  // Pulse mode
+  /// Fires a pulse: ejects the transient rod, which is the safety rod, so the
+  /// reactor goes above prompt critical by what the rod was worth, and the
+  /// fuel temperature feedback turns the power around.
+  ///
+  /// The power SCRAM is held off for PULSE_DURATION_SECONDS, and the pulse
+  /// ends with a SCRAM then, or with any SCRAM before. Only under manual
+  /// control, outside a SCRAM, without a pulse in progress and with the
+  /// safety rod at least partly in, otherwise false and nothing happens
+  bool fire_pulse();
+  bool get_pulse_in_progress();
+  /// Gets the report of the pulse in progress, so far
+  PulseReport get_pulse();
+  /// Gets the report of the last pulse to end, all zeros before the first
+  PulseReport get_last_pulse();
+  /// Gets how many pulses were fired since the reactor was created
+  uint32_t get_pulses_fired();
+
+  /// Loads a steady state from calculate_equilibrium or a preset. Nothing is
+  /// solved, it's written into the state as it is
+  void load_equilibrium(const Equilibrium &equilibrium);
+
+  // The model math the steady states are made of, on its own and constexpr.
+  // The member functions of the same names call these with the reactor's
+  // coefficients and state
+
+  static constexpr Scalar calculate_power_watts(const Coefficients &coefficients,
+                                                Scalar neutrons_in_core);
+  static constexpr Scalar
+  calculate_stationary_fuel_temperature(const Coefficients &coefficients,
+                                        Scalar power_watts,
+                                        Scalar water_temperature_celcius);
+  static constexpr Scalar
+  calculate_fuel_temperature_feedback_pcm(const Coefficients &coefficients,
+                                          Scalar fuel_temperature_celcius,
+                                          bool approximate_thermal_math);
+
+  /// The iodine and xenon a long run at a power builds up
+  static constexpr FissionProducts
+  calculate_fission_products_at_equilibrium(const Coefficients &coefficients,
+                                            Scalar power_watts);
+  /// Works out the steady state at a power, everything but where the rods
+  /// go, which only has to add up to control_rod_worths_pcm. With
+  /// xenon_poisoning the xenon of a long run at the power is in it, and the
+  /// rods make up for its worth
+  static constexpr Equilibrium
+  calculate_equilibrium(const Coefficients &coefficients,
+                        const Configuration &parameters,
+                        Scalar power_watts, Scalar water_temperature_celcius,
+                        bool approximate_thermal_math, bool xenon_poisoning);
+  /// Finds the position closest to a worth, with calculate_worth_at giving
+  /// the worth of the rod at a position, growing going in. UINT32_MAX if the
+  /// worth is out of the rod's reach
+  template <typename WorthAt>
+  static constexpr uint32_t
+  calculate_control_rod_position_for_worth(double worth_pcm,
+                                           WorthAt calculate_worth_at);
+
+  /// The steady state at a power of a reactor as it's made, with CONFIGURATION
+  /// and linear rod worths, the regulating rod holding it and the other two
+  /// out. Not critical if the regulating rod can't reach it
+  static constexpr Equilibrium calculate_preset(Scalar power_watts,
+                                                Scalar water_temperature_celcius,
+                                                bool xenon_poisoning = false);
+  /// The steady state of a reactor as it's made with all three rods in,
+  /// subcritical at the power the source keeps up
+  static constexpr Equilibrium
+  calculate_shutdown_preset(Scalar water_temperature_celcius);
+  /// How far a preset is from a steady state, with the rods where it puts
+  /// them
+  static constexpr EquilibriumResiduals
+  calculate_preset_residuals(const Equilibrium &preset);
+  /// One forward euler step of a preset with the rods held, as a tick with
+  /// the default switches takes it, for the neutrons, precursors and fuel
+  /// temperature. The water isn't in it, it's held at the preset's
+  static constexpr Equilibrium calculate_preset_step(const Equilibrium &preset,
+                                                     Scalar step_seconds);
+
+  /// Ticks a state, to = step(coefficients, switches, from, inputs).
+  ///
+  /// The same tick as tick(), which a BasicReactor runs on its own state,
+  /// run in place on to after from is copied into it, and from and to can be
+  /// the same state. Nothing is made or worked out per call but what the
+  /// tick needs for its step. A configuration compiled in folds its own
+  /// coefficients into the tick, so it only takes CONFIGURATION_COEFFICIENTS
+  /// itself. The fuel element nodes aren't in a state, so it doesn't step
+  /// with fuel_element_temperatures either. False, and nothing happens, for
+  /// either
+  static bool step(const Coefficients &coefficients, const Switches &switches,
+                   const ReactorState &from, const ReactorInputs &inputs,
+                   ReactorState &to);
 
 protected:
-  /// Time for each simulation step, in seconds
-  float time_delta_seconds = 1e-4;
-  /// How many loops we've calculated
-  uint64_t steps_elapsed = 0;
-
-  // Scram data
-  /// Is a scram active?
-  bool in_scram = false;
-  /// The step we started the scram
-  uint64_t step_scram_started = 0;
-
-  // Temperatures
-  double water_temperature_celcius = 20.0;
-  double fuel_temperature_celcius = 20.0;
-
-  // Reactivity and neutrons
-  double reactivity_pcm = calculate_reactivity_pcm();
-  double neutrons_in_core = 0.0;
-
-  double neutron_population_group_1 = 0.0;
-  double neutron_population_group_2 = 0.0;
-  double neutron_population_group_3 = 0.0;
-  double neutron_population_group_4 = 0.0;
-  double neutron_population_group_5 = 0.0;
-  double neutron_population_group_6 = 0.0;
-
-  // Control rods
-  //
-  // See section 2.7 of
-  // https://www.sciencedirect.com/science/article/pii/S0306454920303285#t0005
-  ControlRod safety_control_rod;
-  ControlRod regulating_control_rod;
-  /// Also called shim sometimes
-  ControlRod compensating_control_rod;
+  /// A model of a state and its time step coefficients, reading
+  /// CONFIGURATION's coefficients until it's pointed at others. Only refers
+  /// to them, they have to outlive it
+  BasicReactorModel(const Switches &switches, ReactorState &state,
+                    TimeStepCoefficients &time_step_coefficients);
+  BasicReactorModel(const BasicReactorModel &) = delete;
+  BasicReactorModel &operator=(const BasicReactorModel &) = delete;
+
+  /// Gets the P_fe_stat table for approximate_thermal_math
+  const PiecewiseCubic<Math, 256> &get_power_exchanged_approximation();
+
+  /// Gives the control rods the speeds and worth of the parameters
+  void set_control_rod_parameters(const Configuration &parameters);
+
+  /// Gets how far the control rods move in a step, worked out again when the
+  /// step changed
+  const std::array<typename ControlRod::Motion, 3> &
+  get_control_rod_motions(Scalar step_seconds);
+  /// Keeps the control rods at their speed when the step they move by changes
+  void rescale_control_rod_velocities(Scalar from_step_seconds,
+                                      Scalar to_step_seconds);
+  /// Gets the exponentials of PrecursorIntegration::EXPONENTIAL for
+  /// time_delta_seconds, worked out again when it changed
+  const PrecursorStepExponentials<GROUPS, Scalar> &
+  get_precursor_step_exponentials();
+
+  /// Moves the control rods for a tick, to their targets and to balance the
+  /// target power
+  void move_control_rods();
+
+  /// Moves the control rods one step towards their targets, returns a bit for
+  /// each rod that got there like control_rods_reached_target
+  uint8_t move_control_rods_towards_targets(Scalar step_seconds);
+
+  /// Balances the control rods when automatic control is on and a sample is
+  /// due, see RCS_SAMPLE_PERIOD_MICROSECONDS. Returns whether it did
+  bool sample_control_system();
+
+  /// One tick of the original forward euler scheme
+  void tick_euler();
+
+  /// Sets the time step, and everything that caches something per step
+  void change_time_delta_seconds(float time_delta_s);
+  /// Checks for quiescence after a tick, every QUIESCENCE_CHECK_INTERVAL_TICKS
+  /// at full rate and after every long tick, and changes the tick length
+  void update_quiescence();
+  /// A bit for each rod that isn't at its target, safety, regulating and
+  /// compensating from the lowest
+  uint8_t calculate_control_rods_moving();
+  /// Moves the iodine and xenon forward by the time since the last update,
+  /// at the average power since
+  void update_fission_products();
+  /// Sets the iodine and xenon, and starts their next update from now
+  void load_fission_products(const FissionProducts &fission_products);
+  /// Moves the decay heat groups forward by the time since the last update,
+  /// at the average power since
+  void update_decay_heat();
+  /// Moves the fuel element nodes forward by the time since the last fuel
+  /// update, with the heat since, and the fuel temperature with them
+  void update_fuel_element_temperatures();
+  /// Puts every fuel element node at its stationary temperature at a power,
+  /// and the fuel temperature at their average
+  void set_fuel_elements_at_equilibrium(Scalar power_watts);
+  /// precursor_integration, unless the long quiescent ticks need another
+  PrecursorIntegration get_precursor_integration_for_tick();
+
+  /// Moves the precursor groups forward by one step with
+  /// precursor_integration
+  void integrate_precursor_groups(Scalar neutrons_at_step_start,
+                                  Scalar neutrons_at_step_end);
+  /// Moves the kinetics forward by one step with the prompt jump
+  /// approximation
+  void integrate_prompt_jump_kinetics();
+  /// Moves the full kinetics forward by one step, in sub-steps of at most
+  /// PROMPT_JUMP_FALLBACK_TIME_DELTA_SECONDS, and short enough for the prompt
+  /// period
+  void integrate_full_kinetics_in_sub_steps();
+  /// How many sub-steps the prompt period needs for the step, 1 below prompt
+  /// critical, see KINETICS_SUB_STEPS_PER_PROMPT_PERIOD
+  uint32_t calculate_prompt_period_sub_steps();
+
+  /// Calculates the prompt jump neutrons for a given delayed neutron source
+  Scalar calculate_prompt_jump_neutrons(Scalar delayed_neutron_source);
+
+  /// Moves the kinetics forward by one forward euler step, in the
+  /// logarithmic representation
+  void integrate_logarithmic_kinetics();
+  /// Calculates the relative rate of change of the neutrons, dN(t)/dt / N(t),
+  /// in the logarithmic representation
+  Scalar calculate_logarithmic_dN_dt();
+  /// Moves the neutrons and precursors between the two representations
+  void convert_to_logarithmic_neutron_population();
+  void convert_to_linear_neutron_population();
+  /// One tick of the Runge-Kutta and Rosenbrock integrators
+  void tick_runge_kutta();
+  /// Moves the control rods and the state forward by one Runge-Kutta step,
+  /// starting from the given state and control rods. error is only written
+  /// by the adaptive integrators
+  StateVector take_runge_kutta_step(const StateVector &state,
+                                    const std::array<ControlRod, 3> &rods,
+                                    Scalar step_seconds, StateVector &error);
+
+  /// Whether the power or a temperature is over its SCRAM limit
+  bool calculate_scram_limits_exceeded();
+
+  /// Adds a tick to the report of the pulse in progress, and ends the pulse
+  /// after PULSE_DURATION_SECONDS
+  void update_pulse(double power_at_tick_start_watts, double tick_seconds);
+  /// Files the report of the pulse in progress as the last pulse
+  void end_pulse();
+
+  /// Recalculates the power and the flux, after the neutrons changed
+  void update_derived_power();
+  /// Updates the reactivity, recalculating the control rod worths and the
+  /// fuel temperature feedback it's made of when they changed
+  void update_derived_reactivity();
+
+  /// Everything that changes as the reactor runs
+  ReactorState &state;
+  /// What the tick works out for its step, see ReactorTimeStepCoefficients
+  TimeStepCoefficients &time_step_coefficients;
 
   // RCS information
   uint32_t target_thermal_power_watts = 20001;
+
+  /// The fuel element nodes of fuel_element_temperatures, which are kept
+  /// outside the state, see ReactorState::fuel_elements_current. None
+  /// without a BasicReactor
+  FuelElements *fuel_elements = nullptr;
+
+  /// What a tick reads with the parameters set at runtime, see
+  /// get_coefficients
+  const Coefficients *runtime_coefficients = nullptr;
 };
+
+// == Constexpr model math ==
+
+/// Same as calculate_power_watts()
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+constexpr Scalar BasicReactorModel<Scalar, CONFIGURATION>::calculate_power_watts(
+    const Coefficients &coefficients, Scalar neutrons_in_core) {
+  // Same as calculate_power_MeV_per_second, but without going through double
+  Math in_MeV_per_neutron_unit_second =
+      Math(neutrons_in_core) * Math(0.56) *
+      coefficients.neutron_velocity_meters_per_second *
+      coefficients.neutron_fission_energy_released_MeV;
+
+  Math MeV_per_neutron_unit_second_to_watt =
+      Math(1.6022e-13 * Traits::NEUTRONS_PER_UNIT);
+
+  return Scalar(in_MeV_per_neutron_unit_second *
+                MeV_per_neutron_unit_second_to_watt);
+}
+
+/// Same as calculate_stationary_fuel_temperature()
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+constexpr Scalar
+BasicReactorModel<Scalar, CONFIGURATION>::calculate_stationary_fuel_temperature(
+    const Coefficients &coefficients, Scalar power_watts,
+    Scalar water_temperature_celcius) {
+  // The cube of the power doesn't fit in fixed point
+  Math power_normalized_joule_per_second =
+      Math(power_watts / coefficients.fuel_elements_in_core);
+
+  return Scalar(coefficients.temperature_fe_stat_a0 *
+                    power_normalized_joule_per_second +
+                coefficients.temperature_fe_stat_a1 *
+                    power_normalized_joule_per_second *
+                    power_normalized_joule_per_second +
+                coefficients.temperature_fe_stat_a2 *
+                    power_normalized_joule_per_second *
+                    power_normalized_joule_per_second *
+                    power_normalized_joule_per_second +
+                Math(water_temperature_celcius));
+}
+
+/// Same as calculate_fuel_temperature_feedback_pcm()
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+constexpr Scalar
+BasicReactorModel<Scalar, CONFIGURATION>::calculate_fuel_temperature_feedback_pcm(
+    const Coefficients &coefficients, Scalar fuel_temperature_celcius,
+    bool approximate_thermal_math) {
+
+  // If cold, there is no feedback
+  if (fuel_temperature_celcius <= 0.0) {
+    return 0.0;
+  }
+
+  if (approximate_thermal_math) {
+    if (fuel_temperature_celcius <= 240.0) {
+      return fuel_temperature_celcius *
+             (coefficients.fuel_feedback_below_240_c_c0 +
+              coefficients.fuel_feedback_below_240_c_c1 *
+                  fuel_temperature_celcius);
+    }
+
+    return fuel_temperature_celcius *
+           (coefficients.fuel_feedback_above_240_c_c0 +
+            coefficients.fuel_feedback_above_240_c_c1 *
+                fuel_temperature_celcius);
+  }
+
+  // Between 0 and 240, linerally interpolate
+  if (fuel_temperature_celcius <= 240.0) {
+
+    Scalar fraction_to_240_celcius = fuel_temperature_celcius / Scalar(240.0);
+
+    Scalar coefficient_difference_pcm_per_c =
+        coefficients.fuel_t_feedback_coefficient_difference_pcm_per_c;
+
+    return fuel_temperature_celcius *
+           (coefficients.fuel_t_feedback_coefficient_0_c_pcm_per_c +
+            coefficient_difference_pcm_per_c * fraction_to_240_celcius);
+  }
+
+  // Above 240, calculate with peak
+  Scalar how_far_above_240_celcius = fuel_temperature_celcius - Scalar(240.0);
+
+  Scalar coefficient_at_temperature =
+      coefficients.fuel_t_feedback_coefficient_240_c_pcm_per_c +
+      coefficients
+              .fuel_t_feedback_coefficient_slope_after_peak_pcm_per_c_squared *
+          how_far_above_240_celcius;
+
+  return fuel_temperature_celcius * coefficient_at_temperature;
+}
+
+/// With every dCi/dt = 0, Ci = beta_i / (lifetime * lambda_i) * N, so the
+/// delayed neutron source is beta / lifetime * N and dN/dt = 0 leaves
+/// rho / lifetime * N + S = 0, a reactivity of -S * lifetime / N. The fuel
+/// only stops heating where P_fe_stat, the inverse of the stationary fuel
+/// temperature, matches the power
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+constexpr typename BasicReactorModel<Scalar, CONFIGURATION>::Equilibrium
+BasicReactorModel<Scalar, CONFIGURATION>::calculate_equilibrium(
+    const Coefficients &coefficients, const Configuration &parameters,
+    Scalar power_watts, Scalar water_temperature_celcius,
+    bool approximate_thermal_math, bool xenon_poisoning) {
+  Equilibrium equilibrium = {};
+
+  // The inverse of calculate_power_watts
+  double watts_per_neutron_unit =
+      0.56 * coefficients.neutron_velocity_meters_per_second_double *
+      coefficients.neutron_fission_energy_released_MeV_double * 1.6022e-13 *
+      Traits::NEUTRONS_PER_UNIT;
+  double neutron_units = (double)power_watts / watts_per_neutron_unit;
+
+  equilibrium.power_watts = power_watts;
+  equilibrium.water_temperature_celcius = water_temperature_celcius;
+  equilibrium.neutrons_in_core = Scalar(neutron_units);
+  equilibrium.fuel_temperature_celcius = calculate_stationary_fuel_temperature(
+      coefficients,
+      calculate_power_watts(coefficients, equilibrium.neutrons_in_core),
+      water_temperature_celcius);
+
+  for (uint8_t i = 0; i < GROUPS; i++) {
+    equilibrium.precursor_populations[i] =
+        Scalar(parameters.delayed_neutron_fractions[i] /
+               (parameters.prompt_neutron_lifetime_seconds *
+                parameters.decay_times[i]) *
+               neutron_units);
+  }
+
+  double reactivity_pcm =
+      -(double)coefficients.source_neutron_units_per_second *
+      (double)coefficients.prompt_neutron_lifetime_seconds / neutron_units *
+      1e5;
+
+  if (xenon_poisoning) {
+    equilibrium.fission_products =
+        calculate_fission_products_at_equilibrium(coefficients, power_watts);
+  }
+
+  // The rods make up for the xenon's worth too
+  equilibrium.reactivity_pcm = reactivity_pcm;
+  equilibrium.control_rod_worths_pcm =
+      (double)coefficients.excess_reactivity_pcm -
+      (double)calculate_fuel_temperature_feedback_pcm(
+          coefficients, equilibrium.fuel_temperature_celcius,
+          approximate_thermal_math) -
+      equilibrium.fission_products.xenon_worth_pcm - reactivity_pcm;
+  equilibrium.critical = true;
+
+  return equilibrium;
+}
+
+/// The balances of update_fission_products with nothing changing,
+/// dI/dt = 0 and dX/dt = 0
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+constexpr typename BasicReactorModel<Scalar, CONFIGURATION>::FissionProducts
+BasicReactorModel<Scalar, CONFIGURATION>::calculate_fission_products_at_equilibrium(
+    const Coefficients &coefficients, Scalar power_watts) {
+  double fissions_per_cm3_per_second =
+      (double)power_watts * coefficients.fissions_per_cm3_per_joule;
+  double flux = (double)power_watts * coefficients.thermal_flux_per_watt;
+
+  FissionProducts fission_products = {};
+  fission_products.iodine_atoms_per_cm3 = IODINE_135_FISSION_YIELD *
+                                          fissions_per_cm3_per_second /
+                                          IODINE_135_DECAY_CONSTANT_PER_SECOND;
+  fission_products.xenon_atoms_per_cm3 =
+      (IODINE_135_FISSION_YIELD + XENON_135_FISSION_YIELD) *
+      fissions_per_cm3_per_second /
+      (XENON_135_DECAY_CONSTANT_PER_SECOND +
+       XENON_135_ABSORPTION_CROSS_SECTION_CM2 * flux);
+  fission_products.xenon_worth_pcm = fission_products.xenon_atoms_per_cm3 *
+                                     coefficients.xenon_pcm_per_atom_per_cm3;
+
+  return fission_products;
+}
+
+/// The worth only grows going in, so the first position worth at least as
+/// much is found by bisection, and it or the one before is the closest
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+template <typename WorthAt>
+constexpr uint32_t
+BasicReactorModel<Scalar, CONFIGURATION>::calculate_control_rod_position_for_worth(
+    double worth_pcm, WorthAt calculate_worth_at) {
+  uint32_t outside = 0;
+  uint32_t inside = 4000000;
+
+  if (worth_pcm < (double)calculate_worth_at(outside) ||
+      worth_pcm > (double)calculate_worth_at(inside)) {
+    return UINT32_MAX;
+  }
+
+  while (inside - outside > 1) {
+    uint32_t middle = outside + (inside - outside) / 2;
+
+    if ((double)calculate_worth_at(middle) < worth_pcm) {
+      outside = middle;
+    } else {
+      inside = middle;
+    }
+  }
+
+  if (worth_pcm - (double)calculate_worth_at(outside) <
+      (double)calculate_worth_at(inside) - worth_pcm) {
+    return outside;
+  }
+
+  return inside;
+}
+
+/// Worth of a rod of the reactor as it's made, the same linear worth as
+/// BasicControlRod without a worth curve
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+constexpr Scalar calculate_linear_control_rod_worth_pcm(uint32_t position) {
+  return Scalar(position) / Scalar(4e6) *
+         Scalar(CONFIGURATION.control_rod_worth_pcm);
+}
+
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+constexpr typename BasicReactorModel<Scalar, CONFIGURATION>::Equilibrium
+BasicReactorModel<Scalar, CONFIGURATION>::calculate_preset(
+    Scalar power_watts, Scalar water_temperature_celcius,
+    bool xenon_poisoning) {
+  Equilibrium preset = calculate_equilibrium(
+      CONFIGURATION_COEFFICIENTS, CONFIGURATION, power_watts,
+      water_temperature_celcius, false, xenon_poisoning);
+
+  // The safety and compensating rods are out, worth nothing
+  uint32_t position = calculate_control_rod_position_for_worth(
+      preset.control_rod_worths_pcm,
+      calculate_linear_control_rod_worth_pcm<Scalar, CONFIGURATION>);
+
+  preset.control_rod_positions = {0, position, 0};
+  preset.critical = position != UINT32_MAX;
+
+  return preset;
+}
+
+/// The reactivity of the rods in fixes the neutrons, N = -S * lifetime / rho,
+/// which set the fuel temperature and so the feedback in the reactivity. The
+/// source level barely warms the fuel, so going around a few times settles
+/// it to the last bit
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+constexpr typename BasicReactorModel<Scalar, CONFIGURATION>::Equilibrium
+BasicReactorModel<Scalar, CONFIGURATION>::calculate_shutdown_preset(
+    Scalar water_temperature_celcius) {
+  const Coefficients &coefficients = CONFIGURATION_COEFFICIENTS;
+
+  Scalar rod_worth_pcm =
+      calculate_linear_control_rod_worth_pcm<Scalar, CONFIGURATION>(4000000);
+  Scalar control_rod_worths_pcm = rod_worth_pcm + rod_worth_pcm + rod_worth_pcm;
+
+  Equilibrium preset = {};
+  preset.water_temperature_celcius = water_temperature_celcius;
+  preset.fuel_temperature_celcius = water_temperature_celcius;
+
+  for (uint8_t iteration = 0; iteration < 4; iteration++) {
+    preset.reactivity_pcm =
+        (double)((coefficients.excess_reactivity_pcm - control_rod_worths_pcm) -
+                 calculate_fuel_temperature_feedback_pcm(
+                     coefficients, preset.fuel_temperature_celcius, false));
+
+    double neutron_units =
+        -(double)coefficients.source_neutron_units_per_second *
+        (double)coefficients.prompt_neutron_lifetime_seconds * 1e5 /
+        preset.reactivity_pcm;
+
+    preset.neutrons_in_core = Scalar(neutron_units);
+    preset.power_watts =
+        calculate_power_watts(coefficients, preset.neutrons_in_core);
+    preset.fuel_temperature_celcius = calculate_stationary_fuel_temperature(
+        coefficients, preset.power_watts, water_temperature_celcius);
+
+    for (uint8_t i = 0; i < GROUPS; i++) {
+      preset.precursor_populations[i] =
+          Scalar(CONFIGURATION.delayed_neutron_fractions[i] /
+                 (CONFIGURATION.prompt_neutron_lifetime_seconds *
+                  CONFIGURATION.decay_times[i]) *
+                 neutron_units);
+    }
+  }
+
+  preset.control_rod_worths_pcm = (double)control_rod_worths_pcm;
+  preset.control_rod_positions = {4000000, 4000000, 4000000};
+  preset.critical = false;
+
+  return preset;
+}
+
+/// The same sums as update_derived_reactivity for the reactivity, and the
+/// second kinetic point equation and Cardano's P_fe_stat for the rest
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+constexpr typename BasicReactorModel<Scalar, CONFIGURATION>::EquilibriumResiduals
+BasicReactorModel<Scalar, CONFIGURATION>::calculate_preset_residuals(
+    const Equilibrium &preset) {
+  const Coefficients &coefficients = CONFIGURATION_COEFFICIENTS;
+  EquilibriumResiduals residuals = {};
+
+  Scalar control_rod_worths_pcm = Scalar(0.0);
+
+  for (uint32_t position : preset.control_rod_positions) {
+    control_rod_worths_pcm +=
+        calculate_linear_control_rod_worth_pcm<Scalar, CONFIGURATION>(
+            position);
+  }
+
+  Scalar reactivity_pcm =
+      ((coefficients.excess_reactivity_pcm - control_rod_worths_pcm) -
+       calculate_fuel_temperature_feedback_pcm(
+           coefficients, preset.fuel_temperature_celcius, false)) -
+      Scalar(preset.fission_products.xenon_worth_pcm);
+  residuals.reactivity_pcm = (double)reactivity_pcm - preset.reactivity_pcm;
+
+  for (uint8_t i = 0; i < GROUPS; i++) {
+    double produced = CONFIGURATION.delayed_neutron_fractions[i] /
+                      CONFIGURATION.prompt_neutron_lifetime_seconds *
+                      (double)preset.neutrons_in_core;
+    double decayed = CONFIGURATION.decay_times[i] *
+                     (double)preset.precursor_populations[i];
+    double imbalance = (produced - decayed) / decayed;
+
+    residuals.precursor_imbalance =
+        std::max(residuals.precursor_imbalance,
+                 imbalance < 0.0 ? -imbalance : imbalance);
+  }
+
+  residuals.fuel_power_watts =
+      (double)calculate_power_watts(coefficients, preset.neutrons_in_core) -
+      calculate_constexpr_power_exchanged_watts(
+          CONFIGURATION, (double)preset.water_temperature_celcius -
+                             (double)preset.fuel_temperature_celcius);
+
+  return residuals;
+}
+
+/// The first kinetic point equation, the precursors from the end of step
+/// neutrons, and the fuel from the power less P_fe_stat, as tick_euler and
+/// integrate_euler
+template <typename Scalar, BasicReactorConfiguration CONFIGURATION>
+constexpr typename BasicReactorModel<Scalar, CONFIGURATION>::Equilibrium
+BasicReactorModel<Scalar, CONFIGURATION>::calculate_preset_step(
+    const Equilibrium &preset, Scalar step_seconds) {
+  const Coefficients &coefficients = CONFIGURATION_COEFFICIENTS;
+  Equilibrium stepped = preset;
+
+  Scalar control_rod_worths_pcm = Scalar(0.0);
+
+  for (uint32_t position : preset.control_rod_positions) {
+    control_rod_worths_pcm +=
+        calculate_linear_control_rod_worth_pcm<Scalar, CONFIGURATION>(
+            position);
+  }
+
+  Scalar reactivity_pcm =
+      ((coefficients.excess_reactivity_pcm - control_rod_worths_pcm) -
+       calculate_fuel_temperature_feedback_pcm(
+           coefficients, preset.fuel_temperature_celcius, false)) -
+      Scalar(preset.fission_products.xenon_worth_pcm);
+
+  Scalar delayed_neutron_source = Scalar(0.0);
+  Scalar effective_delayed_neutron_fraction = Scalar(0.0);
+
+  for (uint8_t i = 0; i < GROUPS; i++) {
+    delayed_neutron_source += Scalar(CONFIGURATION.decay_times[i]) *
+                              preset.precursor_populations[i];
+    effective_delayed_neutron_fraction +=
+        Scalar(CONFIGURATION.delayed_neutron_fractions[i]);
+  }
+
+  Scalar dN_dt = preset.neutrons_in_core *
+                     ((reactivity_pcm / Scalar(1e5) -
+                       effective_delayed_neutron_fraction) /
+                      coefficients.prompt_neutron_lifetime_seconds) +
+                 delayed_neutron_source +
+                 coefficients.source_neutron_units_per_second;
+  stepped.neutrons_in_core = preset.neutrons_in_core + dN_dt * step_seconds;
+
+  for (uint8_t i = 0; i < GROUPS; i++) {
+    stepped.precursor_populations[i] +=
+        (Scalar(CONFIGURATION.delayed_neutron_fractions[i] /
+                CONFIGURATION.prompt_neutron_lifetime_seconds) *
+             stepped.neutrons_in_core -
+         Scalar(CONFIGURATION.decay_times[i]) *
+             preset.precursor_populations[i]) *
+        step_seconds;
+  }
+
+  Scalar capacity_J_per_K =
+      coefficients.fuel_capacity_J_per_K_c0 +
+      coefficients.fuel_capacity_J_per_K_c1 * preset.fuel_temperature_celcius;
+  Scalar fuel_power_watts =
+      calculate_power_watts(coefficients, preset.neutrons_in_core) -
+      Scalar(calculate_constexpr_power_exchanged_watts(
+          CONFIGURATION, (double)preset.water_temperature_celcius -
+                             (double)preset.fuel_temperature_celcius));
+  stepped.fuel_temperature_celcius +=
+      fuel_power_watts * step_seconds / capacity_J_per_K;
+
+  stepped.power_watts =
+      calculate_power_watts(coefficients, stepped.neutrons_in_core);
+
+  return stepped;
+}
+
+/// The reactor, the model with its parameters and fuel element nodes.
+///
+/// BasicReactor<double> (Reactor) is the reference. BasicReactor<float> runs
+/// on a single precision FPU, like the RP2350's Cortex-M33, and
+/// BasicReactor<Q32_32> runs without one. Both need the fuel and water
+/// temperatures to be updated less often than every 0.1 ms tick, otherwise
+/// their changes get lost in rounding (see
+/// water_temperature_update_interval_ticks).
+///
+/// Neutron counts are always returned as double, in neutrons.
+///
+/// The core itself is the CONFIGURATION, the JSI TRIGA by default. Every
+/// value of it is a compile time constant, so each configuration is its own
+/// fully folded model. Configurations other than the ones instantiated at the
+/// end of reactor.cpp need adding there.
+///
+/// A configuration with parameters_at_runtime set (RuntimeReactor) starts from
+/// its values instead, and can be given new ones with apply_parameters. Either
+/// way a tick only reads the ReactorCoefficients worked out from them
+template <typename Scalar,
+          BasicReactorConfiguration CONFIGURATION = JSI_TRIGA_CONFIGURATION>
+class BasicReactor : public BasicReactorModel<Scalar, CONFIGURATION> {
+public:
+  using Model = BasicReactorModel<Scalar, CONFIGURATION>;
+  using typename Model::Coefficients;
+  using typename Model::Configuration;
+  using typename Model::ControlRod;
+  using typename Model::Equilibrium;
+  using typename Model::FuelElements;
+  using typename Model::Math;
+  using typename Model::ReactorInputs;
+  using typename Model::ReactorState;
+  using typename Model::Switches;
+  using typename Model::TimeStepCoefficients;
+  using Model::CONFIGURATION_COEFFICIENTS;
+  using Model::GROUPS;
+  using Model::PARAMETERS_AT_RUNTIME;
+  using Model::step;
+  using Model::calculate_control_rod_position_for_worth;
+  using Model::calculate_equilibrium;
+  using Model::get_coefficients;
+  using Model::load_equilibrium;
+  using Model::active_cooling_system_enabled;
+  using Model::automatic_control;
+  using Model::scrams_enabled;
+  using Model::precursor_integration;
+  using Model::integrator;
+  using Model::prompt_jump;
+  using Model::fuel_temperature_update_interval_ticks;
+  using Model::water_temperature_update_interval_ticks;
+  using Model::fuel_temperature_feedback_tolerance_celcius;
+  using Model::approximate_thermal_math;
+  using Model::adaptive_tick_rate;
+  using Model::xenon_poisoning;
+  using Model::decay_heat;
+  using Model::fuel_element_temperatures;
+
+  /// A running reactor saved in a plain struct, so it's written and read as
+  /// its bytes, to a file on the desktop or to flash on the Pico.
+  ///
+  /// Holds the state, the switches and the RCS target, and the parameters.
+  /// Loading one brings back the reactor bit for bit, and it carries on the
+  /// way it would have without being saved. The fuel element nodes are left
+  /// out, they start from the fuel temperature again. The layout is that of
+  /// the platform and compiler that saved it, a snapshot only loads into the
+  /// same reactor type in the same build of the simulator
+  struct ReactorSnapshot {
+    // Checked before anything else is looked at
+    uint32_t magic;
+    uint32_t version;
+    /// sizeof(ReactorSnapshot) and of Scalar, and whether Scalar is fixed
+    /// point, so other reactor types and platforms are told apart
+    uint32_t size;
+    uint32_t scalar_size;
+    bool scalar_is_floating_point;
+
+    ReactorState state;
+    /// The worth curves of the safety, regulating and compensating rods, the
+    /// state only has which of the program's curves they use. Zeros for a
+    /// linear rod
+    std::array<typename ControlRod::WorthCurve, 3> control_rod_worth_curves;
+
+    // Switches and RCS target
+    bool active_cooling_system_enabled;
+    bool automatic_control;
+    bool scrams_enabled;
+    PrecursorIntegration precursor_integration;
+    Integrator integrator;
+    bool prompt_jump;
+    uint32_t fuel_temperature_update_interval_ticks;
+    uint32_t water_temperature_update_interval_ticks;
+    Scalar fuel_temperature_feedback_tolerance_celcius;
+    bool approximate_thermal_math;
+    bool adaptive_tick_rate;
+    bool xenon_poisoning;
+    bool decay_heat;
+    bool fuel_element_temperatures;
+    uint32_t target_thermal_power_watts;
+
+    /// Applied when loading if the parameters are set at runtime, otherwise
+    /// they have to be CONFIGURATION
+    Configuration parameters;
+
+    /// CRC-32 of every byte before it
+    uint32_t checksum;
+  };
+  static_assert(std::is_trivially_copyable_v<ReactorSnapshot>);
+
+  BasicReactor();
+  /// Copies the reactor, the copy's model reading its own parameters and
+  /// nodes
+  BasicReactor(const BasicReactor &other);
+  BasicReactor &operator=(const BasicReactor &other);
+
+  /// Gets the parameters the reactor is running with, CONFIGURATION unless
+  /// others were applied
+  const Configuration &get_parameters();
+  /// Switches to other parameters, usually loaded and validated by
+  /// ReactorParameters, and works out all the coefficients and the precursor
+  /// group constants from them.
+  ///
+  /// The state carries over, the control rods keep their positions with the
+  /// new speeds and worths
+  void apply_parameters(const Configuration &parameters)
+    requires PARAMETERS_AT_RUNTIME;
+
+  /// Gets the fuel element nodes of fuel_element_temperatures, mapped for the
+  /// parameters' elements and fuel length
+  FuelElements *get_fuel_elements();
+
+  /// Saves the state, switches, RCS target and parameters, filling in a
+  /// snapshot the caller keeps, since it's too big for a Pico's stack
+  void save_snapshot(ReactorSnapshot &snapshot);
+  /// save_snapshot without the checksum, little more than a copy of the
+  /// reactor. seal_snapshot works the checksum out once the snapshot is
+  /// kept, and load_snapshot takes it as damaged until then
+  void save_snapshot_unsealed(ReactorSnapshot &snapshot);
+  static void seal_snapshot(ReactorSnapshot &snapshot);
+  /// Loads a snapshot from save_snapshot, once it checked the snapshot is
+  /// for this reactor and wasn't damaged. Nothing changes if it wasn't
+  SnapshotStatus load_snapshot(const ReactorSnapshot &snapshot);
+
+  /// Ticks a state with the reactor's coefficients and switches, without
+  /// changing the reactor, see BasicReactorModel::step
+  bool step(const ReactorState &from, const ReactorInputs &inputs,
+            ReactorState &to) const;
+
+  /// Puts the reactor straight into the steady state at a power, with the
+  /// water at a temperature, instead of simulating the approach to critical
+  /// and the precursor build up.
+  ///
+  /// The neutrons are those of the power, the precursors are in equilibrium
+  /// with them, the fuel is at calculate_stationary_fuel_temperature, and the
+  /// regulating rod is moved to where the reactivity balances the source,
+  /// the other rods staying where they are. The RCS target becomes the power.
+  /// The water is held by nothing, it heats or cools from there at the rate
+  /// the power and the active cooling give.
+  ///
+  /// The rods move in whole steps, so the reactor is critical to within one
+  /// step's worth, a period of months at most. The automatic control still
+  /// dithers the regulating rod around it. False, and nothing changes, if
+  /// the power is 0 or the regulating rod can't reach the reactivity
+  bool initialize_at_equilibrium(uint32_t power_watts,
+                                 Scalar water_temperature_celcius);
+
+protected:
+  /// The parameters applied at runtime, and everything worked out from them
+  struct RuntimeParameters {
+    Configuration parameters;
+    Coefficients coefficients;
+    PiecewiseCubic<Math, 256> power_exchanged_approximation;
+  };
+  struct NoRuntimeParameters {};
+
+  /// Points the model at the parameters and nodes of this reactor
+  void point_model_at_members();
+
+  using Model::set_control_rod_parameters;
+  using Model::update_derived_power;
+  using Model::update_derived_reactivity;
+  using Model::state;
+  using Model::time_step_coefficients;
+  using Model::target_thermal_power_watts;
+  using Model::fuel_elements;
+  using Model::runtime_coefficients;
+
+  /// The fuel element nodes, only worked on with fuel_element_temperatures.
+  /// They're out of the state so it stays small when they're off, see
+  /// ReactorState::fuel_elements_current
+  FuelElements fuel_element_nodes;
+
+  /// Only takes up space when the parameters are set at runtime
+  [[no_unique_address]] std::conditional_t<PARAMETERS_AT_RUNTIME,
+                                           RuntimeParameters,
+                                           NoRuntimeParameters>
+      runtime_parameters;
+
+  /// What the model's state and time step coefficients refer to
+  ReactorState reactor_state;
+  TimeStepCoefficients reactor_time_step_coefficients;
+};
+
+using Reactor = BasicReactor<double>;
+/// The JSI TRIGA with parameters that can be changed at runtime
+using RuntimeReactor = BasicReactor<double, RUNTIME_TRIGA_CONFIGURATION>;
 #endif
@@ -0,0 +1,263 @@
+#ifndef REACTOR_CONFIGURATION_HPP
+#define REACTOR_CONFIGURATION_HPP
+
+#include "constants.hpp"
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Everything that makes one TRIGA core different from another, for
+/// BasicReactor's CONFIGURATION template parameter.
+///
+/// Being a template parameter, every value is a compile time constant inside
+/// the reactor, and each configuration gets its own tick() with them folded
+/// in, unless parameters_at_runtime is set. Only fields the reactor model uses
+/// are here, the hardware and the integrator tolerances stay in constants.hpp.
+///
+/// GROUPS is the number of delayed neutron groups, the reactor sizes its
+/// precursors and state vector by it
+template <uint8_t GROUPS> struct BasicReactorConfiguration {
+  // == Kinetics ==
+  double prompt_neutron_lifetime_seconds;
+  std::array<double, GROUPS> delayed_neutron_fractions;
+  /// Used as decay constants, lambda_i in 1/s
+  std::array<double, GROUPS> decay_times;
+  double neutron_source_intensity_neutrons_per_second;
+  double neutron_velocity_meters_per_second;
+  double neutron_fission_energy_released_MeV;
+  double core_volume_liters;
+  /// Thermal flux averaged over the core, in 1/(cm^2 s) per watt, for the
+  /// xenon poisoning. Not BasicReactor::get_flux, which counts every neutron
+  /// at 2200 m/s
+  double thermal_flux_per_watt;
+
+  // == Fuel ==
+  uint32_t fuel_elements_in_core;
+  double fuel_element_outer_radius_cm;
+  double fuel_element_inner_radius_cm;
+  double fuel_element_length_cm;
+  double fuel_density_kg_per_cm3;
+  /// Stationary fuel temperature polynomial of the power per element, see
+  /// TEMPERATURE_FE_STAT_A0
+  double temperature_fe_stat_a0;
+  double temperature_fe_stat_a1;
+  double temperature_fe_stat_a2;
+  double fuel_t_feedback_coefficient_0_c_pcm_per_c;
+  double fuel_t_feedback_coefficient_240_c_pcm_per_c;
+  double fuel_t_feedback_coefficient_slope_after_peak_pcm_per_c_squared;
+
+  // == Water ==
+  double water_volume_cubic_meters;
+  double water_density_kg_per_m3;
+  double water_specific_heat_capacity_J_per_kg_K;
+  double water_active_cooling_power_watts;
+
+  // == Control rods ==
+  /// Reactivity if we removed all the control poisons
+  double excess_reactivity_pcm;
+  /// Worth of each rod when fully inserted
+  double control_rod_worth_pcm;
+  uint32_t safety_rod_speed_per_second;
+  uint32_t regulating_rod_speed_per_second;
+  uint32_t compensating_rod_speed_per_second;
+  /// How quickly each rod speeds up and slows down, in steps per second
+  /// squared. 0 moves at full speed straight away and stops dead at the target
+  uint32_t safety_rod_acceleration_per_second_squared = 0;
+  uint32_t regulating_rod_acceleration_per_second_squared = 0;
+  uint32_t compensating_rod_acceleration_per_second_squared = 0;
+
+  // == SCRAM limits ==
+  double power_scram_watts;
+  double fuel_temperature_scram_celcius;
+  double water_temperature_scram_celcius;
+
+  /// Whether the reactor takes its parameters from apply_parameters at
+  /// runtime, starting from these values, instead of folding them in at
+  /// compile time. See ReactorParameters
+  bool parameters_at_runtime = false;
+
+  constexpr bool operator==(const BasicReactorConfiguration &) const = default;
+
+  /// The same core with other delayed neutron group data, of any number of
+  /// groups
+  template <size_t OTHER_GROUPS>
+  constexpr BasicReactorConfiguration<OTHER_GROUPS> with_delayed_neutron_groups(
+      const std::array<double, OTHER_GROUPS> &other_delayed_neutron_fractions,
+      const std::array<double, OTHER_GROUPS> &other_decay_times) const {
+    return {
+        .prompt_neutron_lifetime_seconds = prompt_neutron_lifetime_seconds,
+        .delayed_neutron_fractions = other_delayed_neutron_fractions,
+        .decay_times = other_decay_times,
+        .neutron_source_intensity_neutrons_per_second =
+            neutron_source_intensity_neutrons_per_second,
+        .neutron_velocity_meters_per_second =
+            neutron_velocity_meters_per_second,
+        .neutron_fission_energy_released_MeV =
+            neutron_fission_energy_released_MeV,
+        .core_volume_liters = core_volume_liters,
+        .thermal_flux_per_watt = thermal_flux_per_watt,
+
+        .fuel_elements_in_core = fuel_elements_in_core,
+        .fuel_element_outer_radius_cm = fuel_element_outer_radius_cm,
+        .fuel_element_inner_radius_cm = fuel_element_inner_radius_cm,
+        .fuel_element_length_cm = fuel_element_length_cm,
+        .fuel_density_kg_per_cm3 = fuel_density_kg_per_cm3,
+        .temperature_fe_stat_a0 = temperature_fe_stat_a0,
+        .temperature_fe_stat_a1 = temperature_fe_stat_a1,
+        .temperature_fe_stat_a2 = temperature_fe_stat_a2,
+        .fuel_t_feedback_coefficient_0_c_pcm_per_c =
+            fuel_t_feedback_coefficient_0_c_pcm_per_c,
+        .fuel_t_feedback_coefficient_240_c_pcm_per_c =
+            fuel_t_feedback_coefficient_240_c_pcm_per_c,
+        .fuel_t_feedback_coefficient_slope_after_peak_pcm_per_c_squared =
+            fuel_t_feedback_coefficient_slope_after_peak_pcm_per_c_squared,
+
+        .water_volume_cubic_meters = water_volume_cubic_meters,
+        .water_density_kg_per_m3 = water_density_kg_per_m3,
+        .water_specific_heat_capacity_J_per_kg_K =
+            water_specific_heat_capacity_J_per_kg_K,
+        .water_active_cooling_power_watts = water_active_cooling_power_watts,
+
+        .excess_reactivity_pcm = excess_reactivity_pcm,
+        .control_rod_worth_pcm = control_rod_worth_pcm,
+        .safety_rod_speed_per_second = safety_rod_speed_per_second,
+        .regulating_rod_speed_per_second = regulating_rod_speed_per_second,
+        .compensating_rod_speed_per_second = compensating_rod_speed_per_second,
+        .safety_rod_acceleration_per_second_squared =
+            safety_rod_acceleration_per_second_squared,
+        .regulating_rod_acceleration_per_second_squared =
+            regulating_rod_acceleration_per_second_squared,
+        .compensating_rod_acceleration_per_second_squared =
+            compensating_rod_acceleration_per_second_squared,
+
+        .power_scram_watts = power_scram_watts,
+        .fuel_temperature_scram_celcius = fuel_temperature_scram_celcius,
+        .water_temperature_scram_celcius = water_temperature_scram_celcius,
+
+        .parameters_at_runtime = parameters_at_runtime,
+    };
+  }
+
+  constexpr double calculate_one_fuel_element_volume_cm3() const {
+    return ((0.5 * fuel_element_outer_radius_cm) *
+                (0.5 * fuel_element_outer_radius_cm) -
+            (0.5 * fuel_element_inner_radius_cm) *
+                (0.5 * fuel_element_inner_radius_cm)) *
+           fuel_element_length_cm * 3.1415926535;
+  }
+
+  /// Mass of all the fuel elements in the core
+  constexpr double calculate_fuel_mass_kg() const {
+    return fuel_density_kg_per_cm3 * calculate_one_fuel_element_volume_cm3() *
+           fuel_elements_in_core;
+  }
+
+  /// Fissions in each cm^3 of the core for each joule of energy released
+  constexpr double calculate_fissions_per_cm3_per_joule() const {
+    return 1.0 / (neutron_fission_energy_released_MeV * 1.6022e-13 *
+                  (core_volume_liters * 1000.0));
+  }
+
+  /// Part of the power the fission products give off later as decay heat,
+  /// after a long run, see DecayHeatGroups
+  constexpr double calculate_decay_heat_fraction() const {
+    double fraction = 0.0;
+
+    for (uint8_t i = 0; i < DECAY_HEAT_GROUPS; i++) {
+      fraction += DECAY_HEAT_GROUP_POWERS_MEV_PER_SECOND[i] /
+                  DECAY_HEAT_DECAY_CONSTANTS_PER_SECOND[i] /
+                  neutron_fission_energy_released_MeV;
+    }
+
+    return fraction;
+  }
+
+  /// Heat capacity of the cooling water, Cw, always at 20 C
+  constexpr double calculate_water_heat_capacity_J_per_K() const {
+    return water_volume_cubic_meters * water_density_kg_per_m3 *
+           water_specific_heat_capacity_J_per_kg_K;
+  }
+};
+
+/// A configuration with the delayed neutron groups of constants.hpp, the
+/// runtime parameters and the presets are all of this kind
+using ReactorConfiguration = BasicReactorConfiguration<DELAYED_NEUTRON_GROUPS>;
+
+/// The JSI TRIGA Mark II, with the values from constants.hpp
+constexpr ReactorConfiguration JSI_TRIGA_CONFIGURATION = {
+    .prompt_neutron_lifetime_seconds = PROMPT_NEUTRON_LIFETIME_SECONDS,
+    .delayed_neutron_fractions = DELAYED_NEUTRON_FRACTIONS,
+    .decay_times = DECAY_TIMES,
+    .neutron_source_intensity_neutrons_per_second =
+        NEUTRON_SOURCE_INTENSITY_NEUTRONS_PER_SECOND,
+    .neutron_velocity_meters_per_second = NEUTRON_VELOCITY_METERS_PER_SECOND,
+    .neutron_fission_energy_released_MeV = NEUTRON_FISSION_ENERGY_RELEASED_MEV,
+    .core_volume_liters = CORE_VOLUME_LITERS,
+    .thermal_flux_per_watt = THERMAL_FLUX_PER_WATT,
+
+    .fuel_elements_in_core = FUEL_ELEMENTS_IN_CORE,
+    .fuel_element_outer_radius_cm = FUEL_ELEMENT_OUTER_RADIUS_CM,
+    .fuel_element_inner_radius_cm = FUEL_ELEMENT_INNER_RADIUS_CM,
+    .fuel_element_length_cm = FUEL_ELEMENT_LENGTH_CM,
+    .fuel_density_kg_per_cm3 = FUEL_DENSITY_KG_PER_CM3,
+    .temperature_fe_stat_a0 = TEMPERATURE_FE_STAT_A0,
+    .temperature_fe_stat_a1 = TEMPERATURE_FE_STAT_A1,
+    .temperature_fe_stat_a2 = TEMPERATURE_FE_STAT_A2,
+    .fuel_t_feedback_coefficient_0_c_pcm_per_c =
+        FUEL_T_FEEDBACK_COEFFICIENT_0_C_PCM_PER_C,
+    .fuel_t_feedback_coefficient_240_c_pcm_per_c =
+        FUEL_T_FEEDBACK_COEFFICIENT_240_C_PCM_PER_C,
+    .fuel_t_feedback_coefficient_slope_after_peak_pcm_per_c_squared =
+        FUEL_T_FEEDBACK_COEFFICIENT_SLOPE_AFTER_PEAK_PCM_PER_C_SQUARED,
+
+    .water_volume_cubic_meters = WATER_VOLUME_CUBIC_METERS,
+    .water_density_kg_per_m3 = WATER_DENSITY_KG_PER_M3,
+    .water_specific_heat_capacity_J_per_kg_K =
+        WATER_SPECIFIC_HEAT_CAPACITY_J_PER_KG_K,
+    .water_active_cooling_power_watts = WATER_ACTIVE_COOLING_POWER_WATTS,
+
+    .excess_reactivity_pcm = EXCESS_REACTIVITY_PCM,
+    .control_rod_worth_pcm = CONTROL_ROD_WORTH_PCM,
+    .safety_rod_speed_per_second = SAFETY_ROD_SPEED_PER_SECOND,
+    .regulating_rod_speed_per_second = REGULATING_ROD_SPEED_PER_SECOND,
+    .compensating_rod_speed_per_second = COMPENSATING_ROD_SPEED_PER_SECOND,
+
+    .power_scram_watts = POWER_SCRAM_WATTS,
+    .fuel_temperature_scram_celcius = FUEL_TEMPERATURE_SCRAM_CELCIUS,
+    .water_temperature_scram_celcius = WATER_TEMPERATURE_SCRAM_CELCIUS,
+};
+
+/// An example of a bigger core, the JSI fuel and kinetics with 80 elements,
+/// stronger rods, twice the water and cooling, and the power limit moved up to
+/// match. Made up to show another configuration, not calibrated against any
+/// real reactor
+constexpr ReactorConfiguration EXAMPLE_80_ELEMENT_TRIGA_CONFIGURATION = [] {
+  ReactorConfiguration configuration = JSI_TRIGA_CONFIGURATION;
+
+  configuration.fuel_elements_in_core = 80;
+  configuration.core_volume_liters = 34.5;
+  configuration.excess_reactivity_pcm = 3300.0;
+  configuration.control_rod_worth_pcm = 4500.0;
+
+  configuration.water_volume_cubic_meters = 40.0;
+  configuration.water_active_cooling_power_watts = 480000.0;
+
+  configuration.power_scram_watts = 500000.0;
+
+  return configuration;
+}();
+
+/// The JSI TRIGA with the 8 group delayed neutron data, see
+/// DELAYED_NEUTRON_FRACTIONS_8_GROUP
+constexpr BasicReactorConfiguration<8> JSI_TRIGA_8_GROUP_CONFIGURATION =
+    JSI_TRIGA_CONFIGURATION.with_delayed_neutron_groups(
+        DELAYED_NEUTRON_FRACTIONS_8_GROUP, DECAY_TIMES_8_GROUP);
+
+/// The JSI TRIGA as the starting point for parameters changed at runtime, see
+/// RuntimeReactor
+constexpr ReactorConfiguration RUNTIME_TRIGA_CONFIGURATION = [] {
+  ReactorConfiguration configuration = JSI_TRIGA_CONFIGURATION;
+  configuration.parameters_at_runtime = true;
+  return configuration;
+}();
+#endif
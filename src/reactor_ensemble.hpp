@@ -0,0 +1,460 @@
+#ifndef REACTOR_ENSEMBLE_HPP
+#define REACTOR_ENSEMBLE_HPP
+
+// Lockstep ensemble of N reactors, for batch studies on the desktop
+//
+// Every member runs the original physics of Reactor::tick() with its default
+// switches and JSI_TRIGA_CONFIGURATION: euler kinetics and precursors, linear
+// rod worths, and exact thermal math with the temperatures updated every tick.
+// The other configurations, xenon, decay heat, pulses, per element fuel
+// temperatures, rod worth curves and the other switches aren't in it.
+//
+// The state of all members is kept in structure-of-arrays layout and every step of the tick is
+// a loop over the members without branches, so the compiler can vectorize it.
+// The SCRAM and control rod logic become masked (selected) operations.
+//
+// GCC only vectorizes all of tick() with -fno-math-errno -fno-trapping-math
+// (see build-benchmark.sh), neither changes any results.
+#include "constants.hpp"
+#include "vectorizable_math.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stddef.h>
+#include <stdint.h>
+
+template <size_t N> class ReactorEnsemble {
+public:
+  /// Creates N reactors in the same state as a new Reactor()
+  ReactorEnsemble() {
+    excess_reactivity_pcm.fill(EXCESS_REACTIVITY_PCM);
+    control_rod_worth_pcm.fill(CONTROL_ROD_WORTH_PCM);
+    active_cooling_power_watts.fill(WATER_ACTIVE_COOLING_POWER_WATTS);
+    target_thermal_power_watts.fill(20001);
+
+    active_cooling_system_enabled.fill(1);
+    automatic_control.fill(1);
+    scrams_enabled.fill(1);
+    in_scram.fill(0);
+    step_scram_started.fill(0);
+
+    water_temperature_celcius.fill(20.0);
+    fuel_temperature_celcius.fill(20.0);
+    neutrons_in_core.fill(0.0);
+    reactivity_pcm.fill(0.0);
+
+    for (auto &group : precursor_populations) {
+      group.fill(0.0);
+    }
+
+    safety_rod_position.fill(0);
+    safety_rod_target.fill(0);
+    regulating_rod_position.fill(24e5);
+    regulating_rod_target.fill(24e5);
+    compensating_rod_position.fill(0);
+    compensating_rod_target.fill(0);
+    safety_rod_step_remainder_q16.fill(0.0);
+    regulating_rod_step_remainder_q16.fill(0.0);
+    compensating_rod_step_remainder_q16.fill(0.0);
+    rcs_microseconds_since_sample.fill(RCS_SAMPLE_PERIOD_MICROSECONDS);
+
+    for (uint8_t i = 0; i < DELAYED_NEUTRON_GROUPS; i++) {
+      fractions_over_lifetime[i] =
+          DELAYED_NEUTRON_FRACTIONS[i] / PROMPT_NEUTRON_LIFETIME_SECONDS;
+      effective_delayed_neutron_fraction += DELAYED_NEUTRON_FRACTIONS[i];
+    }
+  }
+
+  static constexpr size_t size() { return N; }
+
+  float get_time_delta_seconds() { return time_delta_seconds; }
+  void set_time_delta_seconds(float time_delta_s) {
+    time_delta_seconds = time_delta_s;
+  }
+
+  uint64_t get_steps_elapsed() { return steps_elapsed; }
+  double get_time_elapsed_seconds() {
+    return (double)steps_elapsed * (double)time_delta_seconds;
+  }
+
+  // Per member parameters, they default to the values in constants.hpp
+  void set_excess_reactivity_pcm(size_t lane, double pcm) {
+    excess_reactivity_pcm[lane] = pcm;
+  }
+  /// Worth of every control rod of this member
+  void set_control_rod_worth_pcm(size_t lane, double pcm) {
+    control_rod_worth_pcm[lane] = pcm;
+  }
+  void set_active_cooling_power_watts(size_t lane, double watts) {
+    active_cooling_power_watts[lane] = watts;
+  }
+  void set_target_thermal_power_watts(size_t lane, uint32_t target) {
+    target_thermal_power_watts[lane] = target;
+  }
+
+  // Per member switches, same as on Reactor
+  void set_active_cooling_system_enabled(size_t lane, bool enabled) {
+    active_cooling_system_enabled[lane] = enabled;
+  }
+  void set_automatic_control(size_t lane, bool enabled) {
+    automatic_control[lane] = enabled;
+  }
+  void set_scrams_enabled(size_t lane, bool enabled) {
+    scrams_enabled[lane] = enabled;
+  }
+
+  /// Rod programs: set the targets of a member between ticks, between 0 and
+  /// 4_000_000
+  void set_rod_target_positions(size_t lane, uint32_t safety,
+                                uint32_t regulating, uint32_t compensating) {
+    safety_rod_target[lane] = std::clamp<uint32_t>(safety, 0, 4e6);
+    regulating_rod_target[lane] = std::clamp<uint32_t>(regulating, 0, 4e6);
+    compensating_rod_target[lane] = std::clamp<uint32_t>(compensating, 0, 4e6);
+  }
+
+  uint32_t get_safety_rod_position(size_t lane) {
+    return (uint32_t)safety_rod_position[lane];
+  }
+  uint32_t get_regulating_rod_position(size_t lane) {
+    return (uint32_t)regulating_rod_position[lane];
+  }
+  uint32_t get_compensating_rod_position(size_t lane) {
+    return (uint32_t)compensating_rod_position[lane];
+  }
+
+  double get_neutrons_in_core(size_t lane) { return neutrons_in_core[lane]; }
+  double get_reactivity_pcm(size_t lane) { return reactivity_pcm[lane]; }
+  double get_fuel_temperature_celcius(size_t lane) {
+    return fuel_temperature_celcius[lane];
+  }
+  double get_water_temperature_celcius(size_t lane) {
+    return water_temperature_celcius[lane];
+  }
+  double get_neutron_population_for_group(size_t lane, uint8_t group) {
+    return precursor_populations[group - 1][lane];
+  }
+  bool get_in_scram(size_t lane) { return in_scram[lane]; }
+  uint64_t get_steps_since_scram_started(size_t lane) {
+    return steps_elapsed - step_scram_started[lane];
+  }
+
+  double calculate_power_watts(size_t lane) {
+    return neutrons_in_core[lane] * WATTS_PER_NEUTRON;
+  }
+
+  /// Initiates an emergency shutdown of one member
+  void scram(size_t lane) {
+    in_scram[lane] = 1;
+    step_scram_started[lane] = steps_elapsed;
+
+    safety_rod_position[lane] = 4e6;
+    safety_rod_target[lane] = 4e6;
+    regulating_rod_position[lane] = 4e6;
+    regulating_rod_target[lane] = 4e6;
+    compensating_rod_position[lane] = 4e6;
+    compensating_rod_target[lane] = 4e6;
+  }
+
+  /// Runs every member forward one time_delta_s fraction of time, in the same
+  /// order as Reactor::tick()
+  void tick() {
+    double dt = time_delta_seconds;
+
+    // 1. Re-calculate the fuel temperature based on power from the previous
+    for (size_t i = 0; i < N; i++) {
+      double power_watts = neutrons_in_core[i] * WATTS_PER_NEUTRON;
+
+      double Cp_J_per_K =
+          (333 + 0.678 * (fuel_temperature_celcius[i] + 0.15)) * FUEL_MASS_KG;
+
+      double power_exchanged = calculate_power_exchanged_joule_per_second(
+          water_temperature_celcius[i] - fuel_temperature_celcius[i]);
+
+      fuel_temperature_celcius[i] +=
+          (power_watts * dt - power_exchanged * dt) / Cp_J_per_K;
+    }
+
+    // 2.1 Move control rods to their target positions
+    // In 1/65536 steps per tick, like ControlRod
+    double safety_velocity_q16 = calculate_rod_velocity_q16(
+        dt, SAFETY_ROD_SPEED_PER_SECOND);
+    double regulating_velocity_q16 = calculate_rod_velocity_q16(
+        dt, REGULATING_ROD_SPEED_PER_SECOND);
+    double compensating_velocity_q16 = calculate_rod_velocity_q16(
+        dt, COMPENSATING_ROD_SPEED_PER_SECOND);
+
+    move_rods(safety_rod_position, safety_rod_target,
+              safety_rod_step_remainder_q16, safety_velocity_q16);
+    move_rods(regulating_rod_position, regulating_rod_target,
+              regulating_rod_step_remainder_q16, regulating_velocity_q16);
+    move_rods(compensating_rod_position, compensating_rod_target,
+              compensating_rod_step_remainder_q16, compensating_velocity_q16);
+
+    // 2.2 to balance target power, masked to members with automatic control
+    // that aren't in a scram and have a sample due
+    for (size_t i = 0; i < N; i++) {
+      // Masks are combined with & and |, && and || become branches
+      bool balancing = (in_scram[i] == 0) & (automatic_control[i] != 0) &
+                       (rcs_microseconds_since_sample[i] >=
+                        (double)RCS_SAMPLE_PERIOD_MICROSECONDS);
+
+      safety_rod_target[i] = balancing ? 0 : safety_rod_target[i];
+      compensating_rod_target[i] = balancing ? 0 : compensating_rod_target[i];
+
+      bool others_out =
+          (safety_rod_position[i] == 0.0) & (compensating_rod_position[i] == 0.0);
+
+      // Reactor compares the power truncated to whole watts, this is the
+      // same comparison without the conversion
+      double power_watts = neutrons_in_core[i] * WATTS_PER_NEUTRON;
+      double target = target_thermal_power_watts[i];
+
+      // As far as the regulating rod gets until the next sample, and a tick
+      double step = (double)((uint64_t)REGULATING_ROD_SPEED_PER_SECOND *
+                             RCS_SAMPLE_PERIOD_MICROSECONDS / 1000000) +
+                    std::ceil(regulating_velocity_q16 / 65536.0);
+      double delta_position = power_watts >= target + 1.0 ? step : 0.0;
+      delta_position = power_watts < target ? -step : delta_position;
+
+      double new_target = std::clamp(
+          regulating_rod_position[i] + delta_position, 24e5, 4e6);
+
+      regulating_rod_target[i] =
+          balancing & others_out ? new_target : regulating_rod_target[i];
+
+      rcs_microseconds_since_sample[i] =
+          balancing ? 0.0 : rcs_microseconds_since_sample[i];
+    }
+
+    // 3. Recalculate the reactivity
+    for (size_t i = 0; i < N; i++) {
+      double worth_pcm = control_rod_worth_pcm[i];
+
+      double control_rod_worths_pcm =
+          safety_rod_position[i] / 4e6 * worth_pcm +
+          regulating_rod_position[i] / 4e6 * worth_pcm +
+          compensating_rod_position[i] / 4e6 * worth_pcm;
+
+      reactivity_pcm[i] = excess_reactivity_pcm[i] - control_rod_worths_pcm -
+                          calculate_fuel_temperature_feedback_pcm(
+                              fuel_temperature_celcius[i]);
+    }
+
+    // 4. Point kinetic equations
+    for (size_t i = 0; i < N; i++) {
+      double neutrons_from_population = 0.0;
+
+      for (uint8_t g = 0; g < DELAYED_NEUTRON_GROUPS; g++) {
+        neutrons_from_population +=
+            DECAY_TIMES[g] * precursor_populations[g][i];
+      }
+
+      double balanced_reactivity =
+          reactivity_pcm[i] * 1e-5 - effective_delayed_neutron_fraction;
+
+      double dN_dt = neutrons_in_core[i] * (balanced_reactivity /
+                                            PROMPT_NEUTRON_LIFETIME_SECONDS) +
+                     neutrons_from_population +
+                     NEUTRON_SOURCE_INTENSITY_NEUTRONS_PER_SECOND;
+
+      neutrons_in_core[i] += dN_dt * dt;
+    }
+
+    for (uint8_t g = 0; g < DELAYED_NEUTRON_GROUPS; g++) {
+      for (size_t i = 0; i < N; i++) {
+        precursor_populations[g][i] +=
+            (fractions_over_lifetime[g] * neutrons_in_core[i] -
+             DECAY_TIMES[g] * precursor_populations[g][i]) *
+            dt;
+      }
+    }
+
+    // 5. Propagate the temperature of the water in the fuel tank
+    for (size_t i = 0; i < N; i++) {
+      double water_T = water_temperature_celcius[i];
+
+      double power_watts = neutrons_in_core[i] * WATTS_PER_NEUTRON;
+
+      // Air is always at 20 C, no convection if it's hotter than the water
+      double air_delta_K = water_T - 20.0;
+      double convection_to_air =
+          air_delta_K < 0.0 ? 0.0
+                            : 13.6 * air_delta_K * vectorizable_cbrt(air_delta_K);
+
+      double transfer_to_concrete = 250.0 * (water_T - 20.0);
+
+      double active_cooling =
+          active_cooling_system_enabled[i] ? active_cooling_power_watts[i]
+                                           : 0.0;
+
+      double resultant_J = power_watts * dt - convection_to_air * dt -
+                           transfer_to_concrete * dt - active_cooling * dt;
+
+      water_T += resultant_J / WATER_HEAT_CAPACITY_J_PER_K;
+
+      water_temperature_celcius[i] = std::max(water_T, 20.0);
+    }
+
+    // 6. Check operational limits and start or release SCRAMs
+    for (size_t i = 0; i < N; i++) {
+      double power_watts = neutrons_in_core[i] * WATTS_PER_NEUTRON;
+
+      // Reactor truncates to whole watts, so <= 1 W is < 2 W
+      bool release = (in_scram[i] != 0) &
+                     ((power_watts < 2.0) | (scrams_enabled[i] == 0));
+
+      bool release_rods = release & (automatic_control[i] != 0);
+
+      safety_rod_target[i] = release_rods ? 0 : safety_rod_target[i];
+      compensating_rod_target[i] = release_rods ? 0 : compensating_rod_target[i];
+
+      bool trip = (scrams_enabled[i] != 0) &
+                  ((power_watts >= (double)POWER_SCRAM_WATTS) |
+                   (water_temperature_celcius[i] >=
+                    (double)WATER_TEMPERATURE_SCRAM_CELCIUS) |
+                   (fuel_temperature_celcius[i] >=
+                    (double)FUEL_TEMPERATURE_SCRAM_CELCIUS));
+
+      uint64_t still_in_scram = release ? 0 : in_scram[i];
+      in_scram[i] = trip ? 1 : still_in_scram;
+
+      uint64_t started = release ? 0 : step_scram_started[i];
+      step_scram_started[i] = trip ? steps_elapsed : started;
+
+      safety_rod_position[i] = trip ? 4e6 : safety_rod_position[i];
+      safety_rod_target[i] = trip ? 4e6 : safety_rod_target[i];
+      regulating_rod_position[i] = trip ? 4e6 : regulating_rod_position[i];
+      regulating_rod_target[i] = trip ? 4e6 : regulating_rod_target[i];
+      compensating_rod_position[i] = trip ? 4e6 : compensating_rod_position[i];
+      compensating_rod_target[i] = trip ? 4e6 : compensating_rod_target[i];
+    }
+
+    // The controller's clock, in whole microseconds like Reactor's
+    double tick_microseconds = (double)std::llround((double)dt * 1e6);
+
+    for (size_t i = 0; i < N; i++) {
+      rcs_microseconds_since_sample[i] =
+          std::min(rcs_microseconds_since_sample[i] + tick_microseconds,
+                   (double)RCS_SAMPLE_PERIOD_MICROSECONDS);
+    }
+
+    steps_elapsed += 1;
+  }
+
+protected:
+  /// Same chain of multiplications as Reactor::calculate_power_watts()
+  static constexpr double WATTS_PER_NEUTRON =
+      0.56 * (double)NEUTRON_VELOCITY_METERS_PER_SECOND *
+      NEUTRON_FISSION_ENERGY_RELEASED_MEV * 1.6022e-13;
+
+  /// Same as Reactor::calculate_power_exchanged_joule_per_second, see there
+  static double
+  calculate_power_exchanged_joule_per_second(double temperature_difference_K) {
+    double first = TEMPERATURE_FE_STAT_A1 * TEMPERATURE_FE_STAT_A1 -
+                   3.0 * TEMPERATURE_FE_STAT_A0 * TEMPERATURE_FE_STAT_A2;
+    double second = 2.0 * TEMPERATURE_FE_STAT_A1 * TEMPERATURE_FE_STAT_A1 *
+                        TEMPERATURE_FE_STAT_A1 -
+                    9.0 * TEMPERATURE_FE_STAT_A0 * TEMPERATURE_FE_STAT_A1 *
+                        TEMPERATURE_FE_STAT_A2 +
+                    27.0 * TEMPERATURE_FE_STAT_A2 * TEMPERATURE_FE_STAT_A2 *
+                        temperature_difference_K;
+    double root = vectorizable_cbrt(
+        (second + std::sqrt(second * second - 4.0 * first * first * first)) /
+        2.0);
+    return -FUEL_ELEMENTS_IN_CORE * (1.0 / (3.0 * TEMPERATURE_FE_STAT_A2)) *
+           (TEMPERATURE_FE_STAT_A1 + root + (first / root));
+  }
+
+  /// Same as Reactor::calculate_fuel_temperature_feedback_pcm, as selects
+  static double calculate_fuel_temperature_feedback_pcm(double fuel_T) {
+    double below_240 =
+        fuel_T * (FUEL_T_FEEDBACK_COEFFICIENT_0_C_PCM_PER_C +
+                  (FUEL_T_FEEDBACK_COEFFICIENT_240_C_PCM_PER_C -
+                   FUEL_T_FEEDBACK_COEFFICIENT_0_C_PCM_PER_C) *
+                      (fuel_T / 240.0));
+
+    double above_240 =
+        fuel_T *
+        (FUEL_T_FEEDBACK_COEFFICIENT_240_C_PCM_PER_C +
+         FUEL_T_FEEDBACK_COEFFICIENT_SLOPE_AFTER_PEAK_PCM_PER_C_SQUARED *
+             (fuel_T - 240.0));
+
+    double feedback = fuel_T <= 240.0 ? below_240 : above_240;
+    return fuel_T <= 0.0 ? 0.0 : feedback;
+  }
+
+  /// Same as ControlRod::Motion::calculate, whole 1/65536 steps
+  static double calculate_rod_velocity_q16(double dt, double speed_per_second) {
+    return (double)(int64_t)std::min(dt * speed_per_second * 65536.0,
+                                     4e6 * 65536.0);
+  }
+
+  /// ControlRod::move_towards_target for every member, the part of a step left
+  /// over is kept for the next tick until the rod gets to its target. All
+  /// whole numbers, so exact in double
+  static void move_rods(std::array<double, N> &positions,
+                        const std::array<double, N> &targets,
+                        std::array<double, N> &step_remainders_q16,
+                        double velocity_q16) {
+    for (size_t i = 0; i < N; i++) {
+      double travel_q16 = velocity_q16 + step_remainders_q16[i];
+      double steps = std::floor(travel_q16 * (1.0 / 65536.0));
+      positions[i] += std::clamp(targets[i] - positions[i], -steps, steps);
+
+      step_remainders_q16[i] = positions[i] == targets[i]
+                                   ? 0.0
+                                   : travel_q16 - steps * 65536.0;
+    }
+  }
+
+  float time_delta_seconds = 1e-4;
+  uint64_t steps_elapsed = 0;
+
+  // Parameters
+  alignas(64) std::array<double, N> excess_reactivity_pcm;
+  alignas(64) std::array<double, N> control_rod_worth_pcm;
+  alignas(64) std::array<double, N> active_cooling_power_watts;
+  alignas(64) std::array<double, N> target_thermal_power_watts;
+
+  // Switches, 0 or 1
+  //
+  // Every per member array holds 64 bit values, mixing in narrower lanes stops
+  // GCC from vectorizing the loops on AVX2
+  alignas(64) std::array<uint64_t, N> active_cooling_system_enabled;
+  alignas(64) std::array<uint64_t, N> automatic_control;
+  alignas(64) std::array<uint64_t, N> scrams_enabled;
+
+  // Scram data
+  alignas(64) std::array<uint64_t, N> in_scram;
+  alignas(64) std::array<uint64_t, N> step_scram_started;
+
+  // Temperatures
+  alignas(64) std::array<double, N> water_temperature_celcius;
+  alignas(64) std::array<double, N> fuel_temperature_celcius;
+
+  // Reactivity and neutrons
+  alignas(64) std::array<double, N> reactivity_pcm;
+  alignas(64) std::array<double, N> neutrons_in_core;
+  alignas(64) std::array<std::array<double, N>, DELAYED_NEUTRON_GROUPS>
+      precursor_populations;
+
+  // Control rods, whole steps between 0 and 4_000_000
+  //
+  // Kept as doubles, which hold these integers exactly, so the rod logic needs
+  // no conversions and differences can't wrap
+  alignas(64) std::array<double, N> safety_rod_position;
+  alignas(64) std::array<double, N> safety_rod_target;
+  alignas(64) std::array<double, N> regulating_rod_position;
+  alignas(64) std::array<double, N> regulating_rod_target;
+  alignas(64) std::array<double, N> compensating_rod_position;
+  alignas(64) std::array<double, N> compensating_rod_target;
+  alignas(64) std::array<double, N> safety_rod_step_remainder_q16;
+  alignas(64) std::array<double, N> regulating_rod_step_remainder_q16;
+  alignas(64) std::array<double, N> compensating_rod_step_remainder_q16;
+  alignas(64) std::array<double, N> rcs_microseconds_since_sample;
+
+  // Constants shared by all members
+  std::array<double, DELAYED_NEUTRON_GROUPS> fractions_over_lifetime;
+  double effective_delayed_neutron_fraction = 0.0;
+};
+#endif
@@ -0,0 +1,395 @@
+#include "reactor_parameters.hpp"
+#include "thermal_approximations.hpp"
+#include <cmath>
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// Values validate() accepts for a parameter, besides being finite
+enum class ParameterRange {
+  ANY,
+  /// Divided by, or the model means nothing at 0
+  POSITIVE,
+  NOT_NEGATIVE,
+};
+
+/// A double parameter and its name in the text
+struct DoubleParameter {
+  const char *name;
+  double ReactorConfiguration::*value;
+  ParameterRange range;
+};
+
+/// A whole number parameter and its name in the text. Never below 0, so
+/// only POSITIVE limits it
+struct IntegerParameter {
+  const char *name;
+  uint32_t ReactorConfiguration::*value;
+  ParameterRange range;
+};
+
+static constexpr DoubleParameter DOUBLE_PARAMETERS[] = {
+    {"prompt_neutron_lifetime_seconds",
+     &ReactorConfiguration::prompt_neutron_lifetime_seconds,
+     ParameterRange::POSITIVE},
+    {"neutron_source_intensity_neutrons_per_second",
+     &ReactorConfiguration::neutron_source_intensity_neutrons_per_second,
+     ParameterRange::NOT_NEGATIVE},
+    {"neutron_velocity_meters_per_second",
+     &ReactorConfiguration::neutron_velocity_meters_per_second,
+     ParameterRange::POSITIVE},
+    {"neutron_fission_energy_released_MeV",
+     &ReactorConfiguration::neutron_fission_energy_released_MeV,
+     ParameterRange::POSITIVE},
+    {"core_volume_liters", &ReactorConfiguration::core_volume_liters,
+     ParameterRange::POSITIVE},
+    {"thermal_flux_per_watt", &ReactorConfiguration::thermal_flux_per_watt,
+     ParameterRange::POSITIVE},
+
+    {"fuel_element_outer_radius_cm",
+     &ReactorConfiguration::fuel_element_outer_radius_cm,
+     ParameterRange::POSITIVE},
+    {"fuel_element_inner_radius_cm",
+     &ReactorConfiguration::fuel_element_inner_radius_cm,
+     ParameterRange::NOT_NEGATIVE},
+    {"fuel_element_length_cm", &ReactorConfiguration::fuel_element_length_cm,
+     ParameterRange::POSITIVE},
+    {"fuel_density_kg_per_cm3", &ReactorConfiguration::fuel_density_kg_per_cm3,
+     ParameterRange::POSITIVE},
+    {"temperature_fe_stat_a0", &ReactorConfiguration::temperature_fe_stat_a0,
+     ParameterRange::ANY},
+    {"temperature_fe_stat_a1", &ReactorConfiguration::temperature_fe_stat_a1,
+     ParameterRange::ANY},
+    {"temperature_fe_stat_a2", &ReactorConfiguration::temperature_fe_stat_a2,
+     ParameterRange::ANY},
+    {"fuel_t_feedback_coefficient_0_c_pcm_per_c",
+     &ReactorConfiguration::fuel_t_feedback_coefficient_0_c_pcm_per_c,
+     ParameterRange::ANY},
+    {"fuel_t_feedback_coefficient_240_c_pcm_per_c",
+     &ReactorConfiguration::fuel_t_feedback_coefficient_240_c_pcm_per_c,
+     ParameterRange::ANY},
+    {"fuel_t_feedback_coefficient_slope_after_peak_pcm_per_c_squared",
+     &ReactorConfiguration::
+         fuel_t_feedback_coefficient_slope_after_peak_pcm_per_c_squared,
+     ParameterRange::ANY},
+
+    {"water_volume_cubic_meters",
+     &ReactorConfiguration::water_volume_cubic_meters,
+     ParameterRange::POSITIVE},
+    {"water_density_kg_per_m3", &ReactorConfiguration::water_density_kg_per_m3,
+     ParameterRange::POSITIVE},
+    {"water_specific_heat_capacity_J_per_kg_K",
+     &ReactorConfiguration::water_specific_heat_capacity_J_per_kg_K,
+     ParameterRange::POSITIVE},
+    {"water_active_cooling_power_watts",
+     &ReactorConfiguration::water_active_cooling_power_watts,
+     ParameterRange::NOT_NEGATIVE},
+
+    {"excess_reactivity_pcm", &ReactorConfiguration::excess_reactivity_pcm,
+     ParameterRange::ANY},
+    {"control_rod_worth_pcm", &ReactorConfiguration::control_rod_worth_pcm,
+     ParameterRange::NOT_NEGATIVE},
+
+    {"power_scram_watts", &ReactorConfiguration::power_scram_watts,
+     ParameterRange::POSITIVE},
+    {"fuel_temperature_scram_celcius",
+     &ReactorConfiguration::fuel_temperature_scram_celcius,
+     ParameterRange::ANY},
+    {"water_temperature_scram_celcius",
+     &ReactorConfiguration::water_temperature_scram_celcius,
+     ParameterRange::ANY},
+};
+
+static constexpr IntegerParameter INTEGER_PARAMETERS[] = {
+    {"fuel_elements_in_core", &ReactorConfiguration::fuel_elements_in_core,
+     ParameterRange::POSITIVE},
+    {"safety_rod_speed_per_second",
+     &ReactorConfiguration::safety_rod_speed_per_second,
+     ParameterRange::POSITIVE},
+    {"regulating_rod_speed_per_second",
+     &ReactorConfiguration::regulating_rod_speed_per_second,
+     ParameterRange::POSITIVE},
+    {"compensating_rod_speed_per_second",
+     &ReactorConfiguration::compensating_rod_speed_per_second,
+     ParameterRange::POSITIVE},
+    // 0 moves at full speed straight away
+    {"safety_rod_acceleration_per_second_squared",
+     &ReactorConfiguration::safety_rod_acceleration_per_second_squared,
+     ParameterRange::NOT_NEGATIVE},
+    {"regulating_rod_acceleration_per_second_squared",
+     &ReactorConfiguration::regulating_rod_acceleration_per_second_squared,
+     ParameterRange::NOT_NEGATIVE},
+    {"compensating_rod_acceleration_per_second_squared",
+     &ReactorConfiguration::compensating_rod_acceleration_per_second_squared,
+     ParameterRange::NOT_NEGATIVE},
+};
+
+// The group parameters are these followed by the group, from 1
+static constexpr const char *DELAYED_NEUTRON_FRACTION_PREFIX =
+    "delayed_neutron_fraction_";
+static constexpr const char *DECAY_TIME_PREFIX = "decay_time_";
+
+/// Gets the group of a name starting with prefix, 0 if it doesn't or isn't a
+/// group
+static uint8_t get_group(const char *name, const char *prefix) {
+  size_t prefix_length = strlen(prefix);
+
+  if (strncmp(name, prefix, prefix_length) != 0) {
+    return 0;
+  }
+
+  const char *group_text = name + prefix_length;
+  char *end;
+  long group = strtol(group_text, &end, 10);
+
+  if (end == group_text || *end != '\0' || group < 1 ||
+      group > DELAYED_NEUTRON_GROUPS) {
+    return 0;
+  }
+
+  return (uint8_t)group;
+}
+
+ReactorParameters::ReactorParameters(const ReactorConfiguration &parameters)
+    : parameters(parameters) {}
+
+bool ReactorParameters::load_from_file(const char *path) {
+  FILE *file = fopen(path, "r");
+
+  if (file == nullptr) {
+    return fail("Can't open %s", path);
+  }
+
+  char line[256];
+  uint32_t line_number = 1;
+  bool loaded = true;
+
+  while (loaded && fgets(line, sizeof(line), file) != nullptr) {
+    loaded = load_line(line, line_number);
+    line_number += 1;
+  }
+
+  fclose(file);
+  return loaded;
+}
+
+bool ReactorParameters::load_from_string(const char *text) {
+  char line[256];
+  uint32_t line_number = 1;
+
+  while (*text != '\0') {
+    size_t length = strcspn(text, "\n");
+
+    if (length >= sizeof(line)) {
+      return fail("Line %u is too long", line_number);
+    }
+
+    memcpy(line, text, length);
+    line[length] = '\0';
+
+    if (!load_line(line, line_number)) {
+      return false;
+    }
+
+    text += length;
+    text += *text == '\n' ? 1 : 0;
+    line_number += 1;
+  }
+
+  return true;
+}
+
+/// Loads one "name = value" line, empty lines and comments are skipped
+bool ReactorParameters::load_line(const char *line, uint32_t line_number) {
+  char name[96];
+  size_t length = strcspn(line, "#\r\n");
+
+  // Name
+  while (length > 0 && isspace((unsigned char)*line)) {
+    line++;
+    length--;
+  }
+
+  if (length == 0) {
+    return true;
+  }
+
+  size_t name_length = 0;
+
+  while (name_length < length &&
+         (isalnum((unsigned char)line[name_length]) ||
+          line[name_length] == '_')) {
+    name_length++;
+  }
+
+  if (name_length == 0 || name_length >= sizeof(name)) {
+    return fail("Line %u: expected a parameter name", line_number);
+  }
+
+  memcpy(name, line, name_length);
+  name[name_length] = '\0';
+
+  // = value
+  const char *rest = line + name_length;
+  const char *end_of_line = line + length;
+
+  while (rest < end_of_line && isspace((unsigned char)*rest)) {
+    rest++;
+  }
+
+  if (rest == end_of_line || *rest != '=') {
+    return fail("Line %u: expected = after %s", line_number, name);
+  }
+
+  rest++;
+  char *end_of_value;
+  double value = strtod(rest, &end_of_value);
+
+  if (end_of_value == rest || end_of_value > end_of_line) {
+    return fail("Line %u: expected a number for %s", line_number, name);
+  }
+
+  while (end_of_value < end_of_line && isspace((unsigned char)*end_of_value)) {
+    end_of_value++;
+  }
+
+  if (end_of_value != end_of_line) {
+    return fail("Line %u: unexpected text after the value of %s", line_number,
+                name);
+  }
+
+  if (!set_parameter(name, value)) {
+    char reason[sizeof(error)];
+    strcpy(reason, error);
+    return fail("Line %u: %s", line_number, reason);
+  }
+
+  return true;
+}
+
+bool ReactorParameters::set_parameter(const char *name, double value) {
+  for (const DoubleParameter &parameter : DOUBLE_PARAMETERS) {
+    if (strcmp(name, parameter.name) == 0) {
+      parameters.*parameter.value = value;
+      return true;
+    }
+  }
+
+  for (const IntegerParameter &parameter : INTEGER_PARAMETERS) {
+    if (strcmp(name, parameter.name) == 0) {
+      if (!(value >= 0.0 && value <= (double)UINT32_MAX) ||
+          value != std::floor(value)) {
+        return fail("%s has to be a whole number", name);
+      }
+
+      parameters.*parameter.value = (uint32_t)value;
+      return true;
+    }
+  }
+
+  if (uint8_t group = get_group(name, DELAYED_NEUTRON_FRACTION_PREFIX)) {
+    parameters.delayed_neutron_fractions[group - 1] = value;
+    return true;
+  }
+
+  if (uint8_t group = get_group(name, DECAY_TIME_PREFIX)) {
+    parameters.decay_times[group - 1] = value;
+    return true;
+  }
+
+  return fail("Unknown parameter %s", name);
+}
+
+bool ReactorParameters::validate() {
+  for (const DoubleParameter &parameter : DOUBLE_PARAMETERS) {
+    double value = parameters.*parameter.value;
+
+    if (!std::isfinite(value)) {
+      return fail("%s isn't a finite number", parameter.name);
+    }
+
+    if (parameter.range == ParameterRange::POSITIVE && !(value > 0.0)) {
+      return fail("%s has to be above 0", parameter.name);
+    }
+
+    if (parameter.range == ParameterRange::NOT_NEGATIVE && value < 0.0) {
+      return fail("%s can't be below 0", parameter.name);
+    }
+  }
+
+  for (const IntegerParameter &parameter : INTEGER_PARAMETERS) {
+    if (parameter.range == ParameterRange::POSITIVE &&
+        parameters.*parameter.value == 0) {
+      return fail("%s has to be above 0", parameter.name);
+    }
+  }
+
+  double fraction_sum = 0.0;
+
+  for (uint8_t i = 0; i < DELAYED_NEUTRON_GROUPS; i++) {
+    double fraction = parameters.delayed_neutron_fractions[i];
+    double decay_time = parameters.decay_times[i];
+
+    if (!std::isfinite(fraction) || !(fraction > 0.0)) {
+      return fail("%s%u has to be above 0", DELAYED_NEUTRON_FRACTION_PREFIX,
+                  i + 1);
+    }
+
+    if (!std::isfinite(decay_time) || !(decay_time > 0.0)) {
+      return fail("%s%u has to be above 0", DECAY_TIME_PREFIX, i + 1);
+    }
+
+    fraction_sum += fraction;
+  }
+
+  if (!(fraction_sum < 1.0)) {
+    return fail("The delayed neutron fractions add up to %g, over 1",
+                fraction_sum);
+  }
+
+  // The fuel element nodes have room for a full TRIGA core
+  if (parameters.fuel_elements_in_core >
+      FUEL_ELEMENT_TEMPERATURES_MAX_ELEMENTS) {
+    return fail("fuel_elements_in_core can't be above %u",
+                FUEL_ELEMENT_TEMPERATURES_MAX_ELEMENTS);
+  }
+
+  if (!(parameters.fuel_element_inner_radius_cm <
+        parameters.fuel_element_outer_radius_cm)) {
+    return fail("fuel_element_inner_radius_cm has to be below "
+                "fuel_element_outer_radius_cm");
+  }
+
+  // The stationary temperature has to be a cubic in the power Cardano's
+  // formula can invert, the table catches a polynomial it can't (NaN)
+  if (parameters.temperature_fe_stat_a2 == 0.0) {
+    return fail("temperature_fe_stat_a2 can't be 0");
+  }
+
+  if (!calculate_power_exchanged_approximation_within_error(
+          parameters, calculate_power_exchanged_approximation(parameters))) {
+    return fail("The fuel to water power table is further than %g W per "
+                "element from Cardano's formula, check the "
+                "temperature_fe_stat polynomial",
+                POWER_EXCHANGED_APPROXIMATION_MAX_ERROR_WATTS_PER_ELEMENT);
+  }
+
+  return true;
+}
+
+const char *ReactorParameters::get_error() { return error; }
+
+const ReactorConfiguration &ReactorParameters::get_parameters() {
+  return parameters;
+}
+
+bool ReactorParameters::fail(const char *format, ...) {
+  va_list arguments;
+  va_start(arguments, format);
+  vsnprintf(error, sizeof(error), format, arguments);
+  va_end(arguments);
+
+  return false;
+}
@@ -0,0 +1,52 @@
+#ifndef REACTOR_PARAMETERS_HPP
+#define REACTOR_PARAMETERS_HPP
+
+#include "reactor_configuration.hpp"
+#include <stdint.h>
+
+/// A set of reactor parameters that can be changed at runtime, for sweeps and
+/// what-if runs on the desktop, loaded from text and checked before they are
+/// given to RuntimeReactor::apply_parameters.
+///
+/// The text has one "name = value" per line, the names being the fields of
+/// ReactorConfiguration, with delayed_neutron_fraction_1 to _6 and
+/// decay_time_1 to _6 for the groups. Everything after a # is a comment.
+/// Parameters that aren't given keep their values, so a file only needs what
+/// it changes.
+///
+/// Nothing throws, a failed load or validation returns false and leaves a
+/// description of the first problem in get_error()
+class ReactorParameters {
+public:
+  /// Starts from the parameters of a configuration, the JSI TRIGA by default
+  explicit ReactorParameters(
+      const ReactorConfiguration &parameters = JSI_TRIGA_CONFIGURATION);
+
+  /// Loads the parameters in a text file over the current ones
+  bool load_from_file(const char *path);
+  /// Loads the parameters in a text over the current ones
+  bool load_from_string(const char *text);
+
+  /// Sets one parameter by its name in the text
+  bool set_parameter(const char *name, double value);
+
+  /// Checks the parameters describe a reactor the model can run, and that
+  /// the fuel to water power table is still within its error for them
+  bool validate();
+
+  /// Describes why the last load, set or validation failed
+  const char *get_error();
+
+  const ReactorConfiguration &get_parameters();
+
+protected:
+  /// Loads one line of the text, numbered from 1 for the errors
+  bool load_line(const char *line, uint32_t line_number);
+
+  /// Writes a description of the problem to error, and returns false
+  bool fail(const char *format, ...);
+
+  ReactorConfiguration parameters;
+  char error[160] = "";
+};
+#endif
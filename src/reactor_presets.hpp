@@ -0,0 +1,105 @@
+#ifndef REACTOR_PRESETS_HPP
+#define REACTOR_PRESETS_HPP
+
+#include "reactor.hpp"
+
+// Steady states of the JSI TRIGA, solved by the compiler and kept as constant
+// data, so a reactor starts at one with Reactor::load_equilibrium instead of
+// simulating its way there. The water is at 20 C in all of them.
+//
+// Each is checked against the model's own equations when it's compiled, see
+// Reactor::calculate_preset_residuals, and stepped once to check it stays
+// put, see Reactor::calculate_preset_step
+
+/// All rods in, the neutrons held at the level the source keeps up
+constexpr Reactor::Equilibrium SOURCE_LEVEL_SHUTDOWN_PRESET =
+    Reactor::calculate_shutdown_preset(20.0);
+
+/// Critical at 100 W, the regulating rod holding it
+constexpr Reactor::Equilibrium PRESET_100_W =
+    Reactor::calculate_preset(100.0, 20.0);
+
+/// Critical at 20 kW, the regulating rod holding it
+constexpr Reactor::Equilibrium PRESET_20_KW =
+    Reactor::calculate_preset(20000.0, 20.0);
+
+/// Critical at 240 kW, the regulating rod holding it. Full power is 250 kW,
+/// where the power SCRAM trips, so this is as close as it can stay
+constexpr Reactor::Equilibrium PRESET_240_KW =
+    Reactor::calculate_preset(240000.0, 20.0);
+
+/// Critical at 240 kW after a long run with xenon poisoning, the regulating
+/// rod further out for the xenon's worth. For a reactor with
+/// Reactor::xenon_poisoning on, the presets above have no xenon in them
+constexpr Reactor::Equilibrium PRESET_240_KW_WITH_XENON =
+    Reactor::calculate_preset(240000.0, 20.0, true);
+
+/// Whether a preset is a steady state of the model. The rods move in whole
+/// steps, so the reactivity is only within half a step's worth, and the rest
+/// is down to rounding
+constexpr bool is_preset_at_equilibrium(const Reactor::Equilibrium &preset) {
+  Reactor::EquilibriumResiduals residuals =
+      Reactor::calculate_preset_residuals(preset);
+
+  double half_step_worth_pcm =
+      JSI_TRIGA_CONFIGURATION.control_rod_worth_pcm / 4e6 / 2.0;
+  double fuel_power_tolerance_watts = 1e-9 * ((double)preset.power_watts + 1.0);
+
+  return residuals.reactivity_pcm <= half_step_worth_pcm &&
+         residuals.reactivity_pcm >= -half_step_worth_pcm &&
+         residuals.precursor_imbalance <= 1e-12 &&
+         residuals.fuel_power_watts <= fuel_power_tolerance_watts &&
+         residuals.fuel_power_watts >= -fuel_power_tolerance_watts;
+}
+
+/// Whether one step of a preset, see Reactor::calculate_preset_step, leaves it
+/// where it was. The reactivity the rods are off by, at most half a step's
+/// worth, moves the neutrons by rho / lifetime of them a second
+constexpr bool is_preset_steady_over_a_step(const Reactor::Equilibrium &preset) {
+  double step_seconds = 1e-4;
+  Reactor::Equilibrium stepped =
+      Reactor::calculate_preset_step(preset, step_seconds);
+
+  double half_step_worth = JSI_TRIGA_CONFIGURATION.control_rod_worth_pcm /
+                           4e6 / 2.0 * 1e-5;
+  double neutron_tolerance =
+      2.0 * half_step_worth /
+          JSI_TRIGA_CONFIGURATION.prompt_neutron_lifetime_seconds *
+          step_seconds +
+      1e-12;
+  double neutron_change = stepped.neutrons_in_core / preset.neutrons_in_core - 1.0;
+  double fuel_change_celcius =
+      stepped.fuel_temperature_celcius - preset.fuel_temperature_celcius;
+  double largest_precursor_change = 0.0;
+
+  for (uint8_t i = 0; i < DELAYED_NEUTRON_GROUPS; i++) {
+    double change = stepped.precursor_populations[i] /
+                        preset.precursor_populations[i] -
+                    1.0;
+    largest_precursor_change = std::max(largest_precursor_change,
+                                        change < 0.0 ? -change : change);
+  }
+
+  return neutron_change <= neutron_tolerance &&
+         neutron_change >= -neutron_tolerance &&
+         largest_precursor_change <= neutron_tolerance &&
+         fuel_change_celcius <= 1e-9 && fuel_change_celcius >= -1e-9;
+}
+
+static_assert(is_preset_at_equilibrium(SOURCE_LEVEL_SHUTDOWN_PRESET));
+static_assert(is_preset_at_equilibrium(PRESET_100_W));
+static_assert(is_preset_at_equilibrium(PRESET_20_KW));
+static_assert(is_preset_at_equilibrium(PRESET_240_KW));
+static_assert(is_preset_at_equilibrium(PRESET_240_KW_WITH_XENON));
+
+static_assert(is_preset_steady_over_a_step(SOURCE_LEVEL_SHUTDOWN_PRESET));
+static_assert(is_preset_steady_over_a_step(PRESET_100_W));
+static_assert(is_preset_steady_over_a_step(PRESET_20_KW));
+static_assert(is_preset_steady_over_a_step(PRESET_240_KW));
+static_assert(is_preset_steady_over_a_step(PRESET_240_KW_WITH_XENON));
+
+static_assert(!SOURCE_LEVEL_SHUTDOWN_PRESET.critical && PRESET_100_W.critical &&
+                  PRESET_20_KW.critical && PRESET_240_KW.critical &&
+                  PRESET_240_KW_WITH_XENON.critical,
+              "The regulating rod can't reach a preset");
+#endif
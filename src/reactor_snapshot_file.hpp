@@ -0,0 +1,39 @@
+#ifndef REACTOR_SNAPSHOT_FILE_HPP
+#define REACTOR_SNAPSHOT_FILE_HPP
+
+#include <stdio.h>
+
+// Saving and loading BasicReactor::ReactorSnapshot on the desktop. The file is
+// the bytes of the snapshot, load_snapshot checks it's for the reactor
+
+/// Writes a snapshot from save_snapshot to a file, replacing it
+template <typename Snapshot>
+bool write_snapshot_file(const char *path, const Snapshot &snapshot) {
+  FILE *file = fopen(path, "wb");
+
+  if (file == nullptr) {
+    return false;
+  }
+
+  bool written = fwrite(&snapshot, sizeof(Snapshot), 1, file) == 1;
+
+  return fclose(file) == 0 && written;
+}
+
+/// Reads a snapshot written by write_snapshot_file, for load_snapshot. False
+/// if the file can't be read or isn't the size of a Snapshot
+template <typename Snapshot>
+bool read_snapshot_file(const char *path, Snapshot &snapshot) {
+  FILE *file = fopen(path, "rb");
+
+  if (file == nullptr) {
+    return false;
+  }
+
+  bool read = fread(&snapshot, sizeof(Snapshot), 1, file) == 1 &&
+              fgetc(file) == EOF;
+
+  fclose(file);
+  return read;
+}
+#endif
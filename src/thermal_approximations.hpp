@@ -0,0 +1,366 @@
+#ifndef THERMAL_APPROXIMATIONS_HPP
+#define THERMAL_APPROXIMATIONS_HPP
+
+// Approximations of the thermal model's transcendental math, worked out at
+// compile time from the reactor configuration. See
+// BasicReactor::approximate_thermal_math
+#include "reactor_configuration.hpp"
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Square root that can be worked out at compile time, with newton's method.
+/// 0 for anything not positive
+constexpr double calculate_constexpr_sqrt(double x) {
+  if (x <= 0.0) {
+    return 0.0;
+  }
+
+  // Scale into [0.25, 4], where newton's method from 1 converges quickly
+  double scale = 1.0;
+
+  while (x > 4.0) {
+    x /= 4.0;
+    scale *= 2.0;
+  }
+
+  while (x < 0.25) {
+    x *= 4.0;
+    scale /= 2.0;
+  }
+
+  double root = 1.0;
+
+  for (uint8_t i = 0; i < 8; i++) {
+    root = 0.5 * (root + x / root);
+  }
+
+  return root * scale;
+}
+
+/// Cube root that can be worked out at compile time, with newton's method
+constexpr double calculate_constexpr_cbrt(double x) {
+  if (x == 0.0) {
+    return 0.0;
+  }
+
+  if (x < 0.0) {
+    return -calculate_constexpr_cbrt(-x);
+  }
+
+  // Scale into [0.125, 8], where newton's method from 1 converges quickly
+  double scale = 1.0;
+
+  while (x > 8.0) {
+    x /= 8.0;
+    scale *= 2.0;
+  }
+
+  while (x < 0.125) {
+    x *= 8.0;
+    scale /= 2.0;
+  }
+
+  double root = 1.0;
+
+  for (uint8_t i = 0; i < 10; i++) {
+    root -= (root * root * root - x) / (3.0 * root * root);
+  }
+
+  return root * scale;
+}
+
+/// A function on [x_min, x_max] as PIECES cubic pieces of equal width, each
+/// one the cubic hermite interpolation between the function's values and
+/// slopes at the ends of the piece.
+///
+/// Built at compile time in double, and then converted to the type it's
+/// evaluated in
+template <typename T, size_t PIECES> class PiecewiseCubic {
+public:
+  /// Coefficients of c0 + c1 t + c2 t^2 + c3 t^3, t going from 0 to 1 over
+  /// the piece
+  struct Piece {
+    T c0, c1, c2, c3;
+  };
+
+  constexpr PiecewiseCubic() = default;
+
+  /// Builds the pieces from the function and its derivative
+  template <typename F, typename DF>
+  constexpr PiecewiseCubic(double x_min, double x_max, F &&function,
+                           DF &&derivative)
+      : x_min(x_min), x_max(x_max),
+        pieces_per_unit((double)PIECES / (x_max - x_min)) {
+    double width = (x_max - x_min) / (double)PIECES;
+
+    for (size_t i = 0; i < PIECES; i++) {
+      double start = x_min + width * (double)i;
+      double end = x_min + width * (double)(i + 1);
+
+      double value_at_start = function(start);
+      double value_at_end = function(end);
+      // Slopes per t, not per x
+      double slope_at_start = derivative(start) * width;
+      double slope_at_end = derivative(end) * width;
+
+      pieces[i].c0 = value_at_start;
+      pieces[i].c1 = slope_at_start;
+      pieces[i].c2 = 3.0 * (value_at_end - value_at_start) -
+                     2.0 * slope_at_start - slope_at_end;
+      pieces[i].c3 = 2.0 * (value_at_start - value_at_end) + slope_at_start +
+                     slope_at_end;
+    }
+  }
+
+  /// The same pieces, in another type
+  template <typename U> constexpr PiecewiseCubic<U, PIECES> convert() const {
+    PiecewiseCubic<U, PIECES> result;
+    result.x_min = x_min;
+    result.x_max = x_max;
+    result.pieces_per_unit = pieces_per_unit;
+
+    for (size_t i = 0; i < PIECES; i++) {
+      result.pieces[i] = {U(pieces[i].c0), U(pieces[i].c1), U(pieces[i].c2),
+                          U(pieces[i].c3)};
+    }
+
+    return result;
+  }
+
+  /// Whether x is within the range of the pieces
+  constexpr bool contains(T x) const {
+    return x >= T(x_min) && x <= T(x_max);
+  }
+
+  /// Evaluates the piece x is in, x must be within the range
+  constexpr T evaluate(T x) const {
+    T position = (x - T(x_min)) * T(pieces_per_unit);
+    size_t i = (size_t)position;
+
+    // Only x_max itself, the end of the last piece
+    if (i >= PIECES) {
+      i = PIECES - 1;
+    }
+
+    T t = position - T(i);
+    const Piece &piece = pieces[i];
+
+    return ((piece.c3 * t + piece.c2) * t + piece.c1) * t + piece.c0;
+  }
+
+  /// Calculates the largest difference to the function, sampled at
+  /// samples_per_piece - 1 points inside every piece
+  template <typename F>
+  constexpr double calculate_max_error(F &&function,
+                                       size_t samples_per_piece = 8) const {
+    double max_error = 0.0;
+
+    for (size_t i = 0; i < PIECES; i++) {
+      for (size_t sample = 1; sample < samples_per_piece; sample++) {
+        double x = x_min + ((double)i + (double)sample /
+                                            (double)samples_per_piece) /
+                               pieces_per_unit;
+        double error = (double)evaluate(T(x)) - function(x);
+
+        if (error < 0.0) {
+          error = -error;
+        }
+
+        if (error > max_error) {
+          max_error = error;
+        }
+      }
+    }
+
+    return max_error;
+  }
+
+  double x_min = 0.0;
+  double x_max = 0.0;
+  double pieces_per_unit = 0.0;
+  std::array<Piece, PIECES> pieces = {};
+};
+
+// == Fuel to water power, P_fe_stat ==
+
+/// The exact power the fuel gives the water, by inverting the stationary fuel
+/// temperature polynomial with Cardano's formula. The same math as
+/// BasicReactor::calculate_power_exchanged_joule_per_second, which has the
+/// details
+template <uint8_t GROUPS>
+constexpr double calculate_constexpr_power_exchanged_watts(
+    const BasicReactorConfiguration<GROUPS> &configuration,
+    double temperature_difference_K) {
+  double A0 = configuration.temperature_fe_stat_a0;
+  double A1 = configuration.temperature_fe_stat_a1;
+  double A2 = configuration.temperature_fe_stat_a2;
+
+  double first = A1 * A1 - 3.0 * A0 * A2;
+  double second = 2.0 * A1 * A1 * A1 - 9.0 * A0 * A1 * A2 +
+                  27.0 * A2 * A2 * temperature_difference_K;
+  double discriminant = second * second - 4.0 * first * first * first;
+  double root = calculate_constexpr_cbrt(
+      (second + calculate_constexpr_sqrt(discriminant)) / 2.0);
+
+  return -(double)configuration.fuel_elements_in_core * (1.0 / (3.0 * A2)) *
+         (A1 + root + (first / root));
+}
+
+/// d P_fe_stat / d (T_water - T_fuel). The temperature is a polynomial of the
+/// power per element, so this is one over its derivative
+template <uint8_t GROUPS>
+constexpr double calculate_constexpr_power_exchanged_derivative_watts_per_K(
+    const BasicReactorConfiguration<GROUPS> &configuration,
+    double temperature_difference_K) {
+  double elements = (double)configuration.fuel_elements_in_core;
+  double power_per_element_watts =
+      calculate_constexpr_power_exchanged_watts(configuration,
+                                                temperature_difference_K) /
+      elements;
+
+  return -elements /
+         (configuration.temperature_fe_stat_a0 +
+          2.0 * configuration.temperature_fe_stat_a1 * power_per_element_watts +
+          3.0 * configuration.temperature_fe_stat_a2 *
+              power_per_element_watts * power_per_element_watts);
+}
+
+/// Builds the P_fe_stat table of a configuration, over a water minus fuel
+/// temperature of -448 to 64 C, 2 C a piece. The fuel SCRAMs at 300 C, so the
+/// rest falls back to Cardano.
+///
+/// At compile time for BasicReactor's CONFIGURATION, and when runtime
+/// parameters are applied
+template <uint8_t GROUPS>
+constexpr PiecewiseCubic<double, 256> calculate_power_exchanged_approximation(
+    const BasicReactorConfiguration<GROUPS> &configuration) {
+  return PiecewiseCubic<double, 256>(
+      -448.0, 64.0,
+      [&](double temperature_difference_K) {
+        return calculate_constexpr_power_exchanged_watts(
+            configuration, temperature_difference_K);
+      },
+      [&](double temperature_difference_K) {
+        return calculate_constexpr_power_exchanged_derivative_watts_per_K(
+            configuration, temperature_difference_K);
+      });
+}
+
+template <BasicReactorConfiguration CONFIGURATION>
+constexpr PiecewiseCubic<double, 256> POWER_EXCHANGED_APPROXIMATION_DOUBLE =
+    calculate_power_exchanged_approximation(CONFIGURATION);
+
+/// Largest error of POWER_EXCHANGED_APPROXIMATION per fuel element, out of up
+/// to 15 kW. Checked by BasicReactor for its configuration, and by
+/// ReactorParameters::validate for runtime ones
+constexpr double POWER_EXCHANGED_APPROXIMATION_MAX_ERROR_WATTS_PER_ELEMENT =
+    1.0 / 59.0;
+
+/// Whether a configuration's P_fe_stat table is within
+/// POWER_EXCHANGED_APPROXIMATION_MAX_ERROR_WATTS_PER_ELEMENT of Cardano
+template <uint8_t GROUPS>
+constexpr bool calculate_power_exchanged_approximation_within_error(
+    const BasicReactorConfiguration<GROUPS> &configuration,
+    const PiecewiseCubic<double, 256> &approximation) {
+  double max_error_watts =
+      approximation.calculate_max_error([&](double temperature_difference_K) {
+        return calculate_constexpr_power_exchanged_watts(
+            configuration, temperature_difference_K);
+      });
+
+  return max_error_watts <
+         POWER_EXCHANGED_APPROXIMATION_MAX_ERROR_WATTS_PER_ELEMENT *
+             configuration.fuel_elements_in_core;
+}
+
+template <BasicReactorConfiguration CONFIGURATION>
+constexpr bool POWER_EXCHANGED_APPROXIMATION_WITHIN_ERROR =
+    calculate_power_exchanged_approximation_within_error(
+        CONFIGURATION, POWER_EXCHANGED_APPROXIMATION_DOUBLE<CONFIGURATION>);
+
+template <typename T, BasicReactorConfiguration CONFIGURATION>
+constexpr PiecewiseCubic<T, 256> POWER_EXCHANGED_APPROXIMATION =
+    POWER_EXCHANGED_APPROXIMATION_DOUBLE<CONFIGURATION>.template convert<T>();
+
+// == Water to air convection, Q air ==
+
+/// 13.6 W/K^(4/3) * (T_water - T_air)^(4/3)
+constexpr double
+calculate_constexpr_air_convection_watts(double temperature_difference_K) {
+  return 13.6 * temperature_difference_K *
+         calculate_constexpr_cbrt(temperature_difference_K);
+}
+
+constexpr double calculate_constexpr_air_convection_derivative_watts_per_K(
+    double temperature_difference_K) {
+  return 13.6 * (4.0 / 3.0) *
+         calculate_constexpr_cbrt(temperature_difference_K);
+}
+
+/// Q air for water 0 to 128 C above the air, 0.5 C a piece
+constexpr PiecewiseCubic<double, 256> AIR_CONVECTION_APPROXIMATION_DOUBLE(
+    0.0, 128.0, calculate_constexpr_air_convection_watts,
+    calculate_constexpr_air_convection_derivative_watts_per_K);
+
+/// Largest error of AIR_CONVECTION_APPROXIMATION, out of up to 8.7 kW. Almost
+/// all of it in the first piece, where the slope goes to 0
+constexpr double AIR_CONVECTION_APPROXIMATION_MAX_ERROR_WATTS = 0.5;
+
+static_assert(AIR_CONVECTION_APPROXIMATION_DOUBLE.calculate_max_error(
+                  calculate_constexpr_air_convection_watts) <
+              AIR_CONVECTION_APPROXIMATION_MAX_ERROR_WATTS);
+
+template <typename T>
+constexpr PiecewiseCubic<T, 256> AIR_CONVECTION_APPROXIMATION =
+    AIR_CONVECTION_APPROXIMATION_DOUBLE.convert<T>();
+
+// == Fuel heat capacity, Cp(T) ==
+
+// Cp(T) = 333 + 0.678 (T + 0.15) J/kgK, and times the fuel mass, folded into
+// c0 + c1 T. Exact, apart from rounding
+constexpr double FUEL_CAPACITY_J_PER_KG_K_C0 = 333.0 + 0.678 * 0.15;
+constexpr double FUEL_CAPACITY_J_PER_KG_K_C1 = 0.678;
+template <uint8_t GROUPS>
+constexpr double calculate_fuel_capacity_J_per_K_c0(
+    const BasicReactorConfiguration<GROUPS> &configuration) {
+  return FUEL_CAPACITY_J_PER_KG_K_C0 * configuration.calculate_fuel_mass_kg();
+}
+template <uint8_t GROUPS>
+constexpr double calculate_fuel_capacity_J_per_K_c1(
+    const BasicReactorConfiguration<GROUPS> &configuration) {
+  return FUEL_CAPACITY_J_PER_KG_K_C1 * configuration.calculate_fuel_mass_kg();
+}
+
+// == Fuel temperature feedback ==
+
+// The feedback is T times a coefficient that's linear in T on both sides of
+// 240 C, so T (c0 + c1 T) with the constants folded in. Exact, apart from
+// rounding
+template <uint8_t GROUPS>
+constexpr double calculate_fuel_feedback_below_240_c_c0(
+    const BasicReactorConfiguration<GROUPS> &configuration) {
+  return configuration.fuel_t_feedback_coefficient_0_c_pcm_per_c;
+}
+template <uint8_t GROUPS>
+constexpr double calculate_fuel_feedback_below_240_c_c1(
+    const BasicReactorConfiguration<GROUPS> &configuration) {
+  return (configuration.fuel_t_feedback_coefficient_240_c_pcm_per_c -
+          configuration.fuel_t_feedback_coefficient_0_c_pcm_per_c) /
+         240.0;
+}
+template <uint8_t GROUPS>
+constexpr double calculate_fuel_feedback_above_240_c_c0(
+    const BasicReactorConfiguration<GROUPS> &configuration) {
+  return configuration.fuel_t_feedback_coefficient_240_c_pcm_per_c -
+         configuration
+                 .fuel_t_feedback_coefficient_slope_after_peak_pcm_per_c_squared *
+             240.0;
+}
+template <uint8_t GROUPS>
+constexpr double calculate_fuel_feedback_above_240_c_c1(
+    const BasicReactorConfiguration<GROUPS> &configuration) {
+  return configuration
+      .fuel_t_feedback_coefficient_slope_after_peak_pcm_per_c_squared;
+}
+#endif
@@ -0,0 +1,44 @@
+#ifndef VECTORIZABLE_MATH_HPP
+#define VECTORIZABLE_MATH_HPP
+
+// Math functions for the structure-of-arrays loops of ReactorEnsemble and
+// FuelElementTemperatures, made of operations the compiler can vectorize
+#include <bit>
+#include <stdint.h>
+
+/// Cube root of x >= 0 that the compiler can vectorize, std::cbrt can't be
+///
+/// Starts from the exponent trick in fdlibm's cbrt (divide the high word of the
+/// double by 3) and refines it with newton iterations to double precision, so
+/// the results agree with std::cbrt to rounding.
+///
+/// Only uses 64 bit integer and double operations, since mixing in 32 bit
+/// lanes or int <-> double conversions stops GCC from vectorizing on AVX2
+inline double vectorizable_cbrt(double x) {
+  // 2^52, adding / subtracting it converts between doubles and integers
+  const double TWO_TO_52 = 4503599627370496.0;
+  const uint64_t TWO_TO_52_BITS = 0x4330000000000000;
+
+  // Denormals and 0 don't work with the exponent trick, and the residuals of
+  // tiny numbers are (very slow) denormals. Nudging x up keeps them away and
+  // only changes the result for x below ~1e-184
+  double y = x + 1e-200;
+
+  uint64_t high_word = std::bit_cast<uint64_t>(y) >> 32;
+  double high_word_as_double =
+      std::bit_cast<double>(high_word | TWO_TO_52_BITS) - TWO_TO_52;
+
+  double root_high_word = high_word_as_double * (1.0 / 3.0) + 715094163.0;
+  uint64_t root_high_bits =
+      std::bit_cast<uint64_t>(root_high_word + TWO_TO_52) & 0xFFFFFFFF;
+
+  double root = std::bit_cast<double>(root_high_bits << 32);
+
+  // ~5 correct bits to start with, each iteration doubles that
+  for (uint8_t i = 0; i < 4; i++) {
+    root = root - (root * root * root - y) / (3.0 * root * root);
+  }
+
+  return root;
+}
+#endif